@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef NANOS6_DEBUG_H
@@ -125,6 +125,10 @@ int nanos6_is_dlb_enabled(void);
 //! \brief Check whether NUMA support is enabled
 int nanos6_is_numa_tracking_enabled(void);
 
+//! \brief Write the events kept by the flight recorder to the trace
+//! This function does nothing if the flight recorder is not enabled
+void nanos6_flight_recorder_dump(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1225 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+/* Native reader of the CTF user traces written by Nanos6. It only
+ * understands the subset of the TSDL metadata and the binary layout
+ * that the runtime emits: packed little-endian integers and strings,
+ * one packet per stream file and one struct level inside contexts. */
+
+#include <assert.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <linux/limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ctf.h"
+
+#define err(...) fprintf(stderr, __VA_ARGS__);
+
+#define CTF_MAGIC 0xc1fc1fc1
+
+#define MAX_ALIASES 32
+#define MAX_STRUCTS 16
+#define MAX_MEMBERS CTF_MAX_HWC
+
+/* A declaration inside a struct */
+struct decl {
+	char type[CTF_MAX_NAME];
+	char name[CTF_MAX_NAME];
+	/* Size in bytes, -1 for strings */
+	int size;
+	int is_signed;
+	/* Offset from the start of the struct, -1 after a string */
+	int offset;
+};
+
+struct type_alias {
+	char name[CTF_MAX_NAME];
+	int size;
+	int is_signed;
+};
+
+struct struct_def {
+	char name[CTF_MAX_NAME];
+	int nmembers;
+	struct decl members[MAX_MEMBERS];
+	int size;
+};
+
+struct parser {
+	char **tok;
+	int ntok;
+	int i;
+
+	struct ctf_metadata *meta;
+
+	int naliases;
+	struct type_alias aliases[MAX_ALIASES];
+
+	int nstructs;
+	struct struct_def structs[MAX_STRUCTS];
+};
+
+/* Fields of the block being parsed */
+struct block {
+	char name[CTF_MAX_NAME];
+	int64_t id;
+	int64_t stream_id;
+	int has_id;
+	int64_t offset_s;
+	int64_t offset;
+	int64_t size;
+	int is_signed;
+
+	int has_context;
+	int ncontext;
+	struct decl context[MAX_MEMBERS];
+
+	int has_fields;
+	int nfields;
+	struct decl fields[MAX_MEMBERS];
+
+	int has_packet;
+	int npacket;
+	struct decl packet[MAX_MEMBERS];
+
+	int has_header;
+	int nheader;
+	struct decl header[MAX_MEMBERS];
+};
+
+static void
+fail(struct parser *ps, const char *what)
+{
+	err("ctf: metadata: %s near token %d (%s)\n", what, ps->i,
+			ps->i < ps->ntok ? ps->tok[ps->i] : "EOF");
+	exit(EXIT_FAILURE);
+}
+
+static char *
+read_file(const char *path)
+{
+	FILE *f;
+	long size;
+	char *buf;
+
+	f = fopen(path, "r");
+	if(f == NULL)
+		return NULL;
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	buf = malloc(size + 1);
+	if(buf == NULL || fread(buf, 1, size, f) != (size_t) size)
+	{
+		err("ctf: cannot read %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	buf[size] = '\0';
+	fclose(f);
+
+	return buf;
+}
+
+static void
+add_token(struct parser *ps, const char *start, size_t len)
+{
+	char *tok;
+
+	if((ps->ntok & 255) == 0)
+	{
+		ps->tok = realloc(ps->tok, (ps->ntok + 256) * sizeof(char *));
+		if(ps->tok == NULL) abort();
+	}
+
+	tok = strndup(start, len);
+	if(tok == NULL) abort();
+
+	ps->tok[ps->ntok++] = tok;
+}
+
+/* Split the metadata into identifiers, numbers, strings (which keep the
+ * opening quote) and punctuation. Comments are discarded. */
+static void
+tokenize(struct parser *ps, const char *text)
+{
+	const char *p = text, *start;
+
+	while(*p)
+	{
+		if(isspace((unsigned char) *p))
+		{
+			p++;
+		}
+		else if(p[0] == '/' && p[1] == '*')
+		{
+			p = strstr(p + 2, "*/");
+			if(p == NULL)
+			{
+				err("ctf: metadata: unterminated comment\n");
+				exit(EXIT_FAILURE);
+			}
+			p += 2;
+		}
+		else if(p[0] == '/' && p[1] == '/')
+		{
+			while(*p && *p != '\n')
+				p++;
+		}
+		else if(*p == '"')
+		{
+			start = p++;
+			while(*p && *p != '"')
+				p++;
+			if(*p == '\0')
+			{
+				err("ctf: metadata: unterminated string\n");
+				exit(EXIT_FAILURE);
+			}
+			add_token(ps, start, p - start);
+			p++;
+		}
+		else if(p[0] == ':' && p[1] == '=')
+		{
+			add_token(ps, p, 2);
+			p += 2;
+		}
+		else if(isalnum((unsigned char) *p) || *p == '_' || *p == '-')
+		{
+			start = p++;
+			while(isalnum((unsigned char) *p) || *p == '_' || *p == '.')
+				p++;
+			add_token(ps, start, p - start);
+		}
+		else
+		{
+			add_token(ps, p, 1);
+			p++;
+		}
+	}
+}
+
+static const char *
+peek(struct parser *ps)
+{
+	if(ps->i >= ps->ntok)
+		return "";
+
+	return ps->tok[ps->i];
+}
+
+static const char *
+next(struct parser *ps)
+{
+	if(ps->i >= ps->ntok)
+		fail(ps, "unexpected end");
+
+	return ps->tok[ps->i++];
+}
+
+static void
+expect(struct parser *ps, const char *tok)
+{
+	if(strcmp(next(ps), tok) != 0)
+	{
+		ps->i--;
+		fail(ps, "unexpected token");
+	}
+}
+
+static int
+accept(struct parser *ps, const char *tok)
+{
+	if(strcmp(peek(ps), tok) != 0)
+		return 0;
+
+	ps->i++;
+	return 1;
+}
+
+/* Skip tokens up to and including the next ';' outside braces */
+static void
+skip_statement(struct parser *ps)
+{
+	int depth = 0;
+	const char *tok;
+
+	do {
+		tok = next(ps);
+		if(strcmp(tok, "{") == 0)
+			depth++;
+		else if(strcmp(tok, "}") == 0)
+			depth--;
+	} while(depth > 0 || strcmp(tok, ";") != 0);
+}
+
+static int64_t
+parse_int(struct parser *ps, const char *tok)
+{
+	char *end;
+	int64_t value;
+
+	if(tok[0] == '"')
+		tok++;
+
+	value = strtoll(tok, &end, 0);
+	if(end == tok)
+		fail(ps, "expected an integer");
+
+	return value;
+}
+
+static const struct struct_def *
+find_struct(struct parser *ps, const char *name)
+{
+	int i;
+
+	for(i=0; i<ps->nstructs; i++)
+	{
+		if(strcmp(ps->structs[i].name, name) == 0)
+			return &ps->structs[i];
+	}
+
+	return NULL;
+}
+
+static const struct decl *
+find_decl(const struct decl *decls, int n, const char *name)
+{
+	int i;
+
+	for(i=0; i<n; i++)
+	{
+		if(strcmp(decls[i].name, name) == 0)
+			return &decls[i];
+	}
+
+	return NULL;
+}
+
+/* Parse the declarations of a struct body, after the opening brace and
+ * up to and including the closing one. Returns the number of members */
+static int
+parse_struct_body(struct parser *ps, struct decl *decls, int *size)
+{
+	int n = 0, offset = 0, i;
+	const char *type;
+	struct decl *d;
+
+	while(!accept(ps, "}"))
+	{
+		if(n == MAX_MEMBERS)
+			fail(ps, "too many struct members");
+
+		d = &decls[n++];
+		memset(d, 0, sizeof(*d));
+
+		type = next(ps);
+		if(strcmp(type, "struct") == 0)
+		{
+			const struct struct_def *s = find_struct(ps, next(ps));
+
+			if(s == NULL)
+			{
+				ps->i--;
+				fail(ps, "unknown struct");
+			}
+			strcpy(d->type, s->name);
+			d->size = s->size;
+		}
+		else if(strcmp(type, "string") == 0)
+		{
+			strcpy(d->type, "string");
+			d->size = -1;
+		}
+		else
+		{
+			for(i=0; i<ps->naliases; i++)
+			{
+				if(strcmp(ps->aliases[i].name, type) == 0)
+					break;
+			}
+
+			if(i == ps->naliases)
+			{
+				ps->i--;
+				fail(ps, "unknown type");
+			}
+
+			strncpy(d->type, type, CTF_MAX_NAME - 1);
+			d->size = ps->aliases[i].size;
+			d->is_signed = ps->aliases[i].is_signed;
+		}
+
+		strncpy(d->name, next(ps), CTF_MAX_NAME - 1);
+		expect(ps, ";");
+
+		d->offset = offset;
+		if(offset >= 0)
+			offset = (d->size < 0) ? -1 : offset + d->size;
+	}
+
+	*size = offset;
+
+	return n;
+}
+
+/* Parse the body of a top level block such as "event { ... };" */
+static void
+parse_block(struct parser *ps, struct block *b)
+{
+	const char *key, *value;
+	struct decl *decls;
+	int *ndecls, size;
+
+	memset(b, 0, sizeof(*b));
+	expect(ps, "{");
+
+	while(!accept(ps, "}"))
+	{
+		key = next(ps);
+
+		if(accept(ps, "="))
+		{
+			value = next(ps);
+
+			if(strcmp(key, "name") == 0)
+				strncpy(b->name, value[0] == '"' ? value + 1 : value,
+						CTF_MAX_NAME - 1);
+			else if(strcmp(key, "id") == 0)
+				b->id = parse_int(ps, value), b->has_id = 1;
+			else if(strcmp(key, "stream_id") == 0)
+				b->stream_id = parse_int(ps, value);
+			else if(strcmp(key, "offset_s") == 0)
+				b->offset_s = parse_int(ps, value);
+			else if(strcmp(key, "offset") == 0)
+				b->offset = parse_int(ps, value);
+			else if(strcmp(key, "size") == 0)
+				b->size = parse_int(ps, value);
+			else if(strcmp(key, "signed") == 0)
+				b->is_signed = (strcmp(value, "true") == 0
+						|| strcmp(value, "1") == 0);
+
+			/* Keep the environment as we go */
+			else if(strcmp(key, "cpu_list") == 0)
+				ps->meta->cpu_list = strdup(value + 1);
+			else if(strcmp(key, "external_thread_count") == 0)
+				ps->meta->external_thread_count = parse_int(ps, value);
+			else if(strcmp(key, "start_ts") == 0)
+				ps->meta->start_ts = parse_int(ps, value);
+			else if(strcmp(key, "end_ts") == 0)
+				ps->meta->end_ts = parse_int(ps, value);
+			else if(strcmp(key, "time_correction") == 0)
+				ps->meta->time_correction = parse_int(ps, value);
+
+			expect(ps, ";");
+		}
+		else if(accept(ps, ":="))
+		{
+			if(!accept(ps, "struct"))
+			{
+				skip_statement(ps);
+				continue;
+			}
+
+			if(strcmp(key, "fields") == 0)
+				decls = b->fields, ndecls = &b->nfields, b->has_fields = 1;
+			else if(strcmp(key, "context") == 0 || strcmp(key, "event.context") == 0)
+				decls = b->context, ndecls = &b->ncontext, b->has_context = 1;
+			else if(strcmp(key, "packet.context") == 0 || strcmp(key, "packet.header") == 0)
+				decls = b->packet, ndecls = &b->npacket, b->has_packet = 1;
+			else if(strcmp(key, "event.header") == 0)
+				decls = b->header, ndecls = &b->nheader, b->has_header = 1;
+			else
+				fail(ps, "unknown struct declaration");
+
+			expect(ps, "{");
+			*ndecls = parse_struct_body(ps, decls, &size);
+			expect(ps, ";");
+		}
+		else
+		{
+			skip_statement(ps);
+		}
+	}
+}
+
+static int
+decls_size(struct parser *ps, const struct decl *decls, int n)
+{
+	int size = 0, i;
+
+	for(i=0; i<n; i++)
+	{
+		if(decls[i].size < 0)
+			fail(ps, "strings are only supported in the payload");
+		size += decls[i].size;
+	}
+
+	return size;
+}
+
+static int
+decl_offset(const struct decl *decls, int n, const char *name)
+{
+	const struct decl *d = find_decl(decls, n, name);
+
+	return d ? d->offset : -1;
+}
+
+static void
+parse_typealias(struct parser *ps)
+{
+	struct type_alias *alias;
+	struct block b;
+
+	if(ps->naliases == MAX_ALIASES)
+		fail(ps, "too many type aliases");
+
+	/* integer or floating_point */
+	next(ps);
+	parse_block(ps, &b);
+	expect(ps, ":=");
+
+	alias = &ps->aliases[ps->naliases++];
+	strncpy(alias->name, next(ps), CTF_MAX_NAME - 1);
+	alias->size = b.size / 8;
+	alias->is_signed = b.is_signed;
+	expect(ps, ";");
+}
+
+static void
+parse_struct(struct parser *ps)
+{
+	struct struct_def *s;
+
+	if(ps->nstructs == MAX_STRUCTS)
+		fail(ps, "too many structs");
+
+	s = &ps->structs[ps->nstructs++];
+	strncpy(s->name, next(ps), CTF_MAX_NAME - 1);
+	expect(ps, "{");
+	s->nmembers = parse_struct_body(ps, s->members, &s->size);
+	expect(ps, ";");
+
+	if(s->size < 0)
+		fail(ps, "strings are only supported in the payload");
+
+	/* The hardware counters are declared in their own struct */
+	if(strcmp(s->name, "hwc") == 0)
+	{
+		int i;
+
+		ps->meta->nhwc = s->nmembers;
+		for(i=0; i<s->nmembers; i++)
+			strcpy(ps->meta->hwc_names[i], s->members[i].name);
+	}
+}
+
+static void
+parse_trace(struct parser *ps)
+{
+	struct block b;
+
+	parse_block(ps, &b);
+	expect(ps, ";");
+
+	if(!b.has_packet)
+		fail(ps, "missing packet header");
+
+	ps->meta->packet_header_size = decls_size(ps, b.packet, b.npacket);
+	ps->meta->magic_offset = decl_offset(b.packet, b.npacket, "magic");
+	ps->meta->stream_id_offset = decl_offset(b.packet, b.npacket, "stream_id");
+
+	if(ps->meta->stream_id_offset < 0)
+		fail(ps, "missing stream id in packet header");
+}
+
+static void
+parse_clock(struct parser *ps)
+{
+	struct block b;
+
+	parse_block(ps, &b);
+	expect(ps, ";");
+
+	ps->meta->clock_offset_ns = b.offset_s * 1000000000LL + b.offset;
+}
+
+/* Get the offset of a member of a struct member of the context, such as
+ * "unbounded.tid" */
+static int
+context_member_offset(struct parser *ps, const struct decl *decls, int n,
+		const char *name, const char *member)
+{
+	const struct decl *d = find_decl(decls, n, name);
+	const struct struct_def *s;
+	int offset;
+
+	if(d == NULL)
+		return -1;
+
+	if(member == NULL)
+		return d->offset;
+
+	s = find_struct(ps, d->type);
+	if(s == NULL)
+		return -1;
+
+	offset = decl_offset(s->members, s->nmembers, member);
+	if(offset < 0)
+		return -1;
+
+	return d->offset + offset;
+}
+
+static void
+parse_stream(struct parser *ps)
+{
+	struct ctf_stream_class *sc;
+	const struct decl *id;
+	struct block b;
+
+	parse_block(ps, &b);
+	expect(ps, ";");
+
+	if(!b.has_id || b.id < 0 || b.id >= CTF_MAX_STREAM_CLASSES)
+		fail(ps, "bad stream id");
+
+	if(!b.has_header)
+		fail(ps, "missing event header");
+
+	sc = &ps->meta->streams[b.id];
+	sc->defined = 1;
+
+	sc->packet_context_size = decls_size(ps, b.packet, b.npacket);
+	sc->cpu_id_offset = decl_offset(b.packet, b.npacket, "cpu_id");
+
+	sc->header_size = decls_size(ps, b.header, b.nheader);
+	id = find_decl(b.header, b.nheader, "id");
+	sc->ts_offset = decl_offset(b.header, b.nheader, "timestamp");
+
+	if(id == NULL || sc->ts_offset < 0)
+		fail(ps, "unsupported event header");
+
+	sc->id_offset = id->offset;
+	sc->id_size = id->size;
+
+	sc->context_size = decls_size(ps, b.context, b.ncontext);
+	sc->tid_offset = context_member_offset(ps, b.context, b.ncontext,
+			"unbounded", "tid");
+}
+
+static void
+parse_event(struct parser *ps)
+{
+	struct ctf_event_class *ec;
+	struct ctf_field_class *f;
+	struct block b;
+	const char *name;
+	int i;
+
+	parse_block(ps, &b);
+	expect(ps, ";");
+
+	if(!b.has_id || b.id < 0 || b.id >= CTF_MAX_EVENTS)
+		fail(ps, "bad event id");
+
+	if(b.stream_id < 0 || b.stream_id >= CTF_MAX_STREAM_CLASSES)
+		fail(ps, "bad event stream id");
+
+	if(b.nfields > CTF_MAX_FIELDS)
+		fail(ps, "too many event fields");
+
+	ec = &ps->meta->events[b.stream_id][b.id];
+	ec->defined = 1;
+	ec->id = b.id;
+	strcpy(ec->name, b.name);
+
+	ec->context_size = decls_size(ps, b.context, b.ncontext);
+	ec->hwc_offset = context_member_offset(ps, b.context, b.ncontext,
+			"hwc", NULL);
+
+	ec->nfields = b.nfields;
+	for(i=0; i<b.nfields; i++)
+	{
+		f = &ec->fields[i];
+
+		/* The leading underscore is stripped, as babeltrace does */
+		name = b.fields[i].name;
+		if(name[0] == '_')
+			name++;
+
+		strcpy(f->name, name);
+		f->size = b.fields[i].size;
+
+		if(f->size < 0)
+			f->type = CTF_FIELD_STRING;
+		else if(b.fields[i].is_signed)
+			f->type = CTF_FIELD_INT;
+		else
+			f->type = CTF_FIELD_UINT;
+
+		if(f->type != CTF_FIELD_STRING && f->size != 1 && f->size != 2
+				&& f->size != 4 && f->size != 8)
+			fail(ps, "unsupported integer size");
+	}
+}
+
+static void
+parse_metadata(struct ctf_metadata *meta, const char *path)
+{
+	struct parser ps;
+	const char *tok;
+	char *text;
+	int i;
+
+	text = read_file(path);
+	if(text == NULL)
+	{
+		perror("ctf: cannot open metadata");
+		exit(EXIT_FAILURE);
+	}
+
+	memset(&ps, 0, sizeof(ps));
+	ps.meta = meta;
+
+	tokenize(&ps, text);
+	free(text);
+
+	while(ps.i < ps.ntok)
+	{
+		tok = next(&ps);
+
+		if(strcmp(tok, "typealias") == 0)
+			parse_typealias(&ps);
+		else if(strcmp(tok, "struct") == 0)
+			parse_struct(&ps);
+		else if(strcmp(tok, "trace") == 0)
+			parse_trace(&ps);
+		else if(strcmp(tok, "clock") == 0)
+			parse_clock(&ps);
+		else if(strcmp(tok, "stream") == 0)
+			parse_stream(&ps);
+		else if(strcmp(tok, "event") == 0)
+			parse_event(&ps);
+		else if(strcmp(tok, "env") == 0)
+		{
+			struct block b;
+			parse_block(&ps, &b);
+			expect(&ps, ";");
+		}
+		else
+		{
+			ps.i--;
+			fail(&ps, "unknown block");
+		}
+	}
+
+	for(i=0; i<ps.ntok; i++)
+		free(ps.tok[i]);
+	free(ps.tok);
+
+	if(meta->cpu_list == NULL)
+	{
+		err("ctf: metadata: missing cpu_list\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static uint64_t
+read_uint(const uint8_t *p, int size)
+{
+	uint16_t v16;
+	uint32_t v32;
+	uint64_t v64;
+
+	switch(size)
+	{
+		case 1:
+			return *p;
+		case 2:
+			memcpy(&v16, p, 2);
+			return le16toh(v16);
+		case 4:
+			memcpy(&v32, p, 4);
+			return le32toh(v32);
+		default:
+			memcpy(&v64, p, 8);
+			return le64toh(v64);
+	}
+}
+
+static int64_t
+read_int(const uint8_t *p, int size)
+{
+	switch(size)
+	{
+		case 1:
+			return (int8_t) read_uint(p, 1);
+		case 2:
+			return (int16_t) read_uint(p, 2);
+		case 4:
+			return (int32_t) read_uint(p, 4);
+		default:
+			return (int64_t) read_uint(p, 8);
+	}
+}
+
+static void
+stream_corrupted(struct ctf_stream *s, size_t pos)
+{
+	err("ctf: %s: truncated or corrupted event at offset %zu\n",
+			s->path, pos);
+	exit(EXIT_FAILURE);
+}
+
+/* Decode one event at *pos, which is advanced past it */
+static void
+decode_event(struct ctf_stream *s, size_t *pos, struct ctf_event *ev)
+{
+	const struct ctf_metadata *meta = s->meta;
+	const struct ctf_stream_class *sc = &meta->streams[s->stream_class];
+	const struct ctf_event_class *ec;
+	const struct ctf_field_class *f;
+	const uint8_t *p, *end, *nul;
+	uint64_t id;
+	int i;
+
+	p = s->data + *pos;
+	end = s->data + s->size;
+
+	if(p + sc->header_size + sc->context_size > end)
+		stream_corrupted(s, *pos);
+
+	id = read_uint(p + sc->id_offset, sc->id_size);
+	if(id >= CTF_MAX_EVENTS || !meta->events[s->stream_class][id].defined)
+		stream_corrupted(s, *pos);
+
+	ec = &meta->events[s->stream_class][id];
+
+	ev->ts = (int64_t) read_uint(p + sc->ts_offset, 8) + meta->clock_offset_ns;
+	ev->cpu_id = s->cpu_id;
+	ev->cls = ec;
+	p += sc->header_size;
+
+	ev->tid = -1;
+	if(sc->tid_offset >= 0)
+		ev->tid = (int) read_uint(p + sc->tid_offset, 2);
+	p += sc->context_size;
+
+	if(p + ec->context_size > end)
+		stream_corrupted(s, *pos);
+
+	ev->hwc = (ec->hwc_offset >= 0) ? p + ec->hwc_offset : NULL;
+	p += ec->context_size;
+
+	for(i=0; i<ec->nfields; i++)
+	{
+		f = &ec->fields[i];
+
+		if(f->type == CTF_FIELD_STRING)
+		{
+			nul = memchr(p, '\0', end - p);
+			if(nul == NULL)
+				stream_corrupted(s, *pos);
+
+			ev->values[i].s = (const char *) p;
+			p = nul + 1;
+			continue;
+		}
+
+		if(p + f->size > end)
+			stream_corrupted(s, *pos);
+
+		if(f->type == CTF_FIELD_INT)
+			ev->values[i].i = read_int(p, f->size);
+		else
+			ev->values[i].u = read_uint(p, f->size);
+
+		p += f->size;
+	}
+
+	*pos = p - s->data;
+}
+
+static void *
+stream_decoder(void *arg)
+{
+	struct ctf_stream *s = arg;
+	const struct ctf_metadata *meta = s->meta;
+	struct ctf_chunk *chunk;
+	size_t pos;
+
+	pos = meta->packet_header_size +
+		meta->streams[s->stream_class].packet_context_size;
+
+	do {
+		/* Wait for a free chunk */
+		pthread_mutex_lock(&s->lock);
+		while(s->filled - s->released == CTF_STREAM_CHUNKS)
+			pthread_cond_wait(&s->cond, &s->lock);
+		chunk = &s->chunks[s->filled % CTF_STREAM_CHUNKS];
+		pthread_mutex_unlock(&s->lock);
+
+		chunk->nevents = 0;
+		while(chunk->nevents < CTF_CHUNK_EVENTS && pos < s->size)
+			decode_event(s, &pos, &chunk->events[chunk->nevents++]);
+
+		chunk->last = (pos >= s->size);
+
+		pthread_mutex_lock(&s->lock);
+		s->filled++;
+		pthread_cond_broadcast(&s->cond);
+		pthread_mutex_unlock(&s->lock);
+	} while(!chunk->last);
+
+	return NULL;
+}
+
+/* Wait for the next decoded chunk of the stream */
+static void
+stream_acquire(struct ctf_stream *s)
+{
+	pthread_mutex_lock(&s->lock);
+	while(s->filled == s->released)
+		pthread_cond_wait(&s->cond, &s->lock);
+	s->chunk = &s->chunks[s->released % CTF_STREAM_CHUNKS];
+	pthread_mutex_unlock(&s->lock);
+
+	s->next = 0;
+}
+
+static void
+stream_release(struct ctf_stream *s)
+{
+	pthread_mutex_lock(&s->lock);
+	s->released++;
+	pthread_cond_broadcast(&s->cond);
+	pthread_mutex_unlock(&s->lock);
+
+	s->chunk = NULL;
+}
+
+/* Move to the next event of the stream. Returns 0 at the end */
+static int
+stream_advance(struct ctf_stream *s)
+{
+	s->next++;
+
+	while(s->next >= s->chunk->nevents)
+	{
+		if(s->chunk->last)
+			return 0;
+
+		stream_release(s);
+		stream_acquire(s);
+	}
+
+	return 1;
+}
+
+static void
+stream_open(struct ctf_trace *trace, struct ctf_stream *s, const char *path)
+{
+	const struct ctf_metadata *meta = &trace->meta;
+	const struct ctf_stream_class *sc;
+	struct stat st;
+	void *data;
+	int fd;
+
+	snprintf(s->path, sizeof(s->path), "%s", path);
+	s->meta = meta;
+
+	fd = open(path, O_RDONLY);
+	if(fd < 0 || fstat(fd, &st) != 0)
+	{
+		perror("ctf: cannot open stream");
+		exit(EXIT_FAILURE);
+	}
+
+	s->size = st.st_size;
+	if(s->size < (size_t) meta->packet_header_size)
+		stream_corrupted(s, 0);
+
+	data = mmap(NULL, s->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(data == MAP_FAILED)
+	{
+		perror("ctf: cannot map stream");
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+
+	/* The file is read once, from the beginning to the end */
+	madvise(data, s->size, MADV_SEQUENTIAL);
+	s->data = data;
+
+	if(meta->magic_offset >= 0 &&
+			read_uint(s->data + meta->magic_offset, 4) != CTF_MAGIC)
+	{
+		err("ctf: %s: bad magic number\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	s->stream_class = (int) read_uint(s->data + meta->stream_id_offset, 4);
+	if(s->stream_class >= CTF_MAX_STREAM_CLASSES ||
+			!meta->streams[s->stream_class].defined)
+	{
+		err("ctf: %s: unknown stream class\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	sc = &meta->streams[s->stream_class];
+	if(s->size < (size_t) (meta->packet_header_size + sc->packet_context_size))
+		stream_corrupted(s, 0);
+
+	s->cpu_id = -1;
+	if(sc->cpu_id_offset >= 0)
+		s->cpu_id = (int) read_uint(s->data + meta->packet_header_size
+				+ sc->cpu_id_offset, 2);
+
+	pthread_mutex_init(&s->lock, NULL);
+	pthread_cond_init(&s->cond, NULL);
+	s->filled = 0;
+	s->released = 0;
+
+	if(pthread_create(&s->thread, NULL, stream_decoder, s) != 0)
+	{
+		err("ctf: cannot create the stream thread\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static int
+stream_less(const struct ctf_stream *a, const struct ctf_stream *b)
+{
+	int64_t ta = a->chunk->events[a->next].ts;
+	int64_t tb = b->chunk->events[b->next].ts;
+
+	if(ta != tb)
+		return ta < tb;
+
+	/* Keep the order stable between runs */
+	return a->index < b->index;
+}
+
+static void
+heap_push(struct ctf_trace *trace, struct ctf_stream *s)
+{
+	struct ctf_stream **heap = trace->heap;
+	int i = trace->nheap++, parent;
+
+	while(i > 0)
+	{
+		parent = (i - 1) / 2;
+		if(!stream_less(s, heap[parent]))
+			break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+
+	heap[i] = s;
+}
+
+static struct ctf_stream *
+heap_pop(struct ctf_trace *trace)
+{
+	struct ctf_stream **heap = trace->heap;
+	struct ctf_stream *top = heap[0], *last;
+	int i = 0, child, n;
+
+	n = --trace->nheap;
+	last = heap[n];
+
+	while((child = 2 * i + 1) < n)
+	{
+		if(child + 1 < n && stream_less(heap[child + 1], heap[child]))
+			child++;
+		if(!stream_less(heap[child], last))
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+
+	if(n > 0)
+		heap[i] = last;
+
+	return top;
+}
+
+static int
+is_stream_file(const char *name)
+{
+	return strncmp(name, "channel_", strlen("channel_")) == 0;
+}
+
+int
+ctf_trace_open(struct ctf_trace *trace, const char *dir)
+{
+	char path[PATH_MAX];
+	struct dirent *de;
+	struct ctf_stream *s;
+	DIR *d;
+	int i;
+
+	memset(trace, 0, sizeof(*trace));
+
+	if(snprintf(path, PATH_MAX, "%s/metadata", dir) >= PATH_MAX)
+	{
+		err("ctf: metadata path too large\n");
+		return -1;
+	}
+
+	parse_metadata(&trace->meta, path);
+
+	d = opendir(dir);
+	if(d == NULL)
+	{
+		perror("ctf: cannot open the trace directory");
+		return -1;
+	}
+
+	while((de = readdir(d)) != NULL)
+	{
+		if(!is_stream_file(de->d_name))
+			continue;
+
+		if(snprintf(path, PATH_MAX, "%s/%s", dir, de->d_name) >= PATH_MAX)
+		{
+			err("ctf: stream path too large\n");
+			return -1;
+		}
+
+		trace->streams = realloc(trace->streams,
+				(trace->nstreams + 1) * sizeof(*trace->streams));
+		s = calloc(1, sizeof(*s));
+		if(trace->streams == NULL || s == NULL) abort();
+
+		s->index = trace->nstreams;
+		trace->streams[trace->nstreams++] = s;
+
+		stream_open(trace, s, path);
+	}
+
+	closedir(d);
+
+	trace->heap = malloc((trace->nstreams + 1) * sizeof(*trace->heap));
+	if(trace->heap == NULL) abort();
+
+	/* Wait for the first chunk of each stream to fill the heap */
+	for(i=0; i<trace->nstreams; i++)
+	{
+		s = trace->streams[i];
+		stream_acquire(s);
+
+		if(s->chunk->nevents > 0)
+			heap_push(trace, s);
+	}
+
+	return 0;
+}
+
+const struct ctf_event *
+ctf_trace_next(struct ctf_trace *trace)
+{
+	struct ctf_stream *s = trace->current;
+
+	if(s != NULL && stream_advance(s))
+		heap_push(trace, s);
+
+	trace->current = NULL;
+
+	if(trace->nheap == 0)
+		return NULL;
+
+	s = heap_pop(trace);
+	trace->current = s;
+
+	return &s->chunk->events[s->next];
+}
+
+void
+ctf_trace_close(struct ctf_trace *trace)
+{
+	struct ctf_stream *s;
+	int i;
+
+	for(i=0; i<trace->nstreams; i++)
+	{
+		s = trace->streams[i];
+
+		/* Drain the stream so the decoder can finish */
+		while(s->chunk != NULL && !s->chunk->last)
+		{
+			stream_release(s);
+			stream_acquire(s);
+		}
+
+		pthread_join(s->thread, NULL);
+		pthread_mutex_destroy(&s->lock);
+		pthread_cond_destroy(&s->cond);
+		munmap((void *) s->data, s->size);
+		free(s);
+	}
+
+	free(trace->streams);
+	free(trace->heap);
+	free(trace->meta.cpu_list);
+}
+
+int
+ctf_event_class_field(const struct ctf_event_class *cls, const char *name)
+{
+	int i;
+
+	for(i=0; i<cls->nfields; i++)
+	{
+		if(strcmp(cls->fields[i].name, name) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+uint64_t
+ctf_event_get_uint(const struct ctf_event *ev, const char *name)
+{
+	int i = ctf_event_class_field(ev->cls, name);
+
+	assert(i >= 0);
+	assert(ev->cls->fields[i].type != CTF_FIELD_STRING);
+
+	return ev->values[i].u;
+}
+
+const char *
+ctf_event_get_str(const struct ctf_event *ev, const char *name)
+{
+	int i = ctf_event_class_field(ev->cls, name);
+
+	assert(i >= 0);
+	assert(ev->cls->fields[i].type == CTF_FIELD_STRING);
+
+	return ev->values[i].s;
+}
+
+uint64_t
+ctf_event_get_hwc(const struct ctf_event *ev, int i)
+{
+	assert(ev->hwc != NULL);
+
+	return read_uint(ev->hwc + 8 * i, 8);
+}
@@ -0,0 +1,178 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef LIBCTF_CTF_H
+#define LIBCTF_CTF_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/* Limits of the subset of CTF written by Nanos6 */
+#define CTF_MAX_NAME 128
+#define CTF_MAX_FIELDS 8
+#define CTF_MAX_EVENTS 256
+#define CTF_MAX_STREAM_CLASSES 4
+#define CTF_MAX_HWC 64
+
+/* Number of events decoded at once by a stream thread, and number of
+ * decoded chunks that each stream keeps in memory */
+#define CTF_CHUNK_EVENTS 1024
+#define CTF_STREAM_CHUNKS 4
+
+enum ctf_field_type {
+	CTF_FIELD_UINT,
+	CTF_FIELD_INT,
+	CTF_FIELD_STRING
+};
+
+struct ctf_field_class {
+	char name[CTF_MAX_NAME];
+	enum ctf_field_type type;
+	/* Size in bytes, only for integers */
+	int size;
+};
+
+struct ctf_event_class {
+	int defined;
+	int id;
+	char name[CTF_MAX_NAME];
+	/* Size of the event specific context, and offset of the hardware
+	 * counters inside it or -1 if the event has no counters */
+	int context_size;
+	int hwc_offset;
+	int nfields;
+	struct ctf_field_class fields[CTF_MAX_FIELDS];
+};
+
+struct ctf_stream_class {
+	int defined;
+	/* Size of the packet context and offset of the CPU id inside it */
+	int packet_context_size;
+	int cpu_id_offset;
+	/* Size of the event header and offsets of the id and timestamp */
+	int header_size;
+	int id_offset;
+	int id_size;
+	int ts_offset;
+	/* Size of the per-event stream context, and offset of the thread
+	 * id of the unbounded streams inside it or -1 if there is none */
+	int context_size;
+	int tid_offset;
+};
+
+struct ctf_metadata {
+	/* Size of the packet header and offsets of its fields */
+	int packet_header_size;
+	int magic_offset;
+	int stream_id_offset;
+
+	/* Environment */
+	char *cpu_list;
+	int64_t external_thread_count;
+	int64_t start_ts;
+	int64_t end_ts;
+	int64_t time_correction;
+
+	/* Offset of the clock in ns, added to each event timestamp */
+	int64_t clock_offset_ns;
+
+	/* Names of the hardware counters, in the order of the events */
+	int nhwc;
+	char hwc_names[CTF_MAX_HWC][CTF_MAX_NAME];
+
+	struct ctf_stream_class streams[CTF_MAX_STREAM_CLASSES];
+	struct ctf_event_class events[CTF_MAX_STREAM_CLASSES][CTF_MAX_EVENTS];
+};
+
+union ctf_value {
+	uint64_t u;
+	int64_t i;
+	const char *s;
+};
+
+struct ctf_event {
+	/* Time in ns, with the clock offset applied */
+	int64_t ts;
+	int cpu_id;
+	/* Thread id from the stream context, or -1 if not present */
+	int tid;
+	const struct ctf_event_class *cls;
+	/* Hardware counters, unaligned. Use ctf_event_get_hwc */
+	const uint8_t *hwc;
+	union ctf_value values[CTF_MAX_FIELDS];
+};
+
+struct ctf_chunk {
+	int nevents;
+	int last;
+	struct ctf_event events[CTF_CHUNK_EVENTS];
+};
+
+/* A stream file, decoded by its own thread into a ring of chunks which
+ * are consumed in order by the merge */
+struct ctf_stream {
+	int index;
+	const struct ctf_metadata *meta;
+	char path[4096];
+	const uint8_t *data;
+	size_t size;
+	int stream_class;
+	int cpu_id;
+
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	struct ctf_chunk chunks[CTF_STREAM_CHUNKS];
+	/* Chunks filled by the decoder and chunks released by the merge */
+	uint64_t filled;
+	uint64_t released;
+
+	/* Merge position */
+	struct ctf_chunk *chunk;
+	int next;
+};
+
+struct ctf_trace {
+	struct ctf_metadata meta;
+	int nstreams;
+	struct ctf_stream **streams;
+
+	/* Min-heap of streams ordered by their next event */
+	int nheap;
+	struct ctf_stream **heap;
+
+	/* Stream of the last returned event, to advance it lazily */
+	struct ctf_stream *current;
+};
+
+/* Parse the metadata in the directory and start decoding every stream
+ * file in a separate thread. Returns 0 on success */
+int
+ctf_trace_open(struct ctf_trace *trace, const char *dir);
+
+/* Get the next event of the trace in timestamp order, or NULL when all
+ * streams are consumed. The event is valid until the next call */
+const struct ctf_event *
+ctf_trace_next(struct ctf_trace *trace);
+
+void
+ctf_trace_close(struct ctf_trace *trace);
+
+/* Get the index of a payload field by its name, or -1 if it is missing */
+int
+ctf_event_class_field(const struct ctf_event_class *cls, const char *name);
+
+uint64_t
+ctf_event_get_uint(const struct ctf_event *ev, const char *name);
+
+const char *
+ctf_event_get_str(const struct ctf_event *ev, const char *name);
+
+uint64_t
+ctf_event_get_hwc(const struct ctf_event *ev, int i);
+
+#endif // LIBCTF_CTF_H
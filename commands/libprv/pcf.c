@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2021-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "pcf.h"
@@ -264,6 +264,42 @@ write_task_types(struct pcf *pcf, FILE *f)
 		fprintf(f, "%-4lu %s\n", tt->type, tt->srcline);
 }
 
+static void
+write_debug_types(struct pcf *pcf, FILE *f)
+{
+	struct debug_type *dt;
+
+	/* Appended to the values of the runtime subsystems */
+	for(dt=pcf->debug_types; dt != NULL; dt=dt->hh.next)
+		fprintf(f, "%-4lu Debug: %s\n", RS_DEBUG + dt->id, dt->name);
+}
+
+static void
+write_count_views(FILE *f)
+{
+	write_event_type_header(f, 0, EV_TYPE_NUMBER_OF_CREATED_TASKS,
+			"Number of Created Tasks");
+	write_event_type_header(f, 0, EV_TYPE_NUMBER_OF_BLOCKED_TASKS,
+			"Number of Blocked Tasks");
+	write_event_type_header(f, 0, EV_TYPE_NUMBER_OF_RUNNING_TASKS,
+			"Number of Running Tasks");
+	write_event_type_header(f, 0, EV_TYPE_NUMBER_OF_CREATED_THREADS,
+			"Number of Created Threads");
+	write_event_type_header(f, 0, EV_TYPE_NUMBER_OF_RUNNING_THREADS,
+			"Number of Running Threads");
+	write_event_type_header(f, 0, EV_TYPE_NUMBER_OF_BLOCKED_THREADS,
+			"Number of Blocked Threads");
+}
+
+static void
+write_hwc(struct pcf *pcf, FILE *f)
+{
+	int i;
+
+	for(i=0; i<pcf->nhwc; i++)
+		write_event_type_header(f, 0, pcf->hwc_ids[i], pcf->hwc_descs[i]);
+}
+
 static void
 write_events(struct pcf *pcf, FILE *f)
 {
@@ -272,15 +308,26 @@ write_events(struct pcf *pcf, FILE *f)
 	write_event_type(f, &runtime_task);
 	write_event_type(f, &runtime_mode);
 	write_event_type(f, &runtime_subsystems);
+	write_debug_types(pcf, f);
 	write_event_type(f, &ctf_flush);
 
 	write_task_types(pcf, f);
+
+	if(pcf->count_views)
+		write_count_views(f);
+
+	write_hwc(pcf, f);
 }
 
 void
 pcf_init(struct pcf *pcf)
 {
 	pcf->task_types = NULL;
+	pcf->debug_types = NULL;
+	pcf->count_views = 0;
+	pcf->nhwc = 0;
+	pcf->hwc_ids = NULL;
+	pcf->hwc_descs = NULL;
 }
 
 int
@@ -298,3 +345,23 @@ pcf_set_task_types(struct pcf *pcf, struct task_type *task_types)
 {
 	pcf->task_types = task_types;
 }
+
+void
+pcf_set_debug_types(struct pcf *pcf, struct debug_type *debug_types)
+{
+	pcf->debug_types = debug_types;
+}
+
+void
+pcf_set_count_views(struct pcf *pcf, int enabled)
+{
+	pcf->count_views = enabled;
+}
+
+void
+pcf_set_hwc(struct pcf *pcf, int nhwc, const long *ids, const char * const *descs)
+{
+	pcf->nhwc = nhwc;
+	pcf->hwc_ids = ids;
+	pcf->hwc_descs = descs;
+}
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2021-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef LIBPRV_PCF_H
@@ -45,7 +45,9 @@ enum runtime_subsystem {
 	RS_BLOCKING_API_UNBLOCK,
 	RS_SPAWN_FUNCTION,
 	RS_SCHEDULER_LOCK_ENTER,
-	RS_SCHEDULER_LOCK_SERVING
+	RS_SCHEDULER_LOCK_SERVING,
+	/* Debug regions begin at this value */
+	RS_DEBUG = 100
 };
 
 enum ev_type {
@@ -73,6 +75,15 @@ enum ev_type {
 
 struct pcf {
 	struct task_type *task_types;
+	struct debug_type *debug_types;
+
+	/* Whether to describe the task and thread count views */
+	int count_views;
+
+	/* Hardware counters found in the trace */
+	int nhwc;
+	const long *hwc_ids;
+	const char * const *hwc_descs;
 };
 
 void
@@ -84,4 +95,13 @@ pcf_write(struct pcf *pcf, FILE *f);
 void
 pcf_set_task_types(struct pcf *pcf, struct task_type *task_types);
 
+void
+pcf_set_debug_types(struct pcf *pcf, struct debug_type *debug_types);
+
+void
+pcf_set_count_views(struct pcf *pcf, int enabled);
+
+void
+pcf_set_hwc(struct pcf *pcf, int nhwc, const long *ids, const char * const *descs);
+
 #endif // LIBPRV_PCF_H
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2021-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef LIBPRV_PRV_H
@@ -20,4 +20,10 @@ struct task_type {
 	UT_hash_handle hh;
 };
 
+struct debug_type {
+	uint64_t id;
+	char name[MAX_LABEL];
+	UT_hash_handle hh;
+};
+
 #endif // LIBPRV_PRV_H
@@ -0,0 +1,1889 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+/* Converter of the Nanos6 CTF user traces to Paraver that does not
+ * depend on babeltrace2. The stream files are mapped and decoded in one
+ * thread each, and the events are merged by timestamp and converted in
+ * the main thread with the same views as the Python converter. */
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <linux/limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libctf/ctf.h"
+#include "libprv/hwc.h"
+#include "libprv/pcf.h"
+#include "libprv/prv.h"
+#include "libprv/uthash.h"
+
+#define MAX_CPUS 1024
+#define MAX_HWC CTF_MAX_HWC
+#define MAX_FILTER 16
+#define MAX_HOOKS 16
+
+#define TRACE_NAME "trace"
+
+#define PRV_HEADER_FMT \
+	"#Paraver (09/09/41 at 03:14):%020d_ns:0:1:1(%020d:1)\n"
+
+/* Size of the buffer of the PRV file */
+#define PRV_BUFFER_SIZE (4 * 1024 * 1024)
+
+#define err(...) fprintf(stderr, __VA_ARGS__);
+
+/* Report status every 100 ms */
+#define REPORT_TIME 80e-3
+
+enum class_id {
+	CLASS_ID_UNKNOWN = 0,
+	CLASS_ID_CTF_FLUSH,
+	CLASS_ID_THREAD_CREATE,
+	CLASS_ID_THREAD_RESUME,
+	CLASS_ID_THREAD_SUSPEND,
+	CLASS_ID_THREAD_SHUTDOWN,
+	CLASS_ID_EXTERNAL_THREAD_CREATE,
+	CLASS_ID_EXTERNAL_THREAD_RESUME,
+	CLASS_ID_EXTERNAL_THREAD_SUSPEND,
+	CLASS_ID_EXTERNAL_THREAD_SHUTDOWN,
+	CLASS_ID_WORKER_ENTER_BUSY_WAIT,
+	CLASS_ID_WORKER_EXIT_BUSY_WAIT,
+	CLASS_ID_TASK_LABEL,
+	CLASS_ID_TC_TASK_CREATE_ENTER,
+	CLASS_ID_TC_TASK_CREATE_EXIT,
+	CLASS_ID_OC_TASK_CREATE_ENTER,
+	CLASS_ID_OC_TASK_CREATE_EXIT,
+	CLASS_ID_TC_TASK_SUBMIT_ENTER,
+	CLASS_ID_TC_TASK_SUBMIT_EXIT,
+	CLASS_ID_OC_TASK_SUBMIT_ENTER,
+	CLASS_ID_OC_TASK_SUBMIT_EXIT,
+	CLASS_ID_TASK_START,
+	CLASS_ID_TASK_BLOCK,
+	CLASS_ID_TASK_UNBLOCK,
+	CLASS_ID_TASK_END,
+	CLASS_ID_DEPENDENCY_REGISTER_ENTER,
+	CLASS_ID_DEPENDENCY_REGISTER_EXIT,
+	CLASS_ID_DEPENDENCY_UNREGISTER_ENTER,
+	CLASS_ID_DEPENDENCY_UNREGISTER_EXIT,
+	CLASS_ID_SCHEDULER_ADD_TASK_ENTER,
+	CLASS_ID_SCHEDULER_ADD_TASK_EXIT,
+	CLASS_ID_SCHEDULER_GET_TASK_ENTER,
+	CLASS_ID_SCHEDULER_GET_TASK_EXIT,
+	CLASS_ID_TC_TASKWAIT_ENTER,
+	CLASS_ID_TC_TASKWAIT_EXIT,
+	CLASS_ID_TC_WAITFOR_ENTER,
+	CLASS_ID_TC_WAITFOR_EXIT,
+	CLASS_ID_TC_BLOCKING_API_BLOCK_ENTER,
+	CLASS_ID_TC_BLOCKING_API_BLOCK_EXIT,
+	CLASS_ID_TC_BLOCKING_API_UNBLOCK_ENTER,
+	CLASS_ID_TC_BLOCKING_API_UNBLOCK_EXIT,
+	CLASS_ID_OC_BLOCKING_API_UNBLOCK_ENTER,
+	CLASS_ID_OC_BLOCKING_API_UNBLOCK_EXIT,
+	CLASS_ID_TC_SPAWN_FUNCTION_ENTER,
+	CLASS_ID_TC_SPAWN_FUNCTION_EXIT,
+	CLASS_ID_OC_SPAWN_FUNCTION_ENTER,
+	CLASS_ID_OC_SPAWN_FUNCTION_EXIT,
+	CLASS_ID_TC_MUTEX_LOCK_ENTER,
+	CLASS_ID_TC_MUTEX_LOCK_EXIT,
+	CLASS_ID_TC_MUTEX_UNLOCK_ENTER,
+	CLASS_ID_TC_MUTEX_UNLOCK_EXIT,
+	CLASS_ID_DEBUG_REGISTER,
+	CLASS_ID_DEBUG_ENTER,
+	CLASS_ID_DEBUG_TRANSITION,
+	CLASS_ID_DEBUG_EXIT,
+	CLASS_ID_SCHEDULER_LOCK_SERVER,
+	CLASS_ID_SCHEDULER_LOCK_CLIENT,
+	CLASS_ID_SCHEDULER_LOCK_ASSIGN,
+	CLASS_ID_SCHEDULER_LOCK_SERVER_EXIT,
+	NUM_CLASS_IDS
+};
+
+/* The events are identified by name, as the numeric ids depend on the
+ * order in which the runtime registers them */
+struct class_name {
+	const char *name;
+	int class_id;
+} class_names[] = {
+	{ "nanos6:ctf_flush",				CLASS_ID_CTF_FLUSH },
+	{ "nanos6:thread_create",			CLASS_ID_THREAD_CREATE },
+	{ "nanos6:thread_resume",			CLASS_ID_THREAD_RESUME },
+	{ "nanos6:thread_suspend",			CLASS_ID_THREAD_SUSPEND },
+	{ "nanos6:thread_shutdown",			CLASS_ID_THREAD_SHUTDOWN },
+	{ "nanos6:external_thread_create",		CLASS_ID_EXTERNAL_THREAD_CREATE },
+	{ "nanos6:external_thread_resume",		CLASS_ID_EXTERNAL_THREAD_RESUME },
+	{ "nanos6:external_thread_suspend",		CLASS_ID_EXTERNAL_THREAD_SUSPEND },
+	{ "nanos6:external_thread_shutdown",		CLASS_ID_EXTERNAL_THREAD_SHUTDOWN },
+	{ "nanos6:worker_enter_busy_wait",		CLASS_ID_WORKER_ENTER_BUSY_WAIT },
+	{ "nanos6:worker_exit_busy_wait",		CLASS_ID_WORKER_EXIT_BUSY_WAIT },
+	{ "nanos6:task_label",				CLASS_ID_TASK_LABEL },
+	{ "nanos6:tc:task_create_enter",		CLASS_ID_TC_TASK_CREATE_ENTER },
+	{ "nanos6:tc:task_create_exit",			CLASS_ID_TC_TASK_CREATE_EXIT },
+	{ "nanos6:oc:task_create_enter",		CLASS_ID_OC_TASK_CREATE_ENTER },
+	{ "nanos6:oc:task_create_exit",			CLASS_ID_OC_TASK_CREATE_EXIT },
+	{ "nanos6:tc:task_submit_enter",		CLASS_ID_TC_TASK_SUBMIT_ENTER },
+	{ "nanos6:tc:task_submit_exit",			CLASS_ID_TC_TASK_SUBMIT_EXIT },
+	{ "nanos6:oc:task_submit_enter",		CLASS_ID_OC_TASK_SUBMIT_ENTER },
+	{ "nanos6:oc:task_submit_exit",			CLASS_ID_OC_TASK_SUBMIT_EXIT },
+	{ "nanos6:task_start",				CLASS_ID_TASK_START },
+	{ "nanos6:task_block",				CLASS_ID_TASK_BLOCK },
+	{ "nanos6:task_unblock",			CLASS_ID_TASK_UNBLOCK },
+	{ "nanos6:task_end",				CLASS_ID_TASK_END },
+	{ "nanos6:dependency_register_enter",		CLASS_ID_DEPENDENCY_REGISTER_ENTER },
+	{ "nanos6:dependency_register_exit",		CLASS_ID_DEPENDENCY_REGISTER_EXIT },
+	{ "nanos6:dependency_unregister_enter",		CLASS_ID_DEPENDENCY_UNREGISTER_ENTER },
+	{ "nanos6:dependency_unregister_exit",		CLASS_ID_DEPENDENCY_UNREGISTER_EXIT },
+	{ "nanos6:scheduler_add_task_enter",		CLASS_ID_SCHEDULER_ADD_TASK_ENTER },
+	{ "nanos6:scheduler_add_task_exit",		CLASS_ID_SCHEDULER_ADD_TASK_EXIT },
+	{ "nanos6:scheduler_get_task_enter",		CLASS_ID_SCHEDULER_GET_TASK_ENTER },
+	{ "nanos6:scheduler_get_task_exit",		CLASS_ID_SCHEDULER_GET_TASK_EXIT },
+	{ "nanos6:tc:taskwait_enter",			CLASS_ID_TC_TASKWAIT_ENTER },
+	{ "nanos6:tc:taskwait_exit",			CLASS_ID_TC_TASKWAIT_EXIT },
+	{ "nanos6:tc:waitfor_enter",			CLASS_ID_TC_WAITFOR_ENTER },
+	{ "nanos6:tc:waitfor_exit",			CLASS_ID_TC_WAITFOR_EXIT },
+	{ "nanos6:tc:blocking_api_block_enter",		CLASS_ID_TC_BLOCKING_API_BLOCK_ENTER },
+	{ "nanos6:tc:blocking_api_block_exit",		CLASS_ID_TC_BLOCKING_API_BLOCK_EXIT },
+	{ "nanos6:tc:blocking_api_unblock_enter",	CLASS_ID_TC_BLOCKING_API_UNBLOCK_ENTER },
+	{ "nanos6:tc:blocking_api_unblock_exit",	CLASS_ID_TC_BLOCKING_API_UNBLOCK_EXIT },
+	{ "nanos6:oc:blocking_api_unblock_enter",	CLASS_ID_OC_BLOCKING_API_UNBLOCK_ENTER },
+	{ "nanos6:oc:blocking_api_unblock_exit",	CLASS_ID_OC_BLOCKING_API_UNBLOCK_EXIT },
+	{ "nanos6:tc:spawn_function_enter",		CLASS_ID_TC_SPAWN_FUNCTION_ENTER },
+	{ "nanos6:tc:spawn_function_exit",		CLASS_ID_TC_SPAWN_FUNCTION_EXIT },
+	{ "nanos6:oc:spawn_function_enter",		CLASS_ID_OC_SPAWN_FUNCTION_ENTER },
+	{ "nanos6:oc:spawn_function_exit",		CLASS_ID_OC_SPAWN_FUNCTION_EXIT },
+	{ "nanos6:tc:mutex_lock_enter",			CLASS_ID_TC_MUTEX_LOCK_ENTER },
+	{ "nanos6:tc:mutex_lock_exit",			CLASS_ID_TC_MUTEX_LOCK_EXIT },
+	{ "nanos6:tc:mutex_unlock_enter",		CLASS_ID_TC_MUTEX_UNLOCK_ENTER },
+	{ "nanos6:tc:mutex_unlock_exit",		CLASS_ID_TC_MUTEX_UNLOCK_EXIT },
+	{ "nanos6:debug_register",			CLASS_ID_DEBUG_REGISTER },
+	{ "nanos6:debug_enter",				CLASS_ID_DEBUG_ENTER },
+	{ "nanos6:debug_transition",			CLASS_ID_DEBUG_TRANSITION },
+	{ "nanos6:debug_exit",				CLASS_ID_DEBUG_EXIT },
+	{ "nanos6:scheduler_lock_server",		CLASS_ID_SCHEDULER_LOCK_SERVER },
+	{ "nanos6:scheduler_lock_client",		CLASS_ID_SCHEDULER_LOCK_CLIENT },
+	{ "nanos6:scheduler_lock_assign",		CLASS_ID_SCHEDULER_LOCK_ASSIGN },
+	{ "nanos6:scheduler_lock_server_exit",		CLASS_ID_SCHEDULER_LOCK_SERVER_EXIT },
+	{ NULL, -1 }
+};
+
+enum task_st {
+	TASK_ST_UNINIT,
+	TASK_ST_RUNNING,
+	TASK_ST_BLOCKED
+};
+
+struct task {
+	uint64_t id;
+	uint64_t type;
+	enum task_st state;
+	UT_hash_handle hh;
+};
+
+enum thread_st {
+	THREAD_ST_UNKNOWN,
+	THREAD_ST_CREATED,
+	THREAD_ST_RESUMED,
+	THREAD_ST_SUSPENDED
+};
+
+#define MAX_EV_STACK 256
+#define MAX_TASK_STACK 8
+
+struct task_stack {
+	int num_tasks;
+	struct task *task[MAX_TASK_STACK];
+};
+
+struct thread {
+	uint64_t tid;
+	int cpu;
+	int external;
+	int state;
+	struct task_stack tasks;
+	int busy_wait;
+	int color;
+	/* Whether the thread is counted in the blocked threads view */
+	int blocked;
+	int ev_stack[MAX_EV_STACK];
+	int n_stack;
+	UT_hash_handle hh;
+};
+
+/* A task assigned by the scheduler lock server, to draw the
+ * communication with the client that receives it */
+struct served_task {
+	uint64_t id;
+	int64_t ts;
+	int cpu;
+	UT_hash_handle hh;
+};
+
+struct conv;
+typedef void (*hook_func_t)(struct conv *conv,
+		const struct ctf_event *ev, int class_id);
+
+struct hook_entry {
+	int class_id;
+	hook_func_t func;
+};
+
+struct prv_event {
+	long long type;
+	long long value;
+};
+
+#define MAX_ACC_EVENTS 100
+
+struct cpu {
+	int pcpu;
+	struct thread *thread;
+};
+
+struct conv {
+	struct ctf_trace trace;
+
+	/* Internal class id of each event class of each stream class */
+	int class_map[CTF_MAX_STREAM_CLASSES][CTF_MAX_EVENTS];
+
+	struct thread *threads;
+	struct task *tasks;
+	struct task_type *task_types;
+	struct debug_type *debug_types;
+	struct served_task *served_tasks;
+
+	hook_func_t hook_table[NUM_CLASS_IDS][MAX_HOOKS];
+	int ss_table[NUM_CLASS_IDS];
+
+	struct prv_event acc_ev[MAX_ACC_EVENTS];
+	int n_acc_ev;
+
+	int last_thread_color;
+
+	struct cpu cpus[MAX_CPUS];
+	int pcpu_index[MAX_CPUS];
+	int max_pcpu;
+	int curr_cpu;
+	int nvcpus;
+	int ncpus;
+
+	/* Time of the current event */
+	int64_t ts;
+
+	/* Counters of the count views */
+	int64_t created_tasks;
+	int64_t blocked_tasks;
+	int64_t running_tasks;
+	int64_t created_threads;
+	int64_t running_threads;
+	int64_t blocked_threads;
+
+	uint64_t ev_processed;
+	uint64_t ev_ignored;
+	uint64_t ev_emitted;
+	double ev_progress;
+
+	double last_reported;
+	size_t last_written;
+	double tic;
+	double t0;
+
+	const char *output_dir;
+	FILE *prv;
+	FILE *pcf_file;
+	char row_file_path[PATH_MAX];
+	struct pcf pcf;
+
+	int split_events;
+	int quiet;
+
+	int nhwc;
+	long hwc_table[MAX_HWC];
+	const char *hwc_descs[MAX_HWC];
+
+	int64_t clock_offset_ns;
+	int64_t clock_start_ns;
+	int64_t clock_end_ns;
+	int64_t external_threads;
+
+	int nfilters;
+	long filters[MAX_FILTER];
+};
+
+/* Subsystem of the events that stack a subsystem in the thread stack */
+int ss_list[][2] = {
+  /* Event					Subsystem */
+  { CLASS_ID_THREAD_CREATE,			RS_RUNTIME },
+  { CLASS_ID_THREAD_SUSPEND,			RS_IDLE },
+  { CLASS_ID_THREAD_SHUTDOWN,			RS_IDLE },
+  { CLASS_ID_THREAD_RESUME,			-1 },
+
+  { CLASS_ID_EXTERNAL_THREAD_CREATE,		RS_IDLE },
+  { CLASS_ID_EXTERNAL_THREAD_SUSPEND,		RS_IDLE },
+  { CLASS_ID_EXTERNAL_THREAD_SHUTDOWN,		RS_IDLE },
+  { CLASS_ID_EXTERNAL_THREAD_RESUME,		-1 },
+
+  { CLASS_ID_TASK_END,				RS_TASK },
+  { CLASS_ID_TASK_START,			RS_TASK },
+
+  { CLASS_ID_TC_TASKWAIT_ENTER,			RS_TASK_WAIT },
+  { CLASS_ID_TC_TASKWAIT_EXIT,			RS_TASK_WAIT },
+
+  { CLASS_ID_TC_WAITFOR_ENTER,			RS_WAIT_FOR },
+  { CLASS_ID_TC_WAITFOR_EXIT,			RS_WAIT_FOR },
+
+  { CLASS_ID_TC_MUTEX_LOCK_ENTER,		RS_LOCK },
+  { CLASS_ID_TC_MUTEX_LOCK_EXIT,		RS_LOCK },
+  { CLASS_ID_TC_MUTEX_UNLOCK_ENTER,		RS_UNLOCK },
+  { CLASS_ID_TC_MUTEX_UNLOCK_EXIT,		RS_UNLOCK },
+
+  { CLASS_ID_TC_BLOCKING_API_BLOCK_ENTER,	RS_BLOCKING_API_BLOCK },
+  { CLASS_ID_TC_BLOCKING_API_BLOCK_EXIT,	RS_BLOCKING_API_BLOCK },
+  { CLASS_ID_TC_BLOCKING_API_UNBLOCK_ENTER,	RS_BLOCKING_API_UNBLOCK },
+  { CLASS_ID_TC_BLOCKING_API_UNBLOCK_EXIT,	RS_BLOCKING_API_UNBLOCK },
+  { CLASS_ID_OC_BLOCKING_API_UNBLOCK_ENTER,	RS_BLOCKING_API_UNBLOCK },
+  { CLASS_ID_OC_BLOCKING_API_UNBLOCK_EXIT,	RS_BLOCKING_API_UNBLOCK },
+
+  { CLASS_ID_TC_SPAWN_FUNCTION_ENTER,		RS_SPAWN_FUNCTION },
+  { CLASS_ID_TC_SPAWN_FUNCTION_EXIT,		RS_SPAWN_FUNCTION },
+  { CLASS_ID_OC_SPAWN_FUNCTION_ENTER,		RS_SPAWN_FUNCTION },
+  { CLASS_ID_OC_SPAWN_FUNCTION_EXIT,		RS_SPAWN_FUNCTION },
+
+  { CLASS_ID_WORKER_ENTER_BUSY_WAIT,		RS_BUSY_WAIT },
+  { CLASS_ID_WORKER_EXIT_BUSY_WAIT,		RS_BUSY_WAIT },
+
+  { CLASS_ID_DEPENDENCY_REGISTER_ENTER,		RS_DEPENDENCY_REGISTER },
+  { CLASS_ID_DEPENDENCY_REGISTER_EXIT,		RS_DEPENDENCY_REGISTER },
+  { CLASS_ID_DEPENDENCY_UNREGISTER_ENTER,	RS_DEPENDENCY_UNREGISTER },
+  { CLASS_ID_DEPENDENCY_UNREGISTER_EXIT,	RS_DEPENDENCY_UNREGISTER },
+
+  { CLASS_ID_SCHEDULER_ADD_TASK_ENTER,		RS_SCHEDULER_ADD_TASK },
+  { CLASS_ID_SCHEDULER_ADD_TASK_EXIT,		RS_SCHEDULER_ADD_TASK },
+  { CLASS_ID_SCHEDULER_GET_TASK_ENTER,		RS_SCHEDULER_GET_TASK },
+  { CLASS_ID_SCHEDULER_GET_TASK_EXIT,		RS_SCHEDULER_GET_TASK },
+
+  { CLASS_ID_TC_TASK_CREATE_ENTER,		RS_TASK_CREATE },
+  { CLASS_ID_TC_TASK_CREATE_EXIT,		RS_TASK_CREATE },
+  { CLASS_ID_OC_TASK_CREATE_ENTER,		RS_TASK_CREATE },
+  { CLASS_ID_OC_TASK_CREATE_EXIT,		RS_TASK_CREATE },
+
+  { CLASS_ID_TC_TASK_SUBMIT_ENTER,		RS_TASK_SUBMIT },
+  { CLASS_ID_TC_TASK_SUBMIT_EXIT,		RS_TASK_SUBMIT },
+  { CLASS_ID_OC_TASK_SUBMIT_ENTER,		RS_TASK_SUBMIT },
+  { CLASS_ID_OC_TASK_SUBMIT_EXIT,		RS_TASK_SUBMIT },
+
+  { CLASS_ID_SCHEDULER_LOCK_CLIENT,		RS_SCHEDULER_LOCK_ENTER },
+  { CLASS_ID_SCHEDULER_LOCK_SERVER,		RS_SCHEDULER_LOCK_SERVING },
+  { CLASS_ID_SCHEDULER_LOCK_ASSIGN,		-1 },
+  { CLASS_ID_SCHEDULER_LOCK_SERVER_EXIT,	-1 },
+
+  /* End marker */
+  { -1,						-1},
+};
+
+#define HOOK_DEF(name) \
+	static void name(struct conv *conv, const struct ctf_event *ev, int class_id)
+
+HOOK_DEF(hook_thread_create);
+HOOK_DEF(hook_ext_thread_create);
+HOOK_DEF(hook_thread_resume);
+HOOK_DEF(hook_thread_suspend);
+HOOK_DEF(hook_task_create);
+HOOK_DEF(hook_task_label_register);
+HOOK_DEF(hook_task_execute);
+HOOK_DEF(hook_task_start);
+HOOK_DEF(hook_task_end);
+HOOK_DEF(hook_task_stop);
+HOOK_DEF(hook_enter_busy_wait);
+HOOK_DEF(hook_exit_busy_wait);
+HOOK_DEF(hook_ss_pop);
+HOOK_DEF(hook_ss_push);
+HOOK_DEF(hook_ss_last);
+HOOK_DEF(hook_ss_print);
+HOOK_DEF(hook_ss_lock_client);
+HOOK_DEF(hook_ss_lock_server);
+HOOK_DEF(hook_ss_lock_assign);
+HOOK_DEF(hook_debug_register);
+HOOK_DEF(hook_debug_enter);
+HOOK_DEF(hook_debug_transition);
+HOOK_DEF(hook_flush);
+HOOK_DEF(hook_mode_dead);
+HOOK_DEF(hook_mode_runtime);
+HOOK_DEF(hook_hwc);
+HOOK_DEF(hook_count_task_create);
+HOOK_DEF(hook_count_task_block);
+HOOK_DEF(hook_count_task_unblock);
+HOOK_DEF(hook_count_task_start);
+HOOK_DEF(hook_count_task_end);
+HOOK_DEF(hook_count_thread_create);
+HOOK_DEF(hook_count_thread_resume);
+HOOK_DEF(hook_count_thread_suspend);
+HOOK_DEF(hook_count_thread_shutdown);
+
+/* The order is important */
+struct hook_entry hook_list[] = {
+
+	/* Threads */
+	{ CLASS_ID_THREAD_CREATE,		hook_thread_create },
+	{ CLASS_ID_EXTERNAL_THREAD_CREATE,	hook_ext_thread_create },
+	{ CLASS_ID_THREAD_RESUME,		hook_thread_resume },
+	{ CLASS_ID_EXTERNAL_THREAD_RESUME,	hook_thread_resume },
+	{ CLASS_ID_WORKER_ENTER_BUSY_WAIT,	hook_enter_busy_wait },
+	{ CLASS_ID_WORKER_EXIT_BUSY_WAIT,	hook_exit_busy_wait },
+
+	/* Tasks creation */
+	{ CLASS_ID_TC_TASK_CREATE_ENTER,	hook_task_create },
+	{ CLASS_ID_OC_TASK_CREATE_ENTER,	hook_task_create },
+
+	/* Tasks start/stop */
+	{ CLASS_ID_TASK_START,			hook_task_start },
+	{ CLASS_ID_TC_TASK_CREATE_ENTER,	hook_task_stop },
+	{ CLASS_ID_TC_TASK_SUBMIT_EXIT,		hook_task_execute },
+	{ CLASS_ID_TC_TASKWAIT_ENTER,		hook_task_stop },
+	{ CLASS_ID_TC_TASKWAIT_EXIT,		hook_task_execute },
+	{ CLASS_ID_TC_WAITFOR_ENTER,		hook_task_stop },
+	{ CLASS_ID_TC_WAITFOR_EXIT,		hook_task_execute },
+	{ CLASS_ID_TC_MUTEX_LOCK_ENTER,		hook_task_stop },
+	{ CLASS_ID_TC_MUTEX_LOCK_EXIT,		hook_task_execute },
+	{ CLASS_ID_TC_MUTEX_UNLOCK_ENTER,	hook_task_stop },
+	{ CLASS_ID_TC_MUTEX_UNLOCK_EXIT,	hook_task_execute },
+	{ CLASS_ID_TC_BLOCKING_API_BLOCK_ENTER,	hook_task_stop },
+	{ CLASS_ID_TC_BLOCKING_API_BLOCK_EXIT,	hook_task_execute },
+	{ CLASS_ID_TC_BLOCKING_API_UNBLOCK_ENTER, hook_task_stop },
+	{ CLASS_ID_TC_BLOCKING_API_UNBLOCK_EXIT, hook_task_execute },
+	{ CLASS_ID_TC_SPAWN_FUNCTION_ENTER,	hook_task_stop },
+	{ CLASS_ID_TC_SPAWN_FUNCTION_EXIT,	hook_task_execute },
+	{ CLASS_ID_TASK_BLOCK,			hook_task_stop },
+	{ CLASS_ID_TASK_UNBLOCK,		hook_task_execute },
+
+	/* Task label */
+	{ CLASS_ID_TASK_LABEL,			hook_task_label_register },
+
+	/* Task end (must be after task label) */
+	{ CLASS_ID_TASK_END,			hook_task_end },
+
+	/* Subsystem */
+	{ CLASS_ID_THREAD_CREATE,		hook_ss_push },
+	{ CLASS_ID_THREAD_SUSPEND,		hook_ss_print },
+	{ CLASS_ID_THREAD_RESUME,		hook_ss_last },
+	{ CLASS_ID_THREAD_SHUTDOWN,		hook_ss_print },
+	{ CLASS_ID_EXTERNAL_THREAD_CREATE,	hook_ss_push },
+	{ CLASS_ID_EXTERNAL_THREAD_SUSPEND,	hook_ss_print },
+	{ CLASS_ID_EXTERNAL_THREAD_RESUME,	hook_ss_last },
+	{ CLASS_ID_EXTERNAL_THREAD_SHUTDOWN,	hook_ss_print },
+
+	{ CLASS_ID_TASK_END,			hook_ss_pop },
+	{ CLASS_ID_TASK_START,			hook_ss_push },
+	{ CLASS_ID_TC_TASKWAIT_ENTER,		hook_ss_push },
+	{ CLASS_ID_TC_TASKWAIT_EXIT,		hook_ss_pop },
+
+	{ CLASS_ID_TC_TASK_CREATE_ENTER,	hook_ss_push },
+	{ CLASS_ID_TC_TASK_CREATE_EXIT,		hook_ss_pop },
+	{ CLASS_ID_OC_TASK_CREATE_ENTER,	hook_ss_push },
+	{ CLASS_ID_OC_TASK_CREATE_EXIT,		hook_ss_pop },
+
+	{ CLASS_ID_TC_TASK_SUBMIT_ENTER,	hook_ss_push },
+	{ CLASS_ID_TC_TASK_SUBMIT_EXIT,		hook_ss_pop },
+	{ CLASS_ID_OC_TASK_SUBMIT_ENTER,	hook_ss_push },
+	{ CLASS_ID_OC_TASK_SUBMIT_EXIT,		hook_ss_pop },
+
+	{ CLASS_ID_TC_WAITFOR_ENTER,		hook_ss_push },
+	{ CLASS_ID_TC_WAITFOR_EXIT,		hook_ss_pop },
+	{ CLASS_ID_TC_MUTEX_LOCK_ENTER,		hook_ss_push },
+	{ CLASS_ID_TC_MUTEX_LOCK_EXIT,		hook_ss_pop },
+	{ CLASS_ID_TC_MUTEX_UNLOCK_ENTER,	hook_ss_push },
+	{ CLASS_ID_TC_MUTEX_UNLOCK_EXIT,	hook_ss_pop },
+	{ CLASS_ID_TC_BLOCKING_API_BLOCK_ENTER,	hook_ss_push },
+	{ CLASS_ID_TC_BLOCKING_API_BLOCK_EXIT,	hook_ss_pop },
+	{ CLASS_ID_TC_BLOCKING_API_UNBLOCK_ENTER, hook_ss_push },
+	{ CLASS_ID_TC_BLOCKING_API_UNBLOCK_EXIT, hook_ss_pop },
+	{ CLASS_ID_OC_BLOCKING_API_UNBLOCK_ENTER, hook_ss_push },
+	{ CLASS_ID_OC_BLOCKING_API_UNBLOCK_EXIT, hook_ss_pop },
+	{ CLASS_ID_TC_SPAWN_FUNCTION_ENTER,	hook_ss_push },
+	{ CLASS_ID_TC_SPAWN_FUNCTION_EXIT,	hook_ss_pop },
+	{ CLASS_ID_OC_SPAWN_FUNCTION_ENTER,	hook_ss_push },
+	{ CLASS_ID_OC_SPAWN_FUNCTION_EXIT,	hook_ss_pop },
+	{ CLASS_ID_WORKER_ENTER_BUSY_WAIT,	hook_ss_push },
+	{ CLASS_ID_WORKER_EXIT_BUSY_WAIT,	hook_ss_pop },
+	{ CLASS_ID_DEPENDENCY_REGISTER_ENTER,	hook_ss_push },
+	{ CLASS_ID_DEPENDENCY_REGISTER_EXIT,	hook_ss_pop },
+	{ CLASS_ID_DEPENDENCY_UNREGISTER_ENTER,	hook_ss_push },
+	{ CLASS_ID_DEPENDENCY_UNREGISTER_EXIT,	hook_ss_pop },
+	{ CLASS_ID_SCHEDULER_ADD_TASK_ENTER,	hook_ss_push },
+	{ CLASS_ID_SCHEDULER_ADD_TASK_EXIT,	hook_ss_pop },
+	{ CLASS_ID_SCHEDULER_GET_TASK_ENTER,	hook_ss_push },
+	{ CLASS_ID_SCHEDULER_GET_TASK_EXIT,	hook_ss_pop },
+
+	{ CLASS_ID_SCHEDULER_LOCK_CLIENT,	hook_ss_lock_client },
+	{ CLASS_ID_SCHEDULER_LOCK_SERVER,	hook_ss_lock_server },
+	{ CLASS_ID_SCHEDULER_LOCK_ASSIGN,	hook_ss_lock_assign },
+	{ CLASS_ID_SCHEDULER_LOCK_SERVER_EXIT,	hook_ss_pop },
+
+	/* Debug regions */
+	{ CLASS_ID_DEBUG_REGISTER,		hook_debug_register },
+	{ CLASS_ID_DEBUG_ENTER,			hook_debug_enter },
+	{ CLASS_ID_DEBUG_TRANSITION,		hook_debug_transition },
+	{ CLASS_ID_DEBUG_EXIT,			hook_ss_pop },
+
+	/* Flush trace to disk */
+	{ CLASS_ID_CTF_FLUSH,			hook_flush },
+
+	/* Hardware counter hooks */
+	{ CLASS_ID_THREAD_SUSPEND,			hook_hwc },
+	{ CLASS_ID_THREAD_SHUTDOWN,			hook_hwc },
+	{ CLASS_ID_TASK_START,				hook_hwc },
+	{ CLASS_ID_TASK_END,				hook_hwc },
+	{ CLASS_ID_TC_TASK_CREATE_ENTER,		hook_hwc },
+	{ CLASS_ID_TC_TASK_SUBMIT_EXIT,			hook_hwc },
+	{ CLASS_ID_TC_TASKWAIT_ENTER,			hook_hwc },
+	{ CLASS_ID_TC_TASKWAIT_EXIT,			hook_hwc },
+	{ CLASS_ID_TC_WAITFOR_ENTER,			hook_hwc },
+	{ CLASS_ID_TC_WAITFOR_EXIT,			hook_hwc },
+	{ CLASS_ID_TC_MUTEX_LOCK_ENTER,			hook_hwc },
+	{ CLASS_ID_TC_MUTEX_LOCK_EXIT,			hook_hwc },
+	{ CLASS_ID_TC_MUTEX_UNLOCK_ENTER,		hook_hwc },
+	{ CLASS_ID_TC_MUTEX_UNLOCK_EXIT,		hook_hwc },
+	{ CLASS_ID_TC_BLOCKING_API_BLOCK_ENTER,		hook_hwc },
+	{ CLASS_ID_TC_BLOCKING_API_BLOCK_EXIT,		hook_hwc },
+	{ CLASS_ID_TC_BLOCKING_API_UNBLOCK_ENTER,	hook_hwc },
+	{ CLASS_ID_TC_BLOCKING_API_UNBLOCK_EXIT,	hook_hwc },
+	{ CLASS_ID_TC_SPAWN_FUNCTION_ENTER,		hook_hwc },
+	{ CLASS_ID_TC_SPAWN_FUNCTION_EXIT,		hook_hwc },
+
+	/* Task and thread counts */
+	{ CLASS_ID_TC_TASK_CREATE_ENTER,	hook_count_task_create },
+	{ CLASS_ID_OC_TASK_CREATE_ENTER,	hook_count_task_create },
+	{ CLASS_ID_TASK_BLOCK,			hook_count_task_block },
+	{ CLASS_ID_TASK_UNBLOCK,		hook_count_task_unblock },
+	{ CLASS_ID_TASK_START,			hook_count_task_start },
+	{ CLASS_ID_TASK_END,			hook_count_task_end },
+	{ CLASS_ID_THREAD_CREATE,		hook_count_thread_create },
+	{ CLASS_ID_THREAD_RESUME,		hook_count_thread_resume },
+	{ CLASS_ID_THREAD_SUSPEND,		hook_count_thread_suspend },
+	{ CLASS_ID_THREAD_SHUTDOWN,		hook_count_thread_shutdown },
+
+	/* post */
+	{ CLASS_ID_THREAD_SUSPEND,		hook_thread_suspend },
+	{ CLASS_ID_THREAD_SHUTDOWN,		hook_thread_suspend },
+	{ CLASS_ID_EXTERNAL_THREAD_SUSPEND,	hook_thread_suspend },
+	{ CLASS_ID_EXTERNAL_THREAD_SHUTDOWN,	hook_thread_suspend },
+
+	/* FIXME: We use this hack to exclude the serving tasks state
+	 * from RM_RUNTIME mode, as in reality we are not doing useful
+	 * work. */
+	{ CLASS_ID_SCHEDULER_LOCK_SERVER,	hook_mode_dead },
+	{ CLASS_ID_SCHEDULER_LOCK_SERVER_EXIT,	hook_mode_runtime },
+
+	/* End */
+	{ -1, NULL }
+};
+
+static void
+hook_add(struct conv *conv, int class_id, hook_func_t func)
+{
+	int i;
+
+	/* Keep one empty place at the end to set NULL */
+	for(i=0; i<MAX_HOOKS - 1; i++)
+	{
+		if(conv->hook_table[class_id][i] != NULL)
+			continue;
+
+		conv->hook_table[class_id][i] = func;
+		conv->hook_table[class_id][i+1] = NULL;
+		return;
+	}
+
+	err("too many hooks for class id %d\n", class_id);
+	exit(EXIT_FAILURE);
+}
+
+static double
+get_time()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9;
+}
+
+static void
+populate_cpus(struct conv *conv, const char *cpu_list)
+{
+	char *saveptr, *p, *tmp;
+	int pcpu;
+
+	tmp = strdup(cpu_list);
+	assert(tmp);
+
+	p = strtok_r(tmp, ",", &saveptr);
+
+	conv->ncpus = 0;
+
+	while(p)
+	{
+		pcpu = atoi(p);
+		assert(pcpu >= 0);
+
+		if(pcpu >= MAX_CPUS)
+		{
+			err("too many cpus\n");
+			exit(EXIT_FAILURE);
+		}
+
+		if(conv->pcpu_index[pcpu] != -1)
+		{
+			err("repeated cpus\n");
+			exit(EXIT_FAILURE);
+		}
+
+		conv->cpus[conv->ncpus].pcpu = pcpu;
+		conv->pcpu_index[pcpu] = conv->ncpus;
+		conv->ncpus++;
+		if(pcpu > conv->max_pcpu)
+			conv->max_pcpu = pcpu;
+
+		p = strtok_r(NULL, ",", &saveptr);
+	}
+
+	assert(conv->max_pcpu >= 0);
+	assert(conv->ncpus > 0);
+
+	free(tmp);
+}
+
+/* Map the event classes of the metadata to the internal class ids */
+static void
+populate_classes(struct conv *conv)
+{
+	const struct ctf_event_class *cls;
+	int s, e, i;
+
+	for(s=0; s<CTF_MAX_STREAM_CLASSES; s++)
+	{
+		for(e=0; e<CTF_MAX_EVENTS; e++)
+		{
+			conv->class_map[s][e] = CLASS_ID_UNKNOWN;
+			cls = &conv->trace.meta.events[s][e];
+
+			if(!cls->defined)
+				continue;
+
+			for(i=0; class_names[i].name != NULL; i++)
+			{
+				if(strcmp(class_names[i].name, cls->name) == 0)
+				{
+					conv->class_map[s][e] = class_names[i].class_id;
+					break;
+				}
+			}
+		}
+	}
+}
+
+static void
+populate_hwc(struct conv *conv)
+{
+	const struct ctf_metadata *meta = &conv->trace.meta;
+	int i, j;
+
+	conv->nhwc = meta->nhwc;
+
+	for(i=0; i<meta->nhwc; i++)
+	{
+		for(j=0; hwc_table[j].name != NULL; j++)
+		{
+			if(strcmp(hwc_table[j].name, meta->hwc_names[i]) == 0)
+				break;
+		}
+
+		if(hwc_table[j].name == NULL)
+		{
+			err("unknown HWC %s\n", meta->hwc_names[i]);
+			exit(EXIT_FAILURE);
+		}
+
+		conv->hwc_table[i] = hwc_table[j].id;
+		conv->hwc_descs[i] = hwc_table[j].desc;
+	}
+}
+
+static FILE *
+open_output(struct conv *conv, const char *ext, char *path)
+{
+	FILE *f;
+
+	if(snprintf(path, PATH_MAX, "%s/%s.%s",
+				conv->output_dir, TRACE_NAME, ext) >= PATH_MAX)
+	{
+		err("%s file path too large\n", ext);
+		exit(EXIT_FAILURE);
+	}
+
+	if(f = fopen(path, "w"), f == NULL)
+	{
+		perror("opening output file");
+		exit(EXIT_FAILURE);
+	}
+
+	return f;
+}
+
+static void
+conv_init(struct conv *conv, const char *input_trace, const char *output_dir,
+		int split_events, long *filters, int nfilters, int quiet)
+{
+	const struct ctf_metadata *meta;
+	char path[PATH_MAX];
+	int i;
+
+	memset(conv, 0, sizeof(*conv));
+
+	for(i=0; i<MAX_CPUS; i++)
+	{
+		conv->cpus[i].pcpu = -1;
+		conv->pcpu_index[i] = -1;
+	}
+
+	conv->tic = get_time();
+	conv->t0 = conv->tic;
+	conv->curr_cpu = -1;
+	conv->max_pcpu = -1;
+	conv->last_thread_color = 1;
+
+	for(i=0; i<NUM_CLASS_IDS; i++)
+		conv->ss_table[i] = -1;
+
+	for(i=0; hook_list[i].func != NULL; i++)
+		hook_add(conv, hook_list[i].class_id, hook_list[i].func);
+
+	for(i=0; ss_list[i][0] != -1; i++)
+		conv->ss_table[ss_list[i][0]] = ss_list[i][1];
+
+	conv->split_events = split_events;
+	conv->quiet = quiet;
+	conv->output_dir = output_dir;
+	conv->nfilters = nfilters;
+	for(i=0; i<nfilters; i++)
+		conv->filters[i] = filters[i];
+
+	if(ctf_trace_open(&conv->trace, input_trace) != 0)
+		exit(EXIT_FAILURE);
+
+	meta = &conv->trace.meta;
+
+	populate_cpus(conv, meta->cpu_list);
+	populate_classes(conv);
+	populate_hwc(conv);
+
+	/* The virtual CPUs are populated as external threads appear */
+	conv->nvcpus = 0;
+	conv->external_threads = meta->external_thread_count;
+
+	/* The clock offset corrects the timestamps stored in the payload
+	 * of some events, as the event timestamps already include it */
+	conv->clock_offset_ns = meta->time_correction;
+	conv->clock_start_ns = conv->clock_offset_ns;
+	conv->clock_end_ns = meta->end_ts - meta->start_ts + conv->clock_offset_ns;
+
+	conv->prv = open_output(conv, "prv", path);
+	setvbuf(conv->prv, NULL, _IOFBF, PRV_BUFFER_SIZE);
+	conv->pcf_file = open_output(conv, "pcf", path);
+
+	if(snprintf(conv->row_file_path, PATH_MAX, "%s/%s.row",
+				conv->output_dir, TRACE_NAME) >= PATH_MAX)
+	{
+		err("row file path too large\n");
+		exit(EXIT_FAILURE);
+	}
+
+	pcf_init(&conv->pcf);
+
+	/* Print the prv header */
+	fprintf(conv->prv, PRV_HEADER_FMT, 0, 0);
+}
+
+static void
+write_row_file(struct conv *conv)
+{
+	FILE *f;
+	int i;
+
+	f = fopen(conv->row_file_path, "w");
+
+	if(f == NULL)
+	{
+		perror("cannot open row file");
+		exit(EXIT_FAILURE);
+	}
+
+	fprintf(f, "LEVEL NODE SIZE 1\n");
+	fprintf(f, "hostname\n");
+	fprintf(f, "\n");
+
+	assert(conv->nvcpus >= 1);
+	assert(conv->nvcpus == conv->external_threads);
+	fprintf(f, "LEVEL THREAD SIZE %d\n", conv->ncpus + conv->nvcpus);
+
+	for(i=0; i<conv->ncpus; i++)
+		fprintf(f, "CPU %2d\n", conv->cpus[i].pcpu);
+
+	/* The first virtual cpu is always the leader thread */
+	fprintf(f, "LEADER\n");
+
+	for(i=0; i<conv->nvcpus-1; i++)
+		fprintf(f, "EXT %d\n", i);
+
+	fclose(f);
+}
+
+static void
+conv_finalize(struct conv *conv)
+{
+	double dt;
+
+	/* We don't know the number of "threads" until we had read all
+	 * the events, so we fix the header at the end */
+	fseek(conv->prv, 0, SEEK_SET);
+	fprintf(conv->prv, PRV_HEADER_FMT, 0, conv->ncpus + conv->nvcpus);
+
+	if(fclose(conv->prv) != 0)
+	{
+		perror("error closing prv file");
+		exit(EXIT_FAILURE);
+	}
+
+	pcf_set_task_types(&conv->pcf, conv->task_types);
+	pcf_set_debug_types(&conv->pcf, conv->debug_types);
+	pcf_set_count_views(&conv->pcf, 1);
+	pcf_set_hwc(&conv->pcf, conv->nhwc, conv->hwc_table, conv->hwc_descs);
+
+	pcf_write(&conv->pcf, conv->pcf_file);
+
+	if(fclose(conv->pcf_file) != 0)
+	{
+		perror("error closing pcf file");
+		exit(EXIT_FAILURE);
+	}
+
+	write_row_file(conv);
+
+	ctf_trace_close(&conv->trace);
+
+	dt = get_time() - conv->t0;
+	if(!conv->quiet)
+	{
+		err("\ntotal events: %lu in, %lu out, avg speed %.1f kev/s\n",
+				conv->ev_processed,
+				conv->ev_emitted,
+				(double) conv->ev_processed / dt / 1e3);
+	}
+}
+
+static uint64_t
+get_event_tid(struct conv *conv, const struct ctf_event *ev)
+{
+	/* External threads have their tid in the unbounded context */
+	if(conv->curr_cpu >= conv->ncpus)
+	{
+		assert(ev->tid >= 0);
+		return (uint64_t) ev->tid;
+	}
+
+	return ctf_event_get_uint(ev, "tid");
+}
+
+static inline int
+filter_allowed(struct conv *conv, long long type)
+{
+	int i;
+
+	if(!conv->nfilters)
+		return 1;
+
+	for(i=0; i<conv->nfilters; i++)
+	{
+		if(type == (long long) conv->filters[i])
+			return 1;
+	}
+
+	return 0;
+}
+
+static void
+add_prv_ev(struct conv *conv, long long type, long long value)
+{
+	int i;
+
+	if(conv->n_acc_ev + 1 >= MAX_ACC_EVENTS)
+	{
+		err("too many acc events\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if(!filter_allowed(conv, type))
+		return;
+
+	i = conv->n_acc_ev++;
+	conv->acc_ev[i].type = type;
+	conv->acc_ev[i].value = value;
+}
+
+/* Write an event at a time other than the current one */
+static void
+write_prv_ev(struct conv *conv, int64_t ts, long long type, long long value)
+{
+	if(!filter_allowed(conv, type))
+		return;
+
+	fprintf(conv->prv, "2:0:1:1:%d:%" PRIi64 ":%lld:%lld\n",
+			conv->curr_cpu + 1, ts, type, value);
+}
+
+static struct thread *
+get_thread(struct conv *conv, uint64_t tid)
+{
+	struct thread *t = NULL;
+
+	HASH_FIND(hh, conv->threads, &tid, sizeof(t->tid), t);
+	return t;
+}
+
+static inline void
+task_stack_push(struct task_stack *tasks, struct task *task)
+{
+	if(tasks->num_tasks == MAX_TASK_STACK)
+	{
+		err("Reached maximum task recursion limit of %d tasks per thread\n", MAX_TASK_STACK);
+		exit(EXIT_FAILURE);
+	}
+
+	tasks->task[tasks->num_tasks++] = task;
+}
+
+static inline struct task *
+task_stack_top(struct task_stack *tasks)
+{
+	if(!tasks->num_tasks)
+		return NULL;
+
+	return tasks->task[tasks->num_tasks - 1];
+}
+
+static inline void
+task_stack_pop(struct task_stack *tasks)
+{
+	if(!tasks->num_tasks)
+	{
+		err("Tried to pop task from empty task stack, probably due to an unmatched task_end event\n");
+		exit(EXIT_FAILURE);
+	}
+
+	tasks->num_tasks--;
+}
+
+static struct thread *
+alloc_thread(struct conv *conv, uint64_t tid, int external, int cpu, int state)
+{
+	struct thread *thread;
+
+	thread = calloc(1, sizeof(*thread));
+	if(!thread)
+	{
+		err("malloc failed in alloc_thread\n");
+		exit(EXIT_FAILURE);
+	}
+
+	thread->tid = tid;
+	thread->cpu = cpu;
+	thread->external = external;
+	thread->state = state;
+	thread->color = conv->last_thread_color++;
+
+	HASH_ADD(hh, conv->threads, tid, sizeof(thread->tid), thread);
+
+	return thread;
+}
+
+static struct thread *
+current_thread(struct conv *conv)
+{
+	struct thread *thread = conv->cpus[conv->curr_cpu].thread;
+
+	if(thread == NULL)
+	{
+		err("event without a thread at cpu %d\n", conv->curr_cpu);
+		exit(EXIT_FAILURE);
+	}
+
+	return thread;
+}
+
+static void
+hook_ext_thread_create(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	uint64_t tid = get_event_tid(conv, ev);
+	struct thread *thread = get_thread(conv, tid);
+
+	/* It could be created before */
+	if(thread)
+	{
+		assert(thread->external);
+		assert(thread->state == THREAD_ST_UNKNOWN);
+		thread->state = THREAD_ST_CREATED;
+	}
+	else
+	{
+		thread = alloc_thread(conv, tid, 1, conv->curr_cpu, THREAD_ST_CREATED);
+	}
+
+	conv->cpus[conv->curr_cpu].thread = thread;
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_CODE, RA_RUNTIME);
+	add_prv_ev(conv, EV_TYPE_RUNNING_THREAD_TID, thread->color);
+}
+
+static void
+hook_thread_create(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	uint64_t tid = get_event_tid(conv, ev);
+	struct thread *thread = conv->cpus[conv->curr_cpu].thread;
+
+	if(thread)
+	{
+		/* We can only had it created if is external */
+		assert(thread->external);
+		assert(thread->tid == tid);
+		assert(thread->state == THREAD_ST_UNKNOWN);
+
+		thread->state = THREAD_ST_CREATED;
+	}
+	else
+	{
+		assert(get_thread(conv, tid) == NULL);
+		thread = alloc_thread(conv, tid, 0, conv->curr_cpu, THREAD_ST_CREATED);
+	}
+
+	conv->cpus[conv->curr_cpu].thread = thread;
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_CODE, RA_RUNTIME);
+	add_prv_ev(conv, EV_TYPE_RUNNING_THREAD_TID, thread->color);
+}
+
+static void
+hook_thread_resume(struct conv *conv, const struct ctf_event *ev, int class_id)
+{
+	uint64_t tid = get_event_tid(conv, ev);
+	struct thread *thread = get_thread(conv, tid);
+	struct task *task;
+	int i;
+
+	if(thread == NULL)
+	{
+		err("resume of unknown thread %lu\n", tid);
+		exit(EXIT_FAILURE);
+	}
+
+	assert(thread->state != THREAD_ST_RESUMED);
+
+	/* Set the thread running in the current CPU */
+	conv->cpus[conv->curr_cpu].thread = thread;
+	thread->state = THREAD_ST_RESUMED;
+	thread->cpu = conv->curr_cpu;
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_CODE, RA_RUNTIME);
+	add_prv_ev(conv, EV_TYPE_RUNNING_THREAD_TID, thread->color);
+	add_prv_ev(conv, EV_TYPE_RUNTIME_MODE, RM_RUNTIME);
+
+	if(thread->busy_wait)
+		add_prv_ev(conv, EV_TYPE_RUNTIME_BUSYWAITING, RA_BUSYWAITING);
+
+	task = task_stack_top(&thread->tasks);
+	if(task && task->state == TASK_ST_RUNNING)
+		hook_task_execute(conv, ev, class_id);
+
+	/* Reset the counters */
+	for(i=0; i<conv->nhwc; i++)
+		add_prv_ev(conv, conv->hwc_table[i], 0);
+}
+
+static void
+hook_thread_suspend(struct conv *conv, const struct ctf_event *ev, int class_id)
+{
+	uint64_t tid = get_event_tid(conv, ev);
+	struct thread *thread = get_thread(conv, tid);
+	struct task *task;
+
+	if(thread == NULL)
+	{
+		err("suspend of unknown thread %lu\n", tid);
+		exit(EXIT_FAILURE);
+	}
+
+	thread->state = THREAD_ST_SUSPENDED;
+	if(!thread->external)
+	{
+		thread->cpu = -1;
+
+		/* Remove the thread from the current CPU */
+		assert(conv->cpus[conv->curr_cpu].thread == thread);
+		conv->cpus[conv->curr_cpu].thread = NULL;
+	}
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_CODE, RA_END);
+	add_prv_ev(conv, EV_TYPE_RUNNING_THREAD_TID, RA_END);
+
+	if(thread->busy_wait)
+		add_prv_ev(conv, EV_TYPE_RUNTIME_BUSYWAITING, RA_END);
+
+	task = task_stack_top(&thread->tasks);
+	if(task && task->state == TASK_ST_RUNNING)
+		hook_task_stop(conv, ev, class_id);
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_MODE, RM_DEAD);
+}
+
+static void
+hook_enter_busy_wait(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	current_thread(conv)->busy_wait = 1;
+	add_prv_ev(conv, EV_TYPE_RUNTIME_BUSYWAITING, RA_BUSYWAITING);
+}
+
+static void
+hook_exit_busy_wait(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	current_thread(conv)->busy_wait = 0;
+	add_prv_ev(conv, EV_TYPE_RUNTIME_BUSYWAITING, RA_END);
+}
+
+static void
+hook_task_label_register(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct task_type *tt = NULL;
+	const char *label, *srcline;
+	uint64_t type;
+
+	label = ctf_event_get_str(ev, "label");
+	srcline = ctf_event_get_str(ev, "source");
+	type = ctf_event_get_uint(ev, "type");
+
+	HASH_FIND(hh, conv->task_types, &type, sizeof(type), tt);
+
+	if(tt)
+	{
+		err("The task type %lu was already in the hash table\n", type);
+		exit(EXIT_FAILURE);
+	}
+
+	tt = malloc(sizeof(*tt));
+	if(!tt) abort();
+
+	tt->type = type;
+	snprintf(tt->label, sizeof(tt->label), "%s", label);
+	snprintf(tt->srcline, sizeof(tt->srcline), "%s", srcline);
+
+	HASH_ADD(hh, conv->task_types, type, sizeof(type), tt);
+}
+
+static void
+hook_task_create(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct task *task = NULL;
+	uint64_t type, id;
+
+	type = ctf_event_get_uint(ev, "type");
+	id = ctf_event_get_uint(ev, "id");
+
+	HASH_FIND(hh, conv->tasks, &id, sizeof(id), task);
+
+	if(task)
+	{
+		err("The task with id %lu was already in the hash table\n", id);
+		exit(EXIT_FAILURE);
+	}
+
+	task = malloc(sizeof(*task));
+	if(!task) abort();
+
+	task->id = id;
+	task->type = type;
+	task->state = TASK_ST_UNINIT;
+
+	HASH_ADD(hh, conv->tasks, id, sizeof(id), task);
+}
+
+static void
+hook_task_start(struct conv *conv, const struct ctf_event *ev, int class_id)
+{
+	struct thread *thread = current_thread(conv);
+	struct task *task = NULL;
+	uint64_t id;
+
+	id = ctf_event_get_uint(ev, "id");
+
+	HASH_FIND(hh, conv->tasks, &id, sizeof(id), task);
+
+	if(!task)
+	{
+		err("The task with id %lu is missing in the hash table\n", id);
+		exit(EXIT_FAILURE);
+	}
+
+	task_stack_push(&thread->tasks, task);
+
+	hook_task_execute(conv, ev, class_id);
+}
+
+static void
+hook_task_execute(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, int class_id)
+{
+	struct thread *thread = current_thread(conv);
+	struct task *task = task_stack_top(&thread->tasks);
+
+	assert(task);
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_TASKS, RA_TASK);
+	add_prv_ev(conv, EV_TYPE_RUNNING_TASK_ID, task->id);
+	add_prv_ev(conv, EV_TYPE_RUNNING_TASK_LABEL, task->type);
+	add_prv_ev(conv, EV_TYPE_RUNNING_TASK_SOURCE, task->type);
+
+	/* Avoid a task mode event when we are in waitfor */
+	if(!(class_id == CLASS_ID_THREAD_RESUME && thread->n_stack > 0 &&
+			thread->ev_stack[thread->n_stack-1] == RS_WAIT_FOR))
+	{
+		add_prv_ev(conv, EV_TYPE_RUNTIME_MODE, RM_TASK);
+	}
+}
+
+static void
+hook_task_stop(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_RUNTIME_TASKS, RA_END);
+	add_prv_ev(conv, EV_TYPE_RUNNING_TASK_ID, RA_END);
+	add_prv_ev(conv, EV_TYPE_RUNNING_TASK_LABEL, RA_END);
+	add_prv_ev(conv, EV_TYPE_RUNNING_TASK_SOURCE, RA_END);
+
+	if(class_id == CLASS_ID_THREAD_SUSPEND ||
+			class_id == CLASS_ID_EXTERNAL_THREAD_SUSPEND)
+	{
+		add_prv_ev(conv, EV_TYPE_RUNTIME_MODE, RM_DEAD);
+	}
+	else
+	{
+		add_prv_ev(conv, EV_TYPE_RUNTIME_MODE, RM_RUNTIME);
+	}
+}
+
+static void
+hook_task_end(struct conv *conv, const struct ctf_event *ev, int class_id)
+{
+	task_stack_pop(&current_thread(conv)->tasks);
+
+	hook_task_stop(conv, ev, class_id);
+}
+
+static void
+hook_flush(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	int64_t t0, t1;
+
+	/* The payload timestamps lack the clock offset */
+	t0 = (int64_t) ctf_event_get_uint(ev, "start") + conv->clock_offset_ns;
+	t1 = (int64_t) ctf_event_get_uint(ev, "end") + conv->clock_offset_ns;
+
+	assert(t0 >= 0);
+	assert(t1 >= 0);
+
+	write_prv_ev(conv, t0, EV_TYPE_CTF_FLUSH, 1);
+	write_prv_ev(conv, t1, EV_TYPE_CTF_FLUSH, 0);
+}
+
+static void
+hook_hwc(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	int i;
+
+	if(ev->hwc == NULL)
+		return;
+
+	for(i=0; i<conv->nhwc; i++)
+		add_prv_ev(conv, conv->hwc_table[i], ctf_event_get_hwc(ev, i));
+}
+
+static void
+hook_ss_lock_client(struct conv *conv, const struct ctf_event *ev, int class_id)
+{
+	struct served_task *served = NULL;
+	int64_t ts;
+	uint64_t id;
+
+	ts = (int64_t) ctf_event_get_uint(ev, "ts_acquire") + conv->clock_offset_ns;
+	assert(ts >= 0);
+
+	/* Send an event in the past, when the lock was acquired. No event
+	 * can be emitted by this CPU while it waits for the lock */
+	write_prv_ev(conv, ts, EV_TYPE_RUNTIME_SUBSYSTEMS, RS_SCHEDULER_LOCK_ENTER);
+
+	/* Relate the task received with the server that assigned it */
+	id = ctf_event_get_uint(ev, "id");
+	if(id != 0)
+	{
+		HASH_FIND(hh, conv->served_tasks, &id, sizeof(id), served);
+		if(served)
+		{
+			fprintf(conv->prv,
+					"3:0:1:1:%d:%" PRIi64 ":%" PRIi64
+					":0:1:1:%d:%" PRIi64 ":%" PRIi64 ":1:1\n",
+					served->cpu + 1, served->ts, served->ts,
+					conv->curr_cpu + 1, conv->ts, conv->ts);
+
+			HASH_DEL(conv->served_tasks, served);
+			free(served);
+		}
+	}
+
+	hook_ss_last(conv, ev, class_id);
+}
+
+static void
+hook_ss_lock_server(struct conv *conv, const struct ctf_event *ev, int class_id)
+{
+	int64_t ts;
+
+	ts = (int64_t) ctf_event_get_uint(ev, "ts_acquire") + conv->clock_offset_ns;
+	assert(ts >= 0);
+
+	write_prv_ev(conv, ts, EV_TYPE_RUNTIME_SUBSYSTEMS, RS_SCHEDULER_LOCK_ENTER);
+
+	hook_ss_push(conv, ev, class_id);
+}
+
+static void
+hook_ss_lock_assign(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct served_task *served = NULL;
+	uint64_t id = ctf_event_get_uint(ev, "id");
+
+	HASH_FIND(hh, conv->served_tasks, &id, sizeof(id), served);
+	if(served == NULL)
+	{
+		served = malloc(sizeof(*served));
+		if(!served) abort();
+
+		served->id = id;
+		HASH_ADD(hh, conv->served_tasks, id, sizeof(id), served);
+	}
+
+	served->ts = conv->ts;
+	served->cpu = conv->curr_cpu;
+}
+
+static void
+hook_ss_print(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, int class_id)
+{
+	int subsystem = conv->ss_table[class_id];
+
+	/* It must be defined in ss_list */
+	assert(subsystem != -1);
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_SUBSYSTEMS, subsystem);
+}
+
+static void
+hook_ss_last(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct thread *thread = current_thread(conv);
+
+	assert(thread->n_stack >= 1);
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_SUBSYSTEMS,
+			thread->ev_stack[thread->n_stack-1]);
+}
+
+static void
+hook_ss_pop(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct thread *thread = current_thread(conv);
+
+	assert(thread->n_stack >= 2);
+
+	thread->n_stack--;
+
+	add_prv_ev(conv, EV_TYPE_RUNTIME_SUBSYSTEMS,
+			thread->ev_stack[thread->n_stack-1]);
+}
+
+static void
+ss_push_value(struct conv *conv, int subsystem)
+{
+	struct thread *thread = current_thread(conv);
+
+	if(thread->n_stack + 1 > MAX_EV_STACK)
+	{
+		err("too many events stacked\n");
+		exit(EXIT_FAILURE);
+	}
+
+	thread->ev_stack[thread->n_stack++] = subsystem;
+	add_prv_ev(conv, EV_TYPE_RUNTIME_SUBSYSTEMS, subsystem);
+}
+
+static void
+hook_ss_push(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, int class_id)
+{
+	int subsystem = conv->ss_table[class_id];
+
+	/* It must be defined in ss_list */
+	assert(subsystem != -1);
+
+	ss_push_value(conv, subsystem);
+}
+
+static void
+hook_debug_register(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct debug_type *dt = NULL;
+	uint64_t id = ctf_event_get_uint(ev, "id");
+
+	HASH_FIND(hh, conv->debug_types, &id, sizeof(id), dt);
+	if(dt)
+		return;
+
+	dt = malloc(sizeof(*dt));
+	if(!dt) abort();
+
+	dt->id = id;
+	snprintf(dt->name, sizeof(dt->name), "%s", ctf_event_get_str(ev, "name"));
+
+	HASH_ADD(hh, conv->debug_types, id, sizeof(id), dt);
+}
+
+static void
+hook_debug_enter(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	ss_push_value(conv, RS_DEBUG + ctf_event_get_uint(ev, "id"));
+}
+
+static void
+hook_debug_transition(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct thread *thread = current_thread(conv);
+
+	assert(thread->n_stack >= 1);
+	thread->n_stack--;
+
+	ss_push_value(conv, RS_DEBUG + ctf_event_get_uint(ev, "id"));
+}
+
+static void
+hook_mode_dead(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_RUNTIME_MODE, RM_DEAD);
+}
+
+static void
+hook_mode_runtime(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_RUNTIME_MODE, RM_RUNTIME);
+}
+
+static void
+hook_count_task_create(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_CREATED_TASKS, ++conv->created_tasks);
+}
+
+static void
+hook_count_task_block(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_BLOCKED_TASKS, ++conv->blocked_tasks);
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_RUNNING_TASKS, --conv->running_tasks);
+}
+
+static void
+hook_count_task_unblock(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_BLOCKED_TASKS, --conv->blocked_tasks);
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_RUNNING_TASKS, ++conv->running_tasks);
+}
+
+static void
+hook_count_task_start(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_RUNNING_TASKS, ++conv->running_tasks);
+}
+
+static void
+hook_count_task_end(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_RUNNING_TASKS, --conv->running_tasks);
+}
+
+static void
+hook_count_thread_create(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_CREATED_THREADS, ++conv->created_threads);
+}
+
+static void
+hook_count_thread_resume(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct thread *thread = get_thread(conv, get_event_tid(conv, ev));
+
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_RUNNING_THREADS, ++conv->running_threads);
+
+	/* Only the threads that were suspended before were blocked */
+	if(thread && thread->blocked)
+	{
+		thread->blocked = 0;
+		add_prv_ev(conv, EV_TYPE_NUMBER_OF_BLOCKED_THREADS, --conv->blocked_threads);
+	}
+}
+
+static void
+hook_count_thread_suspend(struct conv *conv, const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	struct thread *thread = get_thread(conv, get_event_tid(conv, ev));
+
+	assert(conv->running_threads > 0);
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_RUNNING_THREADS, --conv->running_threads);
+
+	if(thread == NULL || thread->blocked)
+	{
+		err("attempt to suspend the same thread twice\n");
+		exit(EXIT_FAILURE);
+	}
+
+	thread->blocked = 1;
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_BLOCKED_THREADS, ++conv->blocked_threads);
+}
+
+static void
+hook_count_thread_shutdown(struct conv *conv, __attribute__((unused)) const struct ctf_event *ev, __attribute__((unused)) int class_id)
+{
+	assert(conv->created_threads > 0);
+	assert(conv->running_threads > 0);
+
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_CREATED_THREADS, --conv->created_threads);
+	add_prv_ev(conv, EV_TYPE_NUMBER_OF_RUNNING_THREADS, --conv->running_threads);
+}
+
+static void
+flush_acc_events(struct conv *conv)
+{
+	int i;
+
+	/* Paraver begins CPUs at 1 */
+	int prv_cpu = conv->curr_cpu + 1;
+
+	if(conv->split_events)
+	{
+		for(i=0; i<conv->n_acc_ev; i++)
+		{
+			fprintf(conv->prv,
+					"2:0:1:1:%d:%" PRIi64 ":%lld:%lld\n",
+					prv_cpu, conv->ts,
+					conv->acc_ev[i].type,
+					conv->acc_ev[i].value);
+		}
+	}
+	else
+	{
+		fprintf(conv->prv, "2:0:1:1:%d:%" PRIi64, prv_cpu, conv->ts);
+
+		for(i=0; i<conv->n_acc_ev; i++)
+		{
+			fprintf(conv->prv,
+					":%lld:%lld", conv->acc_ev[i].type,
+					conv->acc_ev[i].value);
+		}
+
+		fprintf(conv->prv, "\n");
+	}
+
+	conv->ev_emitted += conv->n_acc_ev;
+	conv->n_acc_ev = 0;
+	conv->ev_progress = (double) (conv->ts - conv->clock_start_ns) /
+		(conv->clock_end_ns - conv->clock_start_ns);
+}
+
+/* External threads are not bound to any CPU, so we assign them to one
+ * fake CPU each, the virtual CPU, as soon as we see any running */
+static int
+get_external_thread_cpu(struct conv *conv, const struct ctf_event *ev)
+{
+	struct thread *thread;
+	uint64_t tid;
+	int cpu;
+
+	assert(ev->tid >= 0);
+	tid = (uint64_t) ev->tid;
+
+	thread = get_thread(conv, tid);
+
+	if(thread == NULL)
+	{
+		cpu = conv->ncpus + conv->nvcpus++;
+		if(cpu >= MAX_CPUS)
+		{
+			err("too many external threads\n");
+			exit(EXIT_FAILURE);
+		}
+
+		thread = alloc_thread(conv, tid, 1, cpu, THREAD_ST_UNKNOWN);
+	}
+
+	assert(thread->external);
+	assert(thread->cpu >= conv->ncpus);
+
+	conv->cpus[thread->cpu].thread = thread;
+
+	return thread->cpu;
+}
+
+static void
+report_progress(struct conv *conv)
+{
+	double dt, speed;
+	size_t written;
+
+	dt = get_time() - conv->tic;
+
+	written = ftell(conv->prv);
+	speed = (double) (written - conv->last_written) / dt;
+
+	if(!conv->quiet)
+	{
+		fprintf(stderr, "\r%ld MB (%d%%) written at %.2f MB/s",
+			written / (1024 * 1024),
+			(int) (conv->ev_progress * 100.0),
+			speed / (1024 * 1024));
+	}
+
+	conv->tic = get_time();
+	conv->last_written = written;
+	conv->last_reported = conv->tic;
+}
+
+static void
+process_event(struct conv *conv, const struct ctf_event *ev)
+{
+	int stream_class, class_id, i;
+
+	stream_class = (int) (ev->cls - conv->trace.meta.events[0]) / CTF_MAX_EVENTS;
+	class_id = conv->class_map[stream_class][ev->cls->id];
+
+	/* Virtual CPUs are always larger than the largest physical one */
+	if(ev->cpu_id > conv->max_pcpu)
+	{
+		conv->curr_cpu = get_external_thread_cpu(conv, ev);
+		assert(conv->curr_cpu >= conv->ncpus);
+	}
+	else
+	{
+		conv->curr_cpu = conv->pcpu_index[ev->cpu_id];
+		assert(conv->curr_cpu >= 0);
+		assert(conv->curr_cpu < conv->ncpus);
+	}
+
+	conv->ts = ev->ts;
+
+	if(class_id == CLASS_ID_UNKNOWN || conv->hook_table[class_id][0] == NULL)
+		conv->ev_ignored++;
+
+	for(i=0; class_id != CLASS_ID_UNKNOWN && i<MAX_HOOKS; i++)
+	{
+		if(conv->hook_table[class_id][i] == NULL)
+			break;
+
+		conv->hook_table[class_id][i](conv, ev, class_id);
+	}
+
+	conv->ev_processed++;
+
+	if(conv->n_acc_ev)
+		flush_acc_events(conv);
+
+	conv->curr_cpu = -1;
+
+	/* Checking the time is expensive, do it once in a while */
+	if((conv->ev_processed & 0xfff) == 0 &&
+			get_time() - conv->last_reported > REPORT_TIME)
+		report_progress(conv);
+}
+
+static int
+mkpath(char *file_path, mode_t mode, int last)
+{
+	char *p;
+
+	assert(file_path && *file_path);
+	for(p = strchr(file_path + 1, '/'); p; p = strchr(p + 1, '/'))
+	{
+		*p = '\0';
+		if (mkdir(file_path, mode) == -1) {
+			if (errno != EEXIST) {
+				*p = '/';
+				return -1;
+			}
+		}
+		*p = '/';
+	}
+
+	if(last && mkdir(file_path, mode) == -1)
+		if (errno != EEXIST)
+			return -1;
+
+	return 0;
+}
+
+static void
+usage(__attribute__((unused)) int argc, char *argv[])
+{
+	fprintf(stderr, "Usage: %s [-jq] [-o <dir>] [-f <types>] <trace>\n", argv[0]);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "  Convert CTF traces to PRV without babeltrace2\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "The specified <trace> must contain a directory\n"
+			"called \"ctf\" inside.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "The output is placed in the output directory\n"
+			"optionally specified with the \"-o\" option.\n"
+			"By default the directory is at <trace>/prv\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Use -j to join multiple events in a single line.\n");
+	fprintf(stderr, "This results in smaller traces but harder to\n");
+	fprintf(stderr, "manipulate with common text processing tool.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Use -f to specify a list of comma-delimited\n");
+	fprintf(stderr, "Paraver event types. Only events matching the\n");
+	fprintf(stderr, "specified type numbers will be written in the\n");
+	fprintf(stderr, "PRV file if this option is enabled.\n");
+	fprintf(stderr, "Don't use spaces between commas.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Use -q to be quiet.\n");
+
+	exit(EXIT_FAILURE);
+}
+
+static void
+parse_filters(long filter_events[MAX_FILTER], int *num_filters, char *arg)
+{
+	char *event;
+	int i = 0;
+
+	event = strtok(arg, ",");
+
+	while (event != NULL) {
+		if (i >= MAX_FILTER) {
+			fprintf(stderr, "too many filters\n");
+			exit(EXIT_FAILURE);
+		}
+
+		errno = 0;
+		filter_events[i] = strtol(event, NULL, 10);
+
+		if (errno) {
+			perror("could not parse filter event type\n");
+			exit(EXIT_FAILURE);
+		}
+
+		++i;
+		event = strtok(NULL, ",");
+	}
+
+	*num_filters = i;
+}
+
+int main(int argc, char *argv[])
+{
+	static struct conv conv;
+	const struct ctf_event *ev;
+	char input_trace[PATH_MAX];
+	char output_dir[PATH_MAX];
+	long filter_events[MAX_FILTER];
+	int num_filters;
+	const char *input_dir;
+	int opt, split_events, quiet;
+
+	output_dir[0] = '\0';
+
+	num_filters = 0;
+	split_events = 1;
+	quiet = 0;
+
+	while ((opt = getopt(argc, argv, "jqo:f:h")) != -1)
+	{
+		switch (opt) {
+		case 'j':
+			split_events = 0;
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		case 'o':
+			if(strlen(optarg) >= PATH_MAX)
+			{
+				fprintf(stderr, "output dir too large\n");
+				exit(EXIT_FAILURE);
+			}
+			strcpy(output_dir, optarg);
+			break;
+		case 'f':
+			parse_filters(filter_events, &num_filters, optarg);
+			break;
+		case 'h':
+		default: /* '?' */
+			usage(argc, argv);
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "Missing trace\n");
+		usage(argc, argv);
+	}
+
+	input_dir = argv[optind];
+
+	if(snprintf(input_trace, PATH_MAX, "%s/ctf/user",
+				input_dir) >= PATH_MAX)
+	{
+		fprintf(stderr, "input path too large\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if(output_dir[0] == '\0')
+	{
+		if(snprintf(output_dir, PATH_MAX, "%s/prv",
+					input_dir) >= PATH_MAX)
+		{
+			fprintf(stderr, "input path too large\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if(mkpath(output_dir, 0755, 1))
+	{
+		perror("cannot create directories");
+		exit(EXIT_FAILURE);
+	}
+
+	conv_init(&conv, input_trace, output_dir, split_events,
+			filter_events, num_filters, quiet);
+
+	while((ev = ctf_trace_next(&conv.trace)) != NULL)
+		process_event(&conv, ev);
+
+	conv_finalize(&conv);
+
+	return 0;
+}
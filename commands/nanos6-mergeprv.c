@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2021-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <stdio.h>
@@ -12,6 +12,9 @@
 #include <unistd.h>
 #include <limits.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -27,6 +30,19 @@
 #define INROW OUTROW
 #define TRACE_VERSION 1
 
+/* Number of events parsed at once, and number of parsed chunks that
+ * each rank keeps in memory. They bound the memory used by the merge
+ * regardless of the size of the input traces */
+#define CHUNK_EVENTS 1024
+#define RANK_CHUNKS 3
+
+/* Size and number of the output blocks handed to the writer thread */
+#define OUT_BLOCK_SIZE (1024 * 1024)
+#define OUT_BLOCKS 4
+
+/* Default number of parser threads */
+#define DEFAULT_PARSERS 4
+
 /* The spec says:
  * 2:cpu_id:appl_id:task_id:thread_id:time:event_type:event_value
  *
@@ -43,15 +59,77 @@ struct event {
 	int64_t val;
 };
 
+struct chunk {
+	int nevents;
+	/* Whether it is the last chunk of the rank */
+	int last;
+	struct event events[CHUNK_EVENTS];
+};
+
+/* The PRV file of a rank is mapped in memory and parsed by the parser
+ * threads, one chunk at a time, into a ring of chunks that the merge
+ * consumes in order */
+struct input {
+	int rank;
+	const char *data;
+	size_t size;
+
+	/* Parser position, only used by the parser owning the input */
+	size_t pos;
+	size_t released_pos;
+
+	/* Protected by the merger lock */
+	int busy;
+	int parsed;
+	uint64_t filled;
+	uint64_t released;
+	struct chunk chunks[RANK_CHUNKS];
+
+	/* Merge position */
+	struct chunk *chunk;
+	int next;
+};
+
+struct out_block {
+	size_t len;
+	char data[OUT_BLOCK_SIZE];
+};
+
 struct merger {
 	FILE *prv[MAX_RANKS];
-	struct event ev[MAX_RANKS];
+	struct input *in[MAX_RANKS];
 	int ranks;
-	int active[MAX_RANKS];
 	int64_t last_time;
 	FILE *outprv;
 	FILE *outrow;
 	int total_threads;
+
+	/* Parser threads */
+	int nparsers;
+	pthread_t parsers[MAX_RANKS];
+	pthread_mutex_t lock;
+	pthread_cond_t work_cond;
+	pthread_cond_t data_cond;
+	int next_input;
+	int parsers_exit;
+
+	/* Min-heap of the ranks ordered by their next event */
+	int nheap;
+	struct input *heap[MAX_RANKS];
+
+	/* Writer thread and the ring of output blocks */
+	pthread_t writer;
+	pthread_mutex_t out_lock;
+	pthread_cond_t out_cond;
+	struct out_block *out[OUT_BLOCKS];
+	uint64_t out_filled;
+	uint64_t out_written;
+	struct out_block *cur;
+
+	/* Benchmark */
+	int bench;
+	size_t bytes_in;
+	size_t bytes_out;
 };
 
 struct prv_header {
@@ -66,39 +144,107 @@ struct prv_header {
 	int running_node;
 };
 
-int
-next_event(FILE *f, struct event *ev)
+static int
+parse_int(const char **p, const char *end, int64_t *val)
 {
-	int ntok, type;
+	const char *c = *p;
+	int64_t v = 0;
+	int neg = 0;
+
+	if(c < end && *c == '-')
+	{
+		neg = 1;
+		c++;
+	}
+
+	if(c >= end || *c < '0' || *c > '9')
+		return -1;
+
+	while(c < end && *c >= '0' && *c <= '9')
+		v = v * 10 + (*c++ - '0');
+
+	*val = neg ? -v : v;
+	*p = c;
+
+	return 0;
+}
+
+/* Parse the next event line, returning -1 at the end of the file */
+static int
+next_event(struct input *in, struct event *ev)
+{
+	const char *p, *end, *eol;
+	int64_t tok[8];
+	int ntok;
+
+	end = in->data + in->size;
 
 	/* TODO: Support communication and state lines */
 
 	while(1)
 	{
+		p = in->data + in->pos;
+
+		/* Skip blank lines */
+		while(p < end && (*p == '\n' || *p == ' '))
+			p++;
+
+		if(p >= end)
+		{
+			in->pos = in->size;
+			return -1;
+		}
+
+		eol = memchr(p, '\n', end - p);
+		if(eol == NULL)
+			eol = end;
+
+		in->pos = (eol - in->data) + (eol < end);
+
 		/* 2:0:1:1:2:22810769:6400017:7 */
 		/* 2:cpu_id:appl_id:task_id:thread_id:time:event_type:event_value */
-		ntok = fscanf(f, "%d:%d:%d:%d:%d:%ld:%ld:%ld",
-				&type, &ev->cpu, &ev->app, &ev->rank,
-				&ev->thread, &ev->t, &ev->type, &ev->val);
+		for(ntok=0; ntok<8; ntok++)
+		{
+			if(parse_int(&p, eol, &tok[ntok]) != 0)
+				break;
 
-		if(ntok == EOF)
-			return -1;
+			if(ntok < 7)
+			{
+				if(p >= eol || *p != ':')
+				{
+					ntok++;
+					break;
+				}
+				p++;
+			}
+		}
 
 		/* Discard non-events by now */
-		if(ntok >= 1 && type != 2)
+		if(ntok >= 1 && tok[0] != 2)
 		{
 			fprintf(stderr, "warning: ignoring unsupported type %d\n",
-					type);
+					(int) tok[0]);
 			continue;
 		}
 
-		if(ntok != 8)
+		if(ntok != 8 || p != eol)
 		{
-			fprintf(stderr, "error: line with %d tokens, instead of 8\n", ntok);
+			if(ntok == 8)
+				fprintf(stderr, "error: line with more than 8 tokens\n");
+			else
+				fprintf(stderr, "error: line with %d tokens, instead of 8\n", ntok);
 			fprintf(stderr, "Do you use one event per line?\n");
 			exit(EXIT_FAILURE);
 		}
 
+		ev->cpu = (int) tok[1];
+		ev->app = (int) tok[2];
+		ev->rank = (int) tok[3];
+		ev->thread = (int) tok[4];
+		ev->t = tok[5];
+		ev->type = tok[6];
+		ev->val = tok[7];
+
 		return 0;
 	}
 
@@ -106,6 +252,264 @@ next_event(FILE *f, struct event *ev)
 	return 0;
 }
 
+static void
+parse_chunk(struct input *in, struct chunk *chunk)
+{
+	size_t page, pos;
+
+	chunk->last = 0;
+	for(chunk->nevents=0; chunk->nevents < CHUNK_EVENTS; chunk->nevents++)
+	{
+		if(next_event(in, &chunk->events[chunk->nevents]) != 0)
+		{
+			chunk->last = 1;
+			break;
+		}
+	}
+
+	/* Drop the pages already parsed, so the resident memory stays
+	 * bounded for large traces */
+	page = (size_t) sysconf(_SC_PAGESIZE);
+	pos = (in->pos / page) * page;
+	if(pos > in->released_pos + 64 * page)
+	{
+		madvise((void *) (in->data + in->released_pos),
+				pos - in->released_pos, MADV_DONTNEED);
+		in->released_pos = pos;
+	}
+}
+
+static struct input *
+find_parser_work(struct merger *m)
+{
+	struct input *in;
+	int i, j;
+
+	for(i=0; i<m->ranks; i++)
+	{
+		j = (m->next_input + i) % m->ranks;
+		in = m->in[j];
+
+		if(in->busy || in->parsed)
+			continue;
+
+		if(in->filled - in->released >= RANK_CHUNKS)
+			continue;
+
+		m->next_input = (j + 1) % m->ranks;
+		return in;
+	}
+
+	return NULL;
+}
+
+static void *
+parser_thread(void *arg)
+{
+	struct merger *m = arg;
+	struct input *in;
+	struct chunk *chunk;
+
+	pthread_mutex_lock(&m->lock);
+
+	while(!m->parsers_exit)
+	{
+		if((in = find_parser_work(m)) == NULL)
+		{
+			pthread_cond_wait(&m->work_cond, &m->lock);
+			continue;
+		}
+
+		in->busy = 1;
+		chunk = &in->chunks[in->filled % RANK_CHUNKS];
+		pthread_mutex_unlock(&m->lock);
+
+		parse_chunk(in, chunk);
+
+		pthread_mutex_lock(&m->lock);
+		in->busy = 0;
+		in->parsed = chunk->last;
+		in->filled++;
+		pthread_cond_broadcast(&m->data_cond);
+	}
+
+	pthread_mutex_unlock(&m->lock);
+
+	return NULL;
+}
+
+/* Wait for the next parsed chunk of the rank */
+static struct chunk *
+input_acquire(struct merger *m, struct input *in)
+{
+	struct chunk *chunk;
+
+	pthread_mutex_lock(&m->lock);
+	while(in->filled == in->released)
+		pthread_cond_wait(&m->data_cond, &m->lock);
+	chunk = &in->chunks[in->released % RANK_CHUNKS];
+	pthread_mutex_unlock(&m->lock);
+
+	return chunk;
+}
+
+static void
+input_release(struct merger *m, struct input *in)
+{
+	pthread_mutex_lock(&m->lock);
+	in->released++;
+	pthread_cond_signal(&m->work_cond);
+	pthread_mutex_unlock(&m->lock);
+}
+
+/* Move the merge position of the rank to the next event, returning -1
+ * when the rank is depleted */
+static int
+input_advance(struct merger *m, struct input *in)
+{
+	in->next++;
+
+	while(in->next >= in->chunk->nevents)
+	{
+		if(in->chunk->last)
+		{
+			input_release(m, in);
+			in->chunk = NULL;
+			return -1;
+		}
+
+		input_release(m, in);
+		in->chunk = input_acquire(m, in);
+		in->next = 0;
+	}
+
+	return 0;
+}
+
+static inline struct event *
+input_event(struct input *in)
+{
+	return &in->chunk->events[in->next];
+}
+
+/* Order by time, and then by rank as the previous linear search */
+static inline int
+heap_less(struct input *a, struct input *b)
+{
+	int64_t ta = input_event(a)->t;
+	int64_t tb = input_event(b)->t;
+
+	if(ta != tb)
+		return ta < tb;
+
+	return a->rank < b->rank;
+}
+
+static void
+heap_sift_down(struct merger *m, int i)
+{
+	struct input *tmp;
+	int l, r, min;
+
+	while(1)
+	{
+		l = 2 * i + 1;
+		r = l + 1;
+		min = i;
+
+		if(l < m->nheap && heap_less(m->heap[l], m->heap[min]))
+			min = l;
+		if(r < m->nheap && heap_less(m->heap[r], m->heap[min]))
+			min = r;
+
+		if(min == i)
+			break;
+
+		tmp = m->heap[i];
+		m->heap[i] = m->heap[min];
+		m->heap[min] = tmp;
+		i = min;
+	}
+}
+
+static void *
+writer_thread(void *arg)
+{
+	struct merger *m = arg;
+	struct out_block *block;
+
+	while(1)
+	{
+		pthread_mutex_lock(&m->out_lock);
+		while(m->out_written == m->out_filled)
+			pthread_cond_wait(&m->out_cond, &m->out_lock);
+		block = m->out[m->out_written % OUT_BLOCKS];
+		pthread_mutex_unlock(&m->out_lock);
+
+		/* An empty block marks the end */
+		if(block->len == 0)
+			break;
+
+		if(fwrite(block->data, 1, block->len, m->outprv) != block->len)
+		{
+			perror("cannot write the output PRV file");
+			exit(EXIT_FAILURE);
+		}
+
+		pthread_mutex_lock(&m->out_lock);
+		m->out_written++;
+		pthread_cond_signal(&m->out_cond);
+		pthread_mutex_unlock(&m->out_lock);
+	}
+
+	return NULL;
+}
+
+/* Hand the current block to the writer and get an empty one */
+static void
+out_submit(struct merger *m)
+{
+	pthread_mutex_lock(&m->out_lock);
+	m->bytes_out += m->cur->len;
+	m->out_filled++;
+	pthread_cond_signal(&m->out_cond);
+
+	while(m->out_filled - m->out_written >= OUT_BLOCKS)
+		pthread_cond_wait(&m->out_cond, &m->out_lock);
+
+	m->cur = m->out[m->out_filled % OUT_BLOCKS];
+	m->cur->len = 0;
+	pthread_mutex_unlock(&m->out_lock);
+}
+
+static inline char *
+format_int(char *p, int64_t v)
+{
+	char tmp[24];
+	uint64_t u;
+	int n = 0;
+
+	if(v < 0)
+	{
+		*p++ = '-';
+		u = - (uint64_t) v;
+	}
+	else
+	{
+		u = (uint64_t) v;
+	}
+
+	do
+	{
+		tmp[n++] = '0' + (u % 10);
+		u /= 10;
+	} while(u);
+
+	while(n)
+		*p++ = tmp[--n];
+
+	return p;
+}
 
 void
 usage(int argc, char *argv[])
@@ -113,19 +517,46 @@ usage(int argc, char *argv[])
 	fprintf(stderr, "%s: merge multi-rank PRV files into one\n",
 			PROGNAME);
 	fprintf(stderr, "\n");
-	fprintf(stderr, "Usage: %s <trace dir>\n", PROGNAME);
+	fprintf(stderr, "Usage: %s [-b] [-p <parsers>] <trace dir>\n", PROGNAME);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Use -p to set the number of threads parsing the\n");
+	fprintf(stderr, "input traces (default %d).\n", DEFAULT_PARSERS);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Use -b to report the merge throughput.\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "Trace version: %d\n", TRACE_VERSION);
 	exit(EXIT_FAILURE);
 }
 
 void
-emit(FILE *f, struct event *ev)
+emit(struct merger *m, struct event *ev)
 {
+	char *p;
+
+	if(OUT_BLOCK_SIZE - m->cur->len < MAX_LINE)
+		out_submit(m);
+
+	p = m->cur->data + m->cur->len;
+
  	/* 2:cpu_id:appl_id:task_id:thread_id:time:event_type:event_value */
-	fprintf(f, "2:%d:%d:%d:%d:%ld:%ld:%ld\n",
-			ev->cpu, ev->app, ev->rank, ev->thread,
-			ev->t, ev->type, ev->val);
+	*p++ = '2';
+	*p++ = ':';
+	p = format_int(p, ev->cpu);
+	*p++ = ':';
+	p = format_int(p, ev->app);
+	*p++ = ':';
+	p = format_int(p, ev->rank);
+	*p++ = ':';
+	p = format_int(p, ev->thread);
+	*p++ = ':';
+	p = format_int(p, ev->t);
+	*p++ = ':';
+	p = format_int(p, ev->type);
+	*p++ = ':';
+	p = format_int(p, ev->val);
+	*p++ = '\n';
+
+	m->cur->len = p - m->cur->data;
 }
 
 void
@@ -253,43 +684,165 @@ merge_prv_header(struct merger *m)
 }
 
 void
-merge_prv_events(struct merger *m)
+open_inputs(struct merger *m)
 {
-	int i, cur;
+	struct input *in;
+	struct stat st;
+	long offset;
+	void *data;
+	int i, fd;
 
-	/* Populate first events */
 	for(i=0; i < m->ranks; i++)
-		if(next_event(m->prv[i], &m->ev[i]) != 0)
-			m->active[i] = 0;
+	{
+		/* The header has already been read */
+		offset = ftell(m->prv[i]);
+		fd = fileno(m->prv[i]);
 
-	while(1)
+		if(fstat(fd, &st) != 0)
+		{
+			perror("fstat");
+			exit(EXIT_FAILURE);
+		}
+
+		in = calloc(1, sizeof(*in));
+		if(in == NULL)
+		{
+			perror("calloc");
+			exit(EXIT_FAILURE);
+		}
+
+		in->rank = i;
+		in->size = st.st_size;
+		in->pos = offset;
+
+		if(in->size > 0)
+		{
+			data = mmap(NULL, in->size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(data == MAP_FAILED)
+			{
+				perror("mmap");
+				exit(EXIT_FAILURE);
+			}
+
+			madvise(data, in->size, MADV_SEQUENTIAL);
+			in->data = data;
+		}
+
+		m->bytes_in += in->size;
+		m->in[i] = in;
+	}
+}
+
+void
+close_inputs(struct merger *m)
+{
+	int i;
+
+	for(i=0; i < m->ranks; i++)
+	{
+		if(m->in[i]->size > 0)
+			munmap((void *) m->in[i]->data, m->in[i]->size);
+
+		free(m->in[i]);
+	}
+}
+
+void
+merge_prv_events(struct merger *m)
+{
+	struct input *in;
+	int i;
+
+	open_inputs(m);
+
+	pthread_mutex_init(&m->lock, NULL);
+	pthread_cond_init(&m->work_cond, NULL);
+	pthread_cond_init(&m->data_cond, NULL);
+	pthread_mutex_init(&m->out_lock, NULL);
+	pthread_cond_init(&m->out_cond, NULL);
+
+	for(i=0; i < OUT_BLOCKS; i++)
 	{
-		/* Find the next event with the lowest time */
-		for(i=0, cur=-1; i < m->ranks; i++)
+		if((m->out[i] = malloc(sizeof(struct out_block))) == NULL)
 		{
-			if(!m->active[i]) continue;
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	m->cur = m->out[0];
+	m->cur->len = 0;
 
-			if(cur < 0)
-				cur = i;
+	/* The header must reach the file before the writer starts */
+	fflush(m->outprv);
 
-			if(m->ev[i].t < m->ev[cur].t)
-				cur = i;
+	if(pthread_create(&m->writer, NULL, writer_thread, m) != 0)
+	{
+		fprintf(stderr, "cannot create the writer thread\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for(i=0; i < m->nparsers; i++)
+	{
+		if(pthread_create(&m->parsers[i], NULL, parser_thread, m) != 0)
+		{
+			fprintf(stderr, "cannot create the parser threads\n");
+			exit(EXIT_FAILURE);
 		}
+	}
 
-		/* No more events: all ranks depleted */
-		if(cur < 0)
-			break;
+	/* Populate first events */
+	m->nheap = 0;
+	for(i=0; i < m->ranks; i++)
+	{
+		in = m->in[i];
+		in->chunk = input_acquire(m, in);
+		in->next = -1;
+
+		if(input_advance(m, in) == 0)
+			m->heap[m->nheap++] = in;
+	}
+
+	for(i=m->nheap/2 - 1; i >= 0; i--)
+		heap_sift_down(m, i);
+
+	while(m->nheap > 0)
+	{
+		/* The rank with the lowest time is at the top */
+		in = m->heap[0];
 
 		/* Fix the rank (starting in 1) */
-		m->ev[cur].rank = cur + 1;
+		input_event(in)->rank = in->rank + 1;
 
 		/* Emit the event */
-		emit(m->outprv, &m->ev[cur]);
+		emit(m, input_event(in));
 
 		/* Get another event for that rank (if any) */
-		if(next_event(m->prv[cur], &m->ev[cur]) != 0)
-			m->active[cur] = 0;
+		if(input_advance(m, in) != 0)
+			m->heap[0] = m->heap[--m->nheap];
+
+		heap_sift_down(m, 0);
 	}
+
+	/* Write the last block, and then an empty one to finish */
+	if(m->cur->len > 0)
+		out_submit(m);
+	out_submit(m);
+
+	pthread_join(m->writer, NULL);
+
+	pthread_mutex_lock(&m->lock);
+	m->parsers_exit = 1;
+	pthread_cond_broadcast(&m->work_cond);
+	pthread_mutex_unlock(&m->lock);
+
+	for(i=0; i < m->nparsers; i++)
+		pthread_join(m->parsers[i], NULL);
+
+	for(i=0; i < OUT_BLOCKS; i++)
+		free(m->out[i]);
+
+	close_inputs(m);
 }
 
 void
@@ -405,21 +958,56 @@ check_version()
 	fclose(f);
 }
 
+static double
+get_time()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9;
+}
+
 int main(int argc, char *argv[])
 {
-	struct merger merger;
+	static struct merger merger;
 	char prvpath[PATH_MAX];
 	struct stat statbuf;
-	int i;
+	const char *tracedir;
+	double t0, dt;
+	int i, opt;
 
 	memset(&merger, 0, sizeof(merger));
+	merger.nparsers = DEFAULT_PARSERS;
+
+	while((opt = getopt(argc, argv, "bp:h")) != -1)
+	{
+		switch(opt)
+		{
+			case 'b':
+				merger.bench = 1;
+				break;
+			case 'p':
+				merger.nparsers = atoi(optarg);
+				if(merger.nparsers < 1 || merger.nparsers > MAX_RANKS)
+				{
+					fprintf(stderr, "invalid number of parsers: %s\n",
+							optarg);
+					usage(argc, argv);
+				}
+				break;
+			case 'h':
+			default: /* '?' */
+				usage(argc, argv);
+		}
+	}
+
+	if(optind != argc - 1) usage(argc, argv);
 
-	if(argc != 2) usage(argc, argv);
+	tracedir = argv[optind];
 
-	if(stat(argv[1], &statbuf) != 0)
+	if(stat(tracedir, &statbuf) != 0)
 	{
 		fprintf(stderr, "cannot stat trace directory %s: %s\n",
-				argv[1], strerror(errno));
+				tracedir, strerror(errno));
 
 		usage(argc, argv);
 	}
@@ -427,12 +1015,12 @@ int main(int argc, char *argv[])
 	if(!S_ISDIR(statbuf.st_mode))
 	{
 		fprintf(stderr, "the specified path is not a directory: %s\n",
-				argv[1]);
+				tracedir);
 
 		usage(argc, argv);
 	}
 
-	if(chdir(argv[1]) != 0)
+	if(chdir(tracedir) != 0)
 	{
 		perror("chdir");
 		exit(EXIT_FAILURE);
@@ -480,8 +1068,11 @@ int main(int argc, char *argv[])
 		exit(EXIT_FAILURE);
 	}
 
-	for(i=0; i<merger.ranks; i++)
-		merger.active[i] = 1;
+	/* No need for more parsers than ranks */
+	if(merger.nparsers > merger.ranks)
+		merger.nparsers = merger.ranks;
+
+	t0 = get_time();
 
 	merge_prv(&merger);
 
@@ -489,7 +1080,22 @@ int main(int argc, char *argv[])
 		fclose(merger.prv[i]);
 
 	fclose(merger.outrow);
-	fclose(merger.outprv);
+	if(fclose(merger.outprv) != 0)
+	{
+		perror("cannot close the output PRV file");
+		exit(EXIT_FAILURE);
+	}
+
+	dt = get_time() - t0;
+
+	if(merger.bench)
+	{
+		fprintf(stderr, "merged %d ranks with %d parsers in %.3f s\n",
+				merger.ranks, merger.nparsers, dt);
+		fprintf(stderr, "read %.1f MB at %.1f MB/s, wrote %.1f MB at %.1f MB/s\n",
+				merger.bytes_in / 1e6, merger.bytes_in / 1e6 / dt,
+				merger.bytes_out / 1e6, merger.bytes_out / 1e6 / dt);
+	}
 
 	return 0;
 }
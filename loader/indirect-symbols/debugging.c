@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "resolve.h"
@@ -176,5 +176,17 @@ int nanos6_is_numa_tracking_enabled(void)
 	return (*symbol)();
 }
 
+void nanos6_flight_recorder_dump(void)
+{
+	typedef void nanos6_flight_recorder_dump_t(void);
+
+	static nanos6_flight_recorder_dump_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_flight_recorder_dump_t *) _nanos6_resolve_symbol("nanos6_flight_recorder_dump", "debugging", NULL);
+	}
+
+	(*symbol)();
+}
+
 
 #pragma GCC visibility pop
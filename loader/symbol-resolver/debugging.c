@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "resolve.h"
@@ -22,3 +22,4 @@ RESOLVE_API_FUNCTION(nanos6_get_num_cpus, "debugging", NULL);
 RESOLVE_API_FUNCTION(nanos6_get_total_num_cpus, "debugging", NULL);
 RESOLVE_API_FUNCTION(nanos6_is_dlb_enabled, "debugging", NULL);
 RESOLVE_API_FUNCTION(nanos6_is_numa_tracking_enabled, "debugging", NULL);
+RESOLVE_API_FUNCTION(nanos6_flight_recorder_dump, "debugging", NULL);
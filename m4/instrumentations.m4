@@ -30,12 +30,14 @@ AC_DEFUN([SELECT_INSTRUMENTATIONS],
 			ac_build_extrae_instrumentation=yes
 			ac_build_lint_instrumentation=yes
 			ac_build_ovni_instrumentation=yes
+			ac_build_stats_instrumentation=yes
 			ac_build_verbose_instrumentation=yes
 		else
 			ac_build_ctf_instrumentation=no
 			ac_build_extrae_instrumentation=no
 			ac_build_lint_instrumentation=no
 			ac_build_ovni_instrumentation=no
+			ac_build_stats_instrumentation=no
 			ac_build_verbose_instrumentation=no
 		fi
 
@@ -129,6 +131,27 @@ AC_DEFUN([SELECT_INSTRUMENTATIONS],
 		AC_MSG_RESULT([$ac_build_ovni_instrumentation])
 		AM_CONDITIONAL(BUILD_OVNI_INSTRUMENTATION, test x"${ac_build_ovni_instrumentation}" = x"yes")
 
+		AC_MSG_CHECKING([whether to build the stats instrumented variant])
+		AC_ARG_ENABLE(
+			[stats-instrumentation],
+			[AS_HELP_STRING([--disable-stats-instrumentation], [build the stats instrumented variant])],
+			[
+				case "${enableval}" in
+				yes)
+					ac_build_stats_instrumentation=yes
+					;;
+				no)
+					ac_build_stats_instrumentation=no
+					;;
+				*)
+					AC_MSG_ERROR([bad value ${enableval} for --enable-stats-instrumentation])
+					;;
+				esac
+			], []
+		)
+		AC_MSG_RESULT([$ac_build_stats_instrumentation])
+		AM_CONDITIONAL(BUILD_STATS_INSTRUMENTATION, test x"${ac_build_stats_instrumentation}" = x"yes")
+
 		AC_MSG_CHECKING([whether to build the verbose instrumented variant])
 		AC_ARG_ENABLE(
 			[verbose-instrumentation],
@@ -72,6 +72,22 @@ AC_DEFUN([AC_CHECK_OVNI],
 			LIBS="${ac_save_LIBS}"
 		fi
 
+		AC_ARG_WITH(
+			[ovni-max-level],
+			[AS_HELP_STRING([--with-ovni-max-level=LEVEL], [compile out the ovni events above the given level @<:@default=3@:>@])],
+			[ac_ovni_max_level="${withval}"],
+			[ac_ovni_max_level="3"]
+		)
+
+		AC_MSG_CHECKING([the maximum level of the ovni events])
+		if ! test "${ac_ovni_max_level}" -ge 1 2> /dev/null ; then
+			AC_MSG_RESULT([invalid level])
+			AC_MSG_ERROR([the maximum level of the ovni events must be a positive number])
+		fi
+		AC_MSG_RESULT([${ac_ovni_max_level}])
+
+		AC_DEFINE_UNQUOTED([OVNI_MAX_LEVEL], [${ac_ovni_max_level}], [Define the maximum level of the ovni events that are compiled.])
+
 		AM_CONDITIONAL(HAVE_OVNI, test x"${ac_use_ovni}" = x"yes")
 
 		AC_SUBST([ovni_LIBS])
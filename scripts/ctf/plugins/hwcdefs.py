@@ -117,4 +117,19 @@ hardwareCountersDefinitions = [
     ("PAPI_VEC_SP"                          , 4100105, "PAPI_VEC_SP  [Single precision vector/SIMD instructions]"),
     ("PAPI_VEC_DP"                          , 4100106, "PAPI_VEC_DP  [Double precision vector/SIMD instructions]"),
     ("PAPI_REF_CYC"                         , 4100107, "PAPI_REF_CYC [Reference clock cycles]"),
+
+    # perf events
+    ("PERF_CPU_CYCLES"                      , 4200000, "PERF_CPU_CYCLES              [Total cycles]"),
+    ("PERF_INSTRUCTIONS"                    , 4200001, "PERF_INSTRUCTIONS            [Retired instructions]"),
+    ("PERF_CACHE_REFERENCES"                , 4200002, "PERF_CACHE_REFERENCES        [Last level cache accesses]"),
+    ("PERF_CACHE_MISSES"                    , 4200003, "PERF_CACHE_MISSES            [Last level cache misses]"),
+    ("PERF_BRANCH_INSTRUCTIONS"             , 4200004, "PERF_BRANCH_INSTRUCTIONS     [Retired branch instructions]"),
+    ("PERF_BRANCH_MISSES"                   , 4200005, "PERF_BRANCH_MISSES           [Mispredicted branch instructions]"),
+    ("PERF_STALLED_CYCLES_FRONTEND"         , 4200006, "PERF_STALLED_CYCLES_FRONTEND [Stalled cycles during issue]"),
+    ("PERF_STALLED_CYCLES_BACKEND"          , 4200007, "PERF_STALLED_CYCLES_BACKEND  [Stalled cycles during retirement]"),
+    ("PERF_REF_CPU_CYCLES"                  , 4200008, "PERF_REF_CPU_CYCLES          [Reference cycles]"),
+    ("PERF_TASK_CLOCK"                      , 4200009, "PERF_TASK_CLOCK              [Task clock in nanoseconds]"),
+    ("PERF_PAGE_FAULTS"                     , 4200010, "PERF_PAGE_FAULTS             [Page faults]"),
+    ("PERF_CONTEXT_SWITCHES"                , 4200011, "PERF_CONTEXT_SWITCHES        [Context switches]"),
+    ("PERF_CPU_MIGRATIONS"                  , 4200012, "PERF_CPU_MIGRATIONS          [CPU migrations]"),
 ]
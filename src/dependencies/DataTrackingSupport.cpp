@@ -4,6 +4,8 @@
 	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
 */
 
+#include <cassert>
+
 #include "DataTrackingSupport.hpp"
 #include "tasks/Task.hpp"
 
@@ -17,3 +19,32 @@ bool DataTrackingSupport::shouldEnableIS(Task *task)
 {
 	return (task->getDataAccesses().getTotalDataSize() <= _shouldEnableIS);
 }
+
+size_t DataTrackingSupport::computeReusedBytes(Task *predecessor, Task *successor)
+{
+	assert(predecessor != nullptr);
+	assert(successor != nullptr);
+
+	return successor->getDataAccesses().computeReusedBytes(predecessor->getDataAccesses());
+}
+
+bool DataTrackingSupport::shouldRunImmediateSuccessor(Task *successor, size_t reusedBytes, float alpha)
+{
+	assert(successor != nullptr);
+
+	if (alpha <= 0.0)
+		return false;
+
+	size_t totalDataSize = successor->getDataAccesses().getTotalDataSize();
+	if (totalDataSize == 0)
+		return true;
+
+	// The successor evicts the reused data if its footprint does not fit in the cache
+	if (totalDataSize > _shouldEnableIS)
+		return false;
+
+	// The RW bonus factor may give a locality score higher than one
+	double locality = (double) reusedBytes / (double) totalDataSize;
+
+	return (locality >= (1.0 - alpha));
+}
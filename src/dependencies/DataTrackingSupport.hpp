@@ -8,6 +8,7 @@
 #define DATA_TRACKING_SUPPORT_HPP
 
 #include "support/config/ConfigVariable.hpp"
+#include <cstddef>
 #include <cstdint>
 
 class Task;
@@ -45,6 +46,25 @@ public:
 
 	static bool shouldEnableIS(Task *task);
 
+	//! \brief Compute the data that a successor task reuses from the task that released it
+	//!
+	//! \param[in] predecessor The task that has just finished
+	//! \param[in] successor A successor that became ready when the predecessor finished
+	//!
+	//! \returns The reused bytes, weighted by the type of the successor's accesses
+	static size_t computeReusedBytes(Task *predecessor, Task *successor);
+
+	//! \brief Check whether a successor should run as the immediate successor of its predecessor
+	//!
+	//! The successor is only worth running in the same CPU if its data fits in the cache and
+	//! the fraction of its data that was accessed by the predecessor is high enough. Tasks
+	//! without tracked data have nothing to lose and are always accepted
+	//!
+	//! \param[in] successor The immediate successor candidate
+	//! \param[in] reusedBytes The bytes that the candidate reuses from its predecessor
+	//! \param[in] alpha The immediate successor aggressiveness in [0, 1]. Zero disables it
+	static bool shouldRunImmediateSuccessor(Task *successor, size_t reusedBytes, float alpha);
+
 	static inline void setShouldEnableIS(uint64_t ISThreshold)
 	{
 		_shouldEnableIS = ISThreshold;
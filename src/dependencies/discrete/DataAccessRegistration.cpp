@@ -73,27 +73,30 @@ namespace DataAccessRegistration {
 			if (list.size() == 0)
 				continue;
 
-			bool successorExists = (computePlace != nullptr && computePlace->getFirstSuccessor() != nullptr);
-			if (device == nanos6_host_device && !fromBusyThread && !successorExists) {
-				// Find the best immediate successor, which must be highest priority. On priority tie,
-				// grab the first one
-				Task::priority_t highest = std::numeric_limits<Task::priority_t>::min();
-				int candidate = -1;
-
-				Task **successors = list.getArray();
-
-				for (size_t s = 0; s < list.size(); ++s) {
-					if (successors[s]->getPriority() > highest) {
-						highest = successors[s]->getPriority();
-						candidate = (int) s;
+			if (device == nanos6_host_device && !fromBusyThread && computePlace != nullptr) {
+				// Keep the best immediate successor candidates, which must be the highest priority
+				// ones. On priority tie, grab the first one
+				while (computePlace->canAddSuccessorCandidate() && list.size() > 0) {
+					Task::priority_t highest = std::numeric_limits<Task::priority_t>::min();
+					int candidate = -1;
+
+					Task **successors = list.getArray();
+
+					for (size_t s = 0; s < list.size(); ++s) {
+						if (candidate < 0 || successors[s]->getPriority() > highest) {
+							highest = successors[s]->getPriority();
+							candidate = (int) s;
+						}
 					}
-				}
 
-				if (candidate >= 0) {
-					// Set the successor and remove from the list
-					computePlace->setFirstSuccessor(successors[candidate]);
+					// Set the candidate and remove from the list
+					assert(candidate >= 0);
+					computePlace->addSuccessorCandidate(successors[candidate]);
 					list.erase(candidate);
 				}
+
+				if (list.size() == 0)
+					continue;
 			}
 
 			Scheduler::addReadyTasks(
@@ -395,7 +398,7 @@ namespace DataAccessRegistration {
 	{
 		assert(task != nullptr);
 
-		Instrument::enterUnregisterTaskDataAcesses();
+		Instrument::enterUnregisterTaskDataAcesses(task->getInstrumentationTaskId());
 
 		TaskDataAccesses &accessStruct = task->getDataAccesses();
 		assert(!accessStruct.hasBeenDeleted());
@@ -470,7 +473,7 @@ namespace DataAccessRegistration {
 		}
 #endif
 
-		Instrument::exitUnregisterTaskDataAcesses();
+		Instrument::exitUnregisterTaskDataAcesses(task->getInstrumentationTaskId());
 	}
 
 	void handleEnterTaskwait(Task *task, ComputePlace *, CPUDependencyData &)
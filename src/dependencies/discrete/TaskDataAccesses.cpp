@@ -4,6 +4,8 @@
 	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
 */
 
+#include <algorithm>
+
 #include "TaskDataAccesses.hpp"
 #include "memory/numa/NUMAManager.hpp"
 #include "scheduling/SchedulerInterface.hpp"
@@ -61,3 +63,36 @@ uint64_t TaskDataAccesses::computeNUMAAffinity(ComputePlace *computePlace)
 
 	return chosen;
 }
+
+size_t TaskDataAccesses::computeReusedBytes(TaskDataAccesses const &predecessor)
+{
+	if (_totalDataSize == 0 || predecessor._totalDataSize == 0)
+		return 0;
+
+	size_t reusedBytes = 0;
+
+	forAll([&](void *address, const DataAccess *dataAccess) -> bool {
+		//! Weak accesses are not really read/written, so they do not reuse any data
+		if (dataAccess->isWeak())
+			return true;
+
+		// Discrete accesses only match on the same start address
+		const DataAccess *predecessorAccess = predecessor.findAccess(address);
+		if (predecessorAccess == nullptr || predecessorAccess->isWeak())
+			return true;
+
+		size_t length = std::min(dataAccess->getLength(), predecessorAccess->getLength());
+
+		// Apply a bonus factor to RW accesses, since both reading and writing benefit from the cache
+		DataAccessType type = dataAccess->getType();
+		bool rwAccess = (type != READ_ACCESS_TYPE) && (type != WRITE_ACCESS_TYPE);
+		if (rwAccess) {
+			reusedBytes += length * DataTrackingSupport::getRWBonusFactor();
+		} else {
+			reusedBytes += length;
+		}
+		return true;
+	});
+
+	return reusedBytes;
+}
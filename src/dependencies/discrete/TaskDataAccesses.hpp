@@ -225,6 +225,13 @@ struct TaskDataAccesses {
 	}
 
 	uint64_t computeNUMAAffinity(ComputePlace *computePlace);
+
+	//! \brief Compute the bytes of these accesses that were also accessed by another task
+	//!
+	//! \param[in] predecessor The accesses of the task that released these ones
+	//!
+	//! \returns The reused bytes, applying a bonus factor to RW accesses
+	size_t computeReusedBytes(TaskDataAccesses const &predecessor);
 };
 
 #endif // TASK_DATA_ACCESSES_HPP
@@ -12,6 +12,7 @@
 #include <deque>
 #include <iostream>
 #include <mutex>
+#include <utility>
 
 #include "BottomMapEntry.hpp"
 #include "CPUDependencyData.hpp"
@@ -1126,9 +1127,15 @@ namespace DataAccessRegistration {
 	{
 		processSatisfiedCommutativeOriginators(hpDependencyData);
 
-		Task *immediateSuccessor = nullptr;
-		bool searchForIS = (!fromBusyThread && computePlace != nullptr
-			&& computePlace->getFirstSuccessor() == nullptr);
+		bool searchForIS = (!fromBusyThread && computePlace != nullptr);
+
+		// Keep the highest priority host tasks as immediate successor candidates
+		Task *candidates[ComputePlace::MAX_SUCCESSOR_CANDIDATES];
+		size_t numCandidates = 0;
+		size_t maxCandidates = 0;
+		if (searchForIS) {
+			maxCandidates = ComputePlace::MAX_SUCCESSOR_CANDIDATES - computePlace->getNumSuccessorCandidates();
+		}
 
 		// NOTE: This is done without the lock held and may be slow since it can enter the scheduler
 		for (Task *task : hpDependencyData._satisfiedOriginators) {
@@ -1144,19 +1151,29 @@ namespace DataAccessRegistration {
 				schedulingHint = BUSY_COMPUTE_PLACE_TASK_HINT;
 			}
 
-			if (searchForIS && task->getDeviceType() == nanos6_host_device
-				&& (!immediateSuccessor || task->getPriority() > immediateSuccessor->getPriority())) {
-				if (immediateSuccessor)
-					Scheduler::addReadyTask(immediateSuccessor, computePlaceHint, schedulingHint);
+			if (maxCandidates > 0 && task->getDeviceType() == nanos6_host_device) {
+				if (numCandidates < maxCandidates) {
+					candidates[numCandidates++] = task;
+					continue;
+				}
+
+				// Replace the lowest priority candidate if this task has a higher priority
+				size_t lowest = 0;
+				for (size_t c = 1; c < numCandidates; ++c) {
+					if (candidates[c]->getPriority() < candidates[lowest]->getPriority())
+						lowest = c;
+				}
 
-				immediateSuccessor = task;
-			} else {
-				Scheduler::addReadyTask(task, computePlaceHint, schedulingHint);
+				if (task->getPriority() > candidates[lowest]->getPriority()) {
+					std::swap(task, candidates[lowest]);
+				}
 			}
+
+			Scheduler::addReadyTask(task, computePlaceHint, schedulingHint);
 		}
 
-		if (immediateSuccessor) {
-			computePlace->setFirstSuccessor(immediateSuccessor);
+		for (size_t c = 0; c < numCandidates; ++c) {
+			computePlace->addSuccessorCandidate(candidates[c]);
 		}
 
 		hpDependencyData._satisfiedOriginators.clear();
@@ -2475,6 +2492,11 @@ namespace DataAccessRegistration {
 				DataAccess *oldAccess = &(*position);
 				assert(oldAccess != nullptr);
 
+				// A weak access that becomes strong starts counting as task data
+				if (oldAccess->isWeak() && !weak) {
+					accessStructures.incrementTotalDataSize(oldAccess->getAccessRegion().getSize());
+				}
+
 				upgradeAccess(oldAccess, accessType, weak, reductionTypeAndOperatorIndex);
 				oldAccess->addToSymbols(symbol_list);
 
@@ -2485,6 +2507,10 @@ namespace DataAccessRegistration {
 					reductionTypeAndOperatorIndex, reductionIndex);
 				newAccess->addToSymbols(symbol_list);
 
+				if (!weak) {
+					accessStructures.incrementTotalDataSize(missingRegion.getSize());
+				}
+
 				accessStructures._accesses.insert(*newAccess);
 
 				return true;
@@ -2845,7 +2871,7 @@ namespace DataAccessRegistration {
 	{
 		assert(task != nullptr);
 
-		Instrument::enterUnregisterTaskDataAcesses();
+		Instrument::enterUnregisterTaskDataAcesses(task->getInstrumentationTaskId());
 
 		TaskDataAccesses &accessStructures = task->getDataAccesses();
 
@@ -2891,7 +2917,7 @@ namespace DataAccessRegistration {
 			assert(hpDependencyData._inUse.compare_exchange_strong(alreadyTaken, false));
 		}
 #endif
-		Instrument::exitUnregisterTaskDataAcesses();
+		Instrument::exitUnregisterTaskDataAcesses(task->getInstrumentationTaskId());
 	}
 
 	void propagateSatisfiability(Task *task, DataAccessRegion const &region,
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MULTIDIMENSIONAL_API_HPP
@@ -242,7 +242,7 @@ static _AI_ void register_reduction_access(
 		currentBaseAddress += currentDimStart * stride;
 		
 		for (long index = currentDimStart; index < currentDimEnd; index++) {
-			register_reduction_access<WEAK>(reduction_operation, reduction_index, handler, symbolIndex, regionText, baseAddress, otherDimensions...);
+			register_reduction_access<WEAK>(reduction_operation, reduction_index, handler, symbolIndex, regionText, currentBaseAddress, otherDimensions...);
 			currentBaseAddress += stride;
 		}
 	}
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <boost/intrusive/parent_from_member.hpp>
@@ -11,6 +11,7 @@
 #include "ObjectAllocator.hpp"
 #include "TaskDataAccesses.hpp"
 #include "TaskDataAccessLinkingArtifacts.hpp"
+#include "dependencies/DataTrackingSupport.hpp"
 #include "tasks/Task.hpp"
 
 TaskDataAccesses::~TaskDataAccesses()
@@ -54,3 +55,61 @@ TaskDataAccesses::~TaskDataAccesses()
 	hasBeenDeleted() = true;
 #endif
 }
+
+size_t TaskDataAccesses::computeReusedBytes(TaskDataAccesses &predecessor)
+{
+	if (_totalDataSize == 0 || predecessor._totalDataSize == 0)
+		return 0;
+
+	// The accesses of both tasks may be fragmented concurrently, so both locks
+	// are needed. The dependency system never nests the locks of two sibling
+	// tasks, so the predecessor lock is only tried to avoid a deadlock
+	while (true) {
+		_lock.lock();
+		if (predecessor._lock.tryLock())
+			break;
+		_lock.unlock();
+	}
+
+	size_t reusedBytes = 0;
+
+	_accesses.processAll(
+		[&](accesses_t::iterator position) -> bool {
+			DataAccess *dataAccess = &(*position);
+			assert(dataAccess != nullptr);
+
+			// Weak accesses are not really read/written, so they do not reuse any data
+			if (dataAccess->isWeak())
+				return true;
+
+			// Apply a bonus factor to RW accesses, since both reading and writing benefit from the cache
+			DataAccessType type = dataAccess->getType();
+			bool rwAccess = (type != READ_ACCESS_TYPE) && (type != WRITE_ACCESS_TYPE);
+
+			DataAccessRegion region = dataAccess->getAccessRegion();
+			predecessor._accesses.processIntersecting(
+				region,
+				[&](accesses_t::iterator predecessorPosition) -> bool {
+					DataAccess *predecessorAccess = &(*predecessorPosition);
+					assert(predecessorAccess != nullptr);
+
+					if (predecessorAccess->isWeak())
+						return true;
+
+					size_t length = region.intersect(predecessorAccess->getAccessRegion()).getSize();
+					if (rwAccess) {
+						reusedBytes += length * DataTrackingSupport::getRWBonusFactor();
+					} else {
+						reusedBytes += length;
+					}
+					return true;
+				});
+
+			return true;
+		});
+
+	predecessor._lock.unlock();
+	_lock.unlock();
+
+	return reusedBytes;
+}
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASK_DATA_ACCESSES_HPP
@@ -64,6 +64,9 @@ struct TaskDataAccesses {
 	int _liveTaskwaitFragmentCount;
 	size_t _totalCommutativeBytes;
 
+	//! Bytes of the strong accesses, set when the task registers them
+	size_t _totalDataSize;
+
 #ifndef NDEBUG
 	flags_t _flags;
 #endif
@@ -73,7 +76,8 @@ struct TaskDataAccesses {
 		_accesses(), _accessFragments(), _taskwaitFragments(),
 		_subaccessBottomMap(),
 		_removalBlockers(0), _liveTaskwaitFragmentCount(0),
-		_totalCommutativeBytes(0)
+		_totalCommutativeBytes(0),
+		_totalDataSize(0)
 #ifndef NDEBUG
 		,_flags()
 #endif
@@ -102,13 +106,26 @@ struct TaskDataAccesses {
 
 	inline size_t getTotalDataSize() const
 	{
-		return 0;
+		return _totalDataSize;
+	}
+
+	inline void incrementTotalDataSize(size_t size)
+	{
+		_totalDataSize += size;
 	}
 
 	uint64_t computeNUMAAffinity(ComputePlace *)
 	{
 		return (uint64_t) -1;
 	}
+
+	//! \brief Compute the bytes of the strong accesses that intersect with
+	//! the strong accesses of a predecessor
+	//!
+	//! \param[in] predecessor The accesses of the predecessor task
+	//!
+	//! \returns The reused bytes, applying the RW bonus factor
+	size_t computeReusedBytes(TaskDataAccesses &predecessor);
 };
 
 
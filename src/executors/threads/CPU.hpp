@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CPU_HPP
@@ -64,6 +64,9 @@ private:
 	size_t _systemCPUId;
 	size_t _NUMANodeId;
 
+	//! The physical package (socket) of the CPU
+	size_t _packageId;
+
 	//! The CPU mask so that we can later on migrate threads to this CPU
 	cpu_set_t _cpuMask;
 
@@ -101,6 +104,7 @@ public:
 		_activationStatus(uninitialized_status),
 		_systemCPUId((size_t) -1),
 		_NUMANodeId(0),
+		_packageId(0),
 		_hardwareCounters()
 	{
 	}
@@ -158,6 +162,16 @@ public:
 		return _systemCPUId;
 	}
 
+	size_t getPackageId() const
+	{
+		return _packageId;
+	}
+
+	void setPackageId(size_t packageId)
+	{
+		_packageId = packageId;
+	}
+
 	std::atomic<activation_status_t> &getActivationStatus()
 	{
 		return _activationStatus;
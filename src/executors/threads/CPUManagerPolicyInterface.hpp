@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CPU_MANAGER_POLICY_INTERFACE_HPP
@@ -19,6 +19,8 @@ enum CPUManagerPolicy {
 	IDLE_POLICY,
 	BUSY_POLICY,
 	HYBRID_POLICY,
+	PREDICTIVE_POLICY,
+	ENERGY_POLICY,
 	LEWI_POLICY,
 	GREEDY_POLICY
 };
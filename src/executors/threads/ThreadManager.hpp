@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef THREAD_MANAGER_HPP
@@ -19,6 +19,7 @@
 
 #include <hardware/HardwareInfo.hpp>
 #include "hardware/places/ComputePlace.hpp"
+#include "lowlevel/ParkingLot.hpp"
 #include "lowlevel/SpinLock.hpp"
 
 #include "CPU.hpp"
@@ -33,6 +34,9 @@ private:
 	struct IdleThreads {
 		SpinLock _lock;
 		std::deque<WorkerThread *> _threads;
+
+		//! The futex word on which the threads of the NUMA node park
+		ParkingLot _parkingLot;
 	};
 	struct ShutdownThreads {
 		SpinLock _lock;
@@ -89,6 +93,16 @@ public:
 	//! \returns the thread that has been resumed or nullptr
 	static inline WorkerThread *resumeIdle(CPU *idleCPU, bool inInitializationOrShutdown=false, bool doNotCreate=false);
 
+	//! \brief resume an idle thread on each of the given CPUs
+	//!
+	//! The threads parked in the same NUMA node are woken up with a single system call
+	//!
+	//! \param[in] idleCPUs the CPUs on which to resume idle threads
+	//! \param[in] numCPUs the number of CPUs in idleCPUs
+	//! \param[in] inInitializationOrShutdown true if it should not enforce assertions that are not valid during initialization and shutdown
+	//! \param[in] doNotCreate true to avoid creating additional threads in case that none is available
+	static inline void resumeIdle(CPU *const idleCPUs[], size_t numCPUs, bool inInitializationOrShutdown=false, bool doNotCreate=false);
+
 	static inline void resumeIdle(const std::vector<CPU *> &idleCPUs, bool inInitializationOrShutdown=false, bool doNotCreate=false);
 
 	static void addShutdownThread(WorkerThread *shutdownThread);
@@ -111,7 +125,7 @@ inline WorkerThread *ThreadManager::createWorkerThread(CPU *cpu)
 	// The runtime cannot be shutting down when creating a thread
 	assert(cpu->getActivationStatus() != CPU::shutting_down_status);
 
-	return new WorkerThread(cpu);
+	return new WorkerThread(cpu, &_idleThreads[cpu->getNumaNodeId()]._parkingLot);
 }
 
 
@@ -202,19 +216,29 @@ inline WorkerThread *ThreadManager::resumeIdle(CPU *idleCPU, bool inInitializati
 }
 
 
-inline void ThreadManager::resumeIdle(const std::vector<CPU *> &idleCPUs, bool inInitializationOrShutdown, bool doNotCreate)
+inline void ThreadManager::resumeIdle(CPU *const idleCPUs[], size_t numCPUs, bool inInitializationOrShutdown, bool doNotCreate)
 {
-	for (CPU *idleCPU : idleCPUs) {
+	// The wake-ups are issued when the batch goes out of scope
+	ParkingBatch batch;
+
+	for (size_t i = 0; i < numCPUs; ++i) {
+		CPU *idleCPU = idleCPUs[i];
 		assert(idleCPU != nullptr);
 
 		// Get an idle thread for the CPU
 		WorkerThread *idleThread = getIdleThread(idleCPU, doNotCreate);
 
 		if (idleThread != nullptr) {
-			idleThread->resume(idleCPU, inInitializationOrShutdown);
+			idleThread->resume(idleCPU, inInitializationOrShutdown, batch);
 		}
 	}
 }
 
 
+inline void ThreadManager::resumeIdle(const std::vector<CPU *> &idleCPUs, bool inInitializationOrShutdown, bool doNotCreate)
+{
+	resumeIdle(idleCPUs.data(), idleCPUs.size(), inInitializationOrShutdown, doNotCreate);
+}
+
+
 #endif // THREAD_MANAGER_HPP
@@ -19,11 +19,14 @@
 #include "TaskFinalizationImplementation.hpp"
 #include "ThreadManager.hpp"
 #include "WorkerThread.hpp"
+#include "dependencies/DataTrackingSupport.hpp"
 #include "dependencies/SymbolTranslation.hpp"
 #include "hardware/HardwareInfo.hpp"
 #include "hardware/device/AcceleratorStream.hpp"
 #include "lowlevel/TurboSettings.hpp"
 #include "scheduling/Scheduler.hpp"
+#include "scheduling/ready-queues/ReadyQueueCost.hpp"
+#include "system/ExternalEventsInbox.hpp"
 #include "system/If0Task.hpp"
 #include "system/TrackingPoints.hpp"
 #include "tasks/LoopGenerator.hpp"
@@ -32,6 +35,7 @@
 
 #include <DataAccessRegistration.hpp>
 #include <InstrumentInstrumentationContext.hpp>
+#include <InstrumentScheduler.hpp>
 #include <InstrumentThreadInstrumentationContext.hpp>
 #include <InstrumentWorkerThread.hpp>
 
@@ -114,26 +118,19 @@ void WorkerThread::body()
 		instrumentationContext.updateComputePlace(cpu->getInstrumentationId());
 		assert(_task == nullptr);
 
-		Task *immediateSuccessor = cpu->getFirstSuccessor();
-		if (immediateSuccessor) {
-			// Draw a random number between 0.0 and 1.0
-			float randomISValue = _ISDistribution(_ISGenerator);
-
-			// Can only execute Immediate Successor if we accept replacement and probability allows us
-			bool probabilityOfIS = (randomISValue < Scheduler::getImmediateSuccessorAlpha());
-			if (!probabilityOfIS) {
-				Scheduler::addReadyTask(
-					immediateSuccessor,
-					(immediateSuccessor->getDeviceType() == cpu->getType() ? cpu : nullptr),
-					SIBLING_TASK_HINT);
-			} else {
-				// Check if the task needs to execute an onReady handler
-				if (immediateSuccessor->handleOnready(this))
-					_task = immediateSuccessor;
+		// Complete the tasks whose events finished in external threads. They
+		// may leave successor candidates in the CPU
+		if (ExternalEventsInbox::hasPendingTasks())
+			ExternalEventsInbox::processPendingTasks(cpu);
 
-				// Otherwise, we have no IS and should just get a scheduler task
-			}
-			cpu->setFirstSuccessor(nullptr);
+		if (cpu->hasSuccessorCandidates()) {
+			Task *immediateSuccessor = selectImmediateSuccessor(cpu);
+
+			// Check if the task needs to execute an onReady handler
+			if (immediateSuccessor != nullptr && immediateSuccessor->handleOnready(this))
+				_task = immediateSuccessor;
+
+			// Otherwise, we have no IS and should just get a scheduler task
 		}
 
 		// No immediate successor, get a task
@@ -190,6 +187,65 @@ void WorkerThread::body()
 	ThreadManager::addShutdownThread(this);
 }
 
+Task *WorkerThread::selectImmediateSuccessor(CPU *cpu)
+{
+	assert(cpu != nullptr);
+	assert(cpu->hasSuccessorCandidates());
+
+	// Choose the highest priority candidate. On priority tie, choose the one
+	// that reuses more data from the task that released it. With the cost
+	// policy, the shortest predicted candidate is preferred on priority tie,
+	// so short tasks run right away while the long ones go to the queues,
+	// where they are served first
+	const bool costPolicy = (Scheduler::getSchedulingPolicy() == COST_POLICY);
+	size_t numCandidates = cpu->getNumSuccessorCandidates();
+	size_t best = 0;
+	for (size_t c = 1; c < numCandidates; ++c) {
+		Task *candidate = cpu->getSuccessorCandidate(c);
+		Task *bestCandidate = cpu->getSuccessorCandidate(best);
+		if (candidate->getPriority() != bestCandidate->getPriority()) {
+			if (candidate->getPriority() > bestCandidate->getPriority())
+				best = c;
+			continue;
+		}
+
+		if (costPolicy) {
+			double prediction = ReadyQueueCost::getPredictedTime(candidate);
+			double bestPrediction = ReadyQueueCost::getPredictedTime(bestCandidate);
+			if (prediction != bestPrediction) {
+				if (prediction < bestPrediction)
+					best = c;
+				continue;
+			}
+		}
+
+		if (cpu->getSuccessorReusedBytes(c) > cpu->getSuccessorReusedBytes(best))
+			best = c;
+	}
+
+	Task *immediateSuccessor = cpu->getSuccessorCandidate(best);
+	bool taken = DataTrackingSupport::shouldRunImmediateSuccessor(
+		immediateSuccessor, cpu->getSuccessorReusedBytes(best),
+		Scheduler::getImmediateSuccessorAlpha());
+
+	// The rest of candidates go back to the scheduler
+	for (size_t c = 0; c < numCandidates; ++c) {
+		if (c == best && taken)
+			continue;
+
+		Task *candidate = cpu->getSuccessorCandidate(c);
+		Scheduler::addReadyTask(
+			candidate,
+			(candidate->getDeviceType() == cpu->getType() ? cpu : nullptr),
+			SIBLING_TASK_HINT);
+	}
+	cpu->clearSuccessorCandidates();
+
+	Instrument::immediateSuccessorDecision(taken);
+
+	return (taken) ? immediateSuccessor : nullptr;
+}
+
 void WorkerThread::handleTask(CPU *cpu, bool)
 {
 	assert(_task != nullptr);
@@ -275,6 +331,13 @@ void WorkerThread::executeTask(CPU *cpu)
 			_task, cpu, cpu->getDependencyData()
 		);
 
+		// Score the immediate successor candidates while the task accesses are still alive
+		for (size_t c = 0; c < cpu->getNumSuccessorCandidates(); ++c) {
+			size_t reusedBytes = DataTrackingSupport::computeReusedBytes(_task, cpu->getSuccessorCandidate(c));
+			if (reusedBytes > cpu->getSuccessorReusedBytes(c))
+				cpu->setSuccessorReusedBytes(c, reusedBytes);
+		}
+
 		TaskFinalization::taskFinished(_task, cpu);
 		if (_task->markAsReleased()) {
 			TaskFinalization::disposeTask(_task);
@@ -8,7 +8,6 @@
 #define WORKER_THREAD_HPP
 
 #include <cstdint>
-#include <random>
 
 #include "DependencyDomain.hpp"
 #include "WorkerThreadBase.hpp"
@@ -44,25 +43,30 @@ private:
 
 	void initialize();
 	void handleTask(CPU *cpu, bool);
+
+	//! \brief Choose the immediate successor among the candidates of a CPU
+	//!
+	//! The candidates that are not chosen are sent back to the scheduler
+	//!
+	//! \returns The task to run as immediate successor or nullptr if none is worth it
+	Task *selectImmediateSuccessor(CPU *cpu);
 	void executeTask(CPU *cpu);
 
 	friend class ThreadManager;
 	friend class WorkerThreadRunner;
 	friend class Throttle;
 
-	//! Immediate successor probability generator
-	//! NOTE: Need one per WorkerThread as we want the distribution to act
-	//! in chain within each thread
-	std::default_random_engine _ISGenerator;
-	std::uniform_real_distribution<float> _ISDistribution;
-
 	//! Number of initialized WorkerThread
 	static std::atomic<uint64_t> _initializedThreads;
 
 public:
 	WorkerThread() = delete;
 
-	inline WorkerThread(CPU *cpu);
+	//! \brief create and start a worker thread
+	//!
+	//! \param[in] cpu the CPU on which the thread starts
+	//! \param[in] parkingLot the lot shared with the threads that are woken up together or nullptr
+	inline WorkerThread(CPU *cpu, ParkingLot *parkingLot = nullptr);
 
 	inline virtual ~WorkerThread();
 
@@ -18,11 +18,14 @@
 #include <InstrumentThreadManagement.hpp>
 
 
-inline WorkerThread::WorkerThread(CPU *cpu) :
+inline WorkerThread::WorkerThread(CPU *cpu, ParkingLot *parkingLot) :
 	WorkerThreadBase(cpu), _task(nullptr), _dependencyDomain(),
-	_instrumentationData(), _hwCounters(), _replacementCount(0), _ISDistribution(0.0, 1.0)
+	_instrumentationData(), _hwCounters(), _replacementCount(0)
 {
 	_originalNumaNode = cpu->getNumaNodeId();
+	if (parkingLot != nullptr) {
+		setParkingLot(parkingLot);
+	}
 	Instrument::enterThreadCreation(/* OUT */ _instrumentationId, cpu->getInstrumentationId());
 	WorkerThreadBase::start();
 	Instrument::exitThreadCreation(_instrumentationId);
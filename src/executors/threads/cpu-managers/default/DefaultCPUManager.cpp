@@ -8,8 +8,11 @@
 #include "DefaultCPUManager.hpp"
 #include "executors/threads/ThreadManager.hpp"
 #include "executors/threads/cpu-managers/default/policies/BusyPolicy.hpp"
+#include "executors/threads/cpu-managers/default/policies/EnergyPolicy.hpp"
 #include "executors/threads/cpu-managers/default/policies/HybridPolicy.hpp"
 #include "executors/threads/cpu-managers/default/policies/IdlePolicy.hpp"
+#include "executors/threads/cpu-managers/default/policies/PredictivePolicy.hpp"
+#include "monitoring/Monitoring.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/TrackingPoints.hpp"
 
@@ -47,6 +50,15 @@ void DefaultCPUManager::preinitialize()
 	} else if (policyValue == "hybrid" || policyValue == "default") {
 		_cpuManagerPolicy = new HybridPolicy(*this, numCPUs);
 		_policyId = HYBRID_POLICY;
+	} else if (policyValue == "predictive") {
+		_cpuManagerPolicy = new PredictivePolicy(*this, numCPUs);
+		_policyId = PREDICTIVE_POLICY;
+	} else if (policyValue == "energy") {
+		if (!Monitoring::isEnergyEnabled()) {
+			FatalErrorHandler::fail("The 'energy' CPU Manager Policy requires monitoring.energy");
+		}
+		_cpuManagerPolicy = new EnergyPolicy(*this, numCPUs);
+		_policyId = ENERGY_POLICY;
 	} else {
 		FatalErrorHandler::fail("Unexistent '", policyValue, "' CPU Manager Policy");
 	}
@@ -276,3 +288,45 @@ size_t DefaultCPUManager::getIdleCPUs(
 	return numObtainedCPUs;
 }
 
+
+size_t DefaultCPUManager::getIdleCPUsInPackages(
+	size_t numCPUs,
+	CPU *idleCPUs[],
+	size_t numPackages
+) {
+	size_t numObtainedCPUs = 0;
+
+	_idleCPUsLock.lock();
+
+	boost::dynamic_bitset<>::size_type id = _idleCPUs.find_first();
+	while (numObtainedCPUs < numCPUs && id != boost::dynamic_bitset<>::npos) {
+		CPU *cpu = _cpus[id];
+		assert(cpu != nullptr);
+
+		// Skip the CPUs of parked packages
+		if (cpu->getPackageId() < numPackages) {
+			// Mark the CPU as active
+			_idleCPUs[id] = false;
+
+			// Place the CPU in the vector
+			idleCPUs[numObtainedCPUs] = cpu;
+			++numObtainedCPUs;
+		}
+
+		// Iterate to the next idle CPU
+		id = _idleCPUs.find_next(id);
+	}
+
+	// Decrease the counter of idle CPUs by the obtained amount
+	assert(_numIdleCPUs >= numObtainedCPUs);
+	_numIdleCPUs -= numObtainedCPUs;
+
+	_idleCPUsLock.unlock();
+
+	for (size_t i = 0; i < numObtainedCPUs; ++i) {
+		// Runtime Tracking Point - A cpu becomes active
+		TrackingPoints::cpuBecomesActive(idleCPUs[i]);
+	}
+
+	return numObtainedCPUs;
+}
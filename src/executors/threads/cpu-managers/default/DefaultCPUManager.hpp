@@ -7,6 +7,8 @@
 #ifndef DEFAULT_CPU_MANAGER_HPP
 #define DEFAULT_CPU_MANAGER_HPP
 
+#include <atomic>
+
 #include "executors/threads/CPUManagerInterface.hpp"
 #include "lowlevel/MultiConditionVariable.hpp"
 #include "support/config/ConfigVariable.hpp"
@@ -22,8 +24,10 @@ private:
 	//! Spinlock to access idle CPUs
 	SpinLock _idleCPUsLock;
 
-	//! The current number of idle CPUs, kept atomic through idleCPUsLock
-	size_t _numIdleCPUs;
+	//! The current number of idle CPUs. It is only modified with the
+	//! idleCPUsLock held, along with the idle CPUs, but it can be read
+	//! without the lock
+	std::atomic<size_t> _numIdleCPUs;
 
 	//! The system ids of the CPUs in sponge mode. These CPUs are not used by
 	//! the runtime to reduce the system noise
@@ -157,6 +161,15 @@ public:
 	//! \return A CPU or nullptr
 	CPU *getIdleCPU();
 
+	//! \brief Get the current number of idle CPUs
+	//!
+	//! The value is read without taking the idle CPUs lock, so it may be
+	//! outdated by the time it is used
+	inline size_t getNumIdleCPUs() const
+	{
+		return _numIdleCPUs.load(std::memory_order_relaxed);
+	}
+
 	//! \brief Get a specific number of idle CPUs
 	//!
 	//! \param[in] numCPUs The amount of CPUs to retrieve
@@ -165,6 +178,17 @@ public:
 	//!
 	//! \return The number of idle CPUs obtained/valid references in the vector
 	size_t getIdleCPUs(size_t numCPUs, CPU *idleCPUs[]);
+
+	//! \brief Get a specific number of idle CPUs from the first packages
+	//!
+	//! \param[in] numCPUs The amount of CPUs to retrieve
+	//! \param[out] idleCPUs An array of at least size 'numCPUs' where the
+	//! retrieved idle CPUs will be placed
+	//! \param[in] numPackages Only CPUs whose package id is lower than this
+	//! value are retrieved
+	//!
+	//! \return The number of idle CPUs obtained/valid references in the vector
+	size_t getIdleCPUsInPackages(size_t numCPUs, CPU *idleCPUs[], size_t numPackages);
 };
 
 #endif // DEFAULT_CPU_MANAGER_HPP
@@ -0,0 +1,102 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "EnergyPolicy.hpp"
+#include "executors/threads/CPU.hpp"
+#include "executors/threads/ThreadManager.hpp"
+#include "monitoring/EnergyMonitor.hpp"
+#include "monitoring/Monitoring.hpp"
+
+#include <InstrumentWorkerThread.hpp>
+
+
+size_t EnergyPolicy::computeActivePackages(size_t target)
+{
+	EnergyMonitor *energyMonitor = Monitoring::getEnergyMonitor();
+	assert(energyMonitor != nullptr);
+
+	const size_t numPackages = energyMonitor->getNumPackages();
+	const double idlePower = energyMonitor->getIdlePower();
+	const double cpuPower = energyMonitor->getCPUPower();
+
+	// Estimate the energy of running the target on the first k packages. If
+	// the target does not fit, the work takes longer in proportion, and so
+	// does the energy consumed by the packages
+	size_t bestPackages = numPackages;
+	double bestEnergy = std::numeric_limits<double>::max();
+	size_t capacity = 0;
+	for (size_t k = 1; k <= numPackages; ++k) {
+		capacity += energyMonitor->getNumPackageCPUs(k - 1);
+		if (capacity == 0)
+			continue;
+
+		double slowdown = std::max(0.0, ((double) target / (double) capacity) - 1.0);
+		if (slowdown > _maxSlowdown.getValue())
+			continue;
+
+		double power = k * idlePower + std::min(target, capacity) * cpuPower;
+		double energy = power * (1.0 + slowdown);
+		if (energy < bestEnergy) {
+			bestEnergy = energy;
+			bestPackages = k;
+		}
+	}
+
+	return bestPackages;
+}
+
+void EnergyPolicy::execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t numRequested)
+{
+	// NOTE: This policy works as follows:
+	// - If the hint is IDLE_CANDIDATE, we idle the current CPU right away
+	//   if its package is parked. Otherwise, we follow the predictive policy
+	// - If the hint is REQUEST_CPUS, we wake up CPUs to reach the target as
+	//   the predictive policy does, but only from the active packages
+	if (Monitoring::getEnergyMonitor() == nullptr) {
+		// Monitoring is not initialized yet
+		PredictivePolicy::execute(cpu, hint, numRequested);
+		return;
+	}
+
+	size_t target = computeActiveCPUsTarget();
+	size_t numActivePackages = computeActivePackages(target);
+	size_t numActiveCPUs = _numCPUs - _cpuManager.getNumIdleCPUs();
+
+	if (hint == IDLE_CANDIDATE) {
+		assert(cpu != nullptr);
+
+		if (((CPU *) cpu)->getPackageId() < numActivePackages && numActiveCPUs <= target) {
+			Instrument::workerThreadBusyWaits();
+			return;
+		}
+
+		IdlePolicy::execute(cpu, hint);
+	} else { // hint == REQUEST_CPUS
+		assert(numRequested > 0);
+
+		if (target > numActiveCPUs)
+			numRequested = std::max(numRequested, target - numActiveCPUs);
+
+		size_t numCPUsToObtain = std::min(_numCPUs, numRequested);
+		CPU *idleCPUs[numCPUsToObtain];
+
+		size_t numCPUsObtained = _cpuManager.getIdleCPUsInPackages(
+			numCPUsToObtain,
+			idleCPUs,
+			numActivePackages
+		);
+
+		// Never leave the runtime without active CPUs
+		if (numCPUsObtained == 0 && numActiveCPUs == 0) {
+			numCPUsObtained = _cpuManager.getIdleCPUs(numCPUsToObtain, idleCPUs);
+		}
+
+		ThreadManager::resumeIdle(idleCPUs, numCPUsObtained);
+	}
+}
@@ -0,0 +1,51 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef ENERGY_POLICY_HPP
+#define ENERGY_POLICY_HPP
+
+#include "PredictivePolicy.hpp"
+#include "executors/threads/CPUManagerPolicyInterface.hpp"
+#include "executors/threads/cpu-managers/default/DefaultCPUManager.hpp"
+#include "hardware/places/ComputePlace.hpp"
+#include "support/config/ConfigVariable.hpp"
+
+
+//! \brief A predictive policy that concentrates the work in few packages
+//!
+//! The target of active CPUs is computed as in the predictive policy. Then,
+//! the policy chooses the number of packages that minimizes the estimated
+//! energy to run the target, as long as the estimated slowdown of serving
+//! the target with fewer CPUs does not exceed the configured maximum. CPUs
+//! of the remaining packages are idled as soon as they run out of work and
+//! are not woken up, so that these packages can reach deep sleep states
+class EnergyPolicy : public PredictivePolicy {
+private:
+	//! The maximum slowdown accepted to save energy (e.g., 0.1 is 10%)
+	ConfigVariable<float> _maxSlowdown;
+
+	//! \brief Compute the number of packages that should have active CPUs
+	//!
+	//! \param[in] target The number of CPUs that should be active
+	//!
+	//! \return The number of packages, which are always the first ones
+	size_t computeActivePackages(size_t target);
+
+public:
+	inline EnergyPolicy(DefaultCPUManager &cpuManager, size_t numCPUs) :
+		PredictivePolicy(cpuManager, numCPUs),
+		_maxSlowdown("cpumanager.energy_max_slowdown")
+	{
+	}
+
+	void execute(
+		ComputePlace *cpu,
+		CPUManagerPolicyHint hint,
+		size_t numRequested = 0
+	) override;
+};
+
+#endif // ENERGY_POLICY_HPP
@@ -41,10 +41,8 @@ void IdlePolicy::execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t nu
 			idleCPUs
 		);
 
-		// Resume an idle thread for every idle CPU that has awakened
-		for (size_t i = 0; i < numCPUsObtained; ++i) {
-			assert(idleCPUs[i] != nullptr);
-			ThreadManager::resumeIdle(idleCPUs[i]);
-		}
+		// Resume an idle thread for every idle CPU that has awakened. The
+		// threads are woken up in a batch, one system call per NUMA node
+		ThreadManager::resumeIdle(idleCPUs, numCPUsObtained);
 	}
 }
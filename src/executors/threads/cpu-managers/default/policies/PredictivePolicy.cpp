@@ -0,0 +1,69 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+
+#include "PredictivePolicy.hpp"
+#include "executors/threads/ThreadManager.hpp"
+#include "monitoring/Monitoring.hpp"
+#include "scheduling/Scheduler.hpp"
+#include "support/Chrono.hpp"
+
+#include <InstrumentWorkerThread.hpp>
+
+
+size_t PredictivePolicy::computeActiveCPUsTarget() const
+{
+	// The CPU serving tasks plus one CPU per ready task
+	size_t target = Scheduler::getNumReadyTasks() + 1;
+
+	if (Monitoring::isEnabled()) {
+		// Computing a prediction traverses all tasktypes, so only a single
+		// CPU refreshes it once per prediction period
+		size_t now = Chrono::now<size_t>();
+		size_t lastPrediction = _lastPredictionTime.load(std::memory_order_relaxed);
+		if (now - lastPrediction >= _predictionRate.getValue()
+			&& _lastPredictionTime.compare_exchange_strong(lastPrediction, now, std::memory_order_relaxed)
+		) {
+			_predictedCPUUsage.store(
+				Monitoring::getPredictedCPUUsage(_predictionRate.getValue()),
+				std::memory_order_relaxed);
+		}
+
+		target = std::max(target, _predictedCPUUsage.load(std::memory_order_relaxed));
+	}
+
+	return std::min(target, _numCPUs);
+}
+
+void PredictivePolicy::execute(ComputePlace *cpu, CPUManagerPolicyHint hint, size_t numRequested)
+{
+	// NOTE: This policy works as follows:
+	// - If the hint is IDLE_CANDIDATE, we idle the current CPU if there
+	//   are more active CPUs than the target. Otherwise, it keeps spinning
+	// - If the hint is REQUEST_CPUS, we wake up at once as many idle CPUs
+	//   as needed to reach the target, and at least the requested number
+	size_t target = computeActiveCPUsTarget();
+	size_t numActiveCPUs = _numCPUs - _cpuManager.getNumIdleCPUs();
+
+	if (hint == IDLE_CANDIDATE) {
+		assert(cpu != nullptr);
+
+		if (numActiveCPUs <= target) {
+			Instrument::workerThreadBusyWaits();
+			return;
+		}
+
+		IdlePolicy::execute(cpu, hint);
+	} else { // hint == REQUEST_CPUS
+		assert(numRequested > 0);
+
+		if (target > numActiveCPUs)
+			numRequested = std::max(numRequested, target - numActiveCPUs);
+
+		IdlePolicy::execute(cpu, hint, numRequested);
+	}
+}
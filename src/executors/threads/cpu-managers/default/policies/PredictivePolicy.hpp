@@ -0,0 +1,77 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PREDICTIVE_POLICY_HPP
+#define PREDICTIVE_POLICY_HPP
+
+#include <atomic>
+
+#include "IdlePolicy.hpp"
+#include "executors/threads/CPUManagerPolicyInterface.hpp"
+#include "executors/threads/cpu-managers/default/DefaultCPUManager.hpp"
+#include "hardware/places/ComputePlace.hpp"
+#include "support/config/ConfigVariable.hpp"
+
+
+//! \brief A policy that keeps a target of active CPUs
+//!
+//! The target is computed from the backlog of ready tasks in the scheduler
+//! and, when Monitoring is enabled, from its CPU usage predictions. CPUs are
+//! woken up in batches to reach the target as soon as work appears, and CPUs
+//! above the target are idled as soon as they run out of work, instead of
+//! spinning for a fixed amount of iterations
+class PredictivePolicy : public IdlePolicy {
+private:
+	//! The maximum number of iterations to wait before assigning a null task.
+	//! This variable refers to the sum of iterations for all CPUs, thus to
+	//! obtain the number per CPU it must be divided by _numCPUs
+	ConfigVariable<size_t> _numBusyIters;
+
+	//! The period in microseconds between CPU usage predictions
+	ConfigVariable<size_t> _predictionRate;
+
+	//! The last CPU usage prediction from Monitoring
+	mutable std::atomic<size_t> _predictedCPUUsage;
+
+	//! The timestamp in microseconds of the last CPU usage prediction
+	mutable std::atomic<size_t> _lastPredictionTime;
+
+protected:
+	//! \brief Compute the number of CPUs that should be active
+	//!
+	//! \return A number of CPUs in the range [1, _numCPUs]
+	size_t computeActiveCPUsTarget() const;
+
+public:
+	inline PredictivePolicy(DefaultCPUManager &cpuManager, size_t numCPUs) :
+		IdlePolicy(cpuManager, numCPUs),
+		_numBusyIters("cpumanager.busy_iters"),
+		_predictionRate("monitoring.cpuusage_prediction_rate"),
+		_predictedCPUUsage(0),
+		_lastPredictionTime(0)
+	{
+	}
+
+	void execute(
+		ComputePlace *cpu,
+		CPUManagerPolicyHint hint,
+		size_t numRequested = 0
+	) override;
+
+	inline size_t getMaxBusyIterations() const override
+	{
+		// There are more active CPUs than needed, so do not let the waiting
+		// CPU spin. It will get no task and idle right away
+		size_t numActiveCPUs = _numCPUs - _cpuManager.getNumIdleCPUs();
+		if (numActiveCPUs > computeActiveCPUsTarget())
+			return 0;
+
+		// Otherwise, spin as the hybrid policy does
+		return ((size_t) (_numBusyIters.getValue() / _numCPUs));
+	}
+};
+
+#endif // PREDICTIVE_POLICY_HPP
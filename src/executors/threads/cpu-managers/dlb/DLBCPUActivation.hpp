@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef DLB_CPU_ACTIVATION_HPP
@@ -16,6 +16,7 @@
 #include "executors/threads/CPUManager.hpp"
 #include "executors/threads/ThreadManager.hpp"
 #include "executors/threads/WorkerThread.hpp"
+#include "monitoring/Monitoring.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/TrackingPoints.hpp"
 
@@ -252,6 +253,11 @@ public:
 						// callback, but as the status is lending, that callback will
 						// loop until the new status is enabling and then do nothing,
 						// thus it is safe to keep executing with the current thread
+						// The enabling transition notifies that the CPU becomes active
+						// again, so monitoring must see the CPU stop too. The thread
+						// does not suspend, so there are no instrumentation events
+						Monitoring::cpuBecomesIdle(cpu->getIndex());
+
 						expectedStatus = CPU::lending_status;
 						successfulStatus = cpu->getActivationStatus().compare_exchange_strong(expectedStatus, CPU::enabling_status);
 						assert(successfulStatus);
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef WORKER_THREAD_BASE_HPP
@@ -21,6 +21,7 @@
 #include "executors/threads/CPU.hpp"
 #include "hardware-counters/HardwareCounters.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/ParkingLot.hpp"
 #include "lowlevel/threads/KernelLevelThread.hpp"
 #include "support/InstrumentedThread.hpp"
 
@@ -57,6 +58,9 @@ protected:
 		KernelLevelThread::start(_cpu->getPthreadAttr());
 	}
 
+	//! \brief set the CPU on which the thread will run after resuming and bind it there
+	inline void prepareResume(CPU *cpu, bool inInitializationOrShutdown);
+
 
 public:
 	inline WorkerThreadBase(CPU *cpu);
@@ -72,6 +76,13 @@ public:
 	//! \param[in] inInitializationOrShutdown true if it should not enforce assertions that are not valid during initialization and shutdown
 	inline void resume(CPU *cpu, bool inInitializationOrShutdown);
 
+	//! \brief resume the thread on a given CPU, deferring the wake-up to a batch
+	//!
+	//! \param[in] cpu the CPU on which to resume the thread
+	//! \param[in] inInitializationOrShutdown true if it should not enforce assertions that are not valid during initialization and shutdown
+	//! \param[in,out] batch the batch that issues the wake-ups once it is flushed
+	inline void resume(CPU *cpu, bool inInitializationOrShutdown, ParkingBatch &batch);
+
 	//! \brief suspend the currently running thread and replace it by another (if given)
 	//!
 	//! \param[in] replacement a thread that is currently suspended and that must take the place of the current thread or nullptr
@@ -132,10 +143,8 @@ void WorkerThreadBase::suspend()
 }
 
 
-void WorkerThreadBase::resume(CPU *cpu, bool inInitializationOrShutdown)
+void WorkerThreadBase::prepareResume(CPU *cpu, bool inInitializationOrShutdown)
 {
-	Instrument::enterResume();
-
 	assert(cpu != nullptr);
 
 	if (!inInitializationOrShutdown) {
@@ -152,6 +161,14 @@ void WorkerThreadBase::resume(CPU *cpu, bool inInitializationOrShutdown)
 	if (!inInitializationOrShutdown) {
 		assert(KernelLevelThread::getCurrentKernelLevelThread() != this);
 	}
+}
+
+
+void WorkerThreadBase::resume(CPU *cpu, bool inInitializationOrShutdown)
+{
+	Instrument::enterResume();
+
+	prepareResume(cpu, inInitializationOrShutdown);
 
 	// Resume it
 	KernelLevelThread::resume();
@@ -160,6 +177,19 @@ void WorkerThreadBase::resume(CPU *cpu, bool inInitializationOrShutdown)
 }
 
 
+void WorkerThreadBase::resume(CPU *cpu, bool inInitializationOrShutdown, ParkingBatch &batch)
+{
+	Instrument::enterResume();
+
+	prepareResume(cpu, inInitializationOrShutdown);
+
+	// Resume it once the batch is flushed
+	KernelLevelThread::resume(batch);
+
+	Instrument::exitResume();
+}
+
+
 void WorkerThreadBase::switchTo(WorkerThreadBase *replacement)
 {
 	Instrument::enterSwitchTo();
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CPU_HARDWARE_COUNTERS_HPP
@@ -10,6 +10,7 @@
 #include "CPUHardwareCountersInterface.hpp"
 #include "HardwareCounters.hpp"
 #include "SupportedHardwareCounters.hpp"
+#include "hardware-counters/perf/PerfCPUHardwareCounters.hpp"
 
 #if HAVE_PAPI
 #include "hardware-counters/papi/PAPICPUHardwareCounters.hpp"
@@ -30,11 +31,15 @@ private:
 	//! CPU-related hardware counters for the PQoS backend
 	CPUHardwareCountersInterface *_pqosCounters;
 
+	//! CPU-related hardware counters for the perf backend
+	CPUHardwareCountersInterface *_perfCounters;
+
 public:
 
 	inline CPUHardwareCounters() :
 		_papiCounters(nullptr),
-		_pqosCounters(nullptr)
+		_pqosCounters(nullptr),
+		_perfCounters(nullptr)
 	{
 #if HAVE_PAPI
 		if (HardwareCounters::isBackendEnabled(HWCounters::PAPI_BACKEND)) {
@@ -47,6 +52,10 @@ public:
 			_pqosCounters = new PQoSCPUHardwareCounters();
 		}
 #endif
+
+		if (HardwareCounters::isBackendEnabled(HWCounters::PERF_BACKEND)) {
+			_perfCounters = new PerfCPUHardwareCounters();
+		}
 	}
 
 
@@ -59,6 +68,10 @@ public:
 		if (_pqosCounters != nullptr) {
 			delete _pqosCounters;
 		}
+
+		if (_perfCounters != nullptr) {
+			delete _perfCounters;
+		}
 	}
 
 	//! \brief Return the PAPI counters of the CPU (if it is enabled) or nullptr
@@ -73,6 +86,12 @@ public:
 		return _pqosCounters;
 	}
 
+	//! \brief Return the perf counters of the CPU (if it is enabled) or nullptr
+	inline CPUHardwareCountersInterface *getPerfCounters() const
+	{
+		return _perfCounters;
+	}
+
 	//! \brief Get the delta value of a HW counter
 	//!
 	//! \param[in] counterType The type of counter to get the delta from
@@ -83,6 +102,8 @@ public:
 			cpuCounters = getPQoSCounters();
 		} else if (counterType >= HWCounters::HWC_PAPI_MIN_EVENT && counterType <= HWCounters::HWC_PAPI_MAX_EVENT) {
 			cpuCounters = getPAPICounters();
+		} else if (counterType >= HWCounters::HWC_PERF_MIN_EVENT && counterType <= HWCounters::HWC_PERF_MAX_EVENT) {
+			cpuCounters = getPerfCounters();
 		}
 		assert(cpuCounters != nullptr);
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "CPUHardwareCounters.hpp"
@@ -10,6 +10,7 @@
 #include "ThreadHardwareCounters.hpp"
 #include "executors/threads/CPUManager.hpp"
 #include "executors/threads/WorkerThread.hpp"
+#include "hardware-counters/perf/PerfHardwareCounters.hpp"
 #include "hardware-counters/rapl/RAPLHardwareCounters.hpp"
 #include "tasks/Task.hpp"
 
@@ -27,6 +28,7 @@ ConfigVariable<std::string> HardwareCounters::_verboseFile("hardware_counters.ve
 HardwareCountersInterface *HardwareCounters::_papiBackend(nullptr);
 HardwareCountersInterface *HardwareCounters::_pqosBackend(nullptr);
 HardwareCountersInterface *HardwareCounters::_raplBackend(nullptr);
+HardwareCountersInterface *HardwareCounters::_perfBackend(nullptr);
 bool HardwareCounters::_anyBackendEnabled(false);
 std::vector<bool> HardwareCounters::_enabled(HWCounters::NUM_BACKENDS, false);
 std::vector<HWCounters::counters_t> HardwareCounters::_enabledCounters;
@@ -36,6 +38,7 @@ size_t HardwareCounters::_numEnabledCounters;
 void HardwareCounters::loadConfiguration()
 {
 	ConfigVariable<bool> papiEnabled("hardware_counters.papi.enabled");
+	ConfigVariable<bool> perfEnabled("hardware_counters.perf.enabled");
 	ConfigVariable<bool> pqosEnabled("hardware_counters.pqos.enabled");
 	ConfigVariable<bool> raplEnabled("hardware_counters.rapl.enabled");
 
@@ -75,11 +78,30 @@ void HardwareCounters::loadConfiguration()
 		}
 	}
 
+	// Check which perf events are enabled in the config file
+	if (perfEnabled) {
+		bool perfCounterAdded = false;
+		ConfigVariableSet<std::string> counterSet("hardware_counters.perf.counters");
+		for (short i = HWCounters::HWC_PERF_MIN_EVENT; i <= HWCounters::HWC_PERF_MAX_EVENT; ++i) {
+			std::string eventDescription(HWCounters::counterDescriptions[i]);
+			if (counterSet.contains(eventDescription)) {
+				_enabledCounters.push_back((HWCounters::counters_t) i);
+				perfCounterAdded = true;
+			}
+		}
+
+		_enabled[HWCounters::PERF_BACKEND] = perfCounterAdded;
+		if (!perfCounterAdded) {
+			FatalErrorHandler::warn("perf enabled but no counters are enabled in the config file, disabling this backend");
+		}
+	}
+
 	_enabled[HWCounters::RAPL_BACKEND] = raplEnabled;
 
 	_anyBackendEnabled =
 		_enabled[HWCounters::PQOS_BACKEND] ||
 		_enabled[HWCounters::PAPI_BACKEND] ||
+		_enabled[HWCounters::PERF_BACKEND] ||
 		_enabled[HWCounters::RAPL_BACKEND];
 }
 
@@ -123,6 +145,14 @@ void HardwareCounters::preinitialize()
 #endif
 	}
 
+	if (_enabled[HWCounters::PERF_BACKEND]) {
+		_perfBackend = new PerfHardwareCounters(
+			_verbose.getValue(),
+			_verboseFile.getValue(),
+			_enabledCounters
+		);
+	}
+
 	// NOTE: Since the RAPL backend needs to be initialized after hardware is
 	// detected, we do that in the initialize function
 
@@ -143,6 +173,14 @@ void HardwareCounters::initialize()
 	}
 }
 
+RAPLHardwareCounters *HardwareCounters::getRAPLBackend()
+{
+	if (!_enabled[HWCounters::RAPL_BACKEND])
+		return nullptr;
+
+	return (RAPLHardwareCounters *) _raplBackend;
+}
+
 void HardwareCounters::shutdown()
 {
 	if (_enabled[HWCounters::PAPI_BACKEND]) {
@@ -161,6 +199,14 @@ void HardwareCounters::shutdown()
 		_enabled[HWCounters::PQOS_BACKEND] = false;
 	}
 
+	if (_enabled[HWCounters::PERF_BACKEND]) {
+		assert(_perfBackend != nullptr);
+
+		delete _perfBackend;
+		_perfBackend = nullptr;
+		_enabled[HWCounters::PERF_BACKEND] = false;
+	}
+
 	if (_enabled[HWCounters::RAPL_BACKEND]) {
 		assert(_raplBackend != nullptr);
 
@@ -191,6 +237,12 @@ void HardwareCounters::threadInitialized()
 
 		_pqosBackend->threadInitialized(threadCounters.getPQoSCounters());
 	}
+
+	if (_enabled[HWCounters::PERF_BACKEND]) {
+		assert(_perfBackend != nullptr);
+
+		_perfBackend->threadInitialized(threadCounters.getPerfCounters());
+	}
 }
 
 void HardwareCounters::threadShutdown()
@@ -210,6 +262,12 @@ void HardwareCounters::threadShutdown()
 
 		_pqosBackend->threadShutdown(threadCounters.getPQoSCounters());
 	}
+
+	if (_enabled[HWCounters::PERF_BACKEND]) {
+		assert(_perfBackend != nullptr);
+
+		_perfBackend->threadShutdown(threadCounters.getPerfCounters());
+	}
 }
 
 void HardwareCounters::taskCreated(Task *task, bool enabled)
@@ -260,6 +318,15 @@ void HardwareCounters::updateTaskCounters(Task *task)
 				taskCounters.getPQoSCounters()
 			);
 		}
+
+		if (_enabled[HWCounters::PERF_BACKEND]) {
+			assert(_perfBackend != nullptr);
+
+			_perfBackend->updateTaskCounters(
+				threadCounters.getPerfCounters(),
+				taskCounters.getPerfCounters()
+			);
+		}
 	}
 }
 
@@ -291,5 +358,14 @@ void HardwareCounters::updateRuntimeCounters()
 				threadCounters.getPQoSCounters()
 			);
 		}
+
+		if (_enabled[HWCounters::PERF_BACKEND]) {
+			assert(_perfBackend != nullptr);
+
+			_perfBackend->updateRuntimeCounters(
+				cpuCounters.getPerfCounters(),
+				threadCounters.getPerfCounters()
+			);
+		}
 	}
 }
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef HARDWARE_COUNTERS_HPP
@@ -15,6 +15,7 @@
 #include "support/config/ConfigVariable.hpp"
 
 
+class RAPLHardwareCounters;
 class Task;
 
 class HardwareCounters {
@@ -36,6 +37,9 @@ private:
 	//! The underlying RAPL backend
 	static HardwareCountersInterface *_raplBackend;
 
+	//! The underlying perf_event backend
+	static HardwareCountersInterface *_perfBackend;
+
 	//! Whether there is at least one enabled backend
 	static bool _anyBackendEnabled;
 
@@ -60,6 +64,11 @@ private:
 			FatalErrorHandler::fail("PAPI and PQoS are incompatible hardware counter libraries");
 		}
 
+		// Both backends are built on top of the same kernel counters
+		if (_enabled[HWCounters::PAPI_BACKEND] && _enabled[HWCounters::PERF_BACKEND]) {
+			FatalErrorHandler::fail("PAPI and perf are incompatible hardware counter backends");
+		}
+
 		// If extrae is enabled, disable PAPI to avoid hardware counters collisions
 #ifdef EXTRAE_ENABLED
 		if (_enabled[HWCounters::PAPI_BACKEND]) {
@@ -106,6 +115,11 @@ public:
 		return _numEnabledCounters;
 	}
 
+	//! \brief Get the RAPL backend to read the energy of packages
+	//!
+	//! \return The RAPL backend or nullptr if it is not enabled
+	static RAPLHardwareCounters *getRAPLBackend();
+
 	//! \brief Initialize hardware counter structures for a new thread
 	static void threadInitialized();
 
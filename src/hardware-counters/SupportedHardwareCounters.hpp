@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef SUPPORTED_HARDWARE_COUNTERS_HPP
@@ -16,6 +16,7 @@ namespace HWCounters {
 		PAPI_BACKEND = 0,
 		PQOS_BACKEND,
 		RAPL_BACKEND,
+		PERF_BACKEND,
 		NUM_BACKENDS
 	};
 
@@ -161,8 +162,25 @@ namespace HWCounters {
 		HWC_PAPI_REF_CYC,                     // PAPI: Reference clock cycles
 		HWC_PAPI_MAX_EVENT = HWC_PAPI_REF_CYC,
 		HWC_PAPI_NUM_EVENTS = HWC_PAPI_MAX_EVENT - HWC_PAPI_MIN_EVENT + 1,
+		//    PERF EVENTS    //
+		HWC_PERF_MIN_EVENT = 300,                                  // PERF: Minimum event id
+		HWC_PERF_CPU_CYCLES = HWC_PERF_MIN_EVENT,                  // PERF: Total cycles
+		HWC_PERF_INSTRUCTIONS,                                     // PERF: Retired instructions
+		HWC_PERF_CACHE_REFERENCES,                                 // PERF: Last level cache accesses
+		HWC_PERF_CACHE_MISSES,                                     // PERF: Last level cache misses
+		HWC_PERF_BRANCH_INSTRUCTIONS,                              // PERF: Retired branch instructions
+		HWC_PERF_BRANCH_MISSES,                                    // PERF: Mispredicted branch instructions
+		HWC_PERF_STALLED_CYCLES_FRONTEND,                          // PERF: Stalled cycles during issue
+		HWC_PERF_STALLED_CYCLES_BACKEND,                           // PERF: Stalled cycles during retirement
+		HWC_PERF_REF_CPU_CYCLES,                                   // PERF: Reference cycles
+		HWC_PERF_TASK_CLOCK,                                       // PERF: Task clock in nanoseconds (software)
+		HWC_PERF_PAGE_FAULTS,                                      // PERF: Page faults (software)
+		HWC_PERF_CONTEXT_SWITCHES,                                 // PERF: Context switches (software)
+		HWC_PERF_CPU_MIGRATIONS,                                   // PERF: CPU migrations (software)
+		HWC_PERF_MAX_EVENT = HWC_PERF_CPU_MIGRATIONS,              // PERF: Maximum event id
+		HWC_PERF_NUM_EVENTS = HWC_PERF_MAX_EVENT - HWC_PERF_MIN_EVENT + 1,
 		//    GENERAL    //
-		HWC_TOTAL_NUM_EVENTS = HWC_PQOS_NUM_EVENTS + HWC_PAPI_NUM_EVENTS
+		HWC_TOTAL_NUM_EVENTS = HWC_PQOS_NUM_EVENTS + HWC_PAPI_NUM_EVENTS + HWC_PERF_NUM_EVENTS
 	};
 
 	static std::map<uint64_t, const char* const> counterDescriptions = {
@@ -279,7 +297,20 @@ namespace HWCounters {
 		{HWC_PAPI_DP_OPS                  , "PAPI_DP_OPS"},
 		{HWC_PAPI_VEC_SP                  , "PAPI_VEC_SP"},
 		{HWC_PAPI_VEC_DP                  , "PAPI_VEC_DP"},
-		{HWC_PAPI_REF_CYC                 , "PAPI_REF_CYC"}
+		{HWC_PAPI_REF_CYC                 , "PAPI_REF_CYC"},
+		{HWC_PERF_CPU_CYCLES              , "PERF_CPU_CYCLES"},
+		{HWC_PERF_INSTRUCTIONS            , "PERF_INSTRUCTIONS"},
+		{HWC_PERF_CACHE_REFERENCES        , "PERF_CACHE_REFERENCES"},
+		{HWC_PERF_CACHE_MISSES            , "PERF_CACHE_MISSES"},
+		{HWC_PERF_BRANCH_INSTRUCTIONS     , "PERF_BRANCH_INSTRUCTIONS"},
+		{HWC_PERF_BRANCH_MISSES           , "PERF_BRANCH_MISSES"},
+		{HWC_PERF_STALLED_CYCLES_FRONTEND , "PERF_STALLED_CYCLES_FRONTEND"},
+		{HWC_PERF_STALLED_CYCLES_BACKEND  , "PERF_STALLED_CYCLES_BACKEND"},
+		{HWC_PERF_REF_CPU_CYCLES          , "PERF_REF_CPU_CYCLES"},
+		{HWC_PERF_TASK_CLOCK              , "PERF_TASK_CLOCK"},
+		{HWC_PERF_PAGE_FAULTS             , "PERF_PAGE_FAULTS"},
+		{HWC_PERF_CONTEXT_SWITCHES        , "PERF_CONTEXT_SWITCHES"},
+		{HWC_PERF_CPU_MIGRATIONS          , "PERF_CPU_MIGRATIONS"}
 	};
 }
 
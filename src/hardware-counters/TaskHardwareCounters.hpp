@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASK_HARDWARE_COUNTERS_HPP
@@ -10,6 +10,7 @@
 #include "HardwareCounters.hpp"
 #include "SupportedHardwareCounters.hpp"
 #include "TaskHardwareCountersInterface.hpp"
+#include "hardware-counters/perf/PerfTaskHardwareCounters.hpp"
 #include "lowlevel/SpinLock.hpp"
 
 #if HAVE_PAPI
@@ -78,6 +79,16 @@ public:
 				currentAddress = (char *) currentAddress + getPQoSTaskHardwareCountersSize();
 			}
 #endif
+
+			if (HardwareCounters::isBackendEnabled(HWCounters::PERF_BACKEND)) {
+				assert(currentAddress != nullptr);
+
+				// Skip sizeof(PerfTaskHardwareCounters) for the inner address
+				void *innerAddress = (char *) currentAddress + sizeof(PerfTaskHardwareCounters);
+
+				new (currentAddress) PerfTaskHardwareCounters(innerAddress);
+				currentAddress = (char *) currentAddress + getPerfTaskHardwareCountersSize();
+			}
 		}
 	}
 
@@ -98,6 +109,11 @@ public:
 				((PQoSTaskHardwareCounters *) pqosCounters)->~PQoSTaskHardwareCounters();
 #endif
 			}
+
+			TaskHardwareCountersInterface *perfCounters = getPerfCounters();
+			if (perfCounters != nullptr) {
+				((PerfTaskHardwareCounters *) perfCounters)->~PerfTaskHardwareCounters();
+			}
 		}
 	}
 
@@ -136,6 +152,19 @@ public:
 		return nullptr;
 	}
 
+	//! \brief Return the perf counters of the task (if it is enabled) or nullptr
+	inline TaskHardwareCountersInterface *getPerfCounters() const
+	{
+		if (_enabled) {
+			if (HardwareCounters::isBackendEnabled(HWCounters::PERF_BACKEND)) {
+				// The perf counters are placed after the PAPI and PQoS ones
+				size_t offset = getPAPITaskHardwareCountersSize() + getPQoSTaskHardwareCountersSize();
+				return (TaskHardwareCountersInterface *) ((char *) _allocationAddress + offset);
+			}
+		}
+		return nullptr;
+	}
+
 	//! \brief Get the delta value of a HW counter
 	//!
 	//! \param[in] counterType The type of counter to get the delta from
@@ -147,6 +176,8 @@ public:
 				taskCounters = getPAPICounters();
 			} else if (counterType >= HWCounters::HWC_PQOS_MIN_EVENT && counterType <= HWCounters::HWC_PQOS_MAX_EVENT) {
 				taskCounters = getPQoSCounters();
+			} else if (counterType >= HWCounters::HWC_PERF_MIN_EVENT && counterType <= HWCounters::HWC_PERF_MAX_EVENT) {
+				taskCounters = getPerfCounters();
 			}
 			assert(taskCounters != nullptr);
 
@@ -167,6 +198,8 @@ public:
 				taskCounters = getPAPICounters();
 			} else if (counterType >= HWCounters::HWC_PQOS_MIN_EVENT && counterType <= HWCounters::HWC_PQOS_MAX_EVENT) {
 				taskCounters = getPQoSCounters();
+			} else if (counterType >= HWCounters::HWC_PERF_MIN_EVENT && counterType <= HWCounters::HWC_PERF_MAX_EVENT) {
+				taskCounters = getPerfCounters();
 			}
 			assert(taskCounters != nullptr);
 
@@ -186,6 +219,8 @@ public:
 		TaskHardwareCountersInterface *parentPapiCounters = getPAPICounters();
 		TaskHardwareCountersInterface *childPqosCounters = combinee.getPQoSCounters();
 		TaskHardwareCountersInterface *childPapiCounters = combinee.getPAPICounters();
+		TaskHardwareCountersInterface *parentPerfCounters = getPerfCounters();
+		TaskHardwareCountersInterface *childPerfCounters = combinee.getPerfCounters();
 
 		// Call each backend and let them combine their events
 		_spinlock.lock();
@@ -198,6 +233,10 @@ public:
 			parentPapiCounters->combineCounters(childPapiCounters);
 		}
 
+		if (parentPerfCounters != nullptr) {
+			parentPerfCounters->combineCounters(childPerfCounters);
+		}
+
 		_spinlock.unlock();
 	}
 
@@ -220,6 +259,10 @@ public:
 			totalSize += getPQoSTaskHardwareCountersSize();
 		}
 
+		if (HardwareCounters::isBackendEnabled(HWCounters::PERF_BACKEND)) {
+			totalSize += getPerfTaskHardwareCountersSize();
+		}
+
 		return totalSize;
 	}
 
@@ -241,6 +284,12 @@ private:
 #endif
 		return 0;
 	}
+
+	//! \brief Get the size needed to construct all the structures for perf
+	static inline size_t getPerfTaskHardwareCountersSize()
+	{
+		return sizeof(PerfTaskHardwareCounters) + PerfTaskHardwareCounters::getTaskHardwareCountersSize();
+	}
 };
 
 #endif // TASK_HARDWARE_COUNTERS_HPP
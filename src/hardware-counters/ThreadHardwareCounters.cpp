@@ -1,12 +1,13 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "HardwareCounters.hpp"
 #include "SupportedHardwareCounters.hpp"
 #include "ThreadHardwareCounters.hpp"
+#include "hardware-counters/perf/PerfThreadHardwareCounters.hpp"
 
 #if HAVE_PAPI
 #include "hardware-counters/papi/PAPIThreadHardwareCounters.hpp"
@@ -30,6 +31,10 @@ void ThreadHardwareCounters::initialize()
 		_pqosCounters = new PQoSThreadHardwareCounters();
 	}
 #endif
+
+	if (HardwareCounters::isBackendEnabled(HWCounters::PERF_BACKEND)) {
+		_perfCounters = new PerfThreadHardwareCounters();
+	}
 }
 
 void ThreadHardwareCounters::shutdown()
@@ -45,4 +50,8 @@ void ThreadHardwareCounters::shutdown()
 		delete _pqosCounters;;
 	}
 #endif
+
+	if (HardwareCounters::isBackendEnabled(HWCounters::PERF_BACKEND)) {
+		delete _perfCounters;
+	}
 }
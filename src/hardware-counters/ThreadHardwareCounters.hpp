@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef THREAD_HARDWARE_COUNTERS_HPP
@@ -20,12 +20,16 @@ private:
 	//! Thread-related hardware counters for the PQoS backend
 	ThreadHardwareCountersInterface *_pqosCounters;
 
+	//! Thread-related hardware counters for the perf backend
+	ThreadHardwareCountersInterface *_perfCounters;
+
 public:
 
 	inline ThreadHardwareCounters()
 	{
 		_papiCounters = nullptr;
 		_pqosCounters = nullptr;
+		_perfCounters = nullptr;
 	}
 
 	//! \brief Initialize and construct all backend objects
@@ -46,6 +50,12 @@ public:
 		return _pqosCounters;
 	}
 
+	//! \brief Return the perf counters of the thread (if it is enabled) or nullptr
+	inline ThreadHardwareCountersInterface *getPerfCounters() const
+	{
+		return _perfCounters;
+	}
+
 };
 
 #endif // THREAD_HARDWARE_COUNTERS_HPP
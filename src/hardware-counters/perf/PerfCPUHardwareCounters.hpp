@@ -0,0 +1,57 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PERF_CPU_HARDWARE_COUNTERS_HPP
+#define PERF_CPU_HARDWARE_COUNTERS_HPP
+
+#include <cstring>
+
+#include "PerfHardwareCounters.hpp"
+#include "PerfThreadHardwareCounters.hpp"
+#include "hardware-counters/CPUHardwareCountersInterface.hpp"
+#include "hardware-counters/SupportedHardwareCounters.hpp"
+
+
+class PerfCPUHardwareCounters : public CPUHardwareCountersInterface {
+
+private:
+
+	//! Arrays of regular HW counter deltas
+	uint64_t _counters[HWCounters::HWC_PERF_NUM_EVENTS];
+
+public:
+
+	inline PerfCPUHardwareCounters()
+	{
+		memset(_counters, 0, sizeof(_counters));
+	}
+
+	//! \brief Read the counters of a thread since its previous read
+	//!
+	//! \param[in] threadCounters The counters of the thread running in the CPU
+	inline void readCounters(PerfThreadHardwareCounters *threadCounters)
+	{
+		assert(threadCounters != nullptr);
+
+		threadCounters->readDeltas(_counters);
+	}
+
+	//! \brief Get the delta value of a HW counter
+	//!
+	//! \param[in] counterType The type of counter to get the delta from
+	inline uint64_t getDelta(HWCounters::counters_t counterType) const override
+	{
+		assert(PerfHardwareCounters::isCounterEnabled(counterType));
+
+		int innerId = PerfHardwareCounters::getInnerIdentifier(counterType);
+		assert(innerId >= 0 && (size_t) innerId < PerfHardwareCounters::getNumEnabledCounters());
+
+		return _counters[innerId];
+	}
+
+};
+
+#endif // PERF_CPU_HARDWARE_COUNTERS_HPP
@@ -0,0 +1,354 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+#include <asm/unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "PerfCPUHardwareCounters.hpp"
+#include "PerfHardwareCounters.hpp"
+#include "PerfTaskHardwareCounters.hpp"
+#include "PerfThreadHardwareCounters.hpp"
+#include "hardware-counters/CPUHardwareCountersInterface.hpp"
+#include "hardware-counters/TaskHardwareCountersInterface.hpp"
+#include "hardware-counters/ThreadHardwareCountersInterface.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "support/config/ConfigVariable.hpp"
+
+std::vector<HWCounters::counters_t> PerfHardwareCounters::_enabledPerfEvents;
+size_t PerfHardwareCounters::_numEnabledCounters(0);
+int PerfHardwareCounters::_idMap[HWCounters::HWC_PERF_NUM_EVENTS];
+
+
+static inline bool isSoftwareEvent(HWCounters::counters_t counterType)
+{
+	return (counterType >= HWCounters::HWC_PERF_TASK_CLOCK);
+}
+
+static inline int perfEventOpen(HWCounters::counters_t counterType, bool excludeKernel, int groupFd)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+
+	uint32_t type;
+	uint64_t config;
+	PerfHardwareCounters::getEventAttributes(counterType, type, config);
+	attr.type = type;
+	attr.config = config;
+
+	attr.exclude_kernel = excludeKernel;
+	attr.exclude_hv = 1;
+
+	// The hardware events of a thread are opened as a group whose leader is
+	// pinned, so they are never multiplexed. If the group cannot be scheduled,
+	// the kernel puts it in error state instead of scaling the counts
+	attr.pinned = (!isSoftwareEvent(counterType) && groupFd < 0);
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+//! \brief Open an event for the calling thread
+//!
+//! \param[in] counterType The event to open
+//! \param[in] groupFd The leader of the group of hardware events of the
+//! thread, or -1 to open the event as a leader. Ignored by software events
+static inline int perfEventOpen(HWCounters::counters_t counterType, int groupFd = -1)
+{
+	// Count only the user code of the calling thread, as the PAPI backend
+	if (!isSoftwareEvent(counterType))
+		return perfEventOpen(counterType, true, groupFd);
+
+	// Software events already count only the calling thread, but some of
+	// them, such as context switches and migrations, are always recorded in
+	// kernel mode and would read zero when excluding it
+	int fd = perfEventOpen(counterType, false, -1);
+	if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+		// Counting kernel mode is restricted by perf_event_paranoid. The
+		// clock and the page faults are still counted correctly without it
+		if (counterType == HWCounters::HWC_PERF_TASK_CLOCK || counterType == HWCounters::HWC_PERF_PAGE_FAULTS) {
+			fd = perfEventOpen(counterType, true, -1);
+		}
+	}
+	return fd;
+}
+
+void PerfHardwareCounters::getEventAttributes(HWCounters::counters_t counterType, uint32_t &type, uint64_t &config)
+{
+	type = PERF_TYPE_HARDWARE;
+	switch (counterType) {
+		case HWCounters::HWC_PERF_CPU_CYCLES:
+			config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case HWCounters::HWC_PERF_INSTRUCTIONS:
+			config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case HWCounters::HWC_PERF_CACHE_REFERENCES:
+			config = PERF_COUNT_HW_CACHE_REFERENCES;
+			break;
+		case HWCounters::HWC_PERF_CACHE_MISSES:
+			config = PERF_COUNT_HW_CACHE_MISSES;
+			break;
+		case HWCounters::HWC_PERF_BRANCH_INSTRUCTIONS:
+			config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+			break;
+		case HWCounters::HWC_PERF_BRANCH_MISSES:
+			config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+		case HWCounters::HWC_PERF_STALLED_CYCLES_FRONTEND:
+			config = PERF_COUNT_HW_STALLED_CYCLES_FRONTEND;
+			break;
+		case HWCounters::HWC_PERF_STALLED_CYCLES_BACKEND:
+			config = PERF_COUNT_HW_STALLED_CYCLES_BACKEND;
+			break;
+		case HWCounters::HWC_PERF_REF_CPU_CYCLES:
+			config = PERF_COUNT_HW_REF_CPU_CYCLES;
+			break;
+		case HWCounters::HWC_PERF_TASK_CLOCK:
+			type = PERF_TYPE_SOFTWARE;
+			config = PERF_COUNT_SW_TASK_CLOCK;
+			break;
+		case HWCounters::HWC_PERF_PAGE_FAULTS:
+			type = PERF_TYPE_SOFTWARE;
+			config = PERF_COUNT_SW_PAGE_FAULTS;
+			break;
+		case HWCounters::HWC_PERF_CONTEXT_SWITCHES:
+			type = PERF_TYPE_SOFTWARE;
+			config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+			break;
+		case HWCounters::HWC_PERF_CPU_MIGRATIONS:
+			type = PERF_TYPE_SOFTWARE;
+			config = PERF_COUNT_SW_CPU_MIGRATIONS;
+			break;
+		default:
+			FatalErrorHandler::fail("Unknown perf event ", counterType);
+	}
+}
+
+int PerfHardwareCounters::testEvent(HWCounters::counters_t counterType) const
+{
+	int fd = perfEventOpen(counterType);
+	int error = (fd >= 0) ? 0 : errno;
+
+	if (_verbose) {
+		FatalErrorHandler::print("  - ", HWCounters::counterDescriptions[counterType], (error == 0) ? ": OK" : ": FAIL");
+	}
+
+	if (fd >= 0)
+		close(fd);
+
+	return error;
+}
+
+bool PerfHardwareCounters::testHardwareGroup(const std::vector<HWCounters::counters_t> &enabledEvents) const
+{
+	std::vector<int> fds;
+	int leaderFd = -1;
+	bool schedulable = true;
+
+	for (HWCounters::counters_t id : enabledEvents) {
+		if (id < HWCounters::HWC_PERF_MIN_EVENT || id > HWCounters::HWC_PERF_MAX_EVENT || isSoftwareEvent(id))
+			continue;
+
+		// The kernel refuses members that make the group exceed the counters
+		int fd = perfEventOpen(id, leaderFd);
+		if (fd < 0) {
+			schedulable = false;
+			break;
+		}
+
+		fds.push_back(fd);
+		if (leaderFd < 0)
+			leaderFd = fd;
+	}
+
+	// A pinned group that does not fit in the available counters, for
+	// instance because some are taken by the NMI watchdog, is in error state
+	// and reading it returns end-of-file
+	if (schedulable && leaderFd >= 0) {
+		uint64_t values[3];
+		schedulable = (read(leaderFd, values, sizeof(values)) == sizeof(values));
+	}
+
+	for (auto fd = fds.rbegin(); fd != fds.rend(); ++fd) {
+		close(*fd);
+	}
+
+	return schedulable;
+}
+
+PerfHardwareCounters::PerfHardwareCounters(
+	bool verbose,
+	const std::string &,
+	std::vector<HWCounters::counters_t> &enabledEvents
+) {
+	_verbose = verbose;
+	for (size_t i = 0; i < HWCounters::HWC_PERF_NUM_EVENTS; ++i) {
+		_idMap[i] = DISABLED_PERF_COUNTER;
+	}
+
+	ConfigVariable<bool> softwareFallback("hardware_counters.perf.software_fallback");
+
+	FatalErrorHandler::printIf(_verbose,
+		"------------------------------------------------\n",
+		"- Testing requested perf events availabilities"
+	);
+
+	// Hardware events cannot be opened when there is no PMU available, as
+	// in most virtual machines. In that case, disable them and fall back
+	// to the task clock software event, if the user allows it
+	bool fallbackNeeded = false;
+	auto it = enabledEvents.begin();
+	while (it != enabledEvents.end()) {
+		HWCounters::counters_t id = *it;
+		if (id >= HWCounters::HWC_PERF_MIN_EVENT && id <= HWCounters::HWC_PERF_MAX_EVENT) {
+			int error = testEvent(id);
+			if (error != 0) {
+				FatalErrorHandler::warn(
+					HWCounters::counterDescriptions[id],
+					" event cannot be opened with perf_event_open (", strerror(error), "), skipping it"
+				);
+
+				fallbackNeeded = fallbackNeeded || !isSoftwareEvent(id);
+				it = enabledEvents.erase(it);
+				continue;
+			}
+		}
+		++it;
+	}
+
+	if (fallbackNeeded && softwareFallback) {
+		HWCounters::counters_t fallback = HWCounters::HWC_PERF_TASK_CLOCK;
+		if (std::find(enabledEvents.begin(), enabledEvents.end(), fallback) == enabledEvents.end()) {
+			if (testEvent(fallback) == 0) {
+				FatalErrorHandler::warn(
+					"Hardware perf events are not available, falling back to ",
+					HWCounters::counterDescriptions[fallback]
+				);
+				enabledEvents.push_back(fallback);
+			}
+		}
+	}
+
+	// The hardware events are counted at the same time, so they must fit in the
+	// hardware counters together. Otherwise they would be multiplexed
+	if (!testHardwareGroup(enabledEvents)) {
+		FatalErrorHandler::fail(
+			"The enabled hardware perf events cannot be counted at the same time,",
+			" since they do not fit in the hardware counters. Enable fewer events"
+		);
+	}
+
+	for (HWCounters::counters_t id : enabledEvents) {
+		if (id >= HWCounters::HWC_PERF_MIN_EVENT && id <= HWCounters::HWC_PERF_MAX_EVENT) {
+			_idMap[id - HWCounters::HWC_PERF_MIN_EVENT] = _enabledPerfEvents.size();
+			_enabledPerfEvents.push_back(id);
+		}
+	}
+
+	_numEnabledCounters = _enabledPerfEvents.size();
+	if (!_numEnabledCounters) {
+		FatalErrorHandler::warn("No perf events enabled, disabling this backend");
+		_enabled = false;
+	} else {
+		_enabled = true;
+	}
+
+	FatalErrorHandler::printIf(_verbose,
+		"\n- Finished testing perf events availabilities\n",
+		"- Number of perf events enabled: ", _numEnabledCounters, "\n",
+		"------------------------------------------------"
+	);
+}
+
+void PerfHardwareCounters::threadInitialized(ThreadHardwareCountersInterface *threadCounters)
+{
+	if (_enabled) {
+		PerfThreadHardwareCounters *perfThreadCounters = (PerfThreadHardwareCounters *) threadCounters;
+		assert(perfThreadCounters != nullptr);
+
+		const long pageSize = sysconf(_SC_PAGESIZE);
+		int leaderFd = -1;
+		for (HWCounters::counters_t id : _enabledPerfEvents) {
+			int fd = perfEventOpen(id, leaderFd);
+			if (fd < 0) {
+				FatalErrorHandler::fail(
+					"Could not open the ", HWCounters::counterDescriptions[id],
+					" perf event for a new thread: ", strerror(errno)
+				);
+			}
+
+			// The first hardware event leads the group of the thread
+			if (leaderFd < 0 && !isSoftwareEvent(id))
+				leaderFd = fd;
+
+			// Map the control page of the event to read the hardware counter
+			// from userspace. If it fails, the event is read with syscalls
+			struct perf_event_mmap_page *page = nullptr;
+			void *address = mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, fd, 0);
+			if (address != MAP_FAILED) {
+				page = (struct perf_event_mmap_page *) address;
+			}
+
+			perfThreadCounters->addEvent(fd, page);
+		}
+
+		// The counters are never reset, so take the initial values
+		perfThreadCounters->start();
+	}
+}
+
+void PerfHardwareCounters::threadShutdown(ThreadHardwareCountersInterface *threadCounters)
+{
+	if (_enabled) {
+		PerfThreadHardwareCounters *perfThreadCounters = (PerfThreadHardwareCounters *) threadCounters;
+		assert(perfThreadCounters != nullptr);
+
+		// Close the group members before their leader
+		const long pageSize = sysconf(_SC_PAGESIZE);
+		for (size_t i = perfThreadCounters->getNumCounters(); i-- > 0;) {
+			struct perf_event_mmap_page *page = perfThreadCounters->getPage(i);
+			if (page != nullptr) {
+				munmap(page, pageSize);
+			}
+			close(perfThreadCounters->getFileDescriptor(i));
+		}
+	}
+}
+
+void PerfHardwareCounters::updateTaskCounters(
+	ThreadHardwareCountersInterface *threadCounters,
+	TaskHardwareCountersInterface *taskCounters
+) {
+	if (_enabled) {
+		PerfThreadHardwareCounters *perfThreadCounters = (PerfThreadHardwareCounters *) threadCounters;
+		PerfTaskHardwareCounters *perfTaskCounters = (PerfTaskHardwareCounters *) taskCounters;
+		assert(perfThreadCounters != nullptr);
+		assert(perfTaskCounters != nullptr);
+
+		perfTaskCounters->readCounters(perfThreadCounters);
+	}
+}
+
+void PerfHardwareCounters::updateRuntimeCounters(
+	CPUHardwareCountersInterface *cpuCounters,
+	ThreadHardwareCountersInterface *threadCounters
+) {
+	if (_enabled) {
+		PerfCPUHardwareCounters *perfCPUCounters = (PerfCPUHardwareCounters *) cpuCounters;
+		PerfThreadHardwareCounters *perfThreadCounters = (PerfThreadHardwareCounters *) threadCounters;
+		assert(perfCPUCounters != nullptr);
+		assert(perfThreadCounters != nullptr);
+
+		perfCPUCounters->readCounters(perfThreadCounters);
+	}
+}
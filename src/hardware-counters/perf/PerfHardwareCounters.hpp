@@ -0,0 +1,129 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PERF_HARDWARE_COUNTERS_HPP
+#define PERF_HARDWARE_COUNTERS_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware-counters/HardwareCountersInterface.hpp"
+#include "hardware-counters/SupportedHardwareCounters.hpp"
+
+
+class CPUHardwareCountersInterface;
+class TaskHardwareCountersInterface;
+class ThreadHardwareCountersInterface;
+
+class PerfHardwareCounters : public HardwareCountersInterface {
+
+private:
+
+	//! Whether the perf HW Counter backend is enabled
+	bool _enabled;
+
+	//! Whether the verbose mode is enabled
+	bool _verbose;
+
+	//! The enabled perf events, in the order of their inner identifiers
+	static std::vector<HWCounters::counters_t> _enabledPerfEvents;
+
+	//! The number of enabled counters (enabled by the user and available)
+	static size_t _numEnabledCounters;
+
+	//! Maps HWCounters::counters_t identifiers with the "inner perf id" (0..N)
+	//!
+	//! NOTE: This is an array with as many positions as possible counters in
+	//! the perf backend (PERF_NUM_EVENTS), even those that are disabled. If
+	//! the value of a position is -1, the event is disabled
+	static int _idMap[HWCounters::HWC_PERF_NUM_EVENTS];
+
+	static const int DISABLED_PERF_COUNTER = -1;
+
+private:
+
+	//! \brief Check whether an event can be opened by the current thread
+	//!
+	//! \return Zero if the event is available or the error code otherwise
+	int testEvent(HWCounters::counters_t counterType) const;
+
+	//! \brief Check whether the enabled hardware events can be counted at the
+	//! same time, as a pinned group, by the current thread
+	bool testHardwareGroup(const std::vector<HWCounters::counters_t> &enabledEvents) const;
+
+public:
+
+	//! \brief Initialize the perf backend
+	//!
+	//! \param[in] verbose Whether verbose mode is enabled
+	//! \param[in] verboseFile The file onto which to write verbose messages
+	//! \param[in,out] enabledEvents A vector with all the events enabled by the user,
+	//! which will be modified to disable those that are unavailable
+	PerfHardwareCounters(
+		bool verbose,
+		const std::string &,
+		std::vector<HWCounters::counters_t> &enabledEvents
+	);
+
+	inline ~PerfHardwareCounters()
+	{
+	}
+
+	//! \brief Retrieve the mapping from a counters_t identifier to the inner
+	//! identifier of arrays with only enabled events
+	static inline int getInnerIdentifier(HWCounters::counters_t counterType)
+	{
+		assert((counterType - HWCounters::HWC_PERF_MIN_EVENT) < HWCounters::HWC_PERF_NUM_EVENTS);
+
+		return _idMap[counterType - HWCounters::HWC_PERF_MIN_EVENT];
+	}
+
+	//! \brief Check whether a counter is enabled
+	static inline bool isCounterEnabled(HWCounters::counters_t counterType)
+	{
+		assert((counterType - HWCounters::HWC_PERF_MIN_EVENT) < HWCounters::HWC_PERF_NUM_EVENTS);
+
+		return (_idMap[counterType - HWCounters::HWC_PERF_MIN_EVENT] != DISABLED_PERF_COUNTER);
+	}
+
+	//! \brief Get the number of enabled counters in the perf backend
+	static inline size_t getNumEnabledCounters()
+	{
+		return _numEnabledCounters;
+	}
+
+	//! \brief Get the enabled perf events, ordered by their inner identifier
+	static inline const std::vector<HWCounters::counters_t> &getEnabledEvents()
+	{
+		return _enabledPerfEvents;
+	}
+
+	//! \brief Translate an event to the type and config of perf_event_attr
+	//!
+	//! \param[in] counterType The event to translate
+	//! \param[out] type The perf type of the event
+	//! \param[out] config The perf config of the event
+	static void getEventAttributes(HWCounters::counters_t counterType, uint32_t &type, uint64_t &config);
+
+	void threadInitialized(ThreadHardwareCountersInterface *threadCounters) override;
+
+	void threadShutdown(ThreadHardwareCountersInterface *threadCounters) override;
+
+	void updateTaskCounters(
+		ThreadHardwareCountersInterface *threadCounters,
+		TaskHardwareCountersInterface *taskCounters
+	) override;
+
+	void updateRuntimeCounters(
+		CPUHardwareCountersInterface *cpuCounters,
+		ThreadHardwareCountersInterface *threadCounters
+	) override;
+
+};
+
+#endif // PERF_HARDWARE_COUNTERS_HPP
@@ -0,0 +1,114 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PERF_TASK_HARDWARE_COUNTERS_HPP
+#define PERF_TASK_HARDWARE_COUNTERS_HPP
+
+#include <cstring>
+
+#include "PerfHardwareCounters.hpp"
+#include "PerfThreadHardwareCounters.hpp"
+#include "hardware-counters/SupportedHardwareCounters.hpp"
+#include "hardware-counters/TaskHardwareCountersInterface.hpp"
+
+
+class PerfTaskHardwareCounters : public TaskHardwareCountersInterface {
+
+private:
+
+	//! Arrays of regular HW counter deltas and accumulations
+	uint64_t *_countersDelta;
+	uint64_t *_countersAccumulated;
+
+public:
+
+	inline PerfTaskHardwareCounters(void *allocationAddress)
+	{
+		assert(allocationAddress != nullptr);
+
+		const size_t numCounters = PerfHardwareCounters::getNumEnabledCounters();
+		_countersDelta = (uint64_t *) allocationAddress;
+		_countersAccumulated = (uint64_t *) ((char *) allocationAddress + (numCounters * sizeof(uint64_t)));
+
+		clear();
+	}
+
+	//! \brief Empty hardware counter structures
+	inline void clear() override
+	{
+		const size_t numCounters = PerfHardwareCounters::getNumEnabledCounters();
+		memset(_countersDelta, 0, numCounters * sizeof(uint64_t));
+		memset(_countersAccumulated, 0, numCounters * sizeof(uint64_t));
+	}
+
+	//! \brief Read the counters of a thread since its previous read
+	//!
+	//! \param[in] threadCounters The counters of the thread running the task
+	inline void readCounters(PerfThreadHardwareCounters *threadCounters)
+	{
+		assert(threadCounters != nullptr);
+
+		threadCounters->readDeltas(_countersDelta);
+
+		const size_t numCounters = PerfHardwareCounters::getNumEnabledCounters();
+		for (size_t i = 0; i < numCounters; ++i) {
+			_countersAccumulated[i] += _countersDelta[i];
+		}
+	}
+
+	//! \brief Get the delta value of a HW counter
+	//!
+	//! \param[in] counterType The type of counter to get the delta from
+	inline uint64_t getDelta(HWCounters::counters_t counterType) const override
+	{
+		assert(PerfHardwareCounters::isCounterEnabled(counterType));
+
+		int innerId = PerfHardwareCounters::getInnerIdentifier(counterType);
+		assert(innerId >= 0 && (size_t) innerId < PerfHardwareCounters::getNumEnabledCounters());
+
+		return _countersDelta[innerId];
+	}
+
+	//! \brief Get the accumulated value of a HW counter
+	//!
+	//! \param[in] counterType The type of counter to get the accumulation from
+	inline uint64_t getAccumulated(HWCounters::counters_t counterType) const override
+	{
+		assert(PerfHardwareCounters::isCounterEnabled(counterType));
+
+		int innerId = PerfHardwareCounters::getInnerIdentifier(counterType);
+		assert(innerId >= 0 && (size_t) innerId < PerfHardwareCounters::getNumEnabledCounters());
+
+		return _countersAccumulated[innerId];
+	}
+
+	//! \brief Combine the counters of two tasks
+	//!
+	//! \param[in] combineeCounters The counters of a task, which will be combined into
+	//! the current counters
+	inline void combineCounters(const TaskHardwareCountersInterface *combineeCounters) override
+	{
+		PerfTaskHardwareCounters *childCounters = (PerfTaskHardwareCounters *) combineeCounters;
+		assert(childCounters != nullptr);
+
+		const size_t numCounters = PerfHardwareCounters::getNumEnabledCounters();
+		for (size_t i = 0; i < numCounters; ++i) {
+			_countersDelta[i] = childCounters->_countersDelta[i];
+			_countersAccumulated[i] += childCounters->_countersAccumulated[i];
+		}
+	}
+
+	//! \brief Retrieve the size needed for hardware counters
+	static inline size_t getTaskHardwareCountersSize()
+	{
+		const size_t numCounters = PerfHardwareCounters::getNumEnabledCounters();
+
+		return numCounters * 2 * sizeof(uint64_t);
+	}
+
+};
+
+#endif // PERF_TASK_HARDWARE_COUNTERS_HPP
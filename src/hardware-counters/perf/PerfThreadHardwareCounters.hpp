@@ -0,0 +1,178 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PERF_THREAD_HARDWARE_COUNTERS_HPP
+#define PERF_THREAD_HARDWARE_COUNTERS_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <linux/perf_event.h>
+#include <unistd.h>
+
+#include "hardware-counters/SupportedHardwareCounters.hpp"
+#include "hardware-counters/ThreadHardwareCountersInterface.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+
+
+class PerfThreadHardwareCounters : public ThreadHardwareCountersInterface {
+
+private:
+
+	//! The number of opened events
+	size_t _numCounters;
+
+	//! The file descriptor of each event
+	int _fds[HWCounters::HWC_PERF_NUM_EVENTS];
+
+	//! The mmap'd page of each event, or nullptr if it could not be mapped
+	struct perf_event_mmap_page *_pages[HWCounters::HWC_PERF_NUM_EVENTS];
+
+	//! The value of each counter at the previous read, so that deltas are
+	//! computed without resetting the counters
+	uint64_t _lastValues[HWCounters::HWC_PERF_NUM_EVENTS];
+
+private:
+
+#if defined(__x86_64__) || defined(__i386__)
+	static inline uint64_t rdpmc(uint32_t counter)
+	{
+		uint32_t low, high;
+		__asm__ __volatile__("rdpmc" : "=a" (low), "=d" (high) : "c" (counter));
+		return ((uint64_t) high << 32) | low;
+	}
+#endif
+
+	//! \brief Read a counter of the current thread
+	//!
+	//! The counter is read from userspace with rdpmc when the kernel allows
+	//! it and the event is scheduled in a hardware counter. Otherwise (e.g.,
+	//! software events or architectures without user-level access), the
+	//! value is read through the file descriptor. The hardware events are a
+	//! pinned group, so they are never multiplexed while they are readable
+	inline uint64_t readCounter(size_t id) const
+	{
+		assert(id < _numCounters);
+
+#if defined(__x86_64__) || defined(__i386__)
+		struct perf_event_mmap_page *page = _pages[id];
+		if (page != nullptr) {
+			uint32_t sequence, index;
+			uint64_t count;
+			bool available;
+
+			// See the user-space read protocol in linux/perf_event.h
+			do {
+				sequence = page->lock;
+				__atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+				index = page->index;
+				count = page->offset;
+				available = (page->cap_user_rdpmc && index != 0);
+				if (available) {
+					uint16_t width = page->pmc_width;
+					int64_t pmc = (int64_t) rdpmc(index - 1);
+					pmc <<= 64 - width;
+					pmc >>= 64 - width;
+					count += pmc;
+				}
+
+				__atomic_signal_fence(__ATOMIC_SEQ_CST);
+			} while (page->lock != sequence);
+
+			if (available)
+				return count;
+		}
+#endif
+
+		// The value followed by the time enabled and running
+		uint64_t values[3];
+		ssize_t ret = read(_fds[id], values, sizeof(values));
+		FatalErrorHandler::failIf(ret == 0,
+			"The hardware perf events could not be scheduled in the hardware counters");
+		FatalErrorHandler::failIf(ret != sizeof(values), "Could not read a perf event counter");
+
+		// Scale the events that were not counted all the time they were enabled
+		uint64_t value = values[0];
+		if (values[2] < values[1]) {
+			value = (values[2] == 0) ? 0 : (uint64_t) ((double) value * values[1] / values[2]);
+		}
+
+		return value;
+	}
+
+public:
+
+	inline PerfThreadHardwareCounters() :
+		_numCounters(0)
+	{
+		for (size_t i = 0; i < HWCounters::HWC_PERF_NUM_EVENTS; ++i) {
+			_fds[i] = -1;
+			_pages[i] = nullptr;
+			_lastValues[i] = 0;
+		}
+	}
+
+	inline ~PerfThreadHardwareCounters()
+	{
+	}
+
+	//! \brief Register an opened event of the thread
+	//!
+	//! \param[in] fd The file descriptor of the event
+	//! \param[in] page The mmap'd page of the event or nullptr
+	inline void addEvent(int fd, struct perf_event_mmap_page *page)
+	{
+		assert(_numCounters < HWCounters::HWC_PERF_NUM_EVENTS);
+
+		_fds[_numCounters] = fd;
+		_pages[_numCounters] = page;
+		++_numCounters;
+	}
+
+	inline size_t getNumCounters() const
+	{
+		return _numCounters;
+	}
+
+	inline int getFileDescriptor(size_t id) const
+	{
+		assert(id < _numCounters);
+
+		return _fds[id];
+	}
+
+	inline struct perf_event_mmap_page *getPage(size_t id) const
+	{
+		assert(id < _numCounters);
+
+		return _pages[id];
+	}
+
+	//! \brief Take the initial snapshot of all counters
+	inline void start()
+	{
+		for (size_t i = 0; i < _numCounters; ++i) {
+			_lastValues[i] = readCounter(i);
+		}
+	}
+
+	//! \brief Read the counters and compute the deltas since the previous read
+	//!
+	//! \param[out] deltas An array with as many positions as enabled events
+	inline void readDeltas(uint64_t *deltas)
+	{
+		assert(deltas != nullptr);
+
+		for (size_t i = 0; i < _numCounters; ++i) {
+			uint64_t value = readCounter(i);
+			deltas[i] = value - _lastValues[i];
+			_lastValues[i] = value;
+		}
+	}
+
+};
+
+#endif // PERF_THREAD_HARDWARE_COUNTERS_HPP
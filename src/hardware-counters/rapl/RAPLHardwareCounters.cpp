@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cassert>
@@ -116,6 +116,19 @@ void RAPLHardwareCounters::raplInitialize()
 		ret = snprintf(_fileNames[i][j], RAPL_BUFFER_SIZE, "%s/energy_uj", baseNames[i]);
 		assert(ret >= 0);
 
+		// Obtain the range of the package counter to handle its wrap-around
+		_maxEnergyRanges[i] = 0;
+		ret = snprintf(tempFileName, RAPL_BUFFER_SIZE, "%s/max_energy_range_uj", baseNames[i]);
+		assert(ret >= 0);
+
+		file = fopen(tempFileName, "r");
+		if (file != nullptr) {
+			if (fscanf(file, "%zu", &_maxEnergyRanges[i]) != 1) {
+				_maxEnergyRanges[i] = 0;
+			}
+			fclose(file);
+		}
+
 		// Iterate each subdomain
 		for (j = 1; j < RAPL_NUM_DOMAINS; ++j) {
 			ret = snprintf(tempFileName, RAPL_BUFFER_SIZE, "%s/intel-rapl:%zu:%zu/name", baseNames[i], i, j - 1);
@@ -157,6 +170,21 @@ void RAPLHardwareCounters::raplReadCounters(size_t values[RAPL_MAX_PACKAGES][RAP
 	}
 }
 
+bool RAPLHardwareCounters::readPackageEnergy(size_t package, size_t &microjoules) const
+{
+	assert(package < _numPackages);
+
+	// The first domain of each package is the package itself
+	FILE *file = fopen(_fileNames[package][0], "r");
+	if (file == nullptr)
+		return false;
+
+	bool success = (fscanf(file, "%zu", &microjoules) == 1);
+	fclose(file);
+
+	return success;
+}
+
 void RAPLHardwareCounters::raplShutdown()
 {
 	// Gather the finishing values
@@ -1,12 +1,13 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef RAPL_HARDWARE_COUNTERS_HPP
 #define RAPL_HARDWARE_COUNTERS_HPP
 
+#include <cassert>
 #include <cstdio>
 
 #include "hardware-counters/HardwareCountersInterface.hpp"
@@ -53,6 +54,10 @@ private:
 	//! Values read at shutdown time (end of the execution)
 	size_t _finishValues[RAPL_MAX_PACKAGES][RAPL_NUM_DOMAINS];
 
+	//! The value at which the energy counter of each package wraps around,
+	//! or zero if unknown
+	size_t _maxEnergyRanges[RAPL_MAX_PACKAGES];
+
 private:
 
 	//! \brief Detect if the current CPU architecture is compatible with RAPL
@@ -100,6 +105,29 @@ public:
 
 	//! \brief Print power usage information
 	void displayStatistics() const override;
+
+	//! \brief Get the number of packages with power counters
+	inline size_t getNumPackages() const
+	{
+		return _numPackages;
+	}
+
+	//! \brief Read the current energy counter of a package
+	//!
+	//! \param[in] package The package to read
+	//! \param[out] microjoules The value of the counter in microjoules
+	//!
+	//! \return Whether the counter could be read
+	bool readPackageEnergy(size_t package, size_t &microjoules) const;
+
+	//! \brief Get the value at which the energy counter of a package wraps
+	//! around, or zero if unknown
+	inline size_t getMaxEnergyRange(size_t package) const
+	{
+		assert(package < _numPackages);
+
+		return _maxEnergyRanges[package];
+	}
 };
 
 #endif // RAPL_HARDWARE_COUNTERS_HPP
@@ -1,14 +1,17 @@
 /*
     This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2022-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "Accelerator.hpp"
 #include "executors/threads/TaskFinalization.hpp"
+#include "hardware/device/directory/DeviceDirectory.hpp"
 #include "hardware/HardwareInfo.hpp"
 #include "scheduling/Scheduler.hpp"
+#include "support/config/ConfigVariable.hpp"
 #include "system/TrackingPoints.hpp"
+#include "tasks/TaskInfoManager.hpp"
 #include "tasks/TaskImplementation.hpp"
 
 #include <DataAccessRegistration.hpp>
@@ -20,7 +23,7 @@ void Accelerator::callTaskBody(Task *task, nanos6_address_translation_entry_t *t
 	task->body(translationTable);
 }
 
-void Accelerator::runTask(Task *task)
+bool Accelerator::runTask(Task *task)
 {
 	assert(task != nullptr);
 
@@ -31,14 +34,25 @@ void Accelerator::runTask(Task *task)
 	task->setAcceleratorStream(acceleratorStream);
 	task->setAccelerator(this);
 
-	generateDeviceEvironment(task->getDeviceEnvironment(), task->getImplementations());
+	// The device subtype was computed when the task info was registered
+	assert(task->getTaskInfoData() != nullptr);
+	generateDeviceEvironment(task->getDeviceEnvironment(), task->getTaskInfoData()->getDeviceSubtype());
 
 	//if preRunTask passes through the directory,
 	//it will add new operations into the stream,
 	//so the new event will have a correct result.
 	//If not, the prerun will run synchronous, so
 	//the next event will have again a correct result.
-	preRunTask(task);
+	if (!preRunTask(task)) {
+		// The stream may have write-backs of evicted allocations, so it is
+		// released after them
+		finishTaskCleanup(task);
+		acceleratorStream->addOperation([=]() {
+			_streamPool.releaseStream(acceleratorStream);
+			return true;
+		});
+		return false;
+	}
 
 	callBody(task);
 
@@ -48,10 +62,16 @@ void Accelerator::runTask(Task *task)
 #endif
 
 	acceleratorStream->addOperation([=]() {
+		// The allocations of the task can be evicted again
+		if (DeviceDirectoryInstance::useDirectory)
+			DeviceDirectoryInstance::instance->unpin_regions(task);
+
 		finishTask(task);
 		_streamPool.releaseStream(acceleratorStream);
 		return true;
 	});
+
+	return true;
 }
 
 void Accelerator::finishTask(Task *task)
@@ -157,6 +177,8 @@ void  Accelerator::setDirectoryHandler(int directoryHandler) {
 
 void Accelerator::setDirectoryHandle(int handle) { _directoryHandler = handle; }
 
+size_t Accelerator::getDirectoryAllocatedBytes() const { return _directoryAllocatedBytes; }
+
 std::pair<std::shared_ptr<DeviceAllocation>, bool> Accelerator::createNewDeviceAllocation(const DataAccessRegion &region)
 {
 	if (getDeviceType() == nanos6_host_device)
@@ -167,8 +189,14 @@ std::pair<std::shared_ptr<DeviceAllocation>, bool> Accelerator::createNewDeviceA
 		), true};
 
 
-	std::pair<void*, bool> allocation = accel_allocate(region.getSize());
+	// Allocations beyond the capacity fail as if the device was out of memory
+	const size_t size = region.getSize();
+	if (_directoryCapacity != 0 && _directoryAllocatedBytes + size > _directoryCapacity)
+		return {nullptr, false};
+
+	std::pair<void*, bool> allocation = accel_allocate(size);
 	if (!allocation.second) return {nullptr, false};
+	_directoryAllocatedBytes += size;
 
 	void* ptr = allocation.first;
 
@@ -179,7 +207,7 @@ std::pair<std::shared_ptr<DeviceAllocation>, bool> Accelerator::createNewDeviceA
 		(
 			host,
 			device,
-			[=]{ setActiveDevice(); accel_free(ptr); }
+			[=]{ setActiveDevice(); accel_free(ptr); _directoryAllocatedBytes -= size; }
 		), true};
 
 }
@@ -197,22 +225,61 @@ void Accelerator::acceleratorServiceLoop() {
 		do {
 			// Launch as many ready device tasks as possible
 			while (_streamPool.streamAvailable()) {
-				Task *task = Scheduler::getReadyTask(_computePlace, currentThread);
+				Task *task = getNextTask(currentThread);
 				if (task == nullptr)
 					break;
 
-				runTask(task);
+				// Retry the task once the running tasks release memory
+				if (!runTask(task)) {
+					_lookaheadTasks.push_back(task);
+					break;
+				}
 			}
 
+			// All streams are busy, so start copying the data of the next tasks
+			prefetchTasks(currentThread);
+
+			_transferStream.streamServiceLoop();
 			_streamPool.processStreams();
 		// Iterate while there are running tasks and pinned polling is enabled
-		} while (_isPinnedPolling && _streamPool.ongoingStreams());
+		} while (_isPinnedPolling && (_streamPool.ongoingStreams() || _transferStream.streamPendingExecutors()));
 
 		// Sleep for a configured amount of microseconds
 		BlockingAPI::waitForUs(_pollingPeriodUs);
 	}
 }
 
+Task *Accelerator::getNextTask(WorkerThread *currentThread)
+{
+	if (!_lookaheadTasks.empty()) {
+		Task *task = _lookaheadTasks.front();
+		_lookaheadTasks.pop_front();
+		return task;
+	}
+
+	return Scheduler::getReadyTask(_computePlace, currentThread);
+}
+
+void Accelerator::prefetchTasks(WorkerThread *currentThread)
+{
+	if (!DeviceDirectoryInstance::useDirectory)
+		return;
+
+	while (_lookaheadTasks.size() < _lookaheadDepth) {
+		Task *task = Scheduler::getReadyTask(_computePlace, currentThread);
+		if (task == nullptr)
+			break;
+
+		_lookaheadTasks.push_back(task);
+
+		// Reserve the device allocations and enqueue the copies. The allocations are not
+		// pinned until the task runs, so they can be evicted if another task needs the space,
+		// and in that case the task copies its data again when it runs
+		if (!task->ignoreDirectory())
+			DeviceDirectoryInstance::instance->register_regions(task->getSymbolInfo(), this, &_transferStream, (void *) task);
+	}
+}
+
 bool Accelerator::shouldStopService() const {
 	return _stopService.load(std::memory_order_relaxed);
 }
@@ -226,9 +293,13 @@ Accelerator::Accelerator(int handler, nanos6_device_t type, uint32_t numOfStream
 	_memoryPlace(new MemoryPlace(_deviceHandler, _deviceType)),
 	_computePlace(new ComputePlace(_deviceHandler, _deviceType)),
 	_streamPool(numOfStreams, [&]{setActiveDevice();}), _pollingPeriodUs(pollingPeriodUs),
-	_isPinnedPolling(isPinnedPolling)
+	_isPinnedPolling(isPinnedPolling),
+	_lookaheadDepth(0),
+	_directoryCapacity(ConfigVariable<StringifiedMemorySize>("devices.directory_capacity").getValue()),
+	_directoryAllocatedBytes(0)
 {
 	_computePlace->addMemoryPlace(_memoryPlace);
+	_transferStream.addContext([&]{setActiveDevice();});
 }
 
 MemoryPlace * Accelerator::getMemoryPlace() { return _memoryPlace; }
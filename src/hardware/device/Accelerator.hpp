@@ -2,15 +2,17 @@
         This file is part of Nanos6 and is licensed under the terms contained in
    the COPYING file.
 
-	Copyright (C) 2020-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef ACCELERATOR_HPP
 #define ACCELERATOR_HPP
 
+#include <deque>
 #include <functional>
 
 #include "AcceleratorEvent.hpp"
+#include "AcceleratorStream.hpp"
 #include "AcceleratorStreamPool.hpp"
 #include "dependencies/SymbolTranslation.hpp"
 #include "hardware/places/ComputePlace.hpp"
@@ -52,20 +54,44 @@ protected:
 	size_t _pollingPeriodUs;
 	bool _isPinnedPolling;
 
+	// Ready tasks taken from the scheduler in advance while all streams are busy.
+	// Their copy-ins are enqueued in the transfer stream, so they overlap with the
+	// running tasks. When a lookahead task runs, its stream waits for the copies
+	// that are still pending, or skips them if they completed. The tasks that
+	// could not be launched because the device was out of memory wait here too
+	std::deque<Task *> _lookaheadTasks;
+	AcceleratorStream _transferStream;
+
+	// Maximum number of lookahead tasks. Zero disables the prefetch of copy-ins
+	size_t _lookaheadDepth;
+
+	// Maximum bytes allocated through the directory, or zero if unlimited, and
+	// the bytes currently allocated
+	size_t _directoryCapacity;
+	std::atomic<size_t> _directoryAllocatedBytes;
+
 	inline bool shouldStopService() const;
+
+	// Get the next task to run, either a lookahead task or a new ready task
+	Task *getNextTask(WorkerThread *currentThread);
+
+	// Take ready tasks until reaching the lookahead depth and prefetch their copy-ins
+	void prefetchTasks(WorkerThread *currentThread);
 	// Set the current instance as the selected/active device for subsequent
 	// operations
 
 	virtual void acceleratorServiceLoop();
 
 	// Each device may use these methods to prepare or conclude task launch if
-	// needed
-	virtual inline void preRunTask(Task *) {}
+	// needed. If preRunTask fails, the task is not launched and must be retried
+	virtual inline bool preRunTask(Task *) { return true; }
 
 	virtual inline void postRunTask(Task *) {}
 
-	// The main device task launch method; It will call pre- & postRunTask
-	virtual void runTask(Task *);
+	// The main device task launch method; It will call pre- & postRunTask.
+	// Returns false if the task could not be launched because the device is
+	// out of memory until other tasks or write-backs finish
+	virtual bool runTask(Task *);
 
 	// Device specific operations after task completion may go here (e.g. free
 	// environment)
@@ -91,6 +117,9 @@ public:
 
 	void setDirectoryHandler(int directoryHandler);
 
+	// Bytes currently allocated in the device through the directory
+	size_t getDirectoryAllocatedBytes() const;
+
 	// this function performs a copy from a host address space into the
 	// accelerator
 	virtual std::function<std::function<bool(void)>()>
@@ -110,6 +139,13 @@ public:
 		[[maybe_unused]] void *src, [[maybe_unused]] int src_device_handler,
 		[[maybe_unused]] size_t size, [[maybe_unused]] void *) const = 0;
 
+	// whether this accelerator can exchange data with another one through
+	// copy_between. Otherwise, the copies are staged in host memory
+	virtual bool canCopyBetween([[maybe_unused]] const Accelerator *other) const
+	{
+		return false;
+	}
+
 	void setDirectoryHandle(int handle);
 
 	virtual std::pair<std::shared_ptr<DeviceAllocation>, bool> createNewDeviceAllocation(const DataAccessRegion &region);
@@ -141,7 +177,7 @@ public:
 
 	virtual void submitDevice(const DeviceEnvironment &deviceEnvironment, const void* args, const nanos6_task_info_t* taskInfo, const nanos6_address_translation_entry_t* translationTable) const = 0;
 	virtual std::function<bool()> getDeviceSubmissionFinished(const DeviceEnvironment& deviceEnvironment) const = 0;
-	virtual inline void generateDeviceEvironment(DeviceEnvironment& env, const nanos6_task_implementation_info_t* task_implementation) = 0;
+	virtual inline void generateDeviceEvironment(DeviceEnvironment& env, uint64_t deviceSubtype) = 0;
 
 	virtual std::pair<void *, bool> accel_allocate(size_t size) = 0;
 	virtual bool accel_free(void *) = 0;
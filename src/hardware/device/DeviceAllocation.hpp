@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 #ifndef DEVICE_ALLOCATION_HPP
 #define DEVICE_ALLOCATION_HPP
@@ -10,6 +10,8 @@
 #include <vector>
 #include <cstdint>
 #include <functional>
+#include <list>
+#include <memory>
 
 #include <dependencies/linear-regions/DataAccessRegion.hpp>
 
@@ -18,6 +20,16 @@ struct DeviceAllocation
 	std::function<void()> free_deviceAllocation;
 	DataAccessRegion _hostRegion, _deviceRegion;
 
+	//! Position in the LRU list of allocations of its device, if tracked
+	std::list<std::weak_ptr<DeviceAllocation>>::iterator _lruPosition;
+	bool _lruTracked;
+
+	//! Whether the allocation is being evicted, so it must not be reused
+	bool _evicting;
+
+	//! Number of running tasks using the allocation, which cannot be evicted while non-zero
+	std::atomic<size_t> _pinCount;
+
 	~DeviceAllocation(){
 		if(_deviceRegion.getStartAddress() != nullptr)
 		{
@@ -27,7 +39,8 @@ struct DeviceAllocation
 
 	DeviceAllocation(
 		const DataAccessRegion& host,	 const DataAccessRegion& device,  std::function<void()> freeFun) :
-			free_deviceAllocation(std::move(freeFun)), _hostRegion(host),  _deviceRegion(device)
+			free_deviceAllocation(std::move(freeFun)), _hostRegion(host),  _deviceRegion(device),
+			_lruPosition(), _lruTracked(false), _evicting(false), _pinCount(0)
 	{
 	}
 
@@ -40,6 +53,15 @@ struct DeviceAllocation
 	uintptr_t getDeviceBase() const { return (uintptr_t) _deviceRegion.getStartAddress();}
 	uintptr_t getDeviceEnd() const {return (uintptr_t) _deviceRegion.getEndAddress(); }
 
+	size_t getSize() const {return _deviceRegion.getSize();}
+
+	bool isEvicting() const {return _evicting;}
+	void setEvicting() {_evicting = true;}
+
+	bool isPinned() const {return _pinCount.load(std::memory_order_acquire) > 0;}
+	void pin() {_pinCount.fetch_add(1, std::memory_order_relaxed);}
+	void unpin() {_pinCount.fetch_sub(1, std::memory_order_release);}
+
 	uintptr_t getTranslation(uintptr_t to_translate) const{
 		return (uintptr_t) _deviceRegion.getStartAddress() + to_translate - (uintptr_t) _hostRegion.getStartAddress();
 	}
@@ -1,10 +1,11 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "BroadcasterAccelerator.hpp"
+#include "tasks/TaskInfoManager.hpp"
 
 BroadcasterAccelerator::BroadcasterAccelerator(const std::vector<Accelerator*>& _cluster) :
 	Accelerator(0,
@@ -203,7 +204,7 @@ void BroadcasterAccelerator::memcpyVector(void* symbol, int vectorLen, nanos6_di
 	} while (anyOngoing);
 }
 
-void BroadcasterAccelerator::preRunTask([[maybe_unused]] Task* task)
+bool BroadcasterAccelerator::preRunTask([[maybe_unused]] Task* task)
 {
 	/*task->getAcceleratorStream()->addOperation(
 		[&, task] () -> std::function<bool()> {
@@ -250,6 +251,7 @@ void BroadcasterAccelerator::preRunTask([[maybe_unused]] Task* task)
 			};
 		}
 	);*/
+	return true;
 }
 
 void BroadcasterAccelerator::callBody(Task *task) {
@@ -273,7 +275,7 @@ void BroadcasterAccelerator::callBody(Task *task) {
 				for (int j = 0; j < (int)distSymbolInfo.size(); ++j) {
 					translation_table[j].device_address = (size_t)device_addresses[j]->at(i);
 				}
-				dev->generateDeviceEvironment(deviceEnvironments[i], task->getImplementations());
+				dev->generateDeviceEvironment(deviceEnvironments[i], task->getTaskInfoData()->getDeviceSubtype());
 				dev->submitDevice(deviceEnvironments[i], argsBlock, taskInfo, translation_table.data());
 				acceleratorStreams[i].addOperation(
 					[&, dev, i]() -> std::function<bool(void)> {
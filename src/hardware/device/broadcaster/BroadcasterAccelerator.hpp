@@ -1,7 +1,7 @@
 ﻿/*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef BROADCASTER_ACCELERATOR_HPP
@@ -23,7 +23,7 @@ private:
 	std::vector<AcceleratorStream> acceleratorStreams;
 	std::unordered_map<const void*, std::vector<void*>> translationTable;
 
-	void preRunTask(Task *task) override;
+	bool preRunTask(Task *task) override;
 
 	void callBody(Task *task) override;
 
@@ -85,7 +85,7 @@ public:
 	inline int getVendorDeviceId() const override {return 0;}
 	inline void submitDevice(const DeviceEnvironment&, const void*, const nanos6_task_info_t*, const nanos6_address_translation_entry_t*) const override {}
 	inline std::function<bool()> getDeviceSubmissionFinished(const DeviceEnvironment&) const override {return []() -> bool {return true;};}
-	inline void generateDeviceEvironment(DeviceEnvironment&, const nanos6_task_implementation_info_t*) override {}
+	inline void generateDeviceEvironment(DeviceEnvironment&, uint64_t) override {}
 
 };
 #endif // BROADCASTER_ACCELERATOR_HPP
@@ -40,14 +40,18 @@ void CUDAAccelerator::acceleratorServiceLoop()
 		do {
 			// Launch as many ready device tasks as possible
 			while (_streamPool.streamAvailable()) {
-				Task *task = Scheduler::getReadyTask(_computePlace, currentThread);
+				Task *task = getNextTask(currentThread);
 				if (task == nullptr) {
 					// The scheduler might have reported the thread as resting
 					Instrument::workerProgressing();
 					break;
 				}
 
-				runTask(task);
+				// Retry the task once the running tasks release memory
+				if (!runTask(task)) {
+					_lookaheadTasks.push_back(task);
+					break;
+				}
 			}
 
 			// Only set the active device if there have been tasks launched
@@ -101,12 +105,12 @@ void CUDAAccelerator::callBody(Task *task)
 
 }
 
-void CUDAAccelerator::preRunTask(Task *task)
+bool CUDAAccelerator::preRunTask(Task *task)
 {
 
 	if(DeviceDirectoryInstance::useDirectory)
 	{
-		DeviceDirectoryInstance::instance->register_regions(task);
+		return DeviceDirectoryInstance::instance->register_regions(task);
 	}
 	else
 	{
@@ -57,7 +57,7 @@ private:
 
 	void processCUDAEvents();
 
-	void preRunTask(Task *task) override;
+	bool preRunTask(Task *task) override;
 
 	void callBody(Task *task) override;
 
@@ -66,6 +66,11 @@ private:
 	void callTaskBody(Task *task, nanos6_address_translation_entry_t *translation);
 
 public:
+	bool canCopyBetween(const Accelerator *other) const override
+	{
+		return other->getDeviceType() == nanos6_cuda_device;
+	}
+
 	CUDAAccelerator(int cudaDeviceIndex) :
 		Accelerator(cudaDeviceIndex,
 			nanos6_cuda_device,
@@ -1,7 +1,7 @@
 ﻿/*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 #include "DeviceDirectory.hpp"
 
@@ -76,8 +76,14 @@ DeviceDirectory::DeviceDirectory(const std::vector<Accelerator *> &accels) :
 	_accelerators(accels),
 	_directory_handles_devicetype_deviceid(nanos6_device_type_num),
 	_dirMap(accels.size()),
+	_lruAllocations(accels.size()),
+	_lruPrunedSize(accels.size(), 0),
+	_allocationStatistics(accels.size()),
+	_stagingChunkSize(ConfigVariable<StringifiedMemorySize>("devices.directory_staging_chunk").getValue()),
 	_stopService(false), _finishedService(false)
 {
+	FatalErrorHandler::failIf(_stagingChunkSize == 0, "The staging chunk size of the device directory must be positive");
+
 	for (size_t i = 0; i < _accelerators.size(); ++i)
 	{
 		_accelerators[i]->setDirectoryHandle(i);
@@ -108,20 +114,65 @@ void DeviceDirectory::generateCopy(AcceleratorStream* acceleratorStream, const D
 	{
 		acceleratorStream->addOperation(srcA->copy_out((void *)dstAddr, (void *)srcAddr, size, copy_extra));
 	}
-	else if (srcType == nanos6_cuda_device && dstType == nanos6_cuda_device)
+	else if (srcA->canCopyBetween(dstA) && dstA->canCopyBetween(srcA)) //device -> device, direct
 	{
 		acceleratorStream->addOperation(dstA->copy_between((void *)dstAddr, dstA->getDeviceHandler(), (void *)srcAddr, srcA->getDeviceHandler(), size, copy_extra));
 	}
-	else if (srcType == nanos6_fpga_device && dstType == nanos6_fpga_device)
+	else //device -> device, staged
 	{
-		acceleratorStream->addOperation(dstA->copy_between((void *)dstAddr, dstA->getDeviceHandler(), (void *)srcAddr, srcA->getDeviceHandler(), size, copy_extra));
+		//fallback - copy the value to the host, and pass it to the device in chunks
+		acceleratorStream->addOperation(generateStagedCopy(srcA, srcAddr, dstA, dstAddr, smpAddr, size, copy_extra));
 	}
-	else //device -> device
+}
+
+std::function<std::function<bool(void)>()> DeviceDirectory::generateStagedCopy(Accelerator *srcA, uintptr_t srcAddr, Accelerator *dstA, uintptr_t dstAddr, uintptr_t hostAddr, size_t size, void *copy_extra)
+{
+	//Progress of the copy, shared by the activator and the checker
+	struct StagedCopy {
+		size_t _numChunks;
+		size_t _chunksOut;
+		size_t _chunksIn;
+		std::function<bool(void)> _copyOutFinished;
+		std::function<bool(void)> _copyInFinished;
+	};
+
+	const size_t chunkSize = _stagingChunkSize;
+
+	return [=]() -> std::function<bool(void)>
 	{
-		//fallback - copy the value to the host, and pass it to the device
-		acceleratorStream->addOperation(srcA->copy_out((void*) smpAddr, (void*) srcAddr, size, copy_extra));
-		acceleratorStream->addOperation(dstA->copy_in((void*) dstAddr, (void*) smpAddr, size, copy_extra));
-	}
+		auto chunkOffset = [=](size_t chunk) -> uintptr_t { return chunk * chunkSize; };
+		auto chunkLength = [=](size_t chunk) -> size_t { return std::min(chunkSize, size - chunk * chunkSize); };
+
+		std::shared_ptr<StagedCopy> copy = std::make_shared<StagedCopy>();
+		copy->_numChunks = (size + chunkSize - 1) / chunkSize;
+		copy->_chunksOut = 0;
+		copy->_chunksIn = 0;
+
+		//Each chunk is copied into the destination once it is in the host, while the next one is copied from the source.
+		//The chunks are written to disjoint parts of the host address, so there is no need to wait for the destination
+		return [=]() -> bool
+		{
+			if (copy->_copyOutFinished && copy->_copyOutFinished()) {
+				copy->_copyOutFinished = nullptr;
+				++copy->_chunksOut;
+			}
+			if (copy->_copyInFinished && copy->_copyInFinished()) {
+				copy->_copyInFinished = nullptr;
+				++copy->_chunksIn;
+			}
+
+			if (!copy->_copyInFinished && copy->_chunksIn < copy->_chunksOut) {
+				const uintptr_t offset = chunkOffset(copy->_chunksIn);
+				copy->_copyInFinished = dstA->copy_in((void *) (dstAddr + offset), (void *) (hostAddr + offset), chunkLength(copy->_chunksIn), copy_extra)();
+			}
+			if (!copy->_copyOutFinished && copy->_chunksOut < copy->_numChunks) {
+				const uintptr_t offset = chunkOffset(copy->_chunksOut);
+				copy->_copyOutFinished = srcA->copy_out((void *) (hostAddr + offset), (void *) (srcAddr + offset), chunkLength(copy->_chunksOut), copy_extra)();
+			}
+
+			return (copy->_chunksIn == copy->_numChunks);
+		};
+	};
 }
 
 Accelerator *DeviceDirectory::getAcceleratorByHandle(const int handle)
@@ -129,7 +180,7 @@ Accelerator *DeviceDirectory::getAcceleratorByHandle(const int handle)
 	return _accelerators[handle];
 }
 
-bool DeviceDirectory::register_regions(std::vector<SymbolRepresentation>& symbolInfo, Accelerator* accelerator, AcceleratorStream* acceleratorStream, void* copy_extra)
+bool DeviceDirectory::register_regions(std::vector<SymbolRepresentation>& symbolInfo, Accelerator* accelerator, AcceleratorStream* acceleratorStream, void* copy_extra, bool pinAllocations)
 {
 	if (symbolInfo.size() == 0) return true;
 
@@ -140,16 +191,28 @@ bool DeviceDirectory::register_regions(std::vector<SymbolRepresentation>& symbol
 	_symbol_allocations.clear();
 	_symbol_allocations.resize(symbolInfo.size());
 
+	//Drop the allocations set by a previous registration of the symbols, such as a prefetch, so they are
+	//freed if they have been evicted meanwhile
+	for (SymbolRepresentation &symbol : symbolInfo) {
+		if (!symbol.allocationPinned)
+			symbol.setSymbolTranslation(nullptr);
+	}
+
 	for (size_t i = 0; i < symbolInfo.size(); ++i) {
-		auto allocation = getDeviceAllocation(handle, symbolInfo[i]);
+		auto allocation = getDeviceAllocation(handle, acceleratorStream, copy_extra, symbolInfo[i]);
 		if (allocation == nullptr)
 			return false;
 
 		_symbol_allocations[i] = allocation;
 	}
 
-	for (size_t i = 0; i < symbolInfo.size(); ++i)
+	for (size_t i = 0; i < symbolInfo.size(); ++i) {
 		processSymbol(handle, copy_extra, acceleratorStream, symbolInfo[i], _symbol_allocations[i]);
+		if (pinAllocations && handle != SMP_HANDLER) {
+			_symbol_allocations[i]->pin();
+			symbolInfo[i].allocationPinned = true;
+		}
+	}
 
 	_symbol_allocations.clear();
 
@@ -162,7 +225,17 @@ bool DeviceDirectory::register_regions(Task *task)
 
 	if (task->getDeviceType() == nanos6_host_device)
 		task->setAccelerator(getAcceleratorByHandle(0));
-	return register_regions(task->getSymbolInfo(), task->getAccelerator(), task->getAcceleratorStream(), (void*) task);
+	return register_regions(task->getSymbolInfo(), task->getAccelerator(), task->getAcceleratorStream(), (void*) task, /* pin */ true);
+}
+
+void DeviceDirectory::unpin_regions(Task *task)
+{
+	for (SymbolRepresentation &symbol : task->getSymbolInfo()) {
+		if (symbol.allocationPinned) {
+			symbol.allocation->unpin();
+			symbol.allocationPinned = false;
+		}
+	}
 }
 
 //SYMBOL PROCESSING
@@ -207,17 +280,154 @@ void DeviceDirectory::processSymbolRegions(const int handle, void* copy_extra, A
 
 //ALLOCATIONS
 
-std::shared_ptr<DeviceAllocation> DeviceDirectory::getNewAllocation(const int handle, const SymbolRepresentation &symbol)
+//Whether the entry holds data that is only valid in the allocation of the handle
+static inline bool needsWriteBack(const int handle, const DirectoryEntry &entry)
+{
+	return entry.isValid(handle) && !entry.isValid(SMP_HANDLER) && entry.getFirstValidLocation(handle) == SMP_HANDLER;
+}
+
+void DeviceDirectory::touchAllocation(const int handle, const std::shared_ptr<DeviceAllocation> &allocation)
+{
+	if (handle == SMP_HANDLER)
+		return;
+
+	std::list<std::weak_ptr<DeviceAllocation>> &lru = _lruAllocations[handle];
+	if (allocation->_lruTracked) {
+		lru.splice(lru.end(), lru, allocation->_lruPosition);
+		return;
+	}
+
+	//Remove the nodes of freed allocations once the list doubles its size, so it does not
+	//grow unbounded when the device never runs out of memory
+	if (lru.size() >= 2 * _lruPrunedSize[handle] + 64) {
+		lru.remove_if([](const std::weak_ptr<DeviceAllocation> &node) { return node.expired(); });
+		_lruPrunedSize[handle] = lru.size();
+	}
+
+	allocation->_lruPosition = lru.insert(lru.end(), allocation);
+	allocation->_lruTracked = true;
+}
+
+size_t DeviceDirectory::evictAllocations(const int handle, size_t size, bool evictDirty, AcceleratorStream* acceleratorStream, void* copy_extra)
+{
+	const auto isTouchable = [&](const std::shared_ptr<DeviceAllocation> &allocation) {
+		for (const auto &untouchable : _symbol_allocations)
+			if (untouchable == allocation) return false;
+		return true;
+	};
+
+	std::list<std::weak_ptr<DeviceAllocation>> &lru = _lruAllocations[handle];
+	size_t evicted = 0;
+
+	auto it = lru.begin();
+	while (it != lru.end() && evicted < size) {
+		std::shared_ptr<DeviceAllocation> allocation = it->lock();
+		if (allocation == nullptr) {
+			it = lru.erase(it);
+			continue;
+		}
+
+		if (!isTouchable(allocation) || allocation->isPinned()) {
+			++it;
+			continue;
+		}
+
+		//Allocations receiving a copy cannot be evicted until the copy completes
+		bool pending = false;
+		bool dirty = false;
+		_dirMap.applyToRange(allocation->getHostRegion(), [&](DirectoryEntry *entry) {
+			if (entry->getDeviceAllocation(handle) == allocation) {
+				pending = pending || entry->isPending(handle);
+				dirty = dirty || needsWriteBack(handle, *entry);
+			}
+			return true;
+		});
+
+		if (pending || (dirty && !evictDirty)) {
+			++it;
+			continue;
+		}
+
+		if (!dirty) {
+			_dirMap.applyToRange(allocation->getHostRegion(), [&](DirectoryEntry *entry) {
+				if (entry->getDeviceAllocation(handle) == allocation)
+					entry->clearDeviceAllocation(handle);
+				return true;
+			});
+		} else {
+			//Write back the data that is only valid in the device. The entries keep pointing to the
+			//allocation, which stays valid for readers until the copies complete, but it is not reused
+			//by new tasks of the device. Entries that were not overwritten meanwhile become valid in
+			//the host when the copies end, and the allocation is released
+			_dirMap.applyToRange(allocation->getHostRegion(), [&](DirectoryEntry *entry) {
+				if (entry->getDeviceAllocation(handle) == allocation && needsWriteBack(handle, *entry)) {
+					generateCopy(acceleratorStream, *entry, SMP_HANDLER, copy_extra);
+					if (entry->isModified(handle))
+						entry->setModified(NO_DEVICE);
+				}
+				return true;
+			});
+			allocation->setEvicting();
+
+			acceleratorStream->addOperation([itvMap = &_dirMap, allocation, handle]
+			{
+				itvMap->applyToRange(allocation->getHostRegion(), [&](DirectoryEntry *dirEntry) {
+					if (dirEntry->getDeviceAllocation(handle) == allocation) {
+						if (dirEntry->isValid(handle))
+							dirEntry->setValid(SMP_HANDLER);
+						dirEntry->clearDeviceAllocation(handle);
+					}
+					return true;
+				});
+				return true;
+			});
+			++_allocationStatistics[handle]._writeBacks;
+		}
+
+		allocation->_lruTracked = false;
+		it = lru.erase(it);
+
+		evicted += allocation->getSize();
+		++_allocationStatistics[handle]._evictions;
+	}
+
+	return evicted;
+}
+
+std::shared_ptr<DeviceAllocation> DeviceDirectory::getNewAllocation(const int handle, AcceleratorStream* acceleratorStream, void* copy_extra, const SymbolRepresentation &symbol)
 {
 	std::pair<std::shared_ptr<DeviceAllocation>, bool> deviceAllocation = _accelerators[handle]->createNewDeviceAllocation(symbol.getHostRegion());
 
+	//Evict the least recently used clean allocations first, which can be dropped without copies,
+	//and then the ones that must be written back to the host
+	for (int evictDirty = 0; !deviceAllocation.second && evictDirty < 2; ++evictDirty) {
+		while (!deviceAllocation.second) {
+			const size_t evicted = evictAllocations(handle, symbol.getHostRegion().getSize(), evictDirty, acceleratorStream, copy_extra);
+			if (evicted == 0)
+				break;
+
+			deviceAllocation = _accelerators[handle]->createNewDeviceAllocation(symbol.getHostRegion());
+		}
+	}
+
 	if (!deviceAllocation.second) {
-		_dirMap.freeAllocationsForHandle(handle, _symbol_allocations);
-		deviceAllocation = _accelerators[handle]->createNewDeviceAllocation(symbol.getHostRegion());
+		//The evicted dirty allocations are released once their write-backs complete, and the pinned ones once
+		//their tasks finish. If anything other than the allocations of this task is still allocated, the
+		//registration is retried later. Otherwise, the allocation will never fit
+		size_t ownBytes = 0;
+		for (auto it = _symbol_allocations.begin(); it != _symbol_allocations.end(); ++it) {
+			if (*it != nullptr && std::find(_symbol_allocations.begin(), it, *it) == it)
+				ownBytes += (*it)->getSize();
+		}
 
-		FatalErrorHandler::failIf(!deviceAllocation.second, "Device Allocation: Out of space in device memory after already trying to free unused memory");
+		FatalErrorHandler::failIf(_accelerators[handle]->getDirectoryAllocatedBytes() <= ownBytes,
+			"Device Allocation: Out of space in device memory after already trying to free unused memory");
+		return nullptr;
 	}
 
+	++_allocationStatistics[handle]._misses;
+	touchAllocation(handle, deviceAllocation.first);
+
 	_dirMap.addRange(deviceAllocation.first->getHostRegion());
 
 	_dirMap.applyToRange(deviceAllocation.first->getHostRegion(), [=, &deviceAllocation](DirectoryEntry *entry) {
@@ -229,7 +439,7 @@ std::shared_ptr<DeviceAllocation> DeviceDirectory::getNewAllocation(const int ha
 	return deviceAllocation.first;
 }
 
-std::shared_ptr<DeviceAllocation> DeviceDirectory::getDeviceAllocation(const int handle, const SymbolRepresentation &symbol)
+std::shared_ptr<DeviceAllocation> DeviceDirectory::getDeviceAllocation(const int handle, AcceleratorStream* acceleratorStream, void* copy_extra, const SymbolRepresentation &symbol)
 {
 	_dirMap.addRange(symbol.getHostRegion());
 
@@ -237,7 +447,7 @@ std::shared_ptr<DeviceAllocation> DeviceDirectory::getDeviceAllocation(const int
 	auto iter = _dirMap.getIterator(host_region);
 	std::shared_ptr<DeviceAllocation> deviceAllocation = iter->second->getDeviceAllocation(handle);
 
-	if (deviceAllocation != nullptr) {
+	if (deviceAllocation != nullptr && !deviceAllocation->isEvicting()) {
 		const auto symbol_end_address = (uintptr_t)symbol.getEndAddress();
 		const auto checkIfRegionIsAllocated = [=](DirectoryEntry *entry)
 		{
@@ -249,11 +459,14 @@ std::shared_ptr<DeviceAllocation> DeviceDirectory::getDeviceAllocation(const int
 			return true;
 		};
 		const bool allocated = _dirMap.applyToRange(symbol.getHostRegion(), checkIfRegionIsAllocated);
-		if (allocated)
+		if (allocated) {
+			++_allocationStatistics[handle]._hits;
+			touchAllocation(handle, deviceAllocation);
 			return deviceAllocation;
+		}
 	}
 
-	return getNewAllocation(handle, symbol);
+	return getNewAllocation(handle, acceleratorStream, copy_extra, symbol);
 }
 
 //Inner Symbols
@@ -343,7 +556,10 @@ void DeviceDirectory::processSymbolRegions_in(const int handle, void* copy_extra
 void DeviceDirectory::processRegionWithOldAllocation(const int handle, void* copy_extra, AcceleratorStream* acceleratorStream, DirectoryEntry &entry, std::shared_ptr<DeviceAllocation> region, DataAccessType type)
 {
 	if (entry.getDeviceAllocation(handle) != region && handle != SMP_HANDLER) {
-		if (entry.getModifiedLocation() == handle && type != WRITE_ACCESS_TYPE) {
+		//The data of an allocation being evicted may still be only valid there, so it is copied back
+		//to the host in this stream as well before copying it to the new allocation
+		const bool evicting = entry.getDeviceAllocation(handle) != nullptr && entry.getDeviceAllocation(handle)->isEvicting() && entry.isValid(handle);
+		if ((entry.getModifiedLocation() == handle || evicting) && type != WRITE_ACCESS_TYPE) {
 			//std::cout<<"WARNING: RESIZING ENTRY TO FIT SYMBOL[!]!"<<std::endl;
 			generateCopy(acceleratorStream, entry, SMP_HANDLER, copy_extra);
 			acceleratorStream->addOperation([keepalive = entry.getDeviceAllocation(handle)]{ std::ignore = keepalive; return true;});
@@ -426,6 +642,9 @@ void DeviceDirectory::taskwait(const DataAccessRegion &taskwaitRegion, std::func
 
 DeviceDirectory::~DeviceDirectory()
 {
+	if (ConfigVariable<bool>("devices.directory_stats"))
+		printAllocationStatistics();
+
 	for(size_t i = 1; i < _accelerators.size(); ++i)
 		_dirMap.freeAllocationsForHandle(i, {});
 }
@@ -469,6 +688,23 @@ void DeviceDirectory::print()
 	std::for_each(std::begin(_dirMap._inner_m),std::end(_dirMap._inner_m),printEntry);
 
 	printf("END OF DIR\n\n");
+
+	printAllocationStatistics();
+}
+
+DeviceDirectory::AllocationStatistics DeviceDirectory::getAllocationStatistics(const int handle)
+{
+	std::lock_guard<std::mutex> guard(_device_directory_mutex);
+	return _allocationStatistics[handle];
+}
+
+void DeviceDirectory::printAllocationStatistics()
+{
+	for (size_t i = 1; i < _accelerators.size(); ++i) {
+		const AllocationStatistics statistics = getAllocationStatistics(i);
+		printf("Device directory handle %lu: %lu hits, %lu misses, %lu evictions, %lu write-backs\n",
+			i, statistics._hits, statistics._misses, statistics._evictions, statistics._writeBacks);
+	}
 }
 
 void DeviceDirectory::initializeTaskwaitService()
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 #ifndef DEVICE_DIRECTORY_HPP
 #define DEVICE_DIRECTORY_HPP
@@ -10,6 +10,7 @@
 #include <hardware/device/AcceleratorStreamThreadSafe.hpp>
 #include <hardware/device/directory/IntervalMap.hpp>
 #include <functional>
+#include <list>
 #include <mutex>
 #include <vector>
 #include <memory>
@@ -27,6 +28,19 @@ struct SymbolRepresentation;
 
 class DeviceDirectory
 {
+public:
+	//! Counters of the allocations of a device
+	struct AllocationStatistics {
+		size_t _hits;
+		size_t _misses;
+		size_t _evictions;
+		size_t _writeBacks;
+
+		AllocationStatistics() : _hits(0), _misses(0), _evictions(0), _writeBacks(0)
+		{
+		}
+	};
+
 private:
 	std::mutex _device_directory_mutex;
 
@@ -37,6 +51,17 @@ private:
 
 	IntervalMap _dirMap;
 
+	//Allocations of each device, from the least to the most recently used. The nodes of
+	//allocations that have been freed are removed lazily
+	std::vector<std::list<std::weak_ptr<DeviceAllocation>>> _lruAllocations;
+	//Size of each LRU list after removing its freed allocations for the last time
+	std::vector<size_t> _lruPrunedSize;
+
+	std::vector<AllocationStatistics> _allocationStatistics;
+
+	//Size of the chunks of the copies staged in host memory
+	size_t _stagingChunkSize;
+
 	AcceleratorStreamThreadSafe _taskwaitStream;
 	std::atomic<bool> _stopService;
 	std::atomic<bool> _finishedService;
@@ -54,10 +79,14 @@ public:
 
 	//This function tries to register the task dependences in the directory.
 	//As a parameter it accepts the task which dependences are going to be registered, and two steps that will be used for synchronization
-	//This function can fail if there is no space for allocation in the device. In this case, the user is responsible of calling the free
-	//memory function.
+	//This function fails if there is no space for allocation in the device until the running tasks or the write-backs of the evicted
+	//allocations finish. In this case it returns false, and the registration must be retried later.
+	//The allocations of a device task are pinned, so they are not evicted while the task runs, until unpin_regions is called.
 	bool register_regions(Task *task);
-	bool register_regions(std::vector<SymbolRepresentation>& symbolInfo, Accelerator* accelerator, AcceleratorStream* acceleratorStream, void* copy_extra);
+	bool register_regions(std::vector<SymbolRepresentation>& symbolInfo, Accelerator* accelerator, AcceleratorStream* acceleratorStream, void* copy_extra, bool pinAllocations = false);
+
+	//This function unpins the allocations of a device task registered with register_regions, once the task has finished running.
+	void unpin_regions(Task *task);
 
 	//This function registers an accelerator to the directory.
 	//Each accelerator is defined by it's address space, if more than one accelerator share
@@ -81,6 +110,11 @@ public:
 
 	IntervalMap* getIntervalMap();
 
+	//returns the allocation counters of the device with the given directory handle
+	AllocationStatistics getAllocationStatistics(const int handle);
+
+	void printAllocationStatistics();
+
 private:
 
 	inline bool shouldStopService() const;
@@ -89,6 +123,11 @@ private:
 	//interaction between the devices.
 	void generateCopy(AcceleratorStream* acceleratorStream, const DirectoryEntry &entry, int dstHandle, void* copy_extra);
 
+	//This function makes a copy between two devices that cannot copy it directly, through the host address of the data.
+	//The copy is split in chunks, and the copy of each chunk into the destination overlaps with the copy of the next
+	//chunk from the source. The returned operation finishes when all chunks are in the destination.
+	std::function<std::function<bool(void)>()> generateStagedCopy(Accelerator *srcA, uintptr_t srcAddr, Accelerator *dstA, uintptr_t dstAddr, uintptr_t hostAddr, size_t size, void* copy_extra);
+
 	//This function forwards to processSymbolRegions the task dependences of each type
 	void processSymbol(const int handle, void *copy_extra, AcceleratorStream* acceleratorStream, SymbolRepresentation &symbol, std::shared_ptr<DeviceAllocation> deviceAllocation);
 	//This function checks for old allocations or the necessity of a reallocation, after forwards each region of the symbol
@@ -105,10 +144,22 @@ private:
 
 	//This function gets the current allocation for a symbol range. In case it doesn't exists or it's not enough to
 	//contain the new symbol, it tries to allocate a new device address.
-	std::shared_ptr<DeviceAllocation> getDeviceAllocation(const int handle, const SymbolRepresentation &symbol);
-
-	//This function allocates a new device address for a directory range.
-	std::shared_ptr<DeviceAllocation> getNewAllocation(const int handle, const SymbolRepresentation &symbol);
+	std::shared_ptr<DeviceAllocation> getDeviceAllocation(const int handle, AcceleratorStream* acceleratorStream, void* copy_extra, const SymbolRepresentation &symbol);
+
+	//This function allocates a new device address for a directory range. If the device is out of memory, it evicts
+	//the least recently used allocations of the device until the new one fits. If the evicted allocations are still
+	//being written back, or the rest of the memory is used by running tasks, it returns nullptr.
+	std::shared_ptr<DeviceAllocation> getNewAllocation(const int handle, AcceleratorStream* acceleratorStream, void* copy_extra, const SymbolRepresentation &symbol);
+
+	//Marks an allocation as the most recently used of its device
+	void touchAllocation(const int handle, const std::shared_ptr<DeviceAllocation> &allocation);
+
+	//Evicts the least recently used allocations of a device that are neither used by the task being registered nor
+	//pinned by running tasks, until
+	//at least "size" bytes are released. Clean allocations are dropped right away. If evictDirty is true, allocations
+	//holding the only valid copy of some data are also evicted, writing the data back to the host asynchronously
+	//in the acceleratorStream. Returns the number of bytes evicted.
+	size_t evictAllocations(const int handle, size_t size, bool evictDirty, AcceleratorStream* acceleratorStream, void* copy_extra);
 
 
 	//Since two tasks could want to use the same symbol or region, we must ensure that the copy is done only one time.
@@ -1,22 +1,24 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "FPGAAccelerator.hpp"
+#include "FPGAArguments.hpp"
 #include "../directory/DeviceDirectory.hpp"
 #include "hardware/places/ComputePlace.hpp"
 #include "hardware/places/MemoryPlace.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/BlockingAPI.hpp"
+#include "tasks/TaskInfoManager.hpp"
 #include "InstrumentFPGAEvents.hpp"
 
 #include <DataAccessRegistration.hpp>
 #include <DataAccessRegistrationImplementation.hpp>
 #include "lowlevel/FatalErrorHandler.hpp"
 
-std::unordered_map<const nanos6_task_implementation_info_t*, uint64_t> FPGAAccelerator::_device_subtype_map;
+std::atomic<size_t> FPGAAccelerator::_numDeviceTaskTypes(0);
 
 FPGAAccelerator::FPGAAccelerator(int fpgaDeviceIndex) :
 	Accelerator(fpgaDeviceIndex,
@@ -41,6 +43,8 @@ FPGAAccelerator::FPGAAccelerator(int fpgaDeviceIndex) :
 		FatalErrorHandler::fail("Config value", memSyncString, " is not valid for devices.fpga.mem_sync_type");
 	}
 
+	_lookaheadDepth = ConfigVariable<size_t>("devices.fpga.lookahead");
+
 	size_t handlesCount=0;
 	accCount = 0;
 
@@ -82,8 +86,7 @@ FPGAAccelerator::~FPGAAccelerator() {
 		delete acceleratorInstrumentationServices;
 }
 
-inline void FPGAAccelerator::generateDeviceEvironment(DeviceEnvironment& env, const nanos6_task_implementation_info_t* task_implementation) {
-	uint64_t deviceSubtype = _device_subtype_map[task_implementation];
+inline void FPGAAccelerator::generateDeviceEvironment(DeviceEnvironment& env, uint64_t deviceSubtype) {
 #ifndef NDEBUG
 	FatalErrorHandler::failIf(
 		_inner_accelerators.find(deviceSubtype) == _inner_accelerators.end(),
@@ -110,30 +113,32 @@ void FPGAAccelerator::postRunTask(Task *)
 {
 }
 
-void FPGAAccelerator::submitDevice(const DeviceEnvironment &deviceEnvironment, const void* args, const nanos6_task_info_t* taskInfo, const nanos6_address_translation_entry_t* translationTable) const {
-	int numArgs = taskInfo->num_args;
-	int numSymbols = taskInfo->num_symbols;
-	xtasks_arg_val fpga_args[16]; //Current max supported number of arguments
-	assert (numArgs <= 16);
-	memset(fpga_args, 0, sizeof(fpga_args));
-	for (int i = 0; i < numArgs; ++i) {
-		assert (taskInfo->sizeof_table[i] <= (int)sizeof(xtasks_arg_val));
-		char* p = (char*)args + taskInfo->offset_table[i];
-		memcpy(fpga_args + i, p, taskInfo->sizeof_table[i]);
-	}
-	for (int i = 0; i < numSymbols; ++i) {
-		int arg = taskInfo->arg_idx_table[i];
-		uint64_t host_addr = translationTable[i].local_address;
-		uint64_t fpga_addr = translationTable[i].device_address;
-		fpga_args[arg] = fpga_args[arg] - host_addr + fpga_addr;
-	}
-	xtasksAddArgs(numArgs, 0xFF, fpga_args, deviceEnvironment.fpga.taskHandle);
+template <typename TranslationFunction>
+void FPGAAccelerator::submitTask(xtasks_task_handle taskHandle, const void *args, const nanos6_task_info_t *taskInfo, TranslationFunction getTranslation) const
+{
+	// The layout of the arguments is computed once per task type
+	const TaskInfoData *taskInfoData = (const TaskInfoData *) taskInfo->task_type_data;
+	assert(taskInfoData != nullptr);
+	const std::vector<TaskInfoData::DeviceArgument> &deviceArgs = taskInfoData->getDeviceArguments();
+	assert(deviceArgs.size() == (size_t) taskInfo->num_args);
+
+	std::vector<xtasks_arg_val> &fpgaArgs = FPGAArguments::marshal(args, deviceArgs, getTranslation);
+
+	xtasksAddArgs(fpgaArgs.size(), 0xFF, fpgaArgs.data(), taskHandle);
 	FatalErrorHandler::failIf(
-		xtasksSubmitTask(deviceEnvironment.fpga.taskHandle) != XTASKS_SUCCESS,
+		xtasksSubmitTask(taskHandle) != XTASKS_SUCCESS,
 		"Xtasks: Submit Task failed"
 	);
 }
 
+void FPGAAccelerator::submitDevice(const DeviceEnvironment &deviceEnvironment, const void* args, const nanos6_task_info_t* taskInfo, const nanos6_address_translation_entry_t* translationTable) const {
+	submitTask(deviceEnvironment.fpga.taskHandle, args, taskInfo,
+		[translationTable](int symbol) -> xtasks_arg_val {
+			return translationTable[symbol].device_address - translationTable[symbol].local_address;
+		}
+	);
+}
+
 inline std::function<bool()> FPGAAccelerator::getDeviceSubmissionFinished(const DeviceEnvironment& deviceEnvironment) const {
 	return [&] () -> bool {
 		xtasks_task_handle hand;
@@ -156,49 +161,39 @@ void FPGAAccelerator::callBody(Task *task)
 		task->getAcceleratorStream()->addOperation(
 			[this, task, env = &task->getDeviceEnvironment(), handler = getDeviceHandler()]() -> std::function<bool(void)>
 			{
-				void *args = task->getArgsBlock();
-				nanos6_task_info_t *taskInfo = task->getTaskInfo();
 				const std::vector<SymbolRepresentation>& symbolInfo = task->getSymbolInfo();
-				int numArgs = taskInfo->num_args;
-				int numSymbols = taskInfo->num_symbols;
-				const xtasks_task_handle handle = task->getDeviceEnvironment().fpga.taskHandle;
-				xtasks_arg_val fpga_args[16]; //Current max supported number of arguments
-				assert (numArgs <= 16);
-
-				memset(fpga_args, 0, sizeof(fpga_args));
-				for (int i = 0; i < numArgs; ++i) {
-					assert (taskInfo->sizeof_table[i] <= (int)sizeof(xtasks_arg_val));
-					char* p = (char*)args + taskInfo->offset_table[i];
-					memcpy(fpga_args + i, p, taskInfo->sizeof_table[i]);
-				}
-
-				for (int i = 0; i < numSymbols; ++i) {
-					int arg = taskInfo->arg_idx_table[i];
-					uint64_t host_addr = symbolInfo[i].allocation->getHostBase();
-					uint64_t fpga_addr = symbolInfo[i].allocation->getDeviceBase();
-					fpga_args[arg] = fpga_args[arg] - host_addr + fpga_addr;
-				}
-
-				xtasksAddArgs(numArgs, 0xFF, fpga_args, handle);
-
-				FatalErrorHandler::failIf(
-					xtasksSubmitTask(handle) != XTASKS_SUCCESS,
-					"Xtasks: Submit Task failed"
+				submitTask(env->fpga.taskHandle, task->getArgsBlock(), task->getTaskInfo(),
+					[&symbolInfo](int symbol) -> xtasks_arg_val {
+						return symbolInfo[symbol].allocation->getDeviceBase() - symbolInfo[symbol].allocation->getHostBase();
+					}
 				);
+				Instrument::fpgaTaskSubmitted(task->getInstrumentationTaskId());
 
-				return getDeviceSubmissionFinished(*env);
+				std::function<bool()> finished = getDeviceSubmissionFinished(*env);
+				return [finished, task]() -> bool {
+					if (!finished())
+						return false;
+
+					Instrument::fpgaTaskFinished(task->getInstrumentationTaskId());
+					return true;
+				};
 			}
 		);
     }
     else FatalErrorHandler::fail("Can't use FPGA Tasks without the directory");
 }
 
-void FPGAAccelerator::preRunTask(Task *task)
+bool FPGAAccelerator::preRunTask(Task *task)
 {
-	if (DeviceDirectoryInstance::useDirectory)
-		DeviceDirectoryInstance::instance->register_regions(task);
-	else
+	if (!DeviceDirectoryInstance::useDirectory)
 		FatalErrorHandler::fail("Can't use FPGA Tasks without the directory");
+
+	if (!DeviceDirectoryInstance::instance->register_regions(task)) {
+		// The task gets a new xtasks task when it is launched again
+		xtasksDeleteTask((xtasks_task_handle *) &task->getDeviceEnvironment().fpga.taskHandle);
+		return false;
+	}
+	return true;
 }
 
 std::function<std::function<bool(void)>()> FPGAAccelerator::copy_in(void *dst, void *src, size_t size, [[maybe_unused]]  void *task) const
@@ -310,6 +305,14 @@ std::function<std::function<bool(void)>()> FPGAAccelerator::copy_out(void *dst,
 	}
 }
 
+//the copies between FPGAs are done by the send and receive kernels, which must be in the bitstream
+bool FPGAAccelerator::canCopyBetween(const Accelerator *other) const
+{
+	return other->getDeviceType() == nanos6_fpga_device
+		&& _inner_accelerators.find(SEND_KERNEL_SUBTYPE) != _inner_accelerators.end()
+		&& _inner_accelerators.find(RECV_KERNEL_SUBTYPE) != _inner_accelerators.end();
+}
+
 //this functions performs a copy from two accelerators that can share their data without the host intervention
 std::function<std::function<bool(void)>()> FPGAAccelerator::copy_between(
 	void *dst,
@@ -319,8 +322,8 @@ std::function<std::function<bool(void)>()> FPGAAccelerator::copy_between(
 	size_t size,
 	[[maybe_unused]] void *task) const
 {
-	xtasks_acc_handle sendHandle = (xtasks_acc_handle)(((uintptr_t)_inner_accelerators.find(4294967299)->second.getHandle(0) & 0xFFFFFFFF00000000l) | srcDevice);
-	xtasks_acc_handle recvHandle = (xtasks_acc_handle)(((uintptr_t)_inner_accelerators.find(4294967300)->second.getHandle(0) & 0xFFFFFFFF00000000l) | dstDevice);
+	xtasks_acc_handle sendHandle = (xtasks_acc_handle)(((uintptr_t)_inner_accelerators.find(SEND_KERNEL_SUBTYPE)->second.getHandle(0) & 0xFFFFFFFF00000000l) | srcDevice);
+	xtasks_acc_handle recvHandle = (xtasks_acc_handle)(((uintptr_t)_inner_accelerators.find(RECV_KERNEL_SUBTYPE)->second.getHandle(0) & 0xFFFFFFFF00000000l) | dstDevice);
 	return [=]() -> std::function<bool(void)>
 	{
 		nanos6_fpga_device_environment_t* env = new nanos6_fpga_device_environment_t[2];
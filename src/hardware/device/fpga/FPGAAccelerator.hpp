@@ -1,12 +1,13 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef FPGA_ACCELERATOR_HPP
 #define FPGA_ACCELERATOR_HPP
 
+#include <atomic>
 #include <list>
 #include "support/config/ConfigVariable.hpp"
 
@@ -44,13 +45,27 @@ private:
 
 	std::unordered_map<uint64_t, _fpgaAccel> _inner_accelerators;
 
+	//! The subtypes of the kernels that send and receive data between FPGAs
+	static constexpr uint64_t SEND_KERNEL_SUBTYPE = 4294967299;
+	static constexpr uint64_t RECV_KERNEL_SUBTYPE = 4294967300;
+
+	//! \brief Marshal the arguments of a task and submit it
+	//!
+	//! \param[in] taskHandle The xtasks handle of the task
+	//! \param[in] args The args block of the task
+	//! \param[in] taskInfo The task info of the task
+	//! \param[in] getTranslation A function that returns the offset from the
+	//! host address to the device address of a symbol
+	template <typename TranslationFunction>
+	void submitTask(xtasks_task_handle taskHandle, const void *args, const nanos6_task_info_t *taskInfo, TranslationFunction getTranslation) const;
+
 	void submitDevice(const DeviceEnvironment &deviceEnvironment, const void* args, const nanos6_task_info_t* taskInfo, const nanos6_address_translation_entry_t* translationTable) const override;
 	std::function<bool()> getDeviceSubmissionFinished(const DeviceEnvironment& deviceEnvironment) const override;
-	inline void generateDeviceEvironment(DeviceEnvironment&, const nanos6_task_implementation_info_t*) override;
+	inline void generateDeviceEvironment(DeviceEnvironment&, uint64_t deviceSubtype) override;
 
 	inline void finishTaskCleanup([[maybe_unused]] Task *task) override{}
 
-	void preRunTask(Task *task) override;
+	bool preRunTask(Task *task) override;
 
 	void callBody(Task *task) override;
 
@@ -58,7 +73,8 @@ private:
 
 public:
 
-	static std::unordered_map<const nanos6_task_implementation_info_t*, uint64_t> _device_subtype_map;
+	//! Number of registered task types that run on FPGAs
+	static std::atomic<size_t> _numDeviceTaskTypes;
 
 	FPGAAccelerator(int fpgaDeviceIndex);
 	~FPGAAccelerator() override;
@@ -99,6 +115,7 @@ public:
 	std::function<std::function<bool(void)>()> copy_in(void *dst, void *src, size_t size, void* copy_extra) const override;
 	std::function<std::function<bool(void)>()> copy_out(void *dst, void *src, size_t size, void* copy_extra) const override;
 	std::function<std::function<bool(void)>()> copy_between(void *dst, int dstDevice, void *src, int srcDevice, size_t size, void* copy_extra) const override;
+	bool canCopyBetween(const Accelerator *other) const override;
 };
 
 #endif // FPGA_ACCELERATOR_HPP
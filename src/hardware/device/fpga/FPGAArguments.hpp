@@ -0,0 +1,84 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef FPGA_ARGUMENTS_HPP
+#define FPGA_ARGUMENTS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <libxtasks.h>
+
+// This header only depends on libxtasks, so that the marshalling of the
+// arguments can be built and measured outside the runtime
+
+namespace FPGAArguments {
+
+	//! \brief Load an argument zero-extended to an xtasks value
+	//!
+	//! The usual sizes are loaded with fixed-width copies, which are inlined,
+	//! instead of a memcpy call
+	inline xtasks_arg_val loadArgument(const char *address, size_t size)
+	{
+		switch (size) {
+			case sizeof(uint64_t): {
+				uint64_t value;
+				memcpy(&value, address, sizeof(value));
+				return value;
+			}
+			case sizeof(uint32_t): {
+				uint32_t value;
+				memcpy(&value, address, sizeof(value));
+				return value;
+			}
+			case sizeof(uint16_t): {
+				uint16_t value;
+				memcpy(&value, address, sizeof(value));
+				return value;
+			}
+			case sizeof(uint8_t):
+				return *(const uint8_t *) address;
+			default: {
+				xtasks_arg_val value = 0;
+				memcpy(&value, address, size);
+				return value;
+			}
+		}
+	}
+
+	//! \brief Marshal the arguments of an FPGA task as xtasks values
+	//!
+	//! \param[in] args The args block of the task
+	//! \param[in] deviceArgs The layout of the arguments, whose elements have
+	//! the _offset and _size of the argument in the args block and the _symbol
+	//! it points to, or a negative value if it is not a pointer to a symbol
+	//! \param[in] getTranslation Returns the displacement from the host to the
+	//! device address of a symbol
+	//!
+	//! \returns The values of the arguments, in a buffer of the calling thread
+	//! that is reused across calls, since xtasks copies them when added
+	template <typename DeviceArgumentList, typename TranslationFunction>
+	inline std::vector<xtasks_arg_val> &marshal(
+		const void *args,
+		const DeviceArgumentList &deviceArgs,
+		TranslationFunction getTranslation
+	) {
+		static thread_local std::vector<xtasks_arg_val> fpgaArgs;
+		fpgaArgs.resize(deviceArgs.size());
+
+		for (size_t i = 0; i < deviceArgs.size(); ++i) {
+			const auto &deviceArg = deviceArgs[i];
+			fpgaArgs[i] = loadArgument((const char *) args + deviceArg._offset, deviceArg._size);
+			if (deviceArg._symbol >= 0) {
+				fpgaArgs[i] += getTranslation(deviceArg._symbol);
+			}
+		}
+		return fpgaArgs;
+	}
+}
+
+#endif // FPGA_ARGUMENTS_HPP
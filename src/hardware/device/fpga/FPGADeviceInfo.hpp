@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef FPGA_DEVICE_INFO_HPP
@@ -22,7 +22,7 @@ public:
 		_deviceInitialized = false;
 		_deviceCount = 0;
 		// There are no FPGA tasks in the application
-		if (FPGAAccelerator::_device_subtype_map.size() == 0)
+		if (FPGAAccelerator::_numDeviceTaskTypes == 0)
 			return;
 
 		FatalErrorHandler::failIf(
@@ -1,12 +1,22 @@
 #include "FPGAReverseOffload.hpp"
 #include "system/SpawnFunction.hpp"
 #include "system/BlockingAPI.hpp"
+#include "tasks/TaskInfoManager.hpp"
 #include <libxtasks.h>
 #include <assert.h>
+#include <cstring>
+#include <mutex>
 #include <vector>
 #include "InstrumentFPGAEvents.hpp"
 
 std::unordered_map<uint64_t, const nanos6_task_info_t*> FPGAReverseOffload::_reverseMap;
+SpinLock FPGAReverseOffload::_reverseMapLock;
+
+void FPGAReverseOffload::registerReverseTaskInfo(uint64_t subtype, const nanos6_task_info_t *taskInfo) {
+	// Task infos may be registered from several threads
+	std::lock_guard<SpinLock> guard(_reverseMapLock);
+	_reverseMap[subtype] = taskInfo;
+}
 
 void FPGAReverseOffload::serviceFunction(void *data)
 {
@@ -39,10 +49,169 @@ void FPGAReverseOffload::initializeService() {
 void FPGAReverseOffload::shutdownService() {
 	_stopService = true;
 	while (!_finishedService);
+
+	// Wait for the tasks of the requests already submitted
+	while (_pendingRequests > 0);
+
+	// Release the recycled buffers
+	std::lock_guard<SpinLock> guard(_bufferPoolLock);
+	for (size_t sizeClass = 0; sizeClass < _bufferPool.size(); ++sizeClass) {
+		for (void *buffer : _bufferPool[sizeClass]) {
+			MemoryAllocator::free(buffer, (size_t) 1 << sizeClass);
+		}
+		_bufferPool[sizeClass].clear();
+	}
+}
+
+void *FPGAReverseOffload::allocateBuffer(size_t size) {
+	size_t sizeClass = getSizeClass(size);
+	{
+		std::lock_guard<SpinLock> guard(_bufferPoolLock);
+		if (sizeClass < _bufferPool.size() && !_bufferPool[sizeClass].empty()) {
+			void *buffer = _bufferPool[sizeClass].back();
+			_bufferPool[sizeClass].pop_back();
+			return buffer;
+		}
+	}
+	return MemoryAllocator::alloc((size_t) 1 << sizeClass);
+}
+
+void FPGAReverseOffload::freeBuffer(void *buffer, size_t size) {
+	size_t sizeClass = getSizeClass(size);
+	size_t bufferSize = (size_t) 1 << sizeClass;
+
+	// Keep the buffer only while the pool of its size class stays within the
+	// cap, so large copies do not hold their memory for the rest of the run
+	if (bufferSize <= MAX_POOLED_BYTES_PER_CLASS) {
+		std::lock_guard<SpinLock> guard(_bufferPoolLock);
+		if (sizeClass >= _bufferPool.size())
+			_bufferPool.resize(sizeClass + 1);
+		if ((_bufferPool[sizeClass].size() + 1) * bufferSize <= MAX_POOLED_BYTES_PER_CLASS) {
+			_bufferPool[sizeClass].push_back(buffer);
+			return;
+		}
+	}
+
+	MemoryAllocator::free(buffer, bufferSize);
+}
+
+const FPGAReverseOffload::RequestType &FPGAReverseOffload::getRequestType(uint64_t subtype) {
+	auto cached = _requestTypes.find(subtype);
+	if (cached != _requestTypes.end())
+		return cached->second;
+
+	_reverseMapLock.lock();
+	std::unordered_map<uint64_t, const nanos6_task_info_t*>::const_iterator it = _reverseMap.find(subtype);
+	FatalErrorHandler::failIf(
+		it == _reverseMap.end(),
+		"Device subtype ", subtype, " not found in reverse map"
+	);
+	const nanos6_task_info_t* task_info = it->second;
+	_reverseMapLock.unlock();
+
+	RequestType &type = _requestTypes[subtype];
+	type._taskInfo = task_info;
+	type._argsBlockSize = ((const TaskInfoData *) task_info->task_type_data)->getPackedArgsSize();
+
+	// Each task type of reverse offloaded requests gets its own spawned
+	// task info, so they are scheduled, monitored and instrumented apart
+	type._label = task_info->implementations[0].task_type_label;
+	if (type._label == nullptr)
+		type._label = "FPGA reverse offload";
+
+	return type;
+}
+
+void FPGAReverseOffload::submitRequest(xtasks_newtask *xtasksTask) {
+	const RequestType &type = getRequestType(xtasksTask->typeInfo);
+
+	Request *request = (Request *) allocateBuffer(sizeof(Request));
+	request->_service = this;
+	request->_xtasksTask = xtasksTask;
+	request->_taskInfo = type._taskInfo;
+	request->_argsBlockSize = type._argsBlockSize;
+	request->_argsBlock = allocateBuffer(request->_argsBlockSize);
+
+	++_pendingRequests;
+	SpawnFunction::spawnFunction(
+				requestBody, request,
+				requestCompleted, request,
+				type._label, false
+				);
+}
+
+void FPGAReverseOffload::requestBody(void *data) {
+	Request *request = (Request *)data;
+	assert(request != nullptr);
+
+	FPGAReverseOffload *service = request->_service;
+	xtasks_newtask *xtasks_task = request->_xtasksTask;
+	const nanos6_task_info_t* task_info = request->_taskInfo;
+
+	for (unsigned int i = 0; i < xtasks_task->numCopies; ++i) {
+		void* mem = service->allocateBuffer(xtasks_task->copies[i].size);
+		xtasks_task->args[xtasks_task->copies[i].argIdx] = (uint64_t)mem;
+		if (xtasks_task->copies[i].flags & 0x01) {
+			service->_allocator.memcpy(mem, xtasks_task->copies[i].address, xtasks_task->copies[i].size, XTASKS_ACC_TO_HOST);
+		}
+	}
+
+	void* argsBlock = request->_argsBlock;
+	for (int i = 0; i < task_info->num_args; ++i) {
+		assert(task_info->sizeof_table[i] <= (int)sizeof(xtasks_newtask_arg));
+		memcpy((char*)argsBlock + task_info->offset_table[i], &xtasks_task->args[i], task_info->sizeof_table[i]);
+	}
+
+	// The events surround the execution of the SMP task, in the worker
+	// thread that runs it
+	if (service->_isInstrumented)
+	{
+		static thread_local bool threadInstrumented = false;
+		if (!threadInstrumented) {
+			Instrument::startFPGAInstrumentation();
+			threadInstrumented = true;
+		}
+
+		uint64_t eventValue = 0x24; // SMP task
+		uint32_t eventType = 0;
+		Instrument::emitReverseOffloadingEvent(eventValue, eventType);
+	}
+
+	task_info->implementations[0].run(argsBlock, nullptr, nullptr);
+
+	if (service->_isInstrumented)
+	{
+		uint64_t eventValue = 0x24; // SMP task
+		uint32_t eventType = 1;
+		Instrument::emitReverseOffloadingEvent(eventValue, eventType);
+	}
+
+	for (unsigned int i = 0; i < xtasks_task->numCopies; ++i) {
+		void* mem = (void*)xtasks_task->args[xtasks_task->copies[i].argIdx];
+		if (xtasks_task->copies[i].flags & 0x02) {
+			service->_allocator.memcpy(xtasks_task->copies[i].address, mem, xtasks_task->copies[i].size, XTASKS_HOST_TO_ACC);
+		}
+		service->freeBuffer(mem, xtasks_task->copies[i].size);
+	}
+}
+
+void FPGAReverseOffload::requestCompleted(void *data) {
+	Request *request = (Request *)data;
+	assert(request != nullptr);
+
+	FPGAReverseOffload *service = request->_service;
+	xtasks_newtask *xtasks_task = request->_xtasksTask;
+
+	[[maybe_unused]] xtasks_stat stat = xtasksNotifyFinishedTask(xtasks_task->parentId, xtasks_task->taskId);
+	assert(stat == XTASKS_SUCCESS);
+
+	service->freeBuffer(request->_argsBlock, request->_argsBlockSize);
+	service->freeBuffer(request, sizeof(Request));
+
+	--service->_pendingRequests;
 }
 
 void FPGAReverseOffload::serviceLoop() {
-	Instrument::startFPGAInstrumentation();
 	while (!_stopService) {
 		bool foundTask = false;
 		do {
@@ -51,61 +220,10 @@ void FPGAReverseOffload::serviceLoop() {
 			stat = xtasksTryGetNewTask(&xtasks_task);
 			if (stat == XTASKS_SUCCESS) {
 				foundTask = true;
-				std::unordered_map<uint64_t, const nanos6_task_info_t*>::const_iterator it = _reverseMap.find(xtasks_task->typeInfo);
-#ifndef NDEBUG
-				FatalErrorHandler::failIf(
-					it == _reverseMap.end(),
-					"Device subtype ", xtasks_task->typeInfo, " not found in reverse map"
-				);
-#endif
-				const nanos6_task_info_t* task_info = it->second;
-
-				if (_isInstrumented)
-				{
-					uint64_t eventValue = 0x24; // SMP task
-					uint32_t eventType = 0;
-					Instrument::emitReverseOffloadingEvent(eventValue, eventType);
-				}
-
-				for (unsigned int i = 0; i < xtasks_task->numCopies; ++i) {
-					void* mem = MemoryAllocator::alloc(xtasks_task->copies[i].size);
-					xtasks_task->args[xtasks_task->copies[i].argIdx] = (uint64_t)mem;
-					if (xtasks_task->copies[i].flags & 0x01) {
-						_allocator.memcpy(mem, xtasks_task->copies[i].address, xtasks_task->copies[i].size, XTASKS_ACC_TO_HOST);
-					}
-				}
-
-				int numArgs = task_info->num_args;
-				int argsBlockSize = 0;
-				for (int i = 0; i < numArgs; ++i) {
-					argsBlockSize += task_info->sizeof_table[i];
-				}
-				void* argsBlock = MemoryAllocator::alloc(argsBlockSize);
-				for (int i = 0; i < numArgs; ++i) {
-					assert(task_info->sizeof_table[i] <= (int)sizeof(xtasks_newtask_arg));
-					memcpy((char*)argsBlock + task_info->offset_table[i], &xtasks_task->args[i], task_info->sizeof_table[i]);
-				}
-
-				task_info->implementations[0].run(argsBlock, nullptr, nullptr);
-
-				for (unsigned int i = 0; i < xtasks_task->numCopies; ++i) {
-					void* mem = (void*)xtasks_task->args[xtasks_task->copies[i].argIdx];
-					if (xtasks_task->copies[i].flags & 0x02) {
-						_allocator.memcpy(xtasks_task->copies[i].address, mem, xtasks_task->copies[i].size, XTASKS_HOST_TO_ACC);
-					}
-					MemoryAllocator::free(mem, xtasks_task->copies[i].size);
-				}
-
-				if (_isInstrumented)
-				{
-					uint64_t eventValue = 0x24; // SMP task
-					uint32_t eventType = 1;
-					Instrument::emitReverseOffloadingEvent(eventValue, eventType);
-				}
-
-				stat = xtasksNotifyFinishedTask(xtasks_task->parentId, xtasks_task->taskId);
-				assert(stat == XTASKS_SUCCESS);
-				MemoryAllocator::free(argsBlock, argsBlockSize);
+
+				// The request runs as a regular task in any worker thread, so
+				// the service keeps picking up new requests meanwhile
+				submitRequest(xtasks_task);
 			}
 			else {
 				assert(stat == XTASKS_PENDING);
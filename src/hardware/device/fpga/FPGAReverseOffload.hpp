@@ -4,10 +4,36 @@
 #include <unordered_map>
 #include <nanos6/task-instantiation.h>
 #include <atomic>
+#include "lowlevel/SpinLock.hpp"
 #include "memory/allocator/devices/FPGAPinnedAllocator.hpp"
+#include "support/Containers.hpp"
+#include <libxtasks.h>
 
 class FPGAReverseOffload
 {
+	//! The task type of the requests of a device subtype
+	struct RequestType {
+		const nanos6_task_info_t *_taskInfo;
+		size_t _argsBlockSize;
+		const char *_label;
+	};
+
+	//! A reverse offloaded request that runs as a spawned task
+	struct Request {
+		FPGAReverseOffload *_service;
+		xtasks_newtask *_xtasksTask;
+		const nanos6_task_info_t *_taskInfo;
+		void *_argsBlock;
+		size_t _argsBlockSize;
+	};
+
+	//! The smallest size class of the buffer pool (64 bytes)
+	static constexpr size_t MIN_BUFFER_SIZE_CLASS = 6;
+
+	//! The maximum bytes of free buffers kept by each size class (1 MiB).
+	//! Buffers beyond it are returned to the allocator
+	static constexpr size_t MAX_POOLED_BYTES_PER_CLASS = (size_t) 1 << 20;
+
 	std::atomic<bool> _stopService;
 	std::atomic<bool> _finishedService;
 	uint64_t _pollingPeriodUs;
@@ -15,12 +41,56 @@ class FPGAReverseOffload
 	bool _isPinnedPolling;
 	bool _isInstrumented;
 
-public:
+	//! The number of requests whose task has not completed yet
+	std::atomic<size_t> _pendingRequests;
+
+	//! The request types already resolved by the service. It is only
+	//! accessed by the service thread, so it is read without locking
+	Container::unordered_map<uint64_t, RequestType> _requestTypes;
+
+	//! Recycled host buffers for requests, copies and args blocks. Each
+	//! position holds the free buffers of 2^position bytes, up to
+	//! MAX_POOLED_BYTES_PER_CLASS
+	Container::vector<Container::vector<void *>> _bufferPool;
+	SpinLock _bufferPoolLock;
+
+	static inline size_t getSizeClass(size_t size)
+	{
+		size_t sizeClass = MIN_BUFFER_SIZE_CLASS;
+		while (((size_t) 1 << sizeClass) < size)
+			++sizeClass;
+		return sizeClass;
+	}
 
+	void *allocateBuffer(size_t size);
+	void freeBuffer(void *buffer, size_t size);
+
+	//! \brief Get the task type of the requests of a device subtype
+	//!
+	//! The registered task types are only looked up, under their lock, the
+	//! first time that a subtype is requested
+	const RequestType &getRequestType(uint64_t subtype);
+
+	void submitRequest(xtasks_newtask *xtasksTask);
+
+	static void requestBody(void *data);
+	static void requestCompleted(void *data);
+
+	//! The task types of reverse offloaded requests by device subtype
 	static std::unordered_map<uint64_t, const nanos6_task_info_t*> _reverseMap;
+	static SpinLock _reverseMapLock;
+
+public:
+
+	//! \brief Register a task type that can be reverse offloaded from the FPGA
+	//!
+	//! \param[in] subtype The device subtype that identifies the task type
+	//! \param[in] taskInfo The task info of the task type
+	static void registerReverseTaskInfo(uint64_t subtype, const nanos6_task_info_t *taskInfo);
 
 	FPGAReverseOffload(FPGAPinnedAllocator& allocator, uint64_t pollingPeriodUs, bool isPinnedPolling, bool isInstrumented) :
-		_stopService(false), _finishedService(false), _pollingPeriodUs(pollingPeriodUs), _allocator(allocator), _isPinnedPolling(isPinnedPolling), _isInstrumented(isInstrumented)
+		_stopService(false), _finishedService(false), _pollingPeriodUs(pollingPeriodUs), _allocator(allocator), _isPinnedPolling(isPinnedPolling), _isInstrumented(isInstrumented),
+		_pendingRequests(0)
 	{}
 
 	void initializeService();
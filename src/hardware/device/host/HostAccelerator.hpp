@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef HOST_ACCELERATOR_HPP
@@ -18,7 +18,7 @@ public:
 
 	void submitDevice(const DeviceEnvironment&, const void*, const nanos6_task_info_t*, const nanos6_address_translation_entry_t*) const override {}
 	std::function<bool()> getDeviceSubmissionFinished(const DeviceEnvironment&) const override {return []() -> bool{return true;};}
-	void generateDeviceEvironment(DeviceEnvironment&, const nanos6_task_implementation_info_t*) override {}
+	void generateDeviceEvironment(DeviceEnvironment&, uint64_t) override {}
 
 	std::pair<void *, bool> accel_allocate(size_t) override {return {nullptr, false};}
 	bool accel_free(void *) override {return true;}
@@ -42,11 +42,12 @@ private:
 		openAccEnv.asyncId = queue->getQueueId();
 	}
 
-	inline void preRunTask(Task *task) override
+	inline bool preRunTask(Task *task) override
 	{
 		OpenAccQueue *queue = (OpenAccQueue *)task->getDeviceEnvironment().openacc.queue;
 		assert(queue != nullptr);
 		queue->setTask(task);
+		return true;
 	}
 
 	inline void postRunTask(Task *task) override
@@ -252,6 +252,12 @@ HostInfo::HostInfo() :
 		);
 		((NUMAPlace *)_memoryPlaces[NUMANodeId])->increaseNumLocalCores();
 
+		// Machines without package information are considered a single package
+		hwloc_obj_t packageObj = hwloc_get_ancestor_obj_by_type(topology, HWLOC_OBJ_PACKAGE, obj);
+		if (packageObj != nullptr) {
+			cpu->setPackageId(packageObj->logical_index);
+		}
+
 		_computePlaces[cpuLogicalIndex] = cpu;
 	}
 
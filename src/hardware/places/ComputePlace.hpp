@@ -7,6 +7,8 @@
 #ifndef COMPUTE_PLACE_HPP
 #define COMPUTE_PLACE_HPP
 
+#include <cassert>
+#include <cstddef>
 #include <map>
 #include <random>
 #include <vector>
@@ -23,6 +25,10 @@ class Task;
 
 //! \brief A class that represents a place where code can be executed either directly, or in a sub-place within
 class ComputePlace {
+public:
+	//! Maximum number of immediate successor candidates tracked per compute place
+	static constexpr size_t MAX_SUCCESSOR_CANDIDATES = 4;
+
 private:
 	typedef std::map<int, MemoryPlace *> memory_places_t;
 
@@ -35,7 +41,14 @@ private:
 	//! Random generator. Currently used in TaskDataAccesses::computeNUMAAffinity
 	std::minstd_rand0 _randomEngine;
 
-	Task *_firstSuccessor;
+	//! Ready successors released by the tasks that finished in this compute
+	//! place, which are candidates to be run as immediate successors
+	Task *_successorCandidates[MAX_SUCCESSOR_CANDIDATES];
+
+	//! Data reused by each candidate from the task that released it, in bytes
+	size_t _successorReusedBytes[MAX_SUCCESSOR_CANDIDATES];
+
+	size_t _numSuccessorCandidates;
 
 protected:
 	//! The index of the compute place
@@ -57,7 +70,9 @@ public:
 	ComputePlace(int index, nanos6_device_t type, bool owned = true) :
 		_owned(owned),
 		_randomEngine(index),
-		_firstSuccessor(nullptr),
+		_successorCandidates(),
+		_successorReusedBytes(),
+		_numSuccessorCandidates(0),
 		_index(index),
 		_type(type)
 	{
@@ -137,15 +152,55 @@ public:
 		return _randomEngine;
 	}
 
-	inline Task *getFirstSuccessor() const
+	inline bool hasSuccessorCandidates() const
+	{
+		return (_numSuccessorCandidates > 0);
+	}
+
+	inline bool canAddSuccessorCandidate() const
+	{
+		return (_numSuccessorCandidates < MAX_SUCCESSOR_CANDIDATES);
+	}
+
+	inline size_t getNumSuccessorCandidates() const
+	{
+		return _numSuccessorCandidates;
+	}
+
+	inline Task *getSuccessorCandidate(size_t index) const
 	{
-		return _firstSuccessor;
+		assert(index < _numSuccessorCandidates);
+
+		return _successorCandidates[index];
 	}
 
-	inline void setFirstSuccessor(Task *task) {
-		assert(task == nullptr || _firstSuccessor == nullptr);
+	inline size_t getSuccessorReusedBytes(size_t index) const
+	{
+		assert(index < _numSuccessorCandidates);
+
+		return _successorReusedBytes[index];
+	}
 
-		_firstSuccessor = task;
+	inline void setSuccessorReusedBytes(size_t index, size_t reusedBytes)
+	{
+		assert(index < _numSuccessorCandidates);
+
+		_successorReusedBytes[index] = reusedBytes;
+	}
+
+	inline void addSuccessorCandidate(Task *task)
+	{
+		assert(task != nullptr);
+		assert(canAddSuccessorCandidate());
+
+		_successorCandidates[_numSuccessorCandidates] = task;
+		_successorReusedBytes[_numSuccessorCandidates] = 0;
+		_numSuccessorCandidates++;
+	}
+
+	inline void clearSuccessorCandidates()
+	{
+		_numSuccessorCandidates = 0;
 	}
 };
 
@@ -1,12 +1,13 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
 #define INSTRUMENT_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
 
+#include <InstrumentTaskId.hpp>
 
 namespace Instrument {
 
@@ -17,10 +18,14 @@ namespace Instrument {
 	void exitRegisterTaskDataAcesses();
 
 	//! \brief Enter task unregistration
-	void enterUnregisterTaskDataAcesses();
+	//!
+	//! \param[in] taskId The task whose accesses are unregistered
+	void enterUnregisterTaskDataAcesses(task_id_t taskId);
 
 	//! \brief Exit task unregistration
-	void exitUnregisterTaskDataAcesses();
+	//!
+	//! \param[in] taskId The task whose accesses are unregistered
+	void exitUnregisterTaskDataAcesses(task_id_t taskId);
 
 }
 
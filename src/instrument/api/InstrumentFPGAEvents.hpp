@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_FPGA_EVENTS_HPP
@@ -12,6 +12,7 @@
 #include <nanos6.h>
 
 #include <InstrumentInstrumentationContext.hpp>
+#include <InstrumentTaskId.hpp>
 #include <InstrumentThreadInstrumentationContext.hpp>
 
 namespace Instrument {
@@ -27,6 +28,10 @@ namespace Instrument {
 	void emitFPGAEvent(uint64_t value, uint32_t eventId, uint32_t eventType, uint64_t utime);
 	//! This function is called upon receiving a reverse offload task
 	void emitReverseOffloadingEvent(uint64_t value, uint32_t eventType);
+	//! This function is called after submitting a task to an FPGA accelerator
+	void fpgaTaskSubmitted(task_id_t taskId);
+	//! This function is called once the FPGA accelerator has finished the task
+	void fpgaTaskFinished(task_id_t taskId);
 }
 
 
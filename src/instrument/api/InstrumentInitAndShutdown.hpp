@@ -15,6 +15,10 @@ namespace Instrument {
 	void shutdown();
 	void preinitFinished();
 	void addCPUs();
+
+	//! \brief Write the events recorded in memory, if the instrumentation
+	//! keeps them, to the trace
+	void flightRecorderDump();
 }
 
 
@@ -1,16 +1,24 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_LEADER_THREAD_HPP
 #define INSTRUMENT_LEADER_THREAD_HPP
 
 
+#include <cstddef>
+
+
 namespace Instrument {
+	//! Called periodically by the leader thread, and once more when it exits
 	void leaderThreadSpin();
 
+	//! Period in microseconds at which the leader thread must call
+	//! leaderThreadSpin, or zero if it only needs to be called at the exit
+	size_t leaderThreadSpinPeriod();
+
 	//! Called when the leader thread starts the body
 	void leaderThreadBegin();
 
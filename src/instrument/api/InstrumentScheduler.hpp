@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_SCHEDULER_SUBSYTEM_ENTRY_POINTS_HPP
@@ -53,6 +53,15 @@ namespace Instrument {
 	//! \param[in] taskId the identifier of the task that the server assigned itself
 	void exitSchedulerLockAsServer(task_id_t taskId);
 
+	//! \brief The current worker decides whether to run its immediate successor candidate
+	//!
+	//! Only the successors released by a task that finishes in the worker
+	//! loop are candidates. Tasks released from busy paths, such as external
+	//! events, go straight to the scheduler and never reach this point
+	//!
+	//! \param[in] taken whether the candidate will run as immediate successor
+	void immediateSuccessorDecision(bool taken);
+
 }
 
 #endif // INSTRUMENT_SCHEDULER_SUBSYTEM_ENTRY_POINTS_HPP
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_CTF_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -23,12 +23,12 @@ namespace Instrument {
 		tp_dependency_register_exit();
 	}
 
-	inline void enterUnregisterTaskDataAcesses()
+	inline void enterUnregisterTaskDataAcesses(__attribute__((unused)) task_id_t taskId)
 	{
 		tp_dependency_unregister_enter();
 	}
 
-	inline void exitUnregisterTaskDataAcesses()
+	inline void exitUnregisterTaskDataAcesses(__attribute__((unused)) task_id_t taskId)
 	{
 		tp_dependency_unregister_exit();
 	}
@@ -4,15 +4,21 @@
 	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdlib>
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "CTFTracepoints.hpp"
 #include "InstrumentCPULocalData.hpp"
+#include "InstrumentExternalThreadLocalData.hpp"
 #include "InstrumentInitAndShutdown.hpp"
 #include "ctfapi/CTFAPI.hpp"
 #include "ctfapi/CTFKernelMetadata.hpp"
@@ -23,6 +29,7 @@
 #include "ctfapi/stream/CTFStreamUnboundedPrivate.hpp"
 #include "ctfapi/stream/CTFStreamUnboundedShared.hpp"
 #include "ctfapi/stream/CTFKernelStream.hpp"
+#include "ctfapi/stream/CircularBufferFlusher.hpp"
 #include "ctfapi/context/CTFContextTaskHardwareCounters.hpp"
 #include "ctfapi/context/CTFContextCPUHardwareCounters.hpp"
 #include "ctfapi/context/CTFStreamContextUnbounded.hpp"
@@ -32,6 +39,129 @@
 #include "tasks/TaskInfoManager.hpp"
 
 
+//! Thread writing the user streams to disk, if enabled
+static CircularBufferFlusher *_flusher = nullptr;
+
+//! Whether the user streams can be dumped by the flight recorder
+static std::atomic<bool> _flightRecorderReady(false);
+
+//! Whether a dump is in progress, to avoid concurrent dumps
+static std::atomic<bool> _flightRecorderDumping(false);
+
+//! Whether the dump signal has been received
+static std::atomic<bool> _flightRecorderRequested(false);
+
+//! The user streams dumped by the flight recorder, collected in advance so
+//! that the abort handler does not need to walk the runtime structures
+static CTFAPI::CTFStream **_flightRecorderStreams = nullptr;
+static size_t _flightRecorderNumStreams = 0;
+
+//! Message printed after a dump, built in advance for the abort handler
+static char *_flightRecorderDumpMessage = nullptr;
+
+//! The SIGABRT action installed before the flight recorder handler
+static struct sigaction _previousAbortAction;
+
+static size_t dumpFlightRecorderStreams()
+{
+	size_t inconsistent = 0;
+	for (size_t i = 0; i < _flightRecorderNumStreams; i++) {
+		if (!_flightRecorderStreams[i]->dump())
+			inconsistent++;
+	}
+	return inconsistent;
+}
+
+static void flightRecorderSignalHandler(int)
+{
+	// Defer the dump to the leader thread, which can safely allocate memory
+	_flightRecorderRequested.store(true, std::memory_order_relaxed);
+}
+
+static void flightRecorderAbortHandler(int signum, siginfo_t *info, void *context)
+{
+	// The process is dying, so dump right away. Only async-signal-safe
+	// calls can be made here, so the rings and the metadata built at the
+	// initialization are written as they are
+	if (_flightRecorderReady.load(std::memory_order_acquire)
+		&& !_flightRecorderDumping.exchange(true, std::memory_order_acquire)
+	) {
+		if (_flightRecorderReady.load(std::memory_order_relaxed)) {
+			CTFAPI::CTFTrace &trace = CTFAPI::CTFTrace::getInstance();
+
+			dumpFlightRecorderStreams();
+			bool written = trace.getUserMetadata()->writeAbortMetadataFile(
+				Instrument::ExternalThreadLocalData::getExternalThreadCount(),
+				CTFAPI::getTimestamp()
+			);
+			if (written)
+				write(STDOUT_FILENO, _flightRecorderDumpMessage, strlen(_flightRecorderDumpMessage));
+		}
+		_flightRecorderDumping.store(false, std::memory_order_release);
+	}
+
+	// Chain to the previous action. If it was the default one, raise the
+	// signal again so that it terminates the process once this returns
+	sigaction(SIGABRT, &_previousAbortAction, nullptr);
+	if (_previousAbortAction.sa_flags & SA_SIGINFO) {
+		_previousAbortAction.sa_sigaction(signum, info, context);
+	} else if (_previousAbortAction.sa_handler == SIG_DFL) {
+		raise(signum);
+	} else if (_previousAbortAction.sa_handler != SIG_IGN) {
+		_previousAbortAction.sa_handler(signum);
+	}
+}
+
+static void installFlightRecorderHandlers(int dumpSignal)
+{
+	struct sigaction sa;
+	int ret;
+
+	memset(&sa, 0, sizeof(sa));
+	sigemptyset(&sa.sa_mask);
+	sa.sa_sigaction = flightRecorderAbortHandler;
+	sa.sa_flags = SA_SIGINFO;
+	ret = sigaction(SIGABRT, &sa, &_previousAbortAction);
+	FatalErrorHandler::failIf(ret != 0, "ctf: cannot install the flight recorder abort handler: ", strerror(errno));
+
+	if (dumpSignal == 0)
+		return;
+
+	sa.sa_handler = flightRecorderSignalHandler;
+	sa.sa_flags = SA_RESTART;
+	ret = sigaction(dumpSignal, &sa, nullptr);
+	FatalErrorHandler::failIf(ret != 0, "ctf: cannot install the flight recorder handler for signal ", dumpSignal, ": ", strerror(errno));
+}
+
+template <typename F>
+static void forEachUserStream(F function)
+{
+	std::vector<CPU *> const &cpus = CPUManager::getCPUListReference();
+	for (CPU *cpu : cpus) {
+		function(cpu->getInstrumentationData().userStream);
+	}
+	function(CPUManager::getLeaderThreadCPU()->getInstrumentationData().userStream);
+	function(Instrument::getCTFVirtualCPULocalData()->userStream);
+}
+
+static void prepareFlightRecorderDumps(CTFAPI::CTFUserMetadata *userMetadata)
+{
+	std::vector<CTFAPI::CTFStream *> streams;
+	forEachUserStream([&](CTFAPI::CTFStream *stream) { streams.push_back(stream); });
+
+	_flightRecorderNumStreams = streams.size();
+	_flightRecorderStreams = new CTFAPI::CTFStream *[_flightRecorderNumStreams];
+	std::copy(streams.begin(), streams.end(), _flightRecorderStreams);
+
+	CTFAPI::CTFTrace &trace = CTFAPI::CTFTrace::getInstance();
+	std::string message = trace.getLogPreamble()
+		+ "Nanos6 dumped the flight recorder trace at "
+		+ trace.getTemporalTracePath() + "\n";
+	_flightRecorderDumpMessage = strdup(message.c_str());
+
+	userMetadata->prepareAbortMetadataFile();
+}
+
 //static void refineCTFEvents(__attribute__((unused)) CTFAPI::CTFUserMetadata *metadata)
 //{
 //	// TODO perform refinement based on the upcoming Nanos6 JSON
@@ -77,9 +207,14 @@ static void initializeUserStreams(
 	std::vector<CPU *> const &cpus = CPUManager::getCPUListReference();
 	ctf_cpu_id_t totalCPUs = (ctf_cpu_id_t) cpus.size();
 
-	const size_t defaultStreamBufferSize = 2*1024*1024;
+	CTFAPI::CTFTrace &trace = CTFAPI::CTFTrace::getInstance();
+	bool flightRecorder = trace.isFlightRecorderEnabled();
+
+	size_t defaultStreamBufferSize = 2*1024*1024;
 	//const size_t defaultUserBufferSize = 4096;
 	//std::cout << "WARNING: buffer size set to " << defaultUserBufferSize << std::endl;
+	if (flightRecorder)
+		defaultStreamBufferSize = trace.getFlightRecorderBufferSize();
 
 	// create and register contexes for streams
 	CTFAPI::CTFStreamContextUnbounded *context = userMetadata->addContext(
@@ -121,6 +256,27 @@ static void initializeUserStreams(
 	unboundedSharedStream->addContext(context);
 	virtualCPULocalData->userStream = unboundedSharedStream;
 	Instrument::setCTFVirtualCPULocalData(virtualCPULocalData);
+
+	// The flight recorder keeps the most recent events of each stream in
+	// memory, and only writes them on dumps and at shutdown
+	if (flightRecorder) {
+		forEachUserStream([](CTFAPI::CTFStream *stream) { stream->setRing(); });
+		return;
+	}
+
+	// Move the disk writes of the user streams out of the threads that
+	// emit the events. Each stream has a single writer at a time, either
+	// because it is private or because it is locked. Kernel streams keep
+	// flushing synchronously
+	if (trace.isFlusherEnabled()) {
+		_flusher = new CircularBufferFlusher();
+		for (ctf_cpu_id_t i = 0; i < totalCPUs; i++) {
+			cpus[i]->getInstrumentationData().userStream->setFlusher(_flusher);
+		}
+		unboundedPrivateStream->setFlusher(_flusher);
+		unboundedSharedStream->setFlusher(_flusher);
+		_flusher->start(nullptr);
+	}
 }
 
 static void initializeKernelStreams(
@@ -190,12 +346,23 @@ void Instrument::initialize()
 	trace.setTotalCPUs(CPUManager::getTotalCPUs());
 	trace.createTraceDirectories(basePath, userPath, kernelPath);
 	kernelMetadata->initialize();
+	FatalErrorHandler::failIf(
+		kernelMetadata->enabled() && trace.isFlightRecorderEnabled(),
+		"ctf: the flight recorder does not support Linux Kernel events"
+	);
 	initializeUserStreams(userMetadata, userPath);
 	initializeKernelStreams(kernelMetadata, kernelPath);
 
 	preinitializeCTFEvents(userMetadata);
 	userMetadata->refineEvents();
 	initializeCTFEvents(userMetadata);
+
+	// Dumps can start once the metadata of all events is known
+	if (trace.isFlightRecorderEnabled()) {
+		prepareFlightRecorderDumps(userMetadata);
+		_flightRecorderReady.store(true, std::memory_order_release);
+		installFlightRecorderHandlers(trace.getFlightRecorderSignal());
+	}
 }
 
 void Instrument::shutdown()
@@ -209,6 +376,21 @@ void Instrument::shutdown()
 	assert(userMetadata != nullptr);
 	assert(kernelMetadata != nullptr);
 
+	// Wait for any dump in progress and stop accepting new ones
+	if (trace.isFlightRecorderEnabled()) {
+		while (_flightRecorderDumping.exchange(true, std::memory_order_acquire)) {
+			// Wait
+		}
+		_flightRecorderReady.store(false, std::memory_order_relaxed);
+		_flightRecorderDumping.store(false, std::memory_order_release);
+
+		delete[] _flightRecorderStreams;
+		_flightRecorderStreams = nullptr;
+		_flightRecorderNumStreams = 0;
+		free(_flightRecorderDumpMessage);
+		_flightRecorderDumpMessage = nullptr;
+	}
+
 	trace.finalizeTraceTimer();
 	CTFAPI::CTFMetadata::collectCommonInformationAtShutdown();
 	userMetadata->writeMetadataFile();
@@ -232,6 +414,24 @@ void Instrument::shutdown()
 		}
 	}
 
+	// Report how much of the execution did not fit in the flight recorder
+	if (trace.isFlightRecorderEnabled()) {
+		uint64_t droppedBytes = 0;
+		forEachUserStream([&](CTFAPI::CTFStream *stream) { droppedBytes += stream->getDroppedBytes(); });
+		if (droppedBytes > 0) {
+			std::cout << trace.getLogPreamble() << "The flight recorder dropped " << droppedBytes / 1024
+				<< " KiB of the oldest events" << std::endl;
+		}
+	}
+
+	// Write the pending data of the user streams and continue flushing
+	// synchronously from now on
+	if (_flusher != nullptr) {
+		_flusher->shutdown();
+		delete _flusher;
+		_flusher = nullptr;
+	}
+
 	// Shutdown Worker thread streams
 	for (ctf_cpu_id_t i = 0; i < totalCPUs; i++) {
 		cpu = cpus[i];
@@ -315,3 +515,42 @@ void Instrument::preinitFinished()
 void Instrument::addCPUs()
 {
 }
+
+void Instrument::flightRecorderDump()
+{
+	if (!_flightRecorderReady.load(std::memory_order_acquire))
+		return;
+
+	// Skip the dump if there is another in progress
+	if (_flightRecorderDumping.exchange(true, std::memory_order_acquire))
+		return;
+
+	// Check again, as the runtime may have started the shutdown
+	if (!_flightRecorderReady.load(std::memory_order_relaxed)) {
+		_flightRecorderDumping.store(false, std::memory_order_release);
+		return;
+	}
+
+	CTFAPI::CTFTrace &trace = CTFAPI::CTFTrace::getInstance();
+	size_t inconsistent = dumpFlightRecorderStreams();
+
+	trace.finalizeTraceTimer();
+	CTFAPI::CTFMetadata::collectCommonInformationAtShutdown();
+	trace.getUserMetadata()->writeMetadataFile();
+
+	if (inconsistent > 0) {
+		FatalErrorHandler::warn(
+			"ctf: ", inconsistent, " streams could not be written consistently during the flight recorder dump"
+		);
+	}
+
+	std::cout << _flightRecorderDumpMessage << std::flush;
+
+	_flightRecorderDumping.store(false, std::memory_order_release);
+}
+
+void Instrument::flightRecorderPoll()
+{
+	if (_flightRecorderRequested.exchange(false, std::memory_order_relaxed))
+		flightRecorderDump();
+}
@@ -15,6 +15,10 @@ namespace Instrument {
 	void shutdown();
 	void preinitFinished();
 	void addCPUs();
+	void flightRecorderDump();
+
+	//! \brief Dump the flight recorder if the dump signal was received
+	void flightRecorderPoll();
 }
 
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_CTF_LEADER_THREAD_HPP
@@ -10,6 +10,7 @@
 #include <cassert>
 
 #include "instrument/api/InstrumentLeaderThread.hpp"
+#include "instrument/ctf/InstrumentInitAndShutdown.hpp"
 #include "instrument/ctf/InstrumentThreadLocalData.hpp"
 #include "ctfapi/CTFAPI.hpp"
 
@@ -22,6 +23,13 @@ namespace Instrument {
 		assert(userStream != nullptr);
 
 		CTFAPI::flushCurrentVirtualCPUBufferIfNeeded(userStream, userStream);
+		flightRecorderPoll();
+	}
+
+	inline size_t leaderThreadSpinPeriod()
+	{
+		// Flush the buffers every millisecond
+		return 1000;
 	}
 
 	inline void leaderThreadBegin()
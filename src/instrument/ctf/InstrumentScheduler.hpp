@@ -95,6 +95,11 @@ namespace Instrument {
 		tp_scheduler_lock_server_exit();
 	}
 
+	inline void immediateSuccessorDecision(
+		__attribute__((unused)) bool taken
+	) {
+	}
+
 	inline void enterProcessReadyTasks() {}
 	inline void exitProcessReadyTasks() {}
 
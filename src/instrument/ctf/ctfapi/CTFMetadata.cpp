@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cinttypes>
@@ -52,16 +52,23 @@ void CTFAPI::CTFMetadata::printCommonMetaEnv(FILE *f)
 {
 	CTFTrace &trace = CTFTrace::getInstance();
 
+	printCommonMetaEnv(f, _externalThreadsCount, trace.getAbsoluteEndTimestamp());
+}
+
+void CTFAPI::CTFMetadata::printCommonMetaEnv(FILE *f, uint32_t externalThreadsCount, uint64_t endTimestamp)
+{
+	CTFTrace &trace = CTFTrace::getInstance();
+
 	fprintf(f, _meta_commonEnv,
 		CTFTrace::getTraceVersion(),
 		_cpuList.c_str(),
-		_externalThreadsCount,
+		externalThreadsCount,
 		trace.getBinaryName(),
 		trace.getRank(),
 		trace.getNumberOfRanks(),
 		trace.getPid(),
 		trace.getAbsoluteStartTimestamp(),
-		trace.getAbsoluteEndTimestamp(),
+		endTimestamp,
 		trace.getTimeCorrection()
 	);
 }
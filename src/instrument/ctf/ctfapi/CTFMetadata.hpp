@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CTF_METADATA_HPP
@@ -24,6 +24,7 @@ namespace CTFAPI {
 		static uint32_t _externalThreadsCount;
 
 		static void printCommonMetaEnv(FILE *f);
+		static void printCommonMetaEnv(FILE *f, uint32_t externalThreadsCount, uint64_t endTimestamp);
 	};
 }
 
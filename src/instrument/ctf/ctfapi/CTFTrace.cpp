@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef _XOPEN_SOURCE
@@ -33,6 +33,11 @@ ConfigVariable<std::string> CTFAPI::CTFTrace::_defaultTemporalPath("instrument.c
 ConfigVariable<std::string> CTFAPI::CTFTrace::_ctf2prvWrapper("instrument.ctf.converter.location");
 ConfigVariable<bool> CTFAPI::CTFTrace::_ctf2prvEnabled("instrument.ctf.converter.enabled");
 ConfigVariable<bool> CTFAPI::CTFTrace::_ctf2prvFast("instrument.ctf.converter.fast");
+ConfigVariable<bool> CTFAPI::CTFTrace::_ctf2prvNative("instrument.ctf.converter.native");
+ConfigVariable<bool> CTFAPI::CTFTrace::_flusherEnabled("instrument.ctf.flusher.enabled");
+ConfigVariable<bool> CTFAPI::CTFTrace::_flightRecorderEnabled("instrument.ctf.flight_recorder.enabled");
+ConfigVariable<StringifiedMemorySize> CTFAPI::CTFTrace::_flightRecorderBufferSize("instrument.ctf.flight_recorder.buffer_size");
+ConfigVariable<int> CTFAPI::CTFTrace::_flightRecorderSignal("instrument.ctf.flight_recorder.signal");
 EnvironmentVariable<std::string> CTFAPI::CTFTrace::_systemPATH("PATH");
 const int CTFAPI::CTFTrace::_traceVersion = 1;
 
@@ -469,6 +474,13 @@ void CTFAPI::CTFTrace::convertToParaver()
 	if (!_ctf2prvEnabled.getValue())
 		return;
 
+	// The flight recorder only keeps the most recent events, so the
+	// creation of most tasks and threads is missing from the trace
+	if (_flightRecorderEnabled.getValue()) {
+		std::cout << getLogPreamble() << "Nanos6 does not convert flight recorder traces to Paraver" << std::endl;
+		return;
+	}
+
 	// Search for the converter or wrapper path
 	std::string converter = searchPythonCommand(defaultConverter);
 	if (converter == "") {
@@ -478,10 +490,15 @@ void CTFAPI::CTFTrace::convertToParaver()
 
 	std::cout << getLogPreamble() << "Nanos6 is converting the trace to Paraver, please wait" << std::endl;
 
-	std::string maybeFast = _ctf2prvFast.getValue() ? " --fast" : "";
+	std::string option = "";
+	if (_ctf2prvFast.getValue()) {
+		option = " --fast";
+	} else if (_ctf2prvNative.getValue()) {
+		option = " --native";
+	}
 
 	// Perform the conversion!
-	std::string command = converter + maybeFast + " " + _tmpTracePath;
+	std::string command = converter + option + " " + _tmpTracePath;
 	int ret = system(command.c_str());
 	FatalErrorHandler::warnIf(
 		ret == -1,
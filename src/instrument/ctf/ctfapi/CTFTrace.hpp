@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CTFTRACE_HPP
@@ -37,6 +37,11 @@ namespace CTFAPI {
 		static ConfigVariable<std::string> _ctf2prvWrapper;
 		static ConfigVariable<bool> _ctf2prvEnabled;
 		static ConfigVariable<bool> _ctf2prvFast;
+		static ConfigVariable<bool> _ctf2prvNative;
+		static ConfigVariable<bool> _flusherEnabled;
+		static ConfigVariable<bool> _flightRecorderEnabled;
+		static ConfigVariable<StringifiedMemorySize> _flightRecorderBufferSize;
+		static ConfigVariable<int> _flightRecorderSignal;
 		static EnvironmentVariable<std::string> _systemPATH;
 		static const int _traceVersion;
 
@@ -129,6 +134,27 @@ namespace CTFAPI {
 			}
 		}
 
+		inline bool isFlusherEnabled() const
+		{
+			return _flusherEnabled.getValue();
+		}
+
+		inline bool isFlightRecorderEnabled() const
+		{
+			return _flightRecorderEnabled.getValue();
+		}
+
+		inline size_t getFlightRecorderBufferSize() const
+		{
+			return _flightRecorderBufferSize.getValue();
+		}
+
+		//! \brief Get the signal that dumps the flight recorder, or 0
+		inline int getFlightRecorderSignal() const
+		{
+			return _flightRecorderSignal.getValue();
+		}
+
 		inline bool isDistributedMemoryEnabled()
 		{
 			return (_numberOfRanks != 0);
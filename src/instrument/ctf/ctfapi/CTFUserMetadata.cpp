@@ -1,13 +1,18 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
+#include <cassert>
+#include <fcntl.h>
 #include <fstream>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <cinttypes>
+#include <unistd.h>
 #include <vector>
 
 #include "stream/CTFStream.hpp"
@@ -118,6 +123,7 @@ CTFAPI::CTFUserMetadata::~CTFUserMetadata()
 		delete p;
 	events.clear();
 	contexes.clear();
+	free(_abortMetadata);
 }
 
 void CTFAPI::CTFUserMetadata::writeEventContextMetadata(FILE *f, CTFAPI::CTFEvent *event, ctf_stream_id_t streamId)
@@ -155,11 +161,104 @@ void CTFAPI::CTFUserMetadata::writeMetadataFile()
 	f = fopen(path.c_str(), "w");
 	FatalErrorHandler::failIf(f == NULL, std::string("Instrumentation: ctf: writing metadata file: ") + strerror(errno));
 
+	writeMetadata(f, _externalThreadsCount, trace.getAbsoluteEndTimestamp());
+
+	ret = fclose(f);
+	FatalErrorHandler::failIf(ret, std::string("Instrumentation: ctf: closing metadata file: ") + strerror(errno));
+}
+
+//! \brief Get the number of decimal digits of a number
+static constexpr size_t countDigits(uint64_t value)
+{
+	return (value < 10) ? 1 : 1 + countDigits(value / 10);
+}
+
+//! Widths of the fields filled when dumping the abort metadata
+static constexpr size_t ExternalThreadsCountWidth = countDigits(UINT32_MAX);
+static constexpr size_t EndTimestampWidth = countDigits(UINT64_MAX);
+
+void CTFAPI::CTFUserMetadata::prepareAbortMetadataFile()
+{
+	int ret;
+	FILE *f;
+	CTFTrace &trace = CTFTrace::getInstance();
+
+	_abortMetadataPath = trace.getUserTracePath() + "/metadata";
+
+	f = open_memstream(&_abortMetadata, &_abortMetadataSize);
+	FatalErrorHandler::failIf(f == NULL, std::string("Instrumentation: ctf: building abort metadata: ") + strerror(errno));
+
+	// The fields unknown until the dump are printed with their maximum
+	// value, which is also their widest, and filled in place when dumping
+	writeMetadata(f, UINT32_MAX, UINT64_MAX);
+
+	ret = fclose(f);
+	FatalErrorHandler::failIf(ret, std::string("Instrumentation: ctf: building abort metadata: ") + strerror(errno));
+
+	std::string metadata(_abortMetadata, _abortMetadataSize);
+	size_t position = metadata.find("external_thread_count = " + std::to_string(UINT32_MAX) + ";");
+	assert(position != std::string::npos);
+	_abortExternalThreadsCountOffset = position + strlen("external_thread_count = ");
+
+	position = metadata.find("end_ts = " + std::to_string(UINT64_MAX) + ";");
+	assert(position != std::string::npos);
+	_abortEndTimestampOffset = position + strlen("end_ts = ");
+}
+
+//! \brief Print a number right-aligned in a field padded with spaces
+static void fillNumberField(char *field, size_t width, uint64_t value)
+{
+	size_t i = width;
+	do {
+		field[--i] = '0' + (value % 10);
+		value /= 10;
+	} while (value > 0 && i > 0);
+
+	while (i > 0) {
+		field[--i] = ' ';
+	}
+}
+
+bool CTFAPI::CTFUserMetadata::writeAbortMetadataFile(uint32_t externalThreadsCount, uint64_t endTimestamp)
+{
+	int fd;
+	ssize_t ret;
+	size_t written = 0;
+
+	assert(_abortMetadata != nullptr);
+
+	fillNumberField(_abortMetadata + _abortExternalThreadsCountOffset,
+		ExternalThreadsCountWidth, externalThreadsCount);
+	fillNumberField(_abortMetadata + _abortEndTimestampOffset,
+		EndTimestampWidth, endTimestamp);
+
+	fd = open(_abortMetadataPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd == -1)
+		return false;
+
+	while (written < _abortMetadataSize) {
+		ret = write(fd, _abortMetadata + written, _abortMetadataSize - written);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		written += ret;
+	}
+
+	close(fd);
+	return (written == _abortMetadataSize);
+}
+
+void CTFAPI::CTFUserMetadata::writeMetadata(FILE *f, uint32_t externalThreadsCount, uint64_t endTimestamp)
+{
+	CTFTrace &trace = CTFTrace::getInstance();
+
 	fputs(meta_header, f);
 	fputs(meta_typedefs, f);
 	fputs(meta_trace, f);
 	fputs(meta_env, f);
-	printCommonMetaEnv(f);
+	printCommonMetaEnv(f, externalThreadsCount, endTimestamp);
 
 	// FIXME: We should find a better name than getTimeCorrection
 	int64_t rawOffset = trace.getTimeCorrection();
@@ -202,9 +301,6 @@ void CTFAPI::CTFUserMetadata::writeMetadataFile()
 		CTFAPI::CTFEvent *event = it->second;
 		writeEventMetadata(f, event, CTFStreamUnboundedId);
 	}
-
-	ret = fclose(f);
-	FatalErrorHandler::failIf(ret, std::string("Instrumentation: ctf: closing metadata file: ") + strerror(errno));
 }
 
 
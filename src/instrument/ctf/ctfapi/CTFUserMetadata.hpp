@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CTF_USER_METADATA_HPP
@@ -36,6 +36,15 @@ namespace CTFAPI {
 		std::set<CTFContext *> contexes;
 		std::vector<std::string> _enabledEvents;
 
+		//! Metadata file built in advance for the dumps done while aborting,
+		//! and the position of the fields only known at the time of the dump
+		std::string _abortMetadataPath;
+		char *_abortMetadata;
+		size_t _abortMetadataSize;
+		size_t _abortExternalThreadsCountOffset;
+		size_t _abortEndTimestampOffset;
+
+		void writeMetadata(FILE *f, uint32_t externalThreadsCount, uint64_t endTimestamp);
 		void writeEventContextMetadata(FILE *f, CTFAPI::CTFEvent *event, ctf_stream_id_t streamId);
 		void writeEventMetadata(FILE *f, CTFAPI::CTFEvent *event, ctf_stream_id_t streamId);
 
@@ -43,7 +52,13 @@ namespace CTFAPI {
 
 	public:
 
-		CTFUserMetadata() {};
+		CTFUserMetadata() :
+			_abortMetadata(nullptr),
+			_abortMetadataSize(0),
+			_abortExternalThreadsCountOffset(0),
+			_abortEndTimestampOffset(0)
+		{
+		}
 		~CTFUserMetadata();
 
 		CTFEvent *addEvent(CTFEvent *event)
@@ -70,6 +85,19 @@ namespace CTFAPI {
 
 		void refineEvents();
 		void writeMetadataFile();
+
+		//! \brief Build the metadata file written by writeAbortMetadataFile
+		//!
+		//! This must be called once all events and contexts are registered
+		void prepareAbortMetadataFile();
+
+		//! \brief Write the metadata file built in advance
+		//!
+		//! This only uses async-signal-safe calls, so it can be called while
+		//! handling a signal
+		//!
+		//! \returns Whether the file was written
+		bool writeAbortMetadataFile(uint32_t externalThreadsCount, uint64_t endTimestamp);
 	};
 }
 
@@ -1,10 +1,11 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "CTFStream.hpp"
+#include "CircularBufferFlusher.hpp"
 
 CTFAPI::CTFStream::CTFStream(
 	size_t size,
@@ -27,6 +28,11 @@ void CTFAPI::CTFStream::initialize()
 	addStreamHeader();
 }
 
+void CTFAPI::CTFStream::setFlusher(CircularBufferFlusher *flusher)
+{
+	flusher->addBuffer(&_circularBuffer);
+}
+
 void CTFAPI::CTFStream::makePacketHeader(CircularBuffer *circularBuffer, ctf_stream_id_t streamId)
 {
 	const int pks = sizeof(struct PacketHeader);
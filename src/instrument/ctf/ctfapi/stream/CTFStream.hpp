@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CPUSTREAM_HPP
@@ -14,6 +14,8 @@
 #include "instrument/ctf/ctfapi/CTFTypes.hpp"
 #include "instrument/ctf/ctfapi/context/CTFContext.hpp"
 
+class CircularBufferFlusher;
+
 namespace CTFAPI {
 
 	enum ctf_streams {
@@ -115,6 +117,28 @@ namespace CTFAPI {
 		{
 			_circularBuffer.flushAll();
 		}
+
+		//! \brief Write the stream to disk from the given flusher thread
+		void setFlusher(CircularBufferFlusher *flusher);
+
+		//! \brief Keep the most recent events in memory and write them
+		//! only on dumps and at shutdown
+		inline void setRing()
+		{
+			_circularBuffer.setRing();
+		}
+
+		//! \brief Write the events kept in memory to the stream file
+		inline bool dump()
+		{
+			return _circularBuffer.dumpRing();
+		}
+
+		//! \brief Get the bytes of the oldest events that were not kept
+		inline uint64_t getDroppedBytes() const
+		{
+			return _circularBuffer.getDroppedBytes();
+		}
 	};
 }
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef _GNU_SOURCE
@@ -20,7 +20,9 @@
 #include <unistd.h>
 
 #include "CircularBuffer.hpp"
+#include "CircularBufferFlusher.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/SpinWait.hpp"
 
 #define PAGE_SHIFT (12)
 #define PAGE_SIZE (1 << PAGE_SHIFT)
@@ -29,6 +31,9 @@
 #define ALIGN_SHIFT (PAGE_SHIFT + NSUBBUF_SHIFT)
 #define ALIGN_SIZE (1 << ALIGN_SHIFT)
 
+// Times a dump of a ring is retried while the ring is being overwritten
+#define MAX_DUMP_ATTEMPTS 8
+
 void CircularBuffer::initializeFile(const char *path)
 {
 	int tmpfd;
@@ -102,21 +107,79 @@ void CircularBuffer::initializeBuffer(uint64_t size, int node)
 	_bufferSize    = sizeAligned;
 	_subBufferSize = sizeAligned/NSUBBUF;
 	_subBufferMask = _subBufferSize - 1;
+	_subBufferShift = __builtin_ctzll(_subBufferSize);
 
 	resetPointers();
 }
 
 void CircularBuffer::initialize(uint64_t size, int node, const char *path)
 {
+	_flusher = nullptr;
+	_requestHead = 0;
+	_requestTail = 0;
+	_stalls = 0;
+	_stallTime.restart();
+	_ring = false;
+	_ringHeaderSize = 0;
+	_droppedBytes = 0;
+
 	initializeBuffer(size, node);
 	initializeFile(path);
 }
 
+void CircularBuffer::setFlusher(CircularBufferFlusher *flusher)
+{
+	assert(flusher != nullptr);
+	assert(_flusher == nullptr);
+	assert(_fileOffset == 0);
+
+	_flushedTail.store(_tail, std::memory_order_relaxed);
+	_flusher = flusher;
+}
+
+void CircularBuffer::unsetFlusher()
+{
+	assert(_flusher != nullptr);
+	assert(!hasFlushRequests());
+	assert(_flushedTail.load(std::memory_order_acquire) == _tail);
+
+	_flusher = nullptr;
+}
+
+void CircularBuffer::setRing()
+{
+	static_assert(NSUBBUF == NUM_SUB_BUFFERS, "Wrong number of sub-buffers");
+
+	assert(!_ring);
+	assert(_flusher == nullptr);
+	assert(_fileOffset == 0);
+	assert(_head == _tail);
+	assert(_head <= MAX_RING_HEADER);
+
+	_ringHeaderSize = _head;
+	memcpy(_ringHeader, _buffer, _ringHeaderSize);
+
+	resetPointers();
+	for (uint64_t i = 0; i < NSUBBUF; i++) {
+		_subBufferStarts[i].subBuffer = UINT64_MAX;
+	}
+	_ringHead.store(0, std::memory_order_relaxed);
+	_ringTail.store(0, std::memory_order_relaxed);
+	_ringHole.store(0, std::memory_order_relaxed);
+	_ring = true;
+}
+
 void CircularBuffer::shutdown()
 {
 	int ret;
 
-	flushAll();
+	if (_ring) {
+		FatalErrorHandler::warnIf(!dumpRing(),
+			" circular buffer: when dumping ring to file: ", strerror(errno)
+		);
+	} else {
+		flushAll();
+	}
 	ret = close(_fd);
 	FatalErrorHandler::warnIf(
 		ret == -1,
@@ -143,6 +206,7 @@ void CircularBuffer::resetPointers()
 	_tail = 0;
 	_hole = 0;
 	_wall = _bufferSize;
+	_flushedTail.store(0, std::memory_order_relaxed);
 }
 
 void CircularBuffer::flushToFile(char *buf, size_t size)
@@ -168,10 +232,106 @@ void CircularBuffer::flushToFile(char *buf, size_t size)
 	} while (rem > 0);
 }
 
+bool CircularBuffer::dumpToFile(const char *buf, size_t size)
+{
+	ssize_t ret;
+
+	// This may run in a signal handler, so errors are only returned
+	while (size > 0) {
+		ret = pwrite(_fd, buf, size, _fileOffset);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+
+		buf         += ret;
+		size        -= ret;
+		_fileOffset += ret;
+	}
+
+	return true;
+}
+
+void CircularBuffer::flushSegment(uint64_t start, uint64_t size, uint64_t tail)
+{
+	if (size == 0 && tail == _tail)
+		return;
+
+	if (_flusher == nullptr) {
+		flushToFile(_buffer + (start & _mask), size);
+		return;
+	}
+
+	// Hand the segment to the flusher thread. Wait if there are too many
+	// segments pending to be written
+	uint64_t head = _requestHead.load(std::memory_order_relaxed);
+	if (head - _requestTail.load(std::memory_order_acquire) == MAX_FLUSH_REQUESTS) {
+		_stalls++;
+		_stallTime.start();
+		while (head - _requestTail.load(std::memory_order_acquire) == MAX_FLUSH_REQUESTS) {
+			spinWait();
+		}
+		spinWaitRelease();
+		_stallTime.stop();
+	}
+
+	FlushRequest &request = _requests[head % MAX_FLUSH_REQUESTS];
+	request.start = start;
+	request.size = size;
+	request.tail = tail;
+	_requestHead.store(head + 1, std::memory_order_seq_cst);
+
+	_flusher->notify();
+}
+
+void CircularBuffer::waitForFlusher()
+{
+	assert(_flusher != nullptr);
+
+	if (_flushedTail.load(std::memory_order_acquire) == _tail)
+		return;
+
+	_stalls++;
+	_stallTime.start();
+	while (_flushedTail.load(std::memory_order_acquire) != _tail) {
+		spinWait();
+	}
+	spinWaitRelease();
+	_stallTime.stop();
+}
+
+bool CircularBuffer::processFlushRequests()
+{
+	uint64_t tail = _requestTail.load(std::memory_order_relaxed);
+	uint64_t head = _requestHead.load(std::memory_order_acquire);
+
+	if (tail == head)
+		return false;
+
+	while (tail != head) {
+		const FlushRequest &request = _requests[tail % MAX_FLUSH_REQUESTS];
+		uint64_t flushedTail = request.tail;
+
+		flushToFile(_buffer + (request.start & _mask), request.size);
+
+		// Free the request slot before releasing the buffer space. The
+		// writer only resets the buffer once all the space is released
+		_requestTail.store(++tail, std::memory_order_release);
+		_flushedTail.store(flushedTail, std::memory_order_release);
+	}
+
+	return true;
+}
+
 bool CircularBuffer::checkIfNeedsFlush()
 {
 	uint64_t size;
 
+	// Rings are only written on dumps
+	if (_ring)
+		return false;
+
 	// If wraps it needs to flush
 	if (wraps())
 		return true;
@@ -182,13 +342,101 @@ bool CircularBuffer::checkIfNeedsFlush()
 }
 
 bool CircularBuffer::alloc(uint64_t size)
+{
+	if (!_ring)
+		return allocContiguous(size);
+
+	// Rings always have space, at the cost of the oldest events
+	while (!allocContiguous(size)) {
+		dropOldestEvents();
+	}
+
+	return true;
+}
+
+void CircularBuffer::dropOldestEvents()
+{
+	uint64_t subBuffer = (_tail >> _subBufferShift) + 1;
+	uint64_t tail = _head;
+
+	assert(_ring);
+
+	// Move the tail to the first event that begins after the current
+	// sub-buffer. Sub-buffers without any event beginning in them, such as
+	// holes or those in the middle of large events, are skipped
+	while ((subBuffer << _subBufferShift) < _head) {
+		const SubBufferStart &start = _subBufferStarts[subBuffer % NSUBBUF];
+		if (start.subBuffer == subBuffer) {
+			tail = start.position;
+			break;
+		}
+		subBuffer++;
+	}
+
+	assert(tail > _tail);
+
+	// Account the dropped events, skipping the unused space at the wall
+	uint64_t dropped = tail - _tail;
+	if (tail >= _wall && _tail < _hole && _hole < _wall)
+		dropped -= _wall - _hole;
+	_droppedBytes += dropped;
+
+	_tail = tail;
+	while (_tail >= _wall) {
+		_wall += _bufferSize;
+	}
+
+	// Publish the new tail before the dropped events are overwritten, so
+	// that concurrent dumps notice it
+	_ringTail.store(_tail, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+bool CircularBuffer::dumpRing()
+{
+	bool written;
+
+	assert(_ring);
+
+	for (int attempt = 0; attempt < MAX_DUMP_ATTEMPTS; attempt++) {
+		uint64_t tail = _ringTail.load(std::memory_order_acquire);
+		uint64_t head = _ringHead.load(std::memory_order_acquire);
+		uint64_t hole = _ringHole.load(std::memory_order_relaxed);
+		uint64_t wall = (tail & ~_mask) + _bufferSize;
+
+		_fileOffset = 0;
+		written = dumpToFile(_ringHeader, _ringHeaderSize);
+
+		if (head > wall) {
+			// The events wrap, so write up to the hole or the wall first
+			uint64_t end = (tail < hole && hole < wall) ? hole : wall;
+			written = written && dumpToFile(_buffer + (tail & _mask), end - tail);
+			written = written && dumpToFile(_buffer, head - wall);
+		} else {
+			written = written && dumpToFile(_buffer + (tail & _mask), head - tail);
+		}
+
+		if (!written)
+			return false;
+
+		// The events written are valid only if none was dropped meanwhile
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (_ringTail.load(std::memory_order_relaxed) == tail)
+			return (ftruncate(_fd, _fileOffset) == 0);
+	}
+
+	return false;
+}
+
+bool CircularBuffer::allocContiguous(uint64_t size)
 {
 	uint64_t next_wall;
+	uint64_t tail = getFreeTail();
 
 	assert(size <= _bufferSize);
 
 	// There is enough space in the buffer?
-	if (_head + size - _tail > _bufferSize) {
+	if (_head + size - tail > _bufferSize) {
 		return false;
 	}
 
@@ -198,7 +446,7 @@ bool CircularBuffer::alloc(uint64_t size)
 		_hole = _head;
 		_head = next_wall;
 		// if not, is the next space contiguous?
-		if (_head + size - _tail > _bufferSize) {
+		if (_head + size - tail > _bufferSize) {
 			return false;
 		}
 	}
@@ -211,11 +459,12 @@ uint64_t CircularBuffer::allocAtLeast(uint64_t minSize)
 {
 	uint64_t nextWall;
 	uint64_t available;
+	uint64_t tail = getFreeTail();
 
 	assert(minSize <= _bufferSize);
 
 	// Is there enough space in the buffer?
-	if (_head + minSize - _tail > _bufferSize) {
+	if (_head + minSize - tail > _bufferSize) {
 		return 0;
 	}
 
@@ -226,14 +475,14 @@ uint64_t CircularBuffer::allocAtLeast(uint64_t minSize)
 		_hole = _head;
 		_head = nextWall;
 		// We cannot cross the border again so what's left is what we have
-		available = _bufferSize - (_head - _tail);
+		available = _bufferSize - (_head - tail);
 		// Check again the available size, after moving the _head there might
 		// no longer be enough space
 		available = (available >= minSize)? available : 0;
 	} else {
 		// If yes, get the minimum between the real space left and and
 		// the maximum contiguous space
-		available = std::min(_bufferSize - (_head - _tail), nextWall - _head);
+		available = std::min(_bufferSize - (_head - tail), nextWall - _head);
 	}
 
 	return available;
@@ -247,7 +496,7 @@ void CircularBuffer::flushUpToTheWrap()
 		return;
 
 	seg = (_tail < _hole) ? _hole : _wall;
-	flushToFile(_buffer + (_tail & _mask), seg - _tail);
+	flushSegment(_tail, seg - _tail, _wall);
 	_tail = _wall;
 	_wall += _bufferSize;
 }
@@ -258,7 +507,13 @@ void CircularBuffer::flushAll()
 	flushUpToTheWrap();
 
 	// Next flush up to _head
-	flushToFile(_buffer + (_tail & _mask), _head - _tail);
+	flushSegment(_tail, _head - _tail, _head);
+	_tail = _head;
+
+	// With asynchronous flushing, all the data must be written before
+	// reusing the buffer
+	if (_flusher != nullptr)
+		waitForFlusher();
 
 	// Move pointers to the beginning of the buffer; we want head to be as
 	// far as possible from the wall
@@ -275,12 +530,14 @@ void CircularBuffer::flushFilledSubBuffers()
 	// Next, flush up to the next subbuffer. Here we priorize flushing
 	// size aligned blocks rather than flushing everything
 	size = ((_head - _tail) & ~_subBufferMask);
-	flushToFile(_buffer + (_tail & _mask), size);
+	flushSegment(_tail, size, _tail + size);
 	_tail += size;
 
 	// If we have flushed everything, return pointers to the beginning of
-	// the buffer, we want head to be as far as possible from the wall
-	if (_tail == _head) {
+	// the buffer, we want head to be as far as possible from the wall. The
+	// flusher thread may still be writing, so the pointers are kept when
+	// flushing asynchronously
+	if (_tail == _head && _flusher == nullptr) {
 		resetPointers();
 	}
 
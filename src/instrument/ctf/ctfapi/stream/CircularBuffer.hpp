@@ -1,15 +1,46 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
+#ifndef CIRCULAR_BUFFER_HPP
+#define CIRCULAR_BUFFER_HPP
+
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 
+#include "support/Chrono.hpp"
+
+class CircularBufferFlusher;
+
 class CircularBuffer {
 
 private:
+	//! A segment of the buffer handed to the flusher thread
+	struct FlushRequest {
+		uint64_t start;
+		uint64_t size;
+		//! The value of the tail once the segment has been written
+		uint64_t tail;
+	};
+
+	//! Maximum number of segments pending to be written by the flusher
+	static constexpr uint64_t MAX_FLUSH_REQUESTS = 16;
+
+	//! Number of sub-buffers in which the buffer is divided
+	static constexpr uint64_t NUM_SUB_BUFFERS = 4;
+
+	//! Maximum size of the stream header kept aside in ring mode
+	static constexpr uint64_t MAX_RING_HEADER = 64;
+
+	//! Position of the first event that begins in a sub-buffer
+	struct SubBufferStart {
+		uint64_t subBuffer;
+		uint64_t position;
+	};
+
 	char *_buffer;
 	uint64_t _bufferSize;
 	uint64_t _subBufferSize;
@@ -24,17 +55,64 @@ private:
 	uint64_t _fileOffset;
 	int _node;
 
+	//! The flusher thread writing this buffer, if flushing is asynchronous.
+	//! In that case, _tail is the position up to which the data has been
+	//! handed to the flusher, and _flushedTail the position up to which the
+	//! data has been written and the space can be reused
+	CircularBufferFlusher *_flusher;
+	std::atomic<uint64_t> _flushedTail;
+
+	//! Single-producer single-consumer queue of flush requests
+	FlushRequest _requests[MAX_FLUSH_REQUESTS];
+	std::atomic<uint64_t> _requestHead;
+	std::atomic<uint64_t> _requestTail;
+
+	//! Number of times the writer waited for the flusher and for how long
+	uint64_t _stalls;
+	Chrono _stallTime;
+
+	//! In ring mode the buffer is never written while events are being
+	//! recorded. The oldest events are dropped a sub-buffer at a time to
+	//! make room for new ones, and the contents are only written on dumps
+	bool _ring;
+	uint64_t _subBufferShift;
+	SubBufferStart _subBufferStarts[NUM_SUB_BUFFERS];
+	char _ringHeader[MAX_RING_HEADER];
+	uint64_t _ringHeaderSize;
+
+	//! Bytes of events dropped from the ring to make room for new ones
+	uint64_t _droppedBytes;
+
+	//! Copies of the pointers that dumps read while events are recorded
+	std::atomic<uint64_t> _ringHead;
+	std::atomic<uint64_t> _ringTail;
+	std::atomic<uint64_t> _ringHole;
+
 	void initializeFile(const char *path);
 	void initializeBuffer(uint64_t size, int node);
 	void flushToFile(char *buf, size_t size);
+	bool dumpToFile(const char *buf, size_t size);
+	void flushSegment(uint64_t start, uint64_t size, uint64_t tail);
 	void flushUpToTheWrap();
 	void resetPointers();
+	void waitForFlusher();
+	bool allocContiguous(uint64_t size);
+	void dropOldestEvents();
 
 	inline bool wraps()
 	{
 		return ((_head & ~_mask) != (_tail & ~_mask));
 	}
 
+	//! \brief Get the position up to which the buffer space can be reused
+	inline uint64_t getFreeTail() const
+	{
+		if (_flusher == nullptr)
+			return _tail;
+
+		return _flushedTail.load(std::memory_order_acquire);
+	}
+
 public:
 	CircularBuffer() {};
 
@@ -46,6 +124,59 @@ public:
 	bool alloc(uint64_t size);
 	uint64_t allocAtLeast(uint64_t minSize);
 
+	//! \brief Delegate the writes to the backing file to a flusher thread
+	//!
+	//! This must be called before any data is flushed
+	void setFlusher(CircularBufferFlusher *flusher);
+
+	//! \brief Go back to synchronous flushing once the flusher has stopped
+	void unsetFlusher();
+
+	//! \brief Keep only the most recent events instead of flushing them
+	//!
+	//! The data submitted so far is the stream header, which is written at
+	//! the beginning of every dump
+	void setRing();
+
+	//! \brief Write the stream header and the events of the ring
+	//!
+	//! This may be called concurrently with the thread recording events,
+	//! even from a signal handler, so it only uses async-signal-safe calls.
+	//! The write is retried if the oldest events were dropped in the
+	//! meantime
+	//!
+	//! \returns Whether a consistent copy of the ring was written
+	bool dumpRing();
+
+	//! \brief Write the segments handed to the flusher
+	//!
+	//! This is only called by the flusher thread
+	//!
+	//! \returns Whether any segment was written
+	bool processFlushRequests();
+
+	inline bool hasFlushRequests() const
+	{
+		return (_requestTail.load(std::memory_order_relaxed) != _requestHead.load(std::memory_order_seq_cst));
+	}
+
+	inline uint64_t getStalls() const
+	{
+		return _stalls;
+	}
+
+	//! \brief Get the time spent waiting for the flusher in microseconds
+	inline uint64_t getStallTime() const
+	{
+		return _stallTime.getAccumulated();
+	}
+
+	//! \brief Get the bytes of events dropped in ring mode
+	inline uint64_t getDroppedBytes() const
+	{
+		return _droppedBytes;
+	}
+
 	inline void *getBuffer()
 	{
 		return (void *) (_buffer + (_head & _mask));
@@ -53,8 +184,25 @@ public:
 
 	inline void submit(uint64_t size)
 	{
+		if (_ring) {
+			// Record where the first event of each sub-buffer begins
+			uint64_t subBuffer = _head >> _subBufferShift;
+			SubBufferStart &start = _subBufferStarts[subBuffer % NUM_SUB_BUFFERS];
+			if (start.subBuffer != subBuffer) {
+				start.subBuffer = subBuffer;
+				start.position = _head;
+			}
+		}
+
 		_head += size;
-		assert(_head - _tail <= _bufferSize);
+		assert(_head - getFreeTail() <= _bufferSize);
+
+		if (_ring) {
+			_ringHole.store(_hole, std::memory_order_relaxed);
+			_ringHead.store(_head, std::memory_order_release);
+		}
 	}
 
 };
+
+#endif // CIRCULAR_BUFFER_HPP
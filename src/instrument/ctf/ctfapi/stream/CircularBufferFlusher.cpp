@@ -0,0 +1,92 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <cassert>
+
+#include "CircularBuffer.hpp"
+#include "CircularBufferFlusher.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+
+
+CircularBufferFlusher::CircularBufferFlusher() :
+	HelperThread("ctf-flusher"),
+	_buffers(),
+	_sleeping(false),
+	_mustExit(false)
+{
+}
+
+void CircularBufferFlusher::addBuffer(CircularBuffer *buffer)
+{
+	assert(buffer != nullptr);
+
+	buffer->setFlusher(this);
+	_buffers.push_back(buffer);
+}
+
+void CircularBufferFlusher::shutdown()
+{
+	_mustExit.store(true, std::memory_order_seq_cst);
+	{
+		std::lock_guard<std::mutex> guard(_mutex);
+		_condVar.notify_one();
+	}
+	join();
+
+	uint64_t stalls = 0;
+	uint64_t stallTime = 0;
+	for (CircularBuffer *buffer : _buffers) {
+		buffer->unsetFlusher();
+		stalls += buffer->getStalls();
+		stallTime += buffer->getStallTime();
+	}
+
+	if (stalls > 0) {
+		FatalErrorHandler::warn(
+			"CTF: threads waited ", stalls, " times for a total of ",
+			stallTime / 1000, " ms on the trace flusher; consider using a faster trace directory"
+		);
+	}
+}
+
+bool CircularBufferFlusher::hasFlushRequests() const
+{
+	for (CircularBuffer *buffer : _buffers) {
+		if (buffer->hasFlushRequests())
+			return true;
+	}
+	return false;
+}
+
+void CircularBufferFlusher::body()
+{
+	// The thread is not initialized as an instrumented helper thread on
+	// purpose. It would emit events in the streams that it writes, and it
+	// would wait for itself when their buffers are full
+	while (true) {
+		bool flushed = false;
+		for (CircularBuffer *buffer : _buffers) {
+			flushed |= buffer->processFlushRequests();
+		}
+
+		if (flushed)
+			continue;
+
+		// Nothing to write. Sleep unless a request has been added after
+		// announcing the sleep. The writers only notify the flusher when
+		// it announced it is sleeping
+		std::unique_lock<std::mutex> lock(_mutex);
+		_sleeping.store(true, std::memory_order_seq_cst);
+		if (!hasFlushRequests()) {
+			if (_mustExit.load(std::memory_order_seq_cst)) {
+				_sleeping.store(false, std::memory_order_relaxed);
+				break;
+			}
+			_condVar.wait(lock);
+		}
+		_sleeping.store(false, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,69 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef CIRCULAR_BUFFER_FLUSHER_HPP
+#define CIRCULAR_BUFFER_FLUSHER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "lowlevel/threads/HelperThread.hpp"
+
+class CircularBuffer;
+
+//! \brief Thread that writes the filled segments of circular buffers to disk
+//!
+//! The threads writing events hand the filled sub-buffers of their streams
+//! to the flusher and keep writing in the rest of the buffer. They only wait
+//! for the flusher when their buffer is full. The flusher is a helper thread
+//! that never emits events, so it does not need a stream of its own
+class CircularBufferFlusher : public HelperThread {
+
+private:
+	std::vector<CircularBuffer *> _buffers;
+
+	//! Protects the sleep of the flusher
+	std::mutex _mutex;
+	std::condition_variable _condVar;
+
+	//! Whether the flusher is sleeping or about to sleep
+	std::atomic<bool> _sleeping;
+
+	//! Whether the flusher must finish once all requests are written
+	std::atomic<bool> _mustExit;
+
+	bool hasFlushRequests() const;
+
+public:
+	CircularBufferFlusher();
+
+	//! \brief Make the flusher write a circular buffer
+	//!
+	//! All buffers must be added before starting the flusher
+	void addBuffer(CircularBuffer *buffer);
+
+	//! \brief Write all pending requests and stop the flusher
+	//!
+	//! The buffers go back to synchronous flushing. The number of stalls
+	//! of the writers is reported if any
+	void shutdown();
+
+	//! \brief Wake up the flusher after adding a flush request
+	inline void notify()
+	{
+		if (_sleeping.load(std::memory_order_seq_cst)) {
+			std::lock_guard<std::mutex> guard(_mutex);
+			_condVar.notify_one();
+		}
+	}
+
+	//! \brief The loop that writes the flush requests
+	void body();
+};
+
+#endif // CIRCULAR_BUFFER_FLUSHER_HPP
@@ -21,6 +21,10 @@ namespace Instrument {
 	inline void addCPUs()
 	{
 	}
+
+	inline void flightRecorderDump()
+	{
+	}
 }
 
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_EXTRAE_LEADER_THREAD_HPP
@@ -54,6 +54,12 @@ namespace Instrument {
 		}
 	}
 
+	inline size_t leaderThreadSpinPeriod()
+	{
+		// Sample the task counts every millisecond
+		return (_detailLevel < 1) ? 1000 : 0;
+	}
+
 	inline void leaderThreadBegin()
 	{
 	}
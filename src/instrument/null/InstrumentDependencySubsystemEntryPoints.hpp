@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_NULL_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -16,9 +16,9 @@ namespace Instrument {
 
 	inline void exitRegisterTaskDataAcesses() {}
 
-	inline void enterUnregisterTaskDataAcesses() {}
+	inline void enterUnregisterTaskDataAcesses(__attribute__((unused)) task_id_t taskId) {}
 
-	inline void exitUnregisterTaskDataAcesses() {}
+	inline void exitUnregisterTaskDataAcesses(__attribute__((unused)) task_id_t taskId) {}
 
 }
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_NULL_FPGA_EVENTS_HPP
@@ -24,6 +24,8 @@ namespace Instrument {
 	inline void emitReverseOffloadingEvent([[maybe_unused]] uint64_t value, 
 		[[maybe_unused]] uint32_t eventType) {
 		}
+	inline void fpgaTaskSubmitted([[maybe_unused]] task_id_t taskId) {}
+	inline void fpgaTaskFinished([[maybe_unused]] task_id_t taskId) {}
 }
 
 
@@ -26,6 +26,10 @@ namespace Instrument {
 	inline void addCPUs()
 	{
 	}
+
+	inline void flightRecorderDump()
+	{
+	}
 }
 
 
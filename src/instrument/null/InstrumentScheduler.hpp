@@ -46,6 +46,11 @@ namespace Instrument {
 		__attribute__((unused)) task_id_t taskId
 	) {
 	}
+
+	inline void immediateSuccessorDecision(
+		__attribute__((unused)) bool taken
+	) {
+	}
 }
 
 #endif // INSTRUMENT_NULL_SCHEDULER_HPP
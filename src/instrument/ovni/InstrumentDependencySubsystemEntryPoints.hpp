@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2022-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_OVNI_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -22,12 +22,12 @@ namespace Instrument {
 		Ovni::registerAccessesExit();
 	}
 
-	inline void enterUnregisterTaskDataAcesses()
+	inline void enterUnregisterTaskDataAcesses(__attribute__((unused)) task_id_t taskId)
 	{
 		Ovni::unregisterAccessesEnter();
 	}
 
-	inline void exitUnregisterTaskDataAcesses()
+	inline void exitUnregisterTaskDataAcesses(__attribute__((unused)) task_id_t taskId)
 	{
 		Ovni::unregisterAccessesExit();
 	}
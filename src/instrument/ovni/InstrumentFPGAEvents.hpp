@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 #ifndef INSTRUMENT_OVNI_FPGA_EVENTS_HPP
 #define INSTRUMENT_OVNI_FPGA_EVENTS_HPP
@@ -29,5 +29,7 @@ namespace Instrument {
 	inline void emitReverseOffloadingEvent(uint64_t value, uint32_t eventType) {
 		Ovni::reverseOffloadingEvent(value, eventType);
 	}
+	inline void fpgaTaskSubmitted([[maybe_unused]] task_id_t taskId) {}
+	inline void fpgaTaskFinished([[maybe_unused]] task_id_t taskId) {}
 }
 #endif // INSTRUMENT_OVNI_FPGA_EVENTS_HPP
@@ -14,6 +14,10 @@ void Instrument::initialize()
 {
 	// Too late, we initialize the ovni process and thread earlier at
 	// mainThreadBegin.
+
+	FatalErrorHandler::warnIf(_level.getValue() > OVNI_MAX_LEVEL,
+		"ovni: the events above level ", OVNI_MAX_LEVEL, " were not compiled; ",
+		"reconfigure with --with-ovni-max-level to enable level ", _level.getValue());
 }
 
 void Instrument::addCPUs()
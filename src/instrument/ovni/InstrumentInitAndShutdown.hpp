@@ -15,6 +15,10 @@ namespace Instrument {
 	void shutdown();
 	void preinitFinished();
 	void addCPUs();
+
+	inline void flightRecorderDump()
+	{
+	}
 }
 
 
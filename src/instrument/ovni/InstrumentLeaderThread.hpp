@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_OVNI_LEADER_THREAD_HPP
@@ -15,6 +15,11 @@ namespace Instrument {
 	{
 	}
 
+	inline size_t leaderThreadSpinPeriod()
+	{
+		return 0;
+	}
+
 	inline void leaderThreadBegin()
 	{
 		Ovni::threadTypeBegin('L');
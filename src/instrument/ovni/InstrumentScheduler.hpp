@@ -69,6 +69,11 @@ namespace Instrument {
 		Ovni::schedServerExit();
 	}
 
+	inline void immediateSuccessorDecision(
+		__attribute__((unused)) bool taken
+	) {
+	}
+
 	inline void enterProcessReadyTasks()
 	{
 		Ovni::processReadyEnter();
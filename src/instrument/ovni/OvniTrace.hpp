@@ -8,6 +8,7 @@
 #define OVNI_TRACE_HPP
 
 #include <cassert>
+#include <config.h>
 #include <cstdint>
 #include <cstdlib>
 #include <ovni.h>
@@ -18,19 +19,26 @@
 #include "support/config/ConfigVariable.hpp"
 
 #define ALIAS_TRACEPOINT(level, name, str) \
-	static void name()\
+	static inline void name()\
 	{\
-		emitGeneric(level, str);\
+		emitGeneric<level>(str);\
 	}
 
+// The level is checked first, so that disabled events do not need to check
+// whether the ovni thread is ready
 #define ALIAS_TRACEPOINT_MAYBE(level, name, str) \
-	static void name()\
+	static inline void name()\
 	{\
-		if (ovni_thread_isready()) {\
-			emitGeneric(level, str);\
+		if (isLevelEnabled<level>() && ovni_thread_isready()) {\
+			emitEvent(ovni_clock_now(), str);\
 		}\
 	}
 
+// OVNI_MAX_LEVEL is defined by the Nanos6 configure step
+#ifndef OVNI_MAX_LEVEL
+#define OVNI_MAX_LEVEL 3
+#endif
+
 namespace Instrument {
 	const ConfigVariable<unsigned int> _level("instrument.ovni.level");
 
@@ -88,31 +96,82 @@ namespace Instrument {
 	};
 
 	class Ovni {
+		//! The maximum payload of a non-jumbo ovni event
+		static constexpr size_t _maxPayloadSize = 16;
+
 		template <typename T, typename... Ts>
-		static void addPayload(ovni_ev *ev, T first, Ts... args)
+		static inline void stagePayload(uint8_t *buffer, T first, Ts... args)
 		{
-			ovni_payload_add(ev, (uint8_t *)&first, sizeof(T));
-			addPayload(ev, args...);
+			memcpy(buffer, &first, sizeof(T));
+			stagePayload(buffer + sizeof(T), args...);
 		}
 
-		static void addPayload(__attribute__((unused)) ovni_ev *ev)
+		static inline void stagePayload(uint8_t *)
 		{
 		}
 
-		template <typename... Ts>
-		static void emitGeneric(unsigned level, const char *eventCode, Ts... args)
+		//! \brief Add the whole payload of an event at once
+		//!
+		//! The arguments are staged in a buffer of the exact payload size,
+		//! which is computed at compile time, and then added with a single
+		//! call to ovni instead of one call per argument
+		template <typename T, typename... Ts>
+		static inline void addPayload(ovni_ev *ev, T first, Ts... args)
 		{
-			if (level > _level)
-				return;
+			constexpr size_t size = (sizeof(T) + ... + sizeof(Ts));
+			static_assert(size <= _maxPayloadSize, "The payload does not fit in an ovni event");
+
+			uint8_t buffer[size];
+			stagePayload(buffer, first, args...);
+			ovni_payload_add(ev, buffer, size);
+		}
+
+		static inline void addPayload(ovni_ev *)
+		{
+		}
+
+		//! \brief Check whether the events of a given level are emitted
+		//!
+		//! The events above the maximum level of the build are compiled out.
+		//! The rest are checked against the level of the configuration
+		template <unsigned Level>
+		static inline bool isLevelEnabled()
+		{
+			static_assert(Level >= 1, "The minimum ovni level is 1");
 
+			if constexpr (Level > OVNI_MAX_LEVEL) {
+				return false;
+			} else {
+				return (Level <= _level.getValue());
+			}
+		}
+
+		template <typename... Ts>
+		static inline void emitEvent(uint64_t clock, const char *eventCode, Ts... args)
+		{
 			struct ovni_ev ev;
 			memset(&ev, 0, sizeof(struct ovni_ev));
-			ovni_ev_set_clock(&ev, ovni_clock_now());
+			ovni_ev_set_clock(&ev, clock);
 			ovni_ev_set_mcv(&ev, eventCode);
 			addPayload(&ev, args...);
 			ovni_ev_emit(&ev);
 		}
 
+		//! \brief Emit an event of a given level
+		//!
+		//! The level of each event is a template parameter. Events above the
+		//! maximum level of the build are removed at compile time, and the
+		//! rest compare their level with the configured one at run time. The
+		//! clock is not read for events that are not emitted
+		template <unsigned Level, typename... Ts>
+		static inline void emitGeneric(const char *eventCode, Ts... args)
+		{
+			if (!isLevelEnabled<Level>())
+				return;
+
+			emitEvent(ovni_clock_now(), eventCode, args...);
+		}
+
 	public:
 
 		// Nanos6 events divided in categories
@@ -183,61 +242,47 @@ namespace Instrument {
 		// Task lifecycle (these track the state of tasks)
 		static void taskCreate(uint32_t taskId, uint32_t typeId)
 		{
-			emitGeneric(1, "6Tc", taskId, typeId);
+			emitGeneric<1>("6Tc", taskId, typeId);
 		}
 
 		static void taskExecute(uint32_t taskId)
 		{
-			emitGeneric(1, "6Tx", taskId);
+			emitGeneric<1>("6Tx", taskId);
 		}
 
 		static void taskPause(uint32_t taskId)
 		{
-			emitGeneric(1, "6Tp", taskId);
+			emitGeneric<1>("6Tp", taskId);
 		}
 
 		static void taskResume(uint32_t taskId)
 		{
-			emitGeneric(1, "6Tr", taskId);
+			emitGeneric<1>("6Tr", taskId);
 		}
 
 		static void taskEnd(uint32_t taskId)
 		{
-			emitGeneric(1, "6Te", taskId);
+			emitGeneric<1>("6Te", taskId);
 		}
 
 		static void reverseOffloadingEvent(uint64_t value, uint32_t eventType)
 		{
-			if (1 > _level)
-				return;
-
-			struct ovni_ev ev;
-			uint32_t eventId   = 6660; // Reverse Offload task
-			uint64_t time      = ovni_clock_now();
-			memset(&ev, 0, sizeof(struct ovni_ev));
-			ovni_ev_set_clock(&ev, time);
-			ovni_ev_set_mcv(&ev, "Xse");
-			addPayload(&ev, value, eventId, eventType);
-			ovni_ev_emit(&ev);
+			uint32_t eventId = 6660; // Reverse Offload task
+			emitGeneric<1>("Xse", value, eventId, eventType);
 		}
 
 		static void fpgaEvent(uint64_t value, uint32_t eventId, uint32_t eventType, uint64_t time)
 		{
-			if (1 > _level)
+			if (!isLevelEnabled<1>())
 				return;
 
-			struct ovni_ev ev;
-			memset(&ev, 0, sizeof(struct ovni_ev));
-			ovni_ev_set_clock(&ev, time);
-			ovni_ev_set_mcv(&ev, "Xse");
-			addPayload(&ev, value, eventId, eventType);
-			ovni_ev_emit(&ev);
+			emitEvent(time, "Xse", value, eventId, eventType);
 		}
 
 		// Large things like strings need to be sent using jumbo events
 		static inline void typeCreate(uint32_t typeId, const char *label)
 		{
-			if (_level >= 1) {
+			if (isLevelEnabled<1>()) {
 				OvniJumboEvent event;
 				event.addScalarPayload(typeId);
 				event.addString(label);
@@ -254,27 +299,27 @@ namespace Instrument {
 
 		static void affinitySet(int32_t cpu)
 		{
-			emitGeneric(1, "OAs", cpu);
+			emitGeneric<1>("OAs", cpu);
 		}
 
 		static void affinityRemote(int32_t cpu, int32_t tid)
 		{
-			emitGeneric(1, "OAr", cpu, tid);
+			emitGeneric<1>("OAr", cpu, tid);
 		}
 
 		static void cpuCount(int32_t count, int32_t maxcpu)
 		{
-			emitGeneric(1, "OCn", count, maxcpu);
+			emitGeneric<1>("OCn", count, maxcpu);
 		}
 
 		static void threadCreate(int32_t cpu, uint64_t tag)
 		{
-			emitGeneric(1, "OHC", cpu, tag);
+			emitGeneric<1>("OHC", cpu, tag);
 		}
 
 		static void threadExecute(int32_t cpu, int32_t creatorTid, uint64_t tag)
 		{
-			emitGeneric(1, "OHx", cpu, creatorTid, tag);
+			emitGeneric<1>("OHx", cpu, creatorTid, tag);
 		}
 
 		static void threadTypeBegin(char type)
@@ -282,7 +327,7 @@ namespace Instrument {
 			// 6HW 6HL 6HM
 			char mcv[] = {'6', 'H', '?', '\0'};
 			mcv[2] = tolower(type);
-			emitGeneric(1, mcv);
+			emitGeneric<1>(mcv);
 		}
 
 		static void threadTypeEnd(char type)
@@ -290,7 +335,7 @@ namespace Instrument {
 			// 6Hw 6Hl 6Hm
 			char mcv[] = {'6', 'H', '?', '\0'};
 			mcv[2] = toupper(type);
-			emitGeneric(1, mcv);
+			emitGeneric<1>(mcv);
 		}
 
 		static void addCPU(int index, int phyid)
@@ -300,7 +345,7 @@ namespace Instrument {
 
 		static void threadEnd()
 		{
-			emitGeneric(1, "OHe");
+			emitGeneric<1>("OHe");
 			// Flush the events to disk before killing the thread
 			ovni_flush();
 			ovni_thread_free();
@@ -308,7 +353,7 @@ namespace Instrument {
 
 		static void threadSignal(int32_t tid)
 		{
-			emitGeneric(2, "6W*", tid);
+			emitGeneric<2>("6W*", tid);
 		}
 
 		static void checkVersion()
@@ -0,0 +1,104 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_ADD_TASK_HPP
+#define INSTRUMENT_STATS_ADD_TASK_HPP
+
+#include <cassert>
+
+#include "InstrumentStats.hpp"
+#include "InstrumentTaskId.hpp"
+#include "InstrumentTasktypeData.hpp"
+#include "instrument/api/InstrumentAddTask.hpp"
+#include "instrument/support/InstrumentThreadLocalDataSupport.hpp"
+#include "tasks/TaskInfoManager.hpp"
+
+
+namespace Instrument {
+	inline task_id_t enterCreateTask(
+		nanos6_task_info_t *taskInfo,
+		__attribute__((unused)) nanos6_task_invocation_info_t *taskInvokationInfo,
+		__attribute__((unused)) size_t flags,
+		__attribute__((unused)) bool taskRuntimeTransition,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+		assert(taskInfo != nullptr);
+
+		ThreadLocalData &threadLocal = getThreadLocalData();
+		threadLocal._creationStart = Stats::now();
+
+		uint32_t tasktypeId = 0;
+		TaskInfoData *taskInfoData = (TaskInfoData *) taskInfo->task_type_data;
+		if (taskInfoData != nullptr)
+			tasktypeId = taskInfoData->getInstrumentationId()._taskTypeId;
+
+		return task_id_t(new Stats::TaskRecord(tasktypeId));
+	}
+
+	inline void exitCreateTask(
+		__attribute__((unused)) bool taskRuntimeTransition
+	) {
+		ThreadLocalData &threadLocal = getThreadLocalData();
+		threadLocal._creationTime = Stats::now() - threadLocal._creationStart;
+	}
+
+	inline void createdArgsBlock(
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) void *argsBlockPointer,
+		__attribute__((unused)) size_t originalArgsBlockSize,
+		__attribute__((unused)) size_t argsBlockSize,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+
+	inline void createdTask(
+		__attribute__((unused)) void *task,
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+
+	inline void enterSubmitTask(
+		__attribute__((unused)) bool taskRuntimeTransition
+	) {
+		getThreadLocalData()._creationStart = Stats::now();
+	}
+
+	inline void exitSubmitTask(
+		task_id_t taskId,
+		__attribute__((unused)) bool taskRuntimeTransition,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+		assert(taskId._record != nullptr);
+
+		// The creation cost includes the creation and the submission, but
+		// not the user code that fills the args block between them
+		ThreadLocalData &threadLocal = getThreadLocalData();
+		uint64_t submitTime = Stats::now() - threadLocal._creationStart;
+		Stats::addSample(Stats::creation_measure, taskId._record->_tasktypeId, threadLocal._creationTime + submitTime);
+	}
+
+	inline void registeredNewSpawnedTaskType(nanos6_task_info_t *taskInfo)
+	{
+		assert(taskInfo != nullptr);
+		assert(taskInfo->task_type_data != nullptr);
+
+		TaskInfoData *taskInfoData = (TaskInfoData *) taskInfo->task_type_data;
+		taskInfoData->getInstrumentationId().assignNewId();
+	}
+
+	inline void enterSpawnFunction(
+		__attribute__((unused)) bool taskRuntimeTransition
+	) {
+	}
+
+	inline void exitSpawnFunction(
+		__attribute__((unused)) bool taskRuntimeTransition
+	) {
+	}
+}
+
+#endif // INSTRUMENT_STATS_ADD_TASK_HPP
@@ -0,0 +1 @@
+../null/InstrumentBlockingAPI.hpp
\ No newline at end of file
@@ -0,0 +1,26 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_CPU_LOCAL_DATA_HPP
+#define INSTRUMENT_STATS_CPU_LOCAL_DATA_HPP
+
+#include "InstrumentStats.hpp"
+
+
+namespace Instrument {
+	struct CPULocalData {
+		Stats::CPUHistograms _histograms;
+		Stats::ImmediateSuccessorCounters _immediateSuccessors;
+
+		CPULocalData() :
+			_histograms(),
+			_immediateSuccessors()
+		{
+		}
+	};
+}
+
+#endif // INSTRUMENT_STATS_CPU_LOCAL_DATA_HPP
@@ -0,0 +1 @@
+../null/InstrumentComputePlaceId.hpp
\ No newline at end of file
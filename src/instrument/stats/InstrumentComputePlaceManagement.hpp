@@ -0,0 +1 @@
+../null/InstrumentComputePlaceManagement.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentDataAccessId.hpp
\ No newline at end of file
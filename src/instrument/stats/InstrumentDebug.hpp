@@ -0,0 +1 @@
+../null/InstrumentDebug.hpp
\ No newline at end of file
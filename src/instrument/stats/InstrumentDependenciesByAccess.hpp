@@ -0,0 +1 @@
+../null/InstrumentDependenciesByAccess.hpp
\ No newline at end of file
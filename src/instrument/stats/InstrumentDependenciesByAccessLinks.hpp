@@ -0,0 +1 @@
+../null/InstrumentDependenciesByAccessLinks.hpp
\ No newline at end of file
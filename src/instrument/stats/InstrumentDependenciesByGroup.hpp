@@ -0,0 +1 @@
+../null/InstrumentDependenciesByGroup.hpp
\ No newline at end of file
@@ -0,0 +1,39 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
+#define INSTRUMENT_STATS_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
+
+#include <cassert>
+
+#include "InstrumentStats.hpp"
+#include "instrument/api/InstrumentDependencySubsystemEntryPoints.hpp"
+
+
+namespace Instrument {
+
+	inline void enterRegisterTaskDataAcesses() {}
+
+	inline void exitRegisterTaskDataAcesses() {}
+
+	inline void enterUnregisterTaskDataAcesses(task_id_t taskId)
+	{
+		assert(taskId._record != nullptr);
+		taskId._record->_releaseTime.store(Stats::now(), std::memory_order_relaxed);
+	}
+
+	inline void exitUnregisterTaskDataAcesses(task_id_t taskId)
+	{
+		Stats::TaskRecord *record = taskId._record;
+		assert(record != nullptr);
+
+		Stats::addElapsed(Stats::dependency_release_measure, record->_tasktypeId,
+			record->_releaseTime.exchange(0, std::memory_order_relaxed));
+	}
+
+}
+
+#endif //INSTRUMENT_STATS_DEPENDENCY_SUBSYTEM_ENTRY_POINTS_HPP
@@ -0,0 +1 @@
+../null/InstrumentExternalThreadId.hpp
\ No newline at end of file
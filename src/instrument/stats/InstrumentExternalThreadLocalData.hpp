@@ -0,0 +1 @@
+../null/InstrumentExternalThreadLocalData.hpp
\ No newline at end of file
@@ -1,9 +1,47 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
+
 #ifndef INSTRUMENT_STATS_FPGA_EVENTS_HPP
 #define INSTRUMENT_STATS_FPGA_EVENTS_HPP
-#include "instrument/null/InstrumentFPGAEvents.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include "InstrumentStats.hpp"
+#include "instrument/api/InstrumentFPGAEvents.hpp"
+
+
+namespace Instrument {
+	inline uint64_t getCPUTimeForFPGA() {return 0;}
+	inline void startFPGAInstrumentationNewThread() {}
+	inline void startFPGAInstrumentation() {}
+	inline void stopFPGAInstrumentation() {}
+	inline void emitFPGAEvent([[maybe_unused]] uint64_t value,
+		[[maybe_unused]] uint32_t eventId,
+		[[maybe_unused]] uint32_t eventType,
+		[[maybe_unused]] uint64_t utime) {
+		}
+	inline void emitReverseOffloadingEvent([[maybe_unused]] uint64_t value,
+		[[maybe_unused]] uint32_t eventType) {
+		}
+
+	inline void fpgaTaskSubmitted(task_id_t taskId)
+	{
+		assert(taskId._record != nullptr);
+		taskId._record->_fpgaSubmitTime.store(Stats::now(), std::memory_order_relaxed);
+	}
+
+	inline void fpgaTaskFinished(task_id_t taskId)
+	{
+		Stats::TaskRecord *record = taskId._record;
+		assert(record != nullptr);
+
+		Stats::addElapsed(Stats::fpga_submit_to_finish_measure, record->_tasktypeId,
+			record->_fpgaSubmitTime.exchange(0, std::memory_order_relaxed));
+	}
+}
+
 #endif // INSTRUMENT_STATS_FPGA_EVENTS_HPP
@@ -0,0 +1,35 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "InstrumentInitAndShutdown.hpp"
+#include "InstrumentStats.hpp"
+#include "InstrumentTasktypeData.hpp"
+#include "system/RuntimeInfo.hpp"
+#include "tasks/TaskInfoManager.hpp"
+
+
+void Instrument::initialize()
+{
+	RuntimeInfo::addEntry("instrumentation", "Instrumentation", "stats");
+
+	Stats::initialize();
+}
+
+void Instrument::shutdown()
+{
+	Stats::shutdown();
+}
+
+void Instrument::preinitFinished()
+{
+	// Assign an identifier to each registered task type, which selects its
+	// histograms. Spawned task types get theirs when registered
+	TaskInfoManager::processAllTaskInfos(
+		[&](const nanos6_task_info_t *, TaskInfoData &taskInfoData) {
+			taskInfoData.getInstrumentationId().assignNewId();
+		}
+	);
+}
@@ -0,0 +1 @@
+../null/InstrumentInstrumentationContext.hpp
\ No newline at end of file
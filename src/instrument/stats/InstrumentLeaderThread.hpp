@@ -0,0 +1 @@
+../null/InstrumentLeaderThread.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentLogMessage.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentMainThread.hpp
\ No newline at end of file
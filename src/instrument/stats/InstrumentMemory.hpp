@@ -0,0 +1 @@
+../null/InstrumentMemory.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentPthread.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentReductions.hpp
\ No newline at end of file
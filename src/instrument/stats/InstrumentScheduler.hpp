@@ -0,0 +1,57 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_SCHEDULER_HPP
+#define INSTRUMENT_STATS_SCHEDULER_HPP
+
+#include "../api/InstrumentScheduler.hpp"
+#include "InstrumentStats.hpp"
+#include "InstrumentTaskId.hpp"
+
+namespace Instrument {
+
+	inline void enterAddReadyTask() {}
+
+	inline void exitAddReadyTask() {}
+
+	inline void enterGetReadyTask() {}
+
+	inline void exitGetReadyTask() {}
+
+	inline void enterProcessReadyTasks() {}
+
+	inline void exitProcessReadyTasks() {}
+
+	inline void enterSchedulerLock() {}
+
+	inline void schedulerLockBecomesServer() {}
+
+	inline void exitSchedulerLockAsClient(
+		__attribute__((unused)) task_id_t taskId
+	) {
+	}
+
+	inline void exitSchedulerLockAsClient() {}
+
+	inline void schedulerLockServesTask(
+		__attribute__((unused)) task_id_t taskId
+	) {
+	}
+
+	inline void exitSchedulerLockAsServer() {}
+
+	inline void exitSchedulerLockAsServer(
+		__attribute__((unused)) task_id_t taskId
+	) {
+	}
+
+	inline void immediateSuccessorDecision(bool taken)
+	{
+		Stats::addImmediateSuccessorDecision(taken);
+	}
+}
+
+#endif // INSTRUMENT_STATS_SCHEDULER_HPP
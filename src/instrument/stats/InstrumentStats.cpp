@@ -0,0 +1,333 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "InstrumentCPULocalData.hpp"
+#include "InstrumentStats.hpp"
+#include "executors/threads/CPU.hpp"
+#include "executors/threads/CPUManager.hpp"
+#include "instrument/support/InstrumentCPULocalDataSupport.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "support/config/ConfigVariable.hpp"
+#include "tasks/TaskInfoManager.hpp"
+
+
+using namespace Instrument::Stats;
+
+char const *Instrument::Stats::measureNames[num_measures] = {
+	"creation",
+	"ready_to_start",
+	"execution",
+	"dependency_release",
+	"fpga_submit_to_finish"
+};
+
+//! Histograms of the threads that do not run on a CPU of the runtime
+static CPUHistograms _externalHistograms;
+
+//! Immediate successor decisions of the threads that do not run on a CPU
+static ImmediateSuccessorCounters _externalImmediateSuccessors;
+
+//! Percentiles shown in the report
+static const double _percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+static const char *_percentileNames[] = { "p50", "p90", "p99", "p99.9" };
+static const size_t _numPercentiles = sizeof(_percentiles) / sizeof(_percentiles[0]);
+
+
+void Histogram::merge(Histogram const &other)
+{
+	for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+		uint64_t count = other._buckets[i].load(std::memory_order_relaxed);
+		if (count > 0)
+			_buckets[i].fetch_add(count, std::memory_order_relaxed);
+	}
+	_sum.fetch_add(other.getSum(), std::memory_order_relaxed);
+
+	if (other.getMin() < getMin())
+		_min.store(other.getMin(), std::memory_order_relaxed);
+	if (other.getMax() > getMax())
+		_max.store(other.getMax(), std::memory_order_relaxed);
+}
+
+uint64_t Histogram::getCount() const
+{
+	uint64_t count = 0;
+	for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+		count += _buckets[i].load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+uint64_t Histogram::getValueAtPercentile(double percentile) const
+{
+	uint64_t count = getCount();
+	if (count == 0)
+		return 0;
+
+	uint64_t target = (uint64_t) ((percentile / 100.0) * count + 0.5);
+	if (target == 0)
+		target = 1;
+
+	uint64_t accumulated = 0;
+	for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+		accumulated += _buckets[i].load(std::memory_order_relaxed);
+		if (accumulated >= target) {
+			// The bucket may include values above the maximum sample
+			uint64_t value = Histogram::getBucketHighestValue(i);
+			return (value < getMax()) ? value : getMax();
+		}
+	}
+	return getMax();
+}
+
+TasktypeHistograms *CPUHistograms::allocateTasktype(uint32_t tasktypeId)
+{
+	assert(tasktypeId < MAX_TASKTYPES);
+
+	TasktypeHistograms *histograms = new TasktypeHistograms();
+	TasktypeHistograms *expected = nullptr;
+
+	// Another thread may account a sample in the same slot if this is the
+	// histogram of the external threads
+	if (!_tasktypes[tasktypeId].compare_exchange_strong(expected, histograms, std::memory_order_acq_rel)) {
+		delete histograms;
+		return expected;
+	}
+	return histograms;
+}
+
+void Instrument::Stats::addSample(measure_t measure, uint32_t tasktypeId, uint64_t value)
+{
+	CPULocalData *cpuLocalData = getCPULocalData();
+	CPUHistograms *histograms = (cpuLocalData != nullptr) ? &cpuLocalData->_histograms : &_externalHistograms;
+
+	histograms->getTasktype(tasktypeId)->_histograms[measure].add(value);
+}
+
+void Instrument::Stats::addImmediateSuccessorDecision(bool taken)
+{
+	CPULocalData *cpuLocalData = getCPULocalData();
+	ImmediateSuccessorCounters *counters = (cpuLocalData != nullptr) ? &cpuLocalData->_immediateSuccessors : &_externalImmediateSuccessors;
+
+	if (taken) {
+		counters->_taken.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		counters->_rejected.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void Instrument::Stats::initialize()
+{
+	std::string format = ConfigVariable<std::string>("instrument.stats.format");
+	FatalErrorHandler::failIf(
+		format != "text" && format != "json",
+		"Config value ", format, " is not valid for instrument.stats.format"
+	);
+}
+
+static void mergeCPU(std::vector<TasktypeHistograms *> &merged, CPUHistograms &cpuHistograms)
+{
+	for (uint32_t id = 0; id < MAX_TASKTYPES; ++id) {
+		TasktypeHistograms *histograms = cpuHistograms._tasktypes[id].load(std::memory_order_acquire);
+		if (histograms == nullptr)
+			continue;
+
+		if (merged[id] == nullptr)
+			merged[id] = new TasktypeHistograms();
+
+		for (int measure = 0; measure < num_measures; ++measure) {
+			merged[id]->_histograms[measure].merge(histograms->_histograms[measure]);
+		}
+	}
+}
+
+static void mergeCPU(uint64_t &taken, uint64_t &rejected, ImmediateSuccessorCounters &counters)
+{
+	taken += counters._taken.load(std::memory_order_relaxed);
+	rejected += counters._rejected.load(std::memory_order_relaxed);
+}
+
+//! \brief Get the percentage of immediate successor candidates that were taken
+static double getHitRate(uint64_t taken, uint64_t rejected)
+{
+	uint64_t decisions = taken + rejected;
+	return (decisions > 0) ? 100.0 * taken / decisions : 0.0;
+}
+
+static std::string escapeJson(std::string const &text)
+{
+	std::string escaped;
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		} else if ((unsigned char) c < 0x20) {
+			escaped += ' ';
+		} else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+static void writeText(
+	std::ostream &output,
+	std::vector<TasktypeHistograms *> const &merged,
+	std::vector<std::string> const &labels,
+	uint64_t immediateSuccessorsTaken,
+	uint64_t immediateSuccessorsRejected
+) {
+	const int width = 12;
+
+	output << "Nanos6 task statistics (times in microseconds)" << std::endl;
+	output << std::fixed << std::setprecision(3);
+
+	output << std::endl << "Immediate successor candidates: ";
+	output << immediateSuccessorsTaken << " taken, " << immediateSuccessorsRejected << " rejected";
+	output << " (hit rate " << getHitRate(immediateSuccessorsTaken, immediateSuccessorsRejected) << "%)" << std::endl;
+
+	for (uint32_t id = 0; id < MAX_TASKTYPES; ++id) {
+		if (merged[id] == nullptr)
+			continue;
+
+		output << std::endl << "Task type: " << labels[id] << std::endl;
+		output << "  " << std::left << std::setw(24) << "Measure" << std::right;
+		output << std::setw(width) << "Count" << std::setw(width) << "Mean" << std::setw(width) << "Min";
+		for (size_t p = 0; p < _numPercentiles; ++p) {
+			output << std::setw(width) << _percentileNames[p];
+		}
+		output << std::setw(width) << "Max" << std::endl;
+
+		for (int measure = 0; measure < num_measures; ++measure) {
+			Histogram const &histogram = merged[id]->_histograms[measure];
+			uint64_t count = histogram.getCount();
+			if (count == 0)
+				continue;
+
+			output << "  " << std::left << std::setw(24) << measureNames[measure] << std::right;
+			output << std::setw(width) << count;
+			output << std::setw(width) << (double) histogram.getSum() / count / 1000.0;
+			output << std::setw(width) << histogram.getMin() / 1000.0;
+			for (size_t p = 0; p < _numPercentiles; ++p) {
+				output << std::setw(width) << histogram.getValueAtPercentile(_percentiles[p]) / 1000.0;
+			}
+			output << std::setw(width) << histogram.getMax() / 1000.0 << std::endl;
+		}
+	}
+}
+
+static void writeJson(
+	std::ostream &output,
+	std::vector<TasktypeHistograms *> const &merged,
+	std::vector<std::string> const &labels,
+	uint64_t immediateSuccessorsTaken,
+	uint64_t immediateSuccessorsRejected
+) {
+	bool firstTasktype = true;
+
+	output << "{" << std::endl;
+	output << "\t\"unit\": \"ns\"," << std::endl;
+	output << "\t\"immediate_successor\": {";
+	output << " \"taken\": " << immediateSuccessorsTaken;
+	output << ", \"rejected\": " << immediateSuccessorsRejected;
+	output << ", \"hit_rate\": " << getHitRate(immediateSuccessorsTaken, immediateSuccessorsRejected) << " }," << std::endl;
+	output << "\t\"tasktypes\": [";
+
+	for (uint32_t id = 0; id < MAX_TASKTYPES; ++id) {
+		if (merged[id] == nullptr)
+			continue;
+
+		output << (firstTasktype ? "" : ",") << std::endl;
+		output << "\t\t{" << std::endl;
+		output << "\t\t\t\"label\": \"" << escapeJson(labels[id]) << "\"," << std::endl;
+		output << "\t\t\t\"measures\": {";
+		firstTasktype = false;
+
+		bool firstMeasure = true;
+		for (int measure = 0; measure < num_measures; ++measure) {
+			Histogram const &histogram = merged[id]->_histograms[measure];
+			uint64_t count = histogram.getCount();
+			if (count == 0)
+				continue;
+
+			output << (firstMeasure ? "" : ",") << std::endl;
+			output << "\t\t\t\t\"" << measureNames[measure] << "\": {";
+			output << " \"count\": " << count;
+			output << ", \"mean\": " << histogram.getSum() / count;
+			output << ", \"min\": " << histogram.getMin();
+			for (size_t p = 0; p < _numPercentiles; ++p) {
+				output << ", \"" << _percentileNames[p] << "\": " << histogram.getValueAtPercentile(_percentiles[p]);
+			}
+			output << ", \"max\": " << histogram.getMax() << " }";
+			firstMeasure = false;
+		}
+		output << std::endl << "\t\t\t}" << std::endl;
+		output << "\t\t}";
+	}
+	output << std::endl << "\t]" << std::endl;
+	output << "}" << std::endl;
+}
+
+void Instrument::Stats::shutdown()
+{
+	// Merge the histograms of all CPUs. The runtime threads have already
+	// stopped, so the histograms are no longer updated
+	std::vector<TasktypeHistograms *> merged(MAX_TASKTYPES, nullptr);
+	uint64_t immediateSuccessorsTaken = 0;
+	uint64_t immediateSuccessorsRejected = 0;
+
+	std::vector<CPU *> const &cpus = CPUManager::getCPUListReference();
+	for (CPU *cpu : cpus) {
+		mergeCPU(merged, cpu->getInstrumentationData()._histograms);
+		mergeCPU(immediateSuccessorsTaken, immediateSuccessorsRejected, cpu->getInstrumentationData()._immediateSuccessors);
+	}
+	mergeCPU(merged, CPUManager::getLeaderThreadCPU()->getInstrumentationData()._histograms);
+	mergeCPU(merged, _externalHistograms);
+	mergeCPU(immediateSuccessorsTaken, immediateSuccessorsRejected, _externalImmediateSuccessors);
+
+	// Task types without identifier or beyond the limit share the first slot
+	std::vector<std::string> labels(MAX_TASKTYPES, "Other");
+	TaskInfoManager::processAllTaskInfos(
+		[&](const nanos6_task_info_t *, TaskInfoData &taskInfoData) {
+			uint32_t id = taskInfoData.getInstrumentationId()._taskTypeId;
+			if (id > 0 && id < MAX_TASKTYPES)
+				labels[id] = taskInfoData.getTaskTypeLabel();
+		}
+	);
+
+	std::stringstream outputStream;
+	std::string format = ConfigVariable<std::string>("instrument.stats.format");
+	if (format == "json") {
+		writeJson(outputStream, merged, labels, immediateSuccessorsTaken, immediateSuccessorsRejected);
+	} else {
+		writeText(outputStream, merged, labels, immediateSuccessorsTaken, immediateSuccessorsRejected);
+	}
+
+	std::string path = ConfigVariable<std::string>("instrument.stats.output_file");
+	std::ofstream output(path);
+	FatalErrorHandler::warnIf(
+		!output.is_open(),
+		"Could not create or open the stats file: ", path, ". Using standard output."
+	);
+
+	if (output.is_open()) {
+		output << outputStream.str();
+		output.close();
+	} else {
+		std::cout << outputStream.str();
+	}
+
+	for (TasktypeHistograms *histograms : merged) {
+		delete histograms;
+	}
+}
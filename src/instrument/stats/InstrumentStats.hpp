@@ -0,0 +1,137 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_HPP
+#define INSTRUMENT_STATS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "StatsHistogram.hpp"
+#include "support/Chrono.hpp"
+
+
+namespace Instrument {
+	namespace Stats {
+
+		enum measure_t {
+			//! Time spent by the runtime creating and submitting the task
+			creation_measure = 0,
+			//! Time since the task becomes ready until it starts running
+			ready_to_start_measure,
+			//! Time since the task starts running until its body finishes
+			execution_measure,
+			//! Time spent releasing the dependencies of the task
+			dependency_release_measure,
+			//! Time since the task is submitted to an FPGA until it finishes
+			fpga_submit_to_finish_measure,
+			num_measures
+		};
+
+		extern char const *measureNames[num_measures];
+
+		//! Maximum number of task types with separate histograms. The samples
+		//! of the rest of task types are accounted together
+		static constexpr uint32_t MAX_TASKTYPES = 256;
+
+		//! \brief Histograms of all measures of a task type in a CPU
+		struct TasktypeHistograms {
+			Histogram _histograms[num_measures];
+		};
+
+		//! \brief Per-CPU histograms, allocated when a task type first
+		//! accounts a sample in the CPU
+		struct CPUHistograms {
+			std::atomic<TasktypeHistograms *> _tasktypes[MAX_TASKTYPES];
+
+			CPUHistograms()
+			{
+				for (uint32_t i = 0; i < MAX_TASKTYPES; ++i) {
+					_tasktypes[i].store(nullptr, std::memory_order_relaxed);
+				}
+			}
+
+			~CPUHistograms()
+			{
+				for (uint32_t i = 0; i < MAX_TASKTYPES; ++i) {
+					delete _tasktypes[i].load(std::memory_order_relaxed);
+				}
+			}
+
+			inline TasktypeHistograms *getTasktype(uint32_t tasktypeId)
+			{
+				if (tasktypeId >= MAX_TASKTYPES)
+					tasktypeId = 0;
+
+				TasktypeHistograms *histograms = _tasktypes[tasktypeId].load(std::memory_order_acquire);
+				if (histograms == nullptr)
+					histograms = allocateTasktype(tasktypeId);
+				return histograms;
+			}
+
+			TasktypeHistograms *allocateTasktype(uint32_t tasktypeId);
+		};
+
+		//! \brief Decisions on the immediate successor candidates of a CPU
+		struct ImmediateSuccessorCounters {
+			std::atomic<uint64_t> _taken;
+			std::atomic<uint64_t> _rejected;
+
+			ImmediateSuccessorCounters() :
+				_taken(0),
+				_rejected(0)
+			{
+			}
+		};
+
+		//! \brief Timestamps of a task used to compute its measures
+		struct TaskRecord {
+			uint32_t _tasktypeId;
+			std::atomic<uint64_t> _readyTime;
+			std::atomic<uint64_t> _startTime;
+			std::atomic<uint64_t> _releaseTime;
+			std::atomic<uint64_t> _fpgaSubmitTime;
+
+			TaskRecord(uint32_t tasktypeId) :
+				_tasktypeId(tasktypeId),
+				_readyTime(0),
+				_startTime(0),
+				_releaseTime(0),
+				_fpgaSubmitTime(0)
+			{
+			}
+		};
+
+		//! \brief Get the current monotonic time in nanoseconds
+		inline uint64_t now()
+		{
+			return Chrono::now<uint64_t, std::nano>();
+		}
+
+		//! \brief Account a sample in the histograms of the current CPU
+		void addSample(measure_t measure, uint32_t tasktypeId, uint64_t value);
+
+		//! \brief Account an immediate successor decision in the current CPU
+		void addImmediateSuccessorDecision(bool taken);
+
+		//! \brief Account the time elapsed since a timestamp, if it is set
+		inline void addElapsed(measure_t measure, uint32_t tasktypeId, uint64_t since)
+		{
+			if (since == 0)
+				return;
+
+			uint64_t current = now();
+			addSample(measure, tasktypeId, (current > since) ? current - since : 0);
+		}
+
+		void initialize();
+
+		//! \brief Merge the histograms of all CPUs and write the report
+		void shutdown();
+	}
+}
+
+#endif // INSTRUMENT_STATS_HPP
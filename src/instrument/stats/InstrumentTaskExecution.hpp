@@ -0,0 +1,47 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_TASK_EXECUTION_HPP
+#define INSTRUMENT_STATS_TASK_EXECUTION_HPP
+
+#include <cassert>
+
+#include <InstrumentInstrumentationContext.hpp>
+
+#include "InstrumentStats.hpp"
+#include "InstrumentTaskId.hpp"
+#include "instrument/api/InstrumentTaskExecution.hpp"
+
+
+namespace Instrument {
+	inline void startTask(task_id_t taskId, __attribute__((unused)) InstrumentationContext const &context)
+	{
+		Stats::TaskRecord *record = taskId._record;
+		assert(record != nullptr);
+
+		uint64_t current = Stats::now();
+		uint64_t readyTime = record->_readyTime.exchange(0, std::memory_order_relaxed);
+		if (readyTime != 0)
+			Stats::addSample(Stats::ready_to_start_measure, record->_tasktypeId, (current > readyTime) ? current - readyTime : 0);
+
+		record->_startTime.store(current, std::memory_order_relaxed);
+	}
+
+	inline void endTask(task_id_t taskId, __attribute__((unused)) InstrumentationContext const &context)
+	{
+		Stats::TaskRecord *record = taskId._record;
+		assert(record != nullptr);
+
+		Stats::addElapsed(Stats::execution_measure, record->_tasktypeId,
+			record->_startTime.exchange(0, std::memory_order_relaxed));
+	}
+
+	inline void destroyTask(__attribute__((unused)) task_id_t taskId, __attribute__((unused)) InstrumentationContext const &context)
+	{
+	}
+}
+
+#endif // INSTRUMENT_STATS_TASK_EXECUTION_HPP
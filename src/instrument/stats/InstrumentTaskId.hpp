@@ -0,0 +1,36 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_TASK_ID_HPP
+#define INSTRUMENT_STATS_TASK_ID_HPP
+
+
+namespace Instrument {
+	namespace Stats {
+		struct TaskRecord;
+	}
+
+	struct task_id_t {
+		Stats::TaskRecord *_record;
+
+		task_id_t() :
+			_record(nullptr)
+		{
+		}
+
+		task_id_t(Stats::TaskRecord *record) :
+			_record(record)
+		{
+		}
+
+		bool operator==(task_id_t const &other) const
+		{
+			return (_record == other._record);
+		}
+	};
+}
+
+#endif // INSTRUMENT_STATS_TASK_ID_HPP
@@ -0,0 +1,67 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_TASK_STATUS_HPP
+#define INSTRUMENT_STATS_TASK_STATUS_HPP
+
+#include <cassert>
+
+#include "InstrumentStats.hpp"
+#include "InstrumentTaskId.hpp"
+#include "instrument/api/InstrumentTaskStatus.hpp"
+
+
+namespace Instrument {
+	inline void taskIsPending(
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+
+	inline void taskIsReady(
+		task_id_t taskId,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+		assert(taskId._record != nullptr);
+		taskId._record->_readyTime.store(Stats::now(), std::memory_order_relaxed);
+	}
+
+	inline void taskIsExecuting(
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) bool wasBlocked,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+
+	inline void taskIsBlocked(
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) task_blocking_reason_t reason,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+
+	inline void taskIsZombie(
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+
+	inline void taskIsBeingDeleted(
+		task_id_t taskId,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+		delete taskId._record;
+	}
+
+	inline void taskHasNewPriority(
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) long priority,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+}
+
+#endif // INSTRUMENT_STATS_TASK_STATUS_HPP
@@ -0,0 +1 @@
+../null/InstrumentTaskWait.hpp
\ No newline at end of file
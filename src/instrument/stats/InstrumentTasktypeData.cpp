@@ -0,0 +1,10 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "InstrumentTasktypeData.hpp"
+
+
+std::atomic<uint32_t> Instrument::TasktypeInstrument::_nextTaskTypeId(1);
@@ -0,0 +1 @@
+../null/InstrumentThreadId.hpp
\ No newline at end of file
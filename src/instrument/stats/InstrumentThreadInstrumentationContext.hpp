@@ -0,0 +1 @@
+../null/InstrumentThreadInstrumentationContext.hpp
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_THREAD_LOCAL_DATA_HPP
+#define INSTRUMENT_STATS_THREAD_LOCAL_DATA_HPP
+
+#include <cstdint>
+
+#include <InstrumentInstrumentationContext.hpp>
+
+
+namespace Instrument {
+	struct ThreadLocalData {
+		InstrumentationContext _context;
+
+		//! Start of the creation or the submission of the task that the
+		//! thread is currently creating
+		uint64_t _creationStart;
+
+		//! Time spent creating the task, before submitting it
+		uint64_t _creationTime;
+
+		ThreadLocalData() :
+			_context(),
+			_creationStart(0),
+			_creationTime(0)
+		{
+		}
+	};
+}
+
+#endif // INSTRUMENT_STATS_THREAD_LOCAL_DATA_HPP
@@ -0,0 +1 @@
+../null/InstrumentThreadManagement.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentTracingPointTypes.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentTracingPoints.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentUserMutex.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../null/InstrumentWorkerThread.hpp
\ No newline at end of file
@@ -0,0 +1,122 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_HISTOGRAM_HPP
+#define INSTRUMENT_STATS_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Instrument {
+	namespace Stats {
+
+		//! \brief Log-linear histogram of durations in nanoseconds
+		//!
+		//! Each power of two is split in SUB_BUCKETS linear buckets, so the
+		//! values reported from the histogram have a relative error below
+		//! 1/SUB_BUCKETS. The histogram can be updated concurrently, although
+		//! each one is usually updated by the threads of a single CPU
+		class Histogram {
+		public:
+			static constexpr int SUB_BUCKET_BITS = 4;
+			static constexpr uint64_t SUB_BUCKETS = (1ULL << SUB_BUCKET_BITS);
+
+			//! Values of 2^MAX_VALUE_BITS ns (about 18 minutes) or longer
+			//! are accounted in the last bucket
+			static constexpr int MAX_VALUE_BITS = 40;
+
+			static constexpr size_t NUM_BUCKETS = SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+		private:
+			std::atomic<uint64_t> _buckets[NUM_BUCKETS];
+			std::atomic<uint64_t> _sum;
+			std::atomic<uint64_t> _min;
+			std::atomic<uint64_t> _max;
+
+		public:
+			Histogram() :
+				_sum(0),
+				_min(UINT64_MAX),
+				_max(0)
+			{
+				for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+					_buckets[i].store(0, std::memory_order_relaxed);
+				}
+			}
+
+			static inline size_t getBucket(uint64_t value)
+			{
+				if (value < SUB_BUCKETS)
+					return value;
+
+				int magnitude = 63 - __builtin_clzll(value);
+				if (magnitude >= MAX_VALUE_BITS)
+					return NUM_BUCKETS - 1;
+
+				int shift = magnitude - SUB_BUCKET_BITS;
+				uint64_t subBucket = (value >> shift) & (SUB_BUCKETS - 1);
+				return SUB_BUCKETS + shift * SUB_BUCKETS + subBucket;
+			}
+
+			//! \brief Get the highest value accounted in a bucket
+			static inline uint64_t getBucketHighestValue(size_t bucket)
+			{
+				if (bucket < SUB_BUCKETS)
+					return bucket;
+
+				int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+				uint64_t subBucket = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+				uint64_t lowest = (SUB_BUCKETS + subBucket) << shift;
+				return lowest + (1ULL << shift) - 1;
+			}
+
+			inline void add(uint64_t value)
+			{
+				_buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+				_sum.fetch_add(value, std::memory_order_relaxed);
+
+				uint64_t current = _min.load(std::memory_order_relaxed);
+				while (value < current && !_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+				}
+
+				current = _max.load(std::memory_order_relaxed);
+				while (value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+				}
+			}
+
+			//! \brief Accumulate the samples of another histogram
+			//!
+			//! The other histogram must not be updated concurrently
+			void merge(Histogram const &other);
+
+			uint64_t getCount() const;
+
+			inline uint64_t getSum() const
+			{
+				return _sum.load(std::memory_order_relaxed);
+			}
+
+			inline uint64_t getMin() const
+			{
+				return _min.load(std::memory_order_relaxed);
+			}
+
+			inline uint64_t getMax() const
+			{
+				return _max.load(std::memory_order_relaxed);
+			}
+
+			//! \brief Get the value below which a percentage of the samples are
+			//!
+			//! \param[in] percentile The percentage, between 0 and 100
+			uint64_t getValueAtPercentile(double percentile) const;
+		};
+	}
+}
+
+#endif // INSTRUMENT_STATS_HISTOGRAM_HPP
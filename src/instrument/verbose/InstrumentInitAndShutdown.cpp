@@ -165,6 +165,10 @@ namespace Instrument {
 	void addCPUs()
 	{
 	}
+
+	void flightRecorderDump()
+	{
+	}
 } // namespace Instrument
 
 
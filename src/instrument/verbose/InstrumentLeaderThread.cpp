@@ -1,13 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <algorithm>
 #include <cassert>
 #include <iomanip>
 #include <mutex>
+#include <sstream>
 #include <vector>
 
 #include "InstrumentLeaderThread.hpp"
@@ -78,7 +79,11 @@ namespace Instrument {
 			std::sort(entries.begin(), entries.end(), comparator);
 		}
 		
-		// Dump the log and leave the entries ready to be reused
+		// Dump the log and leave the entries ready to be reused. The records
+		// are formatted here, out of the threads that wrote them. Each one is
+		// formatted on a clean stream, as if it had its own stream
+		std::ostringstream line;
+		const std::ostringstream defaultFormat;
 #ifndef __ANDROID__
 		assert(_output != nullptr);
 #endif
@@ -87,39 +92,49 @@ namespace Instrument {
 			for (LogEntry *logEntry : entries) {
 				assert(logEntry != nullptr);
 				
+				line.str("");
+				line.clear();
+				line.copyfmt(defaultFormat);
+				logEntry->_contents.format(line);
+				
 #ifdef __ANDROID__
 				if (_output == nullptr) {
 					__android_log_print(ANDROID_LOG_DEBUG, "Nanos6", "%lu.%09lu %s\n",
 										logEntry->_timestamp.tv_sec, logEntry->_timestamp.tv_nsec,
-										logEntry->_contents.str().c_str());
+										line.str().c_str());
 				} else {
 #endif
 				(*_output) << logEntry->_timestamp.tv_sec << "." << std::setw(9) << std::setfill('0') << logEntry->_timestamp.tv_nsec << std::setw(0) << std::setfill(' ');
-				(*_output) << " " << logEntry->_contents.str() << std::endl;
+				(*_output) << " " << line.str() << std::endl;
 #ifdef __ANDROID__
 				}
 #endif
-				logEntry->_contents.str("");
 			}
 		} else {
 			// Dump the (unsorted) vector in reverse order, which is the actual order of the log creation
 			for (auto it = entries.rbegin(); it != entries.rend(); it++) {
 				LogEntry *logEntry = *it;
+				
+				line.str("");
+				line.clear();
+				line.copyfmt(defaultFormat);
+				logEntry->_contents.format(line);
+				
 #ifdef __ANDROID__
 				if (_output == nullptr) {
-					__android_log_print(ANDROID_LOG_DEBUG, "Nanos6", "%s\n", logEntry->_contents.str().c_str());
+					__android_log_print(ANDROID_LOG_DEBUG, "Nanos6", "%s\n", line.str().c_str());
 				} else {
 #endif
-				(*_output) << logEntry->_contents.str() << std::endl;
+				(*_output) << line.str() << std::endl;
 #ifdef __ANDROID__
 				}
 #endif
-				logEntry->_contents.str("");
 			}
 		}
 		
 		// Recycle the entries
 		for (LogEntry *logEntry : entries) {
+			logEntry->_contents.clear();
 			_freeEntries.push(logEntry, logEntry->_queueSlot);
 		}
 		
@@ -127,6 +142,16 @@ namespace Instrument {
 		entries.clear();
 	}
 	
+	size_t leaderThreadSpinPeriod()
+	{
+		// The log is drained every millisecond unless it is only dumped
+		// at the exit, where the leader thread always calls the spin once
+		if (_dumpOnlyOnExit && !_verboseLeaderThread) {
+			return 0;
+		}
+		return 1000;
+	}
+	
 	void leaderThreadBegin()
 	{
 	}
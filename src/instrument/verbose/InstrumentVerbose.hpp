@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef INSTRUMENT_VERBOSE_HPP
@@ -20,10 +20,14 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <InstrumentInstrumentationContext.hpp>
 
@@ -59,10 +63,126 @@ namespace Instrument {
 		extern std::ofstream *_output;
 
 
+		//! \brief Compact binary record of the contents of a log entry
+		//!
+		//! The values written to the record are stored in binary form, each one
+		//! preceded by the function that formats it. The text is produced when
+		//! the log is dumped, so the threads that write the entries neither
+		//! format strings nor allocate memory once the buffer has grown. Values
+		//! that cannot be copied bytewise are formatted right away
+		class LogRecord {
+			//! Formats a value stored in the record and returns its size
+			typedef size_t (*formatter_t)(std::ostream &stream, char const *data);
+
+			std::vector<char> _buffer;
+
+			template <typename T>
+			static size_t formatValue(std::ostream &stream, char const *data)
+			{
+				typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+				memcpy(&value, data, sizeof(T));
+				stream << *reinterpret_cast<T const *>(&value);
+				return sizeof(T);
+			}
+
+			static size_t formatString(std::ostream &stream, char const *data)
+			{
+				size_t length;
+				memcpy(&length, data, sizeof(length));
+				stream << std::string_view(data + sizeof(length), length);
+				return sizeof(length) + length;
+			}
+
+			inline char *reserve(formatter_t formatter, size_t size)
+			{
+				size_t position = _buffer.size();
+				_buffer.resize(position + sizeof(formatter) + size);
+				memcpy(&_buffer[position], &formatter, sizeof(formatter));
+				return &_buffer[position + sizeof(formatter)];
+			}
+
+			inline void appendString(char const *value, size_t length)
+			{
+				char *data = reserve(&formatString, sizeof(length) + length);
+				memcpy(data, &length, sizeof(length));
+				memcpy(data + sizeof(length), value, length);
+			}
+
+		public:
+			inline LogRecord &operator<<(char const *value)
+			{
+				if (value != nullptr) {
+					appendString(value, strlen(value));
+				}
+				return *this;
+			}
+
+			inline LogRecord &operator<<(std::string const &value)
+			{
+				appendString(value.c_str(), value.size());
+				return *this;
+			}
+
+			inline LogRecord &operator<<(std::ostream &(*manipulator)(std::ostream &))
+			{
+				char *data = reserve(&formatValue<decltype(manipulator)>, sizeof(manipulator));
+				memcpy(data, &manipulator, sizeof(manipulator));
+				return *this;
+			}
+
+			inline LogRecord &operator<<(std::ios_base &(*manipulator)(std::ios_base &))
+			{
+				char *data = reserve(&formatValue<decltype(manipulator)>, sizeof(manipulator));
+				memcpy(data, &manipulator, sizeof(manipulator));
+				return *this;
+			}
+
+			template <typename T>
+			inline LogRecord &operator<<(T const &value)
+			{
+				if constexpr (std::is_same<typename std::decay<T>::type, char *>::value) {
+					return (*this << (char const *) value);
+				} else if constexpr (std::is_trivially_copyable<T>::value) {
+					char *data = reserve(&formatValue<T>, sizeof(T));
+					memcpy(data, &value, sizeof(T));
+				} else {
+					std::ostringstream stream;
+					stream << value;
+					*this << stream.str();
+				}
+				return *this;
+			}
+
+			//! \brief Write the text of the record to a stream
+			inline void format(std::ostream &stream) const
+			{
+				size_t position = 0;
+				while (position < _buffer.size()) {
+					formatter_t formatter;
+					memcpy(&formatter, &_buffer[position], sizeof(formatter));
+					position += sizeof(formatter);
+					position += formatter(stream, &_buffer[position]);
+				}
+			}
+
+			inline std::string str() const
+			{
+				std::ostringstream stream;
+				format(stream);
+				return stream.str();
+			}
+
+			//! \brief Empty the record, keeping its buffer for the next entry
+			inline void clear()
+			{
+				_buffer.clear();
+			}
+		};
+
 		struct LogEntry {
 			timestamp_t _timestamp;
 			ConcurrentUnorderedListSlotManager::Slot _queueSlot;
-			std::ostringstream _contents;
+			LogRecord _contents;
 
 			LogEntry(timestamp_t timestamp, ConcurrentUnorderedListSlotManager::Slot queueSlot, std::ostringstream const &contents)
 				: _timestamp(timestamp), _queueSlot(queueSlot), _contents()
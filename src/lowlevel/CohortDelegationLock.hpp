@@ -0,0 +1,252 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef COHORT_DELEGATION_LOCK_HPP
+#define COHORT_DELEGATION_LOCK_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+#include "DelegationLock.hpp"
+#include "MemoryAllocator.hpp"
+#include "Padding.hpp"
+#include "TicketSpinLock.hpp"
+
+//! \brief A hierarchical delegation lock
+//!
+//! Compute places are grouped in cohorts (e.g., NUMA nodes) and each cohort
+//! has its own delegation lock. The compute place that acquires the lock of
+//! its cohort becomes the server of the cohort and must acquire a global lock
+//! before serving items. Servers only serve items to the compute places of
+//! their cohort, so served items do not cross cohorts. When a server leaves
+//! and there are compute places waiting in its cohort, the global lock is
+//! passed along with the cohort lock, up to MAX_LOCAL_HANDOFFS times in a
+//! row if other cohorts are waiting for the global lock
+template <typename T>
+class CohortDelegationLock {
+private:
+	struct Cohort {
+		//! The delegation lock of the compute places in the cohort
+		DelegationLock<T> _lock;
+
+		//! Whether the global lock was passed to the next server along
+		//! with the lock of the cohort
+		bool _globalPassed;
+
+		Cohort(size_t size) :
+			_lock(size),
+			_globalPassed(false)
+		{
+		}
+	};
+
+	//! Maximum number of consecutive handoffs inside a cohort when
+	//! other cohorts are waiting for the global lock
+	static constexpr size_t MAX_LOCAL_HANDOFFS = 16;
+
+	//! Cohort identifier of the holders of the global lock that do
+	//! not serve items (see tryLock)
+	static constexpr uint64_t NO_COHORT = UINT64_MAX;
+
+	Cohort *_cohorts;
+	const size_t _numCohorts;
+
+	//! The lock protecting the shared resource across cohorts
+	TicketSpinLock<> _globalLock;
+
+	//! The number of threads waiting for the global lock
+	alignas(CACHELINE_SIZE) std::atomic<size_t> _globalWaiters;
+
+	//! The cohort of the current holder of the global lock and the number
+	//! of consecutive handoffs inside that cohort. Only accessed with the
+	//! global lock acquired
+	alignas(CACHELINE_SIZE) uint64_t _serverCohort;
+	size_t _localHandoffs;
+
+public:
+
+	//! \brief Construct a cohort delegation lock
+	//!
+	//! \param[in] size The number of slots in the delegation lock of each
+	//! cohort, i.e., the maximum number of threads that can access the lock
+	//! of a cohort simultaneously
+	//! \param[in] numCohorts The number of cohorts
+	CohortDelegationLock(size_t size, size_t numCohorts) :
+		_cohorts(nullptr),
+		_numCohorts(numCohorts),
+		_globalWaiters(0),
+		_serverCohort(NO_COHORT),
+		_localHandoffs(0)
+	{
+		assert(numCohorts > 0);
+
+		_cohorts = (Cohort *) MemoryAllocator::allocAligned(numCohorts * sizeof(Cohort));
+		assert(_cohorts != nullptr);
+
+		for (size_t i = 0; i < numCohorts; i++) {
+			new (&_cohorts[i]) Cohort(size);
+		}
+	}
+
+	//! \brief Destroy a cohort delegation lock
+	~CohortDelegationLock()
+	{
+		for (size_t i = 0; i < _numCohorts; i++) {
+			_cohorts[i].~Cohort();
+		}
+		MemoryAllocator::freeAligned(_cohorts, _numCohorts * sizeof(Cohort));
+	}
+
+	//! \brief Acquire the lock or wait until someone serves an item
+	//!
+	//! This function blocks the current compute place (busy waiting)
+	//! until we acquire the lock or the server of our cohort has served
+	//! us an item (delegation)
+	//!
+	//! \param[in] cpuIndex The index of the CPU
+	//! \param[in] cohort The cohort of the CPU
+	//! \param[out] item The served item if we did not get the lock
+	//!
+	//! \return Whether the lock was acquired
+	inline bool lockOrDelegate(uint64_t const cpuIndex, uint64_t const cohort, T &item)
+	{
+		assert(cohort < _numCohorts);
+
+		Cohort &localCohort = _cohorts[cohort];
+		if (!localCohort._lock.lockOrDelegate(cpuIndex, item)) {
+			return false;
+		}
+
+		// We are the server of the cohort. Get the global lock unless
+		// the previous server of the cohort passed it to us
+		if (localCohort._globalPassed) {
+			localCohort._globalPassed = false;
+		} else {
+			lockGlobal();
+			_localHandoffs = 0;
+		}
+		_serverCohort = cohort;
+
+		return true;
+	}
+
+	//! \brief Try to acquire the lock without serving items
+	//!
+	//! \return Whether the lock was acquired
+	inline bool tryLock()
+	{
+		if (!_globalLock.tryLock()) {
+			return false;
+		}
+		_serverCohort = NO_COHORT;
+
+		return true;
+	}
+
+	//! \brief Release the lock
+	//!
+	//! This function must be called with the lock acquired
+	inline void unlock()
+	{
+		const uint64_t cohort = _serverCohort;
+		if (cohort == NO_COHORT) {
+			_globalLock.unlock();
+			return;
+		}
+
+		Cohort &localCohort = _cohorts[cohort];
+
+		// Pass the global lock to the next server of the cohort if there is
+		// one, unless the cohort kept it for too long while others wait
+		bool otherCohortsWaiting = (_globalWaiters.load(std::memory_order_relaxed) > 0);
+		if (!localCohort._lock.empty() && (!otherCohortsWaiting || _localHandoffs < MAX_LOCAL_HANDOFFS)) {
+			++_localHandoffs;
+			localCohort._globalPassed = true;
+		} else {
+			_globalLock.unlock();
+		}
+
+		localCohort._lock.unlock();
+	}
+
+	//! \brief Let the servers of other cohorts take the global lock
+	//!
+	//! This function must be called with the lock acquired through
+	//! lockOrDelegate. If other cohorts are waiting, the global lock is
+	//! released and then acquired again, queueing behind them
+	//!
+	//! \return Whether the global lock was released
+	inline bool yield()
+	{
+		const uint64_t cohort = _serverCohort;
+		assert(cohort != NO_COHORT);
+
+		if (_globalWaiters.load(std::memory_order_relaxed) == 0) {
+			return false;
+		}
+
+		_globalLock.unlock();
+		lockGlobal();
+
+		_serverCohort = cohort;
+		_localHandoffs = 0;
+
+		return true;
+	}
+
+	//! \brief Check whether there are no compute places of the server's cohort waiting
+	//!
+	//! This function must be called with the lock acquired through lockOrDelegate
+	inline bool empty() const
+	{
+		return getServerLock().empty();
+	}
+
+	//! \brief Get the index of the first waiting compute place of the server's cohort
+	//!
+	//! This function must be called with the lock acquired through lockOrDelegate
+	//! and there should be a waiting compute place
+	inline uint64_t front() const
+	{
+		return getServerLock().front();
+	}
+
+	//! \brief Unblock the first waiting compute place of the server's cohort
+	//!
+	//! This function must be called with the lock acquired through lockOrDelegate
+	inline void popFront()
+	{
+		getServerLock().popFront();
+	}
+
+	//! \brief Serve an item to a waiting compute place of the server's cohort
+	//!
+	//! This function must be called with the lock acquired through lockOrDelegate
+	//!
+	//! \param[in] cpuIndex The index of the waiting compute place
+	//! \param[in] item The item to be served
+	inline void setItem(const uint64_t cpuIndex, T item)
+	{
+		getServerLock().setItem(cpuIndex, item);
+	}
+
+private:
+	inline void lockGlobal()
+	{
+		_globalWaiters.fetch_add(1, std::memory_order_relaxed);
+		_globalLock.lock();
+		_globalWaiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	inline DelegationLock<T> &getServerLock() const
+	{
+		assert(_serverCohort < _numCohorts);
+		return _cohorts[_serverCohort]._lock;
+	}
+};
+
+#endif // COHORT_DELEGATION_LOCK_HPP
@@ -0,0 +1,264 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PARKING_LOT_HPP
+#define PARKING_LOT_HPP
+
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+//! \brief A futex word shared by a group of parked threads
+//!
+//! Threads park by waiting on the epoch of their lot with a bitset that
+//! identifies their slot. Waking up any number of threads of the same lot
+//! costs a single FUTEX_WAKE_BITSET system call. Threads whose slot bit is
+//! shared with a woken thread see a spurious wake-up and park again
+class ParkingLot {
+public:
+	//! Number of distinct slots; one bit per slot in the futex bitset
+	static constexpr size_t NUM_SLOTS = 32;
+
+private:
+	//! The futex word. It is increased on every wake-up so that a thread
+	//! that is about to wait never misses a concurrent wake-up
+	std::atomic<uint32_t> _epoch;
+
+	//! Next slot to hand out to the threads of the lot
+	std::atomic<uint32_t> _nextSlot;
+
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex words must be 32-bit integers");
+
+public:
+	ParkingLot(const ParkingLot &) = delete;
+	ParkingLot operator=(const ParkingLot &) = delete;
+
+	ParkingLot()
+		: _epoch(0), _nextSlot(0)
+	{
+	}
+
+	//! \brief Get the bitset of a newly assigned slot of the lot
+	inline uint32_t assignSlot()
+	{
+		return 1U << (_nextSlot.fetch_add(1, std::memory_order_relaxed) % NUM_SLOTS);
+	}
+
+	inline uint32_t getEpoch() const
+	{
+		return _epoch.load(std::memory_order_seq_cst);
+	}
+
+	//! \brief Block until a wake-up targets the slot, unless the epoch has changed
+	//!
+	//! \param[in] epoch the epoch read before checking the wake-up condition
+	//! \param[in] slotMask the bitset of the slot of the calling thread
+	inline void wait(uint32_t epoch, uint32_t slotMask)
+	{
+		assert(slotMask != 0);
+
+		// EAGAIN and EINTR are handled by the caller rechecking its condition
+		syscall(SYS_futex, (uint32_t *) &_epoch, FUTEX_WAIT_BITSET_PRIVATE,
+			epoch, nullptr, nullptr, slotMask);
+	}
+
+	//! \brief Wake up all the threads parked on any of the given slots
+	//!
+	//! \param[in] slotsMask the union of the bitsets of the slots to wake up
+	inline void wake(uint32_t slotsMask)
+	{
+		assert(slotsMask != 0);
+
+		_epoch.fetch_add(1, std::memory_order_seq_cst);
+		syscall(SYS_futex, (uint32_t *) &_epoch, FUTEX_WAKE_BITSET_PRIVATE,
+			INT_MAX, nullptr, nullptr, slotsMask);
+	}
+};
+
+
+//! \brief Accumulates the wake-ups of several parked threads
+//!
+//! The wake-ups are grouped by lot and issued when the batch is flushed or
+//! destroyed, so waking N threads of a lot costs one system call
+class ParkingBatch {
+	//! Maximum number of different lots tracked before flushing
+	static constexpr size_t MAX_LOTS = 8;
+
+	ParkingLot *_lots[MAX_LOTS];
+	uint32_t _masks[MAX_LOTS];
+	size_t _numLots;
+
+public:
+	ParkingBatch(const ParkingBatch &) = delete;
+	ParkingBatch operator=(const ParkingBatch &) = delete;
+
+	ParkingBatch()
+		: _numLots(0)
+	{
+	}
+
+	~ParkingBatch()
+	{
+		flush();
+	}
+
+	//! \brief Register the wake-up of a slot of a lot
+	inline void add(ParkingLot *lot, uint32_t slotMask)
+	{
+		assert(lot != nullptr);
+
+		for (size_t i = 0; i < _numLots; ++i) {
+			if (_lots[i] == lot) {
+				_masks[i] |= slotMask;
+				return;
+			}
+		}
+
+		if (_numLots == MAX_LOTS) {
+			flush();
+		}
+
+		_lots[_numLots] = lot;
+		_masks[_numLots] = slotMask;
+		++_numLots;
+	}
+
+	//! \brief Issue the pending wake-ups
+	inline void flush()
+	{
+		for (size_t i = 0; i < _numLots; ++i) {
+			_lots[i]->wake(_masks[i]);
+		}
+		_numLots = 0;
+	}
+};
+
+
+//! \brief The parking state of a single thread
+//!
+//! A thread parks until it is unparked. An unpark that precedes the park
+//! is remembered, so the next park returns immediately. Only one unpark may
+//! be pending at a time
+//!
+//! The owner may return from park and be destroyed as soon as it sees the
+//! unpark, so the unparking thread must not touch the spot after signaling
+//! it. The pending unpark and the parked flag share an atomic word, so the
+//! signal and the check for a sleeping owner are a single operation, and the
+//! lot is read before. Shared lots outlive their threads. The private lot
+//! lives in the spot, which is only destroyed after its owner is joined
+class ParkingSpot {
+	//! Bits of the state of the spot
+	enum state_bits_t : uint32_t {
+		//! There is a pending unpark
+		SIGNALED = 1U << 0,
+		//! The owner is parked or about to park
+		PARKED = 1U << 1
+	};
+
+	//! The lot used when the owner does not belong to any group
+	ParkingLot _privateLot;
+
+	//! Combination of the state bits
+	std::atomic<uint32_t> _state;
+
+	//! The lot where the owner parks and its slot there
+	ParkingLot *_lot;
+	uint32_t _slotMask;
+
+public:
+	ParkingSpot(const ParkingSpot &) = delete;
+	ParkingSpot operator=(const ParkingSpot &) = delete;
+
+	ParkingSpot()
+		: _privateLot(), _state(0), _lot(&_privateLot), _slotMask(_privateLot.assignSlot())
+	{
+	}
+
+	//! \brief Move the spot to a shared lot
+	//!
+	//! This must be called before the owner thread starts
+	inline void setLot(ParkingLot *lot)
+	{
+		assert(lot != nullptr);
+		assert(!(_state.load(std::memory_order_relaxed) & PARKED));
+
+		_lot = lot;
+		_slotMask = lot->assignSlot();
+	}
+
+	//! \brief Block the owner until it is unparked
+	inline void park()
+	{
+		uint32_t state = _state.fetch_or(PARKED, std::memory_order_seq_cst);
+		while (!(state & SIGNALED)) {
+			uint32_t epoch = _lot->getEpoch();
+			state = _state.load(std::memory_order_seq_cst);
+			if (state & SIGNALED)
+				break;
+
+			_lot->wait(epoch, _slotMask);
+			state = _state.load(std::memory_order_seq_cst);
+		}
+
+		// Consume the unpark and initialize for next time
+		_state.store(0, std::memory_order_relaxed);
+	}
+
+	//! \brief Unpark the owner that is parked or will park on the spot
+	inline void unpark()
+	{
+		ParkingLot *lot = _lot;
+		uint32_t slotMask = _slotMask;
+
+		if (signal()) {
+			lot->wake(slotMask);
+		}
+	}
+
+	//! \brief Unpark the owner, deferring the system call to a batch
+	inline void unpark(ParkingBatch &batch)
+	{
+		ParkingLot *lot = _lot;
+		uint32_t slotMask = _slotMask;
+
+		if (signal()) {
+			batch.add(lot, slotMask);
+		}
+	}
+
+	inline bool isPresignaled() const
+	{
+		return (_state.load(std::memory_order_relaxed) & SIGNALED);
+	}
+
+	inline void clearPresignal()
+	{
+		assert(isPresignaled());
+		_state.fetch_and(~SIGNALED, std::memory_order_relaxed);
+	}
+
+private:
+	//! \brief Mark the unpark and check whether the owner may be sleeping
+	//!
+	//! After this call, the spot may no longer exist
+	inline bool signal()
+	{
+		uint32_t previous = _state.fetch_or(SIGNALED, std::memory_order_seq_cst);
+		assert(!(previous & SIGNALED));
+
+		return (previous & PARKED);
+	}
+};
+
+
+#endif // PARKING_LOT_HPP
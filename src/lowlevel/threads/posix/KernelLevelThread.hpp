@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef POSIX_KERNEL_LEVEL_THREAD_HPP
@@ -22,8 +22,8 @@
 
 #include "executors/threads/CPU.hpp"
 #include "lowlevel/CompatSyscalls.hpp"
-#include "lowlevel/ConditionVariable.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/ParkingLot.hpp"
 #include <InstrumentPthread.hpp>
 
 
@@ -37,8 +37,8 @@ protected:
 	pid_t _tid;
 	pid_t _creatorTid; // Who created this thread
 
-	//! This condition variable is used for suspending and resuming the thread
-	ConditionVariable _suspensionConditionVariable;
+	//! This futex-based spot is used for suspending and resuming the thread
+	ParkingSpot _parkingSpot;
 
 	//! stack info to appropriate deallocate it
 	size_t _stackSize;
@@ -99,7 +99,7 @@ public:
 	inline void suspend()
 	{
 		Instrument::pthreadPause();
-		_suspensionConditionVariable.wait();
+		_parkingSpot.park();
 		Instrument::pthreadResume();
 	}
 
@@ -107,7 +107,24 @@ public:
 	inline void resume()
 	{
 		Instrument::pthreadSignal(_tid);
-		_suspensionConditionVariable.signal();
+		_parkingSpot.unpark();
+	}
+
+	//! \brief Resume the thread, deferring the wake-up to a batch
+	//!
+	//! \param[in,out] batch the batch that issues the wake-ups of the same parking lot together
+	inline void resume(ParkingBatch &batch)
+	{
+		Instrument::pthreadSignal(_tid);
+		_parkingSpot.unpark(batch);
+	}
+
+	//! \brief Make the thread park in a lot shared with other threads
+	//!
+	//! This must be called before starting the thread
+	inline void setParkingLot(ParkingLot *parkingLot)
+	{
+		_parkingSpot.setLot(parkingLot);
 	}
 
 	//! \brief Pauses the thread for the given time in nanoseconds
@@ -119,13 +136,13 @@ public:
 	//! \brief check if the thread will resume immediately when calling to suspend
 	inline bool willResumeImmediately()
 	{
-		return _suspensionConditionVariable.isPresignaled();
+		return _parkingSpot.isPresignaled();
 	}
 
 	//! \brief clear the pending resumption mark
 	inline void abortResumption()
 	{
-		_suspensionConditionVariable.clearPresignal();
+		_parkingSpot.clearPresignal();
 	}
 
 	//! \brief code that the thread executes
@@ -0,0 +1,267 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+#include <iomanip>
+
+#include "EnergyMonitor.hpp"
+#include "TaskStatistics.hpp"
+#include "Tasktype.hpp"
+#include "TasktypeStatistics.hpp"
+#include "executors/threads/CPUManager.hpp"
+#include "executors/threads/WorkerThread.hpp"
+#include "hardware-counters/HardwareCounters.hpp"
+#include "hardware-counters/rapl/RAPLHardwareCounters.hpp"
+#include "support/Chrono.hpp"
+#include "tasks/Task.hpp"
+
+
+ConfigVariable<size_t> EnergyMonitor::_samplingRate("monitoring.energy_sampling_rate");
+ConfigVariable<float> EnergyMonitor::_modelIdlePower("monitoring.energy_idle_power");
+ConfigVariable<float> EnergyMonitor::_modelCPUPower("monitoring.energy_cpu_power");
+
+
+EnergyMonitor::EnergyMonitor() :
+	_rapl(HardwareCounters::getRAPLBackend()),
+	_numPackages(1),
+	_sampleLock(),
+	_lastSampleTime(Chrono::now<size_t>())
+{
+	// Compute the package of each CPU. Packages are numbered contiguously
+	const std::vector<CPU *> &cpus = CPUManager::getCPUListReference();
+	_cpuPackages.resize(cpus.size());
+	for (size_t id = 0; id < cpus.size(); ++id) {
+		assert(cpus[id] != nullptr);
+
+		_cpuPackages[id] = cpus[id]->getPackageId();
+		_numPackages = std::max(_numPackages, _cpuPackages[id] + 1);
+	}
+
+	if (_rapl != nullptr && _rapl->getNumPackages() < _numPackages) {
+		FatalErrorHandler::warn("RAPL does not report all the packages, using the synthetic energy model");
+		_rapl = nullptr;
+	}
+
+	// The owned CPUs start running when the runtime is initialized, while the
+	// CPUs acquired through DLB notify when they become active
+	std::vector<size_t> packageOwnedCPUs(_numPackages, 0);
+	_packageNumCPUs.resize(_numPackages, 0);
+	for (size_t id = 0; id < _cpuPackages.size(); ++id) {
+		++_packageNumCPUs[_cpuPackages[id]];
+		if (cpus[id]->isOwned()) {
+			++packageOwnedCPUs[_cpuPackages[id]];
+		}
+	}
+
+	_packageActiveCPUs = new std::atomic<size_t>[_numPackages];
+	_packagePower = new std::atomic<double>[_numPackages];
+	_lastPackageEnergy.resize(_numPackages, 0);
+	_packageEnergy.resize(_numPackages, 0.0);
+
+	for (size_t package = 0; package < _numPackages; ++package) {
+		_packageActiveCPUs[package] = packageOwnedCPUs[package];
+		_packagePower[package] = _modelIdlePower.getValue()
+			+ packageOwnedCPUs[package] * _modelCPUPower.getValue();
+
+		if (_rapl != nullptr && !_rapl->readPackageEnergy(package, _lastPackageEnergy[package])) {
+			FatalErrorHandler::warn("Could not read the RAPL energy of package ", package,
+				", using the synthetic energy model");
+			_rapl = nullptr;
+		}
+	}
+}
+
+EnergyMonitor::~EnergyMonitor()
+{
+	delete [] _packageActiveCPUs;
+	delete [] _packagePower;
+}
+
+bool EnergyMonitor::readEnergy(size_t package, size_t elapsed, double &energy)
+{
+	if (_rapl == nullptr) {
+		// Synthetic model: Watts * microseconds = microjoules
+		double power = _modelIdlePower.getValue()
+			+ getNumPackageActiveCPUs(package) * _modelCPUPower.getValue();
+		energy = power * elapsed;
+		return true;
+	}
+
+	size_t current;
+	if (!_rapl->readPackageEnergy(package, current))
+		return false;
+
+	size_t last = _lastPackageEnergy[package];
+	if (current >= last) {
+		energy = (double) (current - last);
+	} else {
+		// The counter wrapped around
+		size_t range = _rapl->getMaxEnergyRange(package);
+		energy = (range > last) ? (double) (range - last + current) : 0.0;
+	}
+	_lastPackageEnergy[package] = current;
+
+	return true;
+}
+
+void EnergyMonitor::sample()
+{
+	size_t now = Chrono::now<size_t>();
+	if (now - _lastSampleTime.load(std::memory_order_relaxed) < _samplingRate.getValue())
+		return;
+
+	// Only one thread computes each sample; the rest keep the last one
+	if (!_sampleLock.tryLock())
+		return;
+
+	size_t elapsed = now - _lastSampleTime.load(std::memory_order_relaxed);
+	if (elapsed >= _samplingRate.getValue()) {
+		for (size_t package = 0; package < _numPackages; ++package) {
+			double energy;
+			if (readEnergy(package, elapsed, energy)) {
+				_packageEnergy[package] += energy;
+
+				// Microjoules per microsecond = Watts
+				_packagePower[package].store(energy / elapsed, std::memory_order_relaxed);
+			}
+		}
+		_lastSampleTime.store(now, std::memory_order_relaxed);
+	}
+
+	_sampleLock.unlock();
+}
+
+double EnergyMonitor::getIdlePower() const
+{
+	double idlePower = _modelIdlePower.getValue();
+	if (_rapl == nullptr)
+		return idlePower;
+
+	bool measured = false;
+	for (size_t package = 0; package < _numPackages; ++package) {
+		if (getNumPackageActiveCPUs(package) == 0) {
+			double packagePower = getPackagePower(package);
+			if (!measured || packagePower < idlePower) {
+				idlePower = packagePower;
+				measured = true;
+			}
+		}
+	}
+
+	return idlePower;
+}
+
+double EnergyMonitor::getCPUPower() const
+{
+	if (_rapl == nullptr)
+		return _modelCPUPower.getValue();
+
+	const double idlePower = getIdlePower();
+
+	double dynamicPower = 0.0;
+	size_t activeCPUs = 0;
+	for (size_t package = 0; package < _numPackages; ++package) {
+		size_t packageActiveCPUs = getNumPackageActiveCPUs(package);
+		if (packageActiveCPUs > 0) {
+			dynamicPower += std::max(0.0, getPackagePower(package) - idlePower);
+			activeCPUs += packageActiveCPUs;
+		}
+	}
+
+	if (activeCPUs == 0)
+		return _modelCPUPower.getValue();
+
+	return dynamicPower / activeCPUs;
+}
+
+void EnergyMonitor::cpuBecomesActive(int cpuId)
+{
+	assert((size_t) cpuId < _cpuPackages.size());
+
+	const size_t package = _cpuPackages[cpuId];
+	__attribute__((unused)) size_t previous = _packageActiveCPUs[package].fetch_add(1);
+	assert(previous < _packageNumCPUs[package]);
+
+	sample();
+}
+
+void EnergyMonitor::cpuBecomesIdle(int cpuId)
+{
+	assert((size_t) cpuId < _cpuPackages.size());
+
+	// Sample before the CPU stops counting as active
+	sample();
+
+	__attribute__((unused)) size_t previous = _packageActiveCPUs[_cpuPackages[cpuId]].fetch_sub(1);
+	assert(previous > 0);
+}
+
+void EnergyMonitor::taskFinished(Task *task)
+{
+	assert(task != nullptr);
+
+	TaskStatistics *taskStatistics = task->getTaskStatistics();
+	assert(taskStatistics != nullptr);
+
+	TasktypeStatistics *tasktypeStatistics = taskStatistics->getTasktypeStatistics();
+	assert(tasktypeStatistics != nullptr);
+
+	sample();
+
+	// Use the power of a CPU of the package where the task finished. The
+	// power above the idle power of the package is shared by its active CPUs
+	double cpuPower = getCPUPower();
+	WorkerThread *thread = WorkerThread::getCurrentWorkerThread();
+	if (_rapl != nullptr && thread != nullptr && thread->getComputePlace() != nullptr) {
+		CPU *cpu = thread->getComputePlace();
+		size_t package = _cpuPackages[cpu->getIndex()];
+		size_t activeCPUs = std::max((size_t) 1, getNumPackageActiveCPUs(package));
+		cpuPower = std::max(0.0, getPackagePower(package) - getIdlePower()) / activeCPUs;
+	}
+
+	// Watts * microseconds = microjoules
+	Chrono executionTime(taskStatistics->getChronoTicks(executing_status));
+	tasktypeStatistics->increaseAccumulatedEnergy((size_t) (cpuPower * (double) executionTime));
+}
+
+void EnergyMonitor::displayStatistics(std::stringstream &stream)
+{
+	_sampleLock.lock();
+	std::vector<double> packageEnergy(_packageEnergy);
+	_sampleLock.unlock();
+
+	stream << std::left << std::fixed << std::setprecision(5) << "\n";
+	stream << "+-----------------------------+\n";
+	stream << "|      ENERGY STATISTICS      |\n";
+	stream << "+-----------------------------+\n";
+
+	const char *source = (_rapl != nullptr) ? "RAPL" : "MODEL";
+	for (size_t package = 0; package < _numPackages; ++package) {
+		std::string label = "PACKAGE(" + std::to_string(package) + ")";
+		stream <<
+			std::setw(7)  << "STATS"                       << " " <<
+			std::setw(12) << "ENERGY"                      << " " <<
+			std::setw(30) << label                         << " " <<
+			std::setw(25) << source                        << " " <<
+			std::setw(10) << packageEnergy[package] / 1e6  << " J\n";
+	}
+
+	Tasktype::processAllTasktypes(
+		[&](const std::string &taskLabel, const std::string &, TasktypeStatistics &tasktypeStatistics) {
+			size_t energy = tasktypeStatistics.getAccumulatedEnergy();
+			if (energy) {
+				stream <<
+					std::setw(7)  << "STATS"                   << " " <<
+					std::setw(12) << "ENERGY"                  << " " <<
+					std::setw(30) << "TASK-TYPE"               << " " <<
+					std::setw(25) << taskLabel                 << " " <<
+					std::setw(10) << (double) energy / 1e6     << " J\n";
+			}
+		}
+	);
+
+	stream << "+-----------------------------+\n\n";
+}
@@ -0,0 +1,167 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef ENERGY_MONITOR_HPP
+#define ENERGY_MONITOR_HPP
+
+#include <atomic>
+#include <cassert>
+#include <sstream>
+#include <vector>
+
+#include "lowlevel/SpinLock.hpp"
+#include "support/config/ConfigVariable.hpp"
+
+
+class RAPLHardwareCounters;
+class Task;
+
+//! \brief Samples the power of each package and attributes energy to tasks
+//!
+//! The power of each package is sampled periodically by the leader thread,
+//! and also when a CPU changes its state, so that the synthetic model
+//! accounts the time of each number of active CPUs. When the RAPL backend
+//! of hardware counters is enabled, the power is computed from its package
+//! energy counters. Otherwise, a synthetic model computes the power of each
+//! package from its number of active CPUs:
+//!   power = idle_power + active_cpus * cpu_power
+//!
+//! The energy of a task is its execution time multiplied by the power of
+//! an active CPU of the package where it finished
+class EnergyMonitor {
+
+private:
+
+	//! The period in microseconds between power samples
+	static ConfigVariable<size_t> _samplingRate;
+
+	//! The power of an idle package in the synthetic model (Watts)
+	static ConfigVariable<float> _modelIdlePower;
+
+	//! The power of each active CPU in the synthetic model (Watts)
+	static ConfigVariable<float> _modelCPUPower;
+
+	//! The RAPL backend, or nullptr if the synthetic model is used
+	RAPLHardwareCounters *_rapl;
+
+	//! The number of packages
+	size_t _numPackages;
+
+	//! The package of each CPU, indexed by virtual CPU id
+	std::vector<size_t> _cpuPackages;
+
+	//! The number of CPUs of each package
+	std::vector<size_t> _packageNumCPUs;
+
+	//! The number of active CPUs of each package
+	std::atomic<size_t> *_packageActiveCPUs;
+
+	//! The last power sampled of each package (Watts)
+	std::atomic<double> *_packagePower;
+
+	//! Lock taken by the thread that computes a sample
+	SpinLock _sampleLock;
+
+	//! The timestamp in microseconds of the last sample
+	std::atomic<size_t> _lastSampleTime;
+
+	//! The energy counter of each package at the last sample (microjoules).
+	//! Only accessed while holding the sample lock
+	std::vector<size_t> _lastPackageEnergy;
+
+	//! The energy consumed by each package since the initialization
+	//! (microjoules). Only accessed while holding the sample lock
+	std::vector<double> _packageEnergy;
+
+	//! \brief Read the energy counter of a package
+	//!
+	//! \param[in] package The package
+	//! \param[in] elapsed The time since the last sample in microseconds
+	//! \param[out] energy The energy consumed since the last sample
+	//!
+	//! \return Whether the energy could be read
+	bool readEnergy(size_t package, size_t elapsed, double &energy);
+
+public:
+
+	EnergyMonitor();
+
+	~EnergyMonitor();
+
+	//! \brief Whether the energy comes from the synthetic model
+	inline bool isSynthetic() const
+	{
+		return (_rapl == nullptr);
+	}
+
+	inline size_t getNumPackages() const
+	{
+		return _numPackages;
+	}
+
+	inline size_t getNumPackageCPUs(size_t package) const
+	{
+		assert(package < _numPackages);
+
+		return _packageNumCPUs[package];
+	}
+
+	inline size_t getNumPackageActiveCPUs(size_t package) const
+	{
+		assert(package < _numPackages);
+
+		return _packageActiveCPUs[package].load(std::memory_order_relaxed);
+	}
+
+	//! \brief Get the last power sampled of a package in Watts
+	inline double getPackagePower(size_t package) const
+	{
+		assert(package < _numPackages);
+
+		return _packagePower[package].load(std::memory_order_relaxed);
+	}
+
+	//! \brief Get the power of a package without active CPUs in Watts
+	//!
+	//! With RAPL, it is the lowest power sampled of the packages without
+	//! active CPUs. Otherwise, or if all packages have active CPUs, it is
+	//! the power of the model
+	double getIdlePower() const;
+
+	//! \brief Get the power of an active CPU in Watts
+	//!
+	//! With RAPL, the power above the idle power of each package is divided
+	//! among its active CPUs. Otherwise, it is the power of the model
+	double getCPUPower() const;
+
+	//! \brief Get the period in microseconds between power samples
+	static inline size_t getSamplingRate()
+	{
+		return _samplingRate.getValue();
+	}
+
+	//! \brief Signal that a CPU just became active
+	void cpuBecomesActive(int cpuId);
+
+	//! \brief Signal that a CPU just became idle
+	void cpuBecomesIdle(int cpuId);
+
+	//! \brief Sample the power of all packages if the sampling period expired
+	void sample();
+
+	//! \brief Attribute the energy of a finished task to its tasktype
+	//!
+	//! \param[in] task The task, whose execution time must be final
+	void taskFinished(Task *task);
+
+	//! \brief Display energy statistics
+	//!
+	//! \param[out] stream The output stream
+	void displayStatistics(std::stringstream &stream);
+
+};
+
+#endif // ENERGY_MONITOR_HPP
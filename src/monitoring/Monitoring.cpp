@@ -1,18 +1,22 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <config.h>
+#include <cmath>
 #include <fstream>
+#include <map>
 
 #include "CPUMonitor.hpp"
+#include "EnergyMonitor.hpp"
 #include "Monitoring.hpp"
 #include "MonitoringSupport.hpp"
 #include "TaskMonitor.hpp"
 #include "Tasktype.hpp"
 #include "TasktypeStatistics.hpp"
+#include "WisdomFile.hpp"
 #include "executors/threads/CPUManager.hpp"
 #include "hardware-counters/HardwareCounters.hpp"
 #include "hardware-counters/SupportedHardwareCounters.hpp"
@@ -24,10 +28,12 @@
 ConfigVariable<bool> Monitoring::_enabled("monitoring.enabled");
 ConfigVariable<bool> Monitoring::_verbose("monitoring.verbose");
 ConfigVariable<bool> Monitoring::_wisdomEnabled("monitoring.wisdom");
+ConfigVariable<bool> Monitoring::_energyEnabled("monitoring.energy");
 ConfigVariable<std::string> Monitoring::_outputFile("monitoring.verbose_file");
-JsonFile *Monitoring::_wisdom(nullptr);
+WisdomFile *Monitoring::_wisdom(nullptr);
 CPUMonitor *Monitoring::_cpuMonitor(nullptr);
 TaskMonitor *Monitoring::_taskMonitor(nullptr);
+EnergyMonitor *Monitoring::_energyMonitor(nullptr);
 size_t Monitoring::_predictedCPUUsage(0);
 
 
@@ -56,6 +62,13 @@ void Monitoring::initialize()
 		// Create the CPU monitor
 		_cpuMonitor = new CPUMonitor();
 		assert(_cpuMonitor != nullptr);
+
+		// Create the energy monitor after the hardware counters, since it
+		// reads the RAPL backend if enabled
+		if (_energyEnabled) {
+			_energyMonitor = new EnergyMonitor();
+			assert(_energyMonitor != nullptr);
+		}
 	}
 }
 
@@ -79,6 +92,11 @@ void Monitoring::shutdown()
 		delete _taskMonitor;
 		_cpuMonitor = nullptr;
 		_taskMonitor = nullptr;
+
+		if (_energyMonitor != nullptr) {
+			delete _energyMonitor;
+			_energyMonitor = nullptr;
+		}
 		_enabled.setValue(false);
 	}
 }
@@ -132,6 +150,10 @@ void Monitoring::taskFinished(Task *task)
 
 		// Mark task as completely executed
 		_taskMonitor->taskFinished(task);
+
+		if (_energyMonitor != nullptr) {
+			_energyMonitor->taskFinished(task);
+		}
 	}
 }
 
@@ -144,6 +166,10 @@ void Monitoring::cpuBecomesIdle(int cpuId)
 		assert(_cpuMonitor != nullptr);
 
 		_cpuMonitor->cpuBecomesIdle(cpuId);
+
+		if (_energyMonitor != nullptr) {
+			_energyMonitor->cpuBecomesIdle(cpuId);
+		}
 	}
 }
 
@@ -153,6 +179,10 @@ void Monitoring::cpuBecomesActive(int cpuId)
 		assert(_cpuMonitor != nullptr);
 
 		_cpuMonitor->cpuBecomesActive(cpuId);
+
+		if (_energyMonitor != nullptr) {
+			_energyMonitor->cpuBecomesActive(cpuId);
+		}
 	}
 }
 
@@ -244,6 +274,9 @@ void Monitoring::displayStatistics()
 	std::stringstream outputStream;
 	_taskMonitor->displayStatistics(outputStream);
 	_cpuMonitor->displayStatistics(outputStream);
+	if (_energyMonitor != nullptr) {
+		_energyMonitor->displayStatistics(outputStream);
+	}
 
 	if (output.is_open()) {
 		output << outputStream.str();
@@ -255,78 +288,89 @@ void Monitoring::displayStatistics()
 
 void Monitoring::loadMonitoringWisdom()
 {
-	// Create a representation of the system file as a JsonFile
-	_wisdom = new JsonFile("./.nanos6-monitoring-wisdom.json");
+	_wisdom = new WisdomFile("./.nanos6-monitoring-wisdom.bin");
 	assert(_wisdom != nullptr);
 
+	// If there is no binary wisdom yet, convert the JSON wisdom of older
+	// versions, if any
+	if (!_wisdom->load()) {
+		if (!convertLegacyMonitoringWisdom() || !_wisdom->load())
+			return;
+	}
+
+	// Find the position of each metric in the file only once
+	const std::vector<HWCounters::counters_t> &enabledCounters =
+		HardwareCounters::getEnabledCounters();
+	int costIndex = _wisdom->getMetricIndex("NORMALIZED_COST");
+	std::vector<int> counterIndexes(enabledCounters.size());
+	for (size_t i = 0; i < enabledCounters.size(); ++i) {
+		counterIndexes[i] = _wisdom->getMetricIndex(HWCounters::counterDescriptions[enabledCounters[i]]);
+	}
+
+	// Look up each registered tasktype in the file
+	Tasktype::processAllTasktypes(
+		[&](const std::string &taskLabel, const std::string &, TasktypeStatistics &tasktypeStatistics) {
+			const double *values = _wisdom->getValues(taskLabel);
+			if (values == nullptr)
+				return;
+
+			if (costIndex >= 0 && !std::isnan(values[costIndex])) {
+				tasktypeStatistics.insertNormalizedTime(values[costIndex]);
+			}
+
+			for (size_t i = 0; i < counterIndexes.size(); ++i) {
+				if (counterIndexes[i] >= 0 && !std::isnan(values[counterIndexes[i]])) {
+					tasktypeStatistics.insertNormalizedCounter(i, values[counterIndexes[i]]);
+				}
+			}
+		}
+	);
+}
+
+bool Monitoring::convertLegacyMonitoringWisdom()
+{
+	JsonFile legacyWisdom("./.nanos6-monitoring-wisdom.json");
+	if (!legacyWisdom.fileExists())
+		return false;
+
 	// Try to populate the JsonFile with the system file's data
-	_wisdom->loadData();
+	legacyWisdom.loadData();
 
-	// Navigate through the file and extract metrics of each tasktype
-	_wisdom->getRootNode()->traverseChildrenNodes(
+	// Gather all the metrics of each tasktype in the file
+	WisdomFile::wisdom_data_t data;
+	legacyWisdom.getRootNode()->traverseChildrenNodes(
 		[&](const std::string &label, const JsonNode<> &metricsNode) {
-			// For each tasktype in the file, process all current registered
-			// tasktypes to check if we must copy the wisdom data into them
-			Tasktype::processAllTasktypes(
-				[&](const std::string &taskLabel, const std::string &, TasktypeStatistics &tasktypeStatistics) {
-					if (taskLabel == label) {
-						// Labels coincide, first copy Monitoring data
-						if (metricsNode.dataExists("NORMALIZED_COST")) {
-							double metricValue = 0.0;
-							bool converted = metricsNode.getData("NORMALIZED_COST", metricValue);
-							if (converted) {
-								tasktypeStatistics.insertNormalizedTime(metricValue);
-							}
-						}
-
-						// Next, copy Hardware Counters data if existent
-						const std::vector<HWCounters::counters_t> &enabledCounters =
-							HardwareCounters::getEnabledCounters();
-						for (size_t i = 0; i < enabledCounters.size(); ++i) {
-							HWCounters::counters_t counterType = enabledCounters[i];
-							std::string metricLabel(HWCounters::counterDescriptions[counterType]);
-							if (metricsNode.dataExists(metricLabel)) {
-								double metricValue = 0.0;
-								bool converted = metricsNode.getData(metricLabel, metricValue);
-								if (converted) {
-									tasktypeStatistics.insertNormalizedCounter(i, metricValue);
-								}
-							}
-						}
+			JsonNode<> tasktypeNode(metricsNode);
+			tasktypeNode.traverseChildrenNodes(
+				[&](const std::string &metricLabel, const JsonNode<> &) {
+					double metricValue = 0.0;
+					if (metricsNode.getData(metricLabel, metricValue)) {
+						data[label][metricLabel] = metricValue;
 					}
 				}
 			);
 		}
 	);
+
+	assert(_wisdom != nullptr);
+	_wisdom->store(data);
+
+	return true;
 }
 
 void Monitoring::storeMonitoringWisdom()
 {
 	assert(_wisdom != nullptr);
 
-	JsonNode<> *rootNode = _wisdom->getRootNode();
-	assert(rootNode != nullptr);
-
-	// A vector of nodes to save
-	std::vector<std::pair<std::string, JsonNode<double>>> nodesToSave;
+	WisdomFile::wisdom_data_t data;
 
 	// Process all the tasktypes and gather Monitoring and Hardware Counters metrics
 	Tasktype::processAllTasktypes(
 		[&](const std::string &taskLabel, const std::string &, TasktypeStatistics &tasktypeStatistics) {
-			// If the file already contains this tasktype as a node, retreive
-			// its inner node instead of creating a new one
-			JsonNode<double> tasktypeNode;
-			if (rootNode->childNodeExists(taskLabel)) {
-				tasktypeNode = rootNode->getChildNode(taskLabel);
-			}
+			std::map<std::string, double> &metrics = data[taskLabel];
 
 			// Retreive monitoring statistics
-			double value = tasktypeStatistics.getTimingRollingAverage();
-			if (tasktypeNode.dataExists("NORMALIZED_COST")) {
-				tasktypeNode.replaceData("NORMALIZED_COST", value);
-			} else {
-				tasktypeNode.addData("NORMALIZED_COST", value);
-			}
+			metrics["NORMALIZED_COST"] = tasktypeStatistics.getTimingRollingAverage();
 
 			// Retrieve hardware counter metrics
 			const std::vector<HWCounters::counters_t> &enabledCounters =
@@ -334,34 +378,17 @@ void Monitoring::storeMonitoringWisdom()
 			for (size_t i = 0; i < enabledCounters.size(); ++i) {
 				double counterValue = tasktypeStatistics.getCounterRollingAverage(i);
 				if (counterValue >= 0.0) {
-					std::string counterLabel(HWCounters::counterDescriptions[enabledCounters[i]]);
-					if (tasktypeNode.dataExists(counterLabel)) {
-						tasktypeNode.replaceData(counterLabel, counterValue);
-					} else {
-						tasktypeNode.addData(counterLabel, counterValue);
-					}
+					metrics[HWCounters::counterDescriptions[enabledCounters[i]]] = counterValue;
 				}
 			}
-
-			// Finally, add the new or updated tasktype node
-			nodesToSave.push_back(std::make_pair(taskLabel, tasktypeNode));
 		}
 	);
 
-	// Clear the wisdom file
-	_wisdom->clearFile();
-
-	// Save all the new/updated nodes in the file
-	for (size_t i = 0; i < nodesToSave.size(); ++i) {
-		rootNode->addChildNode(
-			nodesToSave[i].first,
-			nodesToSave[i].second
-		);
-	}
-
-	// Store the data from the JsonFile in the system file
-	_wisdom->storeData();
+	// Merge the metrics with the ones already in the file, which may have
+	// been updated by other processes since it was loaded
+	_wisdom->store(data);
 
 	// Delete the file as it is no longer needed
 	delete _wisdom;
+	_wisdom = nullptr;
 }
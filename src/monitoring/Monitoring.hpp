@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MONITORING_HPP
@@ -16,9 +16,10 @@
 
 
 class CPUMonitor;
-class JsonFile;
+class EnergyMonitor;
 class Task;
 class TaskMonitor;
+class WisdomFile;
 
 class Monitoring {
 
@@ -33,11 +34,14 @@ private:
 	//! Whether the wisdom mechanism is enabled
 	static ConfigVariable<bool> _wisdomEnabled;
 
+	//! Whether the energy of packages and tasktypes is monitored
+	static ConfigVariable<bool> _energyEnabled;
+
 	//! The file where output is saved in, if verbose mode is enabled
 	static ConfigVariable<std::string> _outputFile;
 
-	//! A Json file for monitoring data
-	static JsonFile *_wisdom;
+	//! The binary file with monitoring data of previous executions
+	static WisdomFile *_wisdom;
 
 	//    MONITORS    //
 
@@ -47,6 +51,9 @@ private:
 	//! A monitor that handles task statistics
 	static TaskMonitor *_taskMonitor;
 
+	//! A monitor that handles energy statistics, if enabled
+	static EnergyMonitor *_energyMonitor;
+
 	//    CPU USAGE PREDICTION VARIABLES    //
 
 	//! The most recent past CPU usage prediction
@@ -60,6 +67,11 @@ private:
 	//! \brief Try to load previous monitoring data into accumulators
 	static void loadMonitoringWisdom();
 
+	//! \brief Convert the JSON wisdom file of older versions to the binary format
+	//!
+	//! \return Whether there was a JSON wisdom file
+	static bool convertLegacyMonitoringWisdom();
+
 	//! \brief Store monitoring data for future executions as warm-up data
 	static void storeMonitoringWisdom();
 
@@ -83,6 +95,20 @@ public:
 	{
 		return _enabled;
 	}
+
+	//! \brief Check whether energy monitoring is enabled
+	static inline bool isEnergyEnabled()
+	{
+		return (_enabled && _energyEnabled);
+	}
+
+	//! \brief Get the energy monitor
+	//!
+	//! \return The energy monitor or nullptr if it is not enabled
+	static inline EnergyMonitor *getEnergyMonitor()
+	{
+		return _energyMonitor;
+	}
 	
 	//! \brief Check and register a Tasktype after registering a taskinfo
 	static inline void registerTasktype(nanos6_task_info_t *task_info)
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASKTYPE_STATISTICS_HPP
@@ -86,6 +86,11 @@ private:
 	//! Spinlock to ensure atomic access within the previous accumulators
 	SpinLock _timingAccumulatorLock;
 
+	//    ENERGY METRICS    //
+
+	//! The energy attributed to the instances of this tasktype (in microjoules)
+	std::atomic<size_t> _accumulatedEnergy;
+
 	//    HARDWARE COUNTER METRICS    //
 
 	//! A vector of hardware counter accumulators
@@ -118,6 +123,7 @@ public:
 		_timingAccuracyAccumulator(),
 		_accumulatedTimeAccumulator(),
 		_timingAccumulatorLock(),
+		_accumulatedEnergy(0),
 		_counterAccumulators(HWCounters::HWC_TOTAL_NUM_EVENTS),
 		_normalizedCounterAccumulators(
 			HWCounters::HWC_TOTAL_NUM_EVENTS,
@@ -204,6 +210,16 @@ public:
 		return _completedTime.load();
 	}
 
+	inline void increaseAccumulatedEnergy(size_t microjoules)
+	{
+		_accumulatedEnergy += microjoules;
+	}
+
+	inline size_t getAccumulatedEnergy()
+	{
+		return _accumulatedEnergy.load();
+	}
+
 	inline double getAccumulatedTime()
 	{
 		_timingAccumulatorLock.lock();
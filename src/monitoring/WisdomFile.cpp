@@ -0,0 +1,326 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <set>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "WisdomFile.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+
+
+static const char _magic[8] = { 'N', '6', 'W', 'I', 'S', 'D', 'O', 'M' };
+
+
+//! \brief Compare a label with a string of the file, as std::string does
+static inline int compareLabel(const std::string &label, const char *string, size_t length)
+{
+	int result = memcmp(label.data(), string, std::min(label.size(), length));
+	if (result != 0)
+		return result;
+
+	return (label.size() < length) ? -1 : ((label.size() > length) ? 1 : 0);
+}
+
+//! \brief Write a whole buffer into a file, retrying on short writes
+static bool writeAll(int fd, const void *buffer, size_t size)
+{
+	const char *data = (const char *) buffer;
+	while (size > 0) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		data += written;
+		size -= written;
+	}
+	return true;
+}
+
+bool WisdomFile::map(int fd)
+{
+	assert(_mapping == nullptr);
+
+	struct stat fileStatus;
+	if (fstat(fd, &fileStatus) != 0 || (size_t) fileStatus.st_size < sizeof(Header))
+		return false;
+
+	size_t size = fileStatus.st_size;
+	void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapping == MAP_FAILED) {
+		FatalErrorHandler::warn("Could not map the wisdom file ", _path, ": ", strerror(errno));
+		return false;
+	}
+
+	_mapping = mapping;
+	_mappingSize = size;
+
+	const char *base = (const char *) mapping;
+	const Header *header = (const Header *) base;
+	if (memcmp(header->_magic, _magic, sizeof(_magic)) != 0 || header->_version != FORMAT_VERSION) {
+		FatalErrorHandler::warn("The wisdom file ", _path, " has an unknown format or version, ignoring it");
+		unmap();
+		return false;
+	}
+
+	// Validate the sections before accessing them
+	const uint64_t numMetrics = header->_numMetrics;
+	const uint64_t numEntries = header->_numEntries;
+	const uint64_t referencesEnd = sizeof(Header) + (numMetrics + numEntries) * sizeof(StringReference);
+	bool valid = (header->_fileSize == size)
+		&& (header->_valuesOffset == referencesEnd)
+		&& (header->_stringsOffset == header->_valuesOffset + numMetrics * numEntries * sizeof(double))
+		&& (header->_stringsOffset <= size);
+
+	if (valid) {
+		const StringReference *references = (const StringReference *) (base + sizeof(Header));
+		const uint64_t stringsSize = size - header->_stringsOffset;
+		for (uint64_t i = 0; i < numMetrics + numEntries && valid; ++i) {
+			valid = (references[i]._offset <= stringsSize)
+				&& (references[i]._length <= stringsSize - references[i]._offset);
+		}
+	}
+
+	if (!valid) {
+		FatalErrorHandler::warn("The wisdom file ", _path, " is corrupted, ignoring it");
+		unmap();
+		return false;
+	}
+
+	_header = header;
+	_metrics = (const StringReference *) (base + sizeof(Header));
+	_entries = _metrics + numMetrics;
+	_values = (const double *) (base + header->_valuesOffset);
+	_strings = base + header->_stringsOffset;
+
+	return true;
+}
+
+void WisdomFile::unmap()
+{
+	if (_mapping != nullptr) {
+		munmap(_mapping, _mappingSize);
+		_mapping = nullptr;
+		_mappingSize = 0;
+	}
+
+	_header = nullptr;
+	_metrics = nullptr;
+	_entries = nullptr;
+	_values = nullptr;
+	_strings = nullptr;
+}
+
+bool WisdomFile::load()
+{
+	unmap();
+
+	int fd = open(_path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	// The mapping remains valid after closing the file, even if another
+	// process replaces the file meanwhile
+	bool loaded = map(fd);
+	close(fd);
+
+	return loaded;
+}
+
+int WisdomFile::getMetricIndex(const std::string &metric) const
+{
+	if (_header == nullptr)
+		return -1;
+
+	for (uint32_t i = 0; i < _header->_numMetrics; ++i) {
+		if (compareLabel(metric, _strings + _metrics[i]._offset, _metrics[i]._length) == 0)
+			return (int) i;
+	}
+	return -1;
+}
+
+const double *WisdomFile::getValues(const std::string &label) const
+{
+	if (_header == nullptr)
+		return nullptr;
+
+	// The entries are sorted by label
+	uint64_t low = 0;
+	uint64_t high = _header->_numEntries;
+	while (low < high) {
+		uint64_t middle = low + (high - low) / 2;
+		const StringReference &entry = _entries[middle];
+
+		int result = compareLabel(label, _strings + entry._offset, entry._length);
+		if (result == 0) {
+			return _values + middle * _header->_numMetrics;
+		} else if (result < 0) {
+			high = middle;
+		} else {
+			low = middle + 1;
+		}
+	}
+	return nullptr;
+}
+
+void WisdomFile::exportData(wisdom_data_t &data) const
+{
+	assert(_header != nullptr);
+
+	std::vector<std::string> metrics;
+	for (uint32_t i = 0; i < _header->_numMetrics; ++i) {
+		metrics.push_back(getString(_metrics[i]));
+	}
+
+	for (uint64_t entry = 0; entry < _header->_numEntries; ++entry) {
+		std::map<std::string, double> &values = data[getString(_entries[entry])];
+
+		const double *entryValues = _values + entry * _header->_numMetrics;
+		for (uint32_t i = 0; i < _header->_numMetrics; ++i) {
+			if (!std::isnan(entryValues[i])) {
+				values[metrics[i]] = entryValues[i];
+			}
+		}
+	}
+}
+
+bool WisdomFile::writeData(const wisdom_data_t &data, const std::string &path) const
+{
+	// Gather the metrics of all tasktypes
+	std::set<std::string> metricSet;
+	for (auto const &entry : data) {
+		for (auto const &value : entry.second) {
+			metricSet.insert(value.first);
+		}
+	}
+	std::vector<std::string> metrics(metricSet.begin(), metricSet.end());
+
+	const uint64_t numMetrics = metrics.size();
+	const uint64_t numEntries = data.size();
+
+	std::vector<StringReference> references;
+	std::vector<double> values(numMetrics * numEntries, std::numeric_limits<double>::quiet_NaN());
+	std::string strings;
+
+	for (const std::string &metric : metrics) {
+		references.push_back({ strings.size(), metric.size() });
+		strings += metric;
+	}
+
+	// The map is sorted by label, as required by the lookups
+	uint64_t entry = 0;
+	for (auto const &tasktype : data) {
+		references.push_back({ strings.size(), tasktype.first.size() });
+		strings += tasktype.first;
+
+		for (auto const &value : tasktype.second) {
+			size_t metric = std::lower_bound(metrics.begin(), metrics.end(), value.first) - metrics.begin();
+			values[entry * numMetrics + metric] = value.second;
+		}
+		++entry;
+	}
+
+	Header header;
+	memcpy(header._magic, _magic, sizeof(_magic));
+	header._version = FORMAT_VERSION;
+	header._numMetrics = numMetrics;
+	header._numEntries = numEntries;
+	header._valuesOffset = sizeof(Header) + references.size() * sizeof(StringReference);
+	header._stringsOffset = header._valuesOffset + values.size() * sizeof(double);
+	header._fileSize = header._stringsOffset + strings.size();
+
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		FatalErrorHandler::warn("Could not create the wisdom file ", path, ": ", strerror(errno));
+		return false;
+	}
+
+	// Flush the content to the disk before the file replaces the current
+	// one, so a crash never leaves a truncated wisdom file in its place
+	bool written = writeAll(fd, &header, sizeof(header))
+		&& writeAll(fd, references.data(), references.size() * sizeof(StringReference))
+		&& writeAll(fd, values.data(), values.size() * sizeof(double))
+		&& writeAll(fd, strings.data(), strings.size())
+		&& (fsync(fd) == 0);
+
+	if (!written) {
+		FatalErrorHandler::warn("Could not write the wisdom file ", path, ": ", strerror(errno));
+	}
+
+	if (close(fd) != 0 && written) {
+		FatalErrorHandler::warn("Could not close the wisdom file ", path, ": ", strerror(errno));
+		written = false;
+	}
+
+	return written;
+}
+
+void WisdomFile::store(const wisdom_data_t &data)
+{
+	// Lock the current file. Another process may replace it while waiting
+	// for the lock, so retry until the locked file is the one in the path
+	int fd;
+	while (true) {
+		fd = open(_path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0) {
+			FatalErrorHandler::warn("Could not open the wisdom file ", _path, ": ", strerror(errno));
+			return;
+		}
+
+		if (flock(fd, LOCK_EX) != 0) {
+			FatalErrorHandler::warn("Could not lock the wisdom file ", _path, ": ", strerror(errno));
+			close(fd);
+			return;
+		}
+
+		struct stat fdStatus, pathStatus;
+		if (fstat(fd, &fdStatus) == 0 && stat(_path.c_str(), &pathStatus) == 0
+			&& fdStatus.st_dev == pathStatus.st_dev && fdStatus.st_ino == pathStatus.st_ino
+		) {
+			break;
+		}
+		close(fd);
+	}
+
+	// Merge the current content of the file with the new data
+	wisdom_data_t merged;
+	unmap();
+	if (map(fd)) {
+		exportData(merged);
+	}
+	unmap();
+
+	for (auto const &tasktype : data) {
+		std::map<std::string, double> &values = merged[tasktype.first];
+		for (auto const &value : tasktype.second) {
+			values[value.first] = value.second;
+		}
+	}
+
+	// Replace the file atomically, so readers never see a partial file
+	std::string temporaryPath = _path + ".tmp." + std::to_string(getpid());
+	if (!writeData(merged, temporaryPath)) {
+		unlink(temporaryPath.c_str());
+	} else if (rename(temporaryPath.c_str(), _path.c_str()) != 0) {
+		FatalErrorHandler::warn("Could not replace the wisdom file ", _path, ": ", strerror(errno));
+		unlink(temporaryPath.c_str());
+	}
+
+	// Closing the file releases the lock
+	close(fd);
+}
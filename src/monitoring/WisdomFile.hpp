@@ -0,0 +1,142 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef WISDOM_FILE_HPP
+#define WISDOM_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+
+//! \brief A binary store of the normalized metrics of each tasktype
+//!
+//! The file is mapped in memory when loaded, so the lookups of tasktypes do
+//! not need to parse it. Its layout is the following:
+//!   - Header
+//!   - Metric names: numMetrics string references
+//!   - Tasktype labels: numEntries string references, sorted by label
+//!   - Values: numEntries * numMetrics doubles, NaN if the value is missing
+//!   - Strings: the characters of all the names and labels
+//!
+//! Storing the file merges its current content with the new values while
+//! holding a lock on it, so concurrent processes do not lose their updates
+class WisdomFile {
+
+public:
+
+	//! Metric values of each tasktype, indexed by tasktype label and metric name
+	typedef std::map<std::string, std::map<std::string, double>> wisdom_data_t;
+
+	static constexpr uint32_t FORMAT_VERSION = 1;
+
+private:
+
+	struct Header {
+		char _magic[8];
+		uint32_t _version;
+		uint32_t _numMetrics;
+		uint64_t _numEntries;
+		uint64_t _valuesOffset;
+		uint64_t _stringsOffset;
+		uint64_t _fileSize;
+	};
+
+	struct StringReference {
+		uint64_t _offset;
+		uint64_t _length;
+	};
+
+	//! The path of the file
+	std::string _path;
+
+	//! The mapping of the loaded file or nullptr
+	void *_mapping;
+
+	//! The size of the mapping
+	size_t _mappingSize;
+
+	//! Pointers to the sections of the mapped file
+	const Header *_header;
+	const StringReference *_metrics;
+	const StringReference *_entries;
+	const double *_values;
+	const char *_strings;
+
+	//! \brief Map a file descriptor and validate its content
+	//!
+	//! \return Whether the file has a valid content
+	bool map(int fd);
+
+	//! \brief Unmap the current mapping, if any
+	void unmap();
+
+	//! \brief Get a string of the strings section
+	inline std::string getString(const StringReference &reference) const
+	{
+		return std::string(_strings + reference._offset, reference._length);
+	}
+
+	//! \brief Add the content of the mapped file to a map of metrics
+	void exportData(wisdom_data_t &data) const;
+
+	//! \brief Serialize a map of metrics and write it into a file
+	//!
+	//! \return Whether the whole file was written and flushed to the disk
+	bool writeData(const wisdom_data_t &data, const std::string &path) const;
+
+public:
+
+	inline WisdomFile(const std::string &path) :
+		_path(path),
+		_mapping(nullptr),
+		_mappingSize(0),
+		_header(nullptr),
+		_metrics(nullptr),
+		_entries(nullptr),
+		_values(nullptr),
+		_strings(nullptr)
+	{
+	}
+
+	inline ~WisdomFile()
+	{
+		unmap();
+	}
+
+	inline const std::string &getPath() const
+	{
+		return _path;
+	}
+
+	//! \brief Map the file in memory
+	//!
+	//! \return Whether the file exists and has a valid format
+	bool load();
+
+	//! \brief Get the index of a metric in the loaded file
+	//!
+	//! \return The index of the metric or -1 if it is not present
+	int getMetricIndex(const std::string &metric) const;
+
+	//! \brief Get the values of a tasktype in the loaded file
+	//!
+	//! \return An array of values indexed by metric index, or nullptr if the
+	//! tasktype is not present
+	const double *getValues(const std::string &label) const;
+
+	//! \brief Merge new metrics into the file
+	//!
+	//! The values of the tasktypes and metrics not present in the new data
+	//! are kept, so that different programs and processes can share the file
+	//!
+	//! \param[in] data The new metric values of each tasktype
+	void store(const wisdom_data_t &data);
+
+};
+
+#endif // WISDOM_FILE_HPP
@@ -0,0 +1,159 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "DeadlineTimer.hpp"
+#include "Scheduler.hpp"
+#include "executors/threads/CPUManager.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "support/Chrono.hpp"
+
+#include <InstrumentThreadManagement.hpp>
+
+
+DeadlineTimer *DeadlineTimer::_singleton;
+
+
+DeadlineTimer::DeadlineTimer() :
+	HelperThread("deadline-timer"),
+	_lock(),
+	_tasks(),
+	_timerFd(-1),
+	_mustExit(false)
+{
+	// Task deadlines are taken from the steady clock, which is monotonic
+	_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	FatalErrorHandler::failIf(_timerFd == -1, "Failed to create the deadline timer: ", strerror(errno));
+}
+
+DeadlineTimer::~DeadlineTimer()
+{
+	assert(_tasks.empty());
+
+	int ret = close(_timerFd);
+	FatalErrorHandler::warnIf(ret == -1, "Failed to close the deadline timer: ", strerror(errno));
+}
+
+void DeadlineTimer::initialize()
+{
+	_singleton = new DeadlineTimer();
+	_singleton->start(nullptr);
+}
+
+void DeadlineTimer::shutdown()
+{
+	assert(_singleton != nullptr);
+
+	bool expected = false;
+	_singleton->_mustExit.compare_exchange_strong(expected, true);
+	assert(!expected);
+
+	// Fire the timer right away to unblock the thread
+	_singleton->_lock.lock();
+	_singleton->arm(1);
+	_singleton->_lock.unlock();
+
+	_singleton->join();
+
+	delete _singleton;
+	_singleton = nullptr;
+}
+
+void DeadlineTimer::addTask(Task *task)
+{
+	assert(task != nullptr);
+	assert(task->hasDeadline());
+	assert(_singleton != nullptr);
+
+	std::lock_guard<SpinLock> guard(_singleton->_lock);
+
+	_singleton->_tasks.push(task);
+
+	// Reprogram the timer only if the task has the earliest deadline
+	if (_singleton->_tasks.top() == task) {
+		_singleton->arm(task->getDeadline());
+	}
+}
+
+void DeadlineTimer::arm(Task::deadline_t deadline)
+{
+	struct itimerspec spec;
+	spec.it_interval.tv_sec = 0;
+	spec.it_interval.tv_nsec = 0;
+	spec.it_value.tv_sec = deadline / 1000000;
+	spec.it_value.tv_nsec = (deadline % 1000000) * 1000;
+
+	int ret = timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+	FatalErrorHandler::failIf(ret == -1, "Failed to arm the deadline timer: ", strerror(errno));
+}
+
+void DeadlineTimer::processDueTasks()
+{
+	Task *dueTasks[MAX_DUE_TASKS];
+	size_t numDueTasks;
+
+	do {
+		numDueTasks = 0;
+
+		_lock.lock();
+		Task::deadline_t now = Chrono::now<Task::deadline_t>();
+		while (!_tasks.empty() && numDueTasks < MAX_DUE_TASKS) {
+			Task *task = _tasks.top();
+			assert(task != nullptr);
+
+			if (task->getDeadline() > now)
+				break;
+
+			dueTasks[numDueTasks++] = task;
+			_tasks.pop();
+		}
+
+		// Program the next expiration, if any. A deadline already
+		// expired makes the timer fire immediately
+		if (!_tasks.empty()) {
+			arm(_tasks.top()->getDeadline());
+		}
+		_lock.unlock();
+
+		for (size_t t = 0; t < numDueTasks; ++t) {
+			Scheduler::addReadyTask(dueTasks[t], nullptr, UNBLOCKED_TASK_HINT);
+		}
+
+		if (numDueTasks > 0) {
+			CPUManager::executeCPUManagerPolicy(nullptr, REQUEST_CPUS, numDueTasks);
+		}
+	} while (numDueTasks == MAX_DUE_TASKS);
+}
+
+void DeadlineTimer::body()
+{
+	initializeHelperThread();
+	Instrument::threadHasResumed(getInstrumentationId());
+
+	while (!_mustExit.load(std::memory_order_relaxed)) {
+		uint64_t expirations;
+
+		// Block until the earliest deadline expires. The read is
+		// repeated if the thread is interrupted by a signal
+		Instrument::threadWillSuspend(getInstrumentationId());
+		ssize_t ret;
+		do {
+			ret = read(_timerFd, &expirations, sizeof(expirations));
+		} while (ret == -1 && errno == EINTR);
+		FatalErrorHandler::failIf(ret != sizeof(expirations), "Failed to read the deadline timer: ", strerror(errno));
+		Instrument::threadHasResumed(getInstrumentationId());
+
+		processDueTasks();
+	}
+
+	Instrument::threadWillShutdown(getInstrumentationId());
+}
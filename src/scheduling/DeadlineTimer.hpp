@@ -0,0 +1,84 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef DEADLINE_TIMER_HPP
+#define DEADLINE_TIMER_HPP
+
+#include <atomic>
+
+#include "lowlevel/SpinLock.hpp"
+#include "lowlevel/threads/HelperThread.hpp"
+#include "support/Containers.hpp"
+#include "tasks/Task.hpp"
+
+
+//! \brief Keeps the tasks paused with a deadline until the deadline expires
+//!
+//! Tasks with a deadline are kept in a min-heap ordered by deadline, out of
+//! the scheduler. A helper thread blocks on a timerfd armed with the earliest
+//! deadline. When it expires, the thread adds the due tasks to the scheduler
+//! as unblocked tasks and requests CPUs to run them. Thus, neither the cost
+//! of the scheduler nor the serving loop depend on the waiting deadline tasks
+class DeadlineTimer : public HelperThread {
+	//! Deadline compare function. The earliest deadline is on top
+	struct DeadlineCompare {
+		bool operator() (const Task *left, const Task *right) const
+		{
+			return (left->getDeadline() > right->getDeadline());
+		}
+	};
+
+	typedef Container::priority_queue<Task *, Container::vector<Task *>, DeadlineCompare> deadline_heap_t;
+
+	//! Maximum number of due tasks taken from the heap at once
+	static constexpr size_t MAX_DUE_TASKS = 64;
+
+	//! The singleton instance
+	static DeadlineTimer *_singleton;
+
+	//! Protects the heap and the timer programming
+	SpinLock _lock;
+
+	//! The tasks waiting for their deadline
+	deadline_heap_t _tasks;
+
+	//! The timer armed with the earliest deadline
+	int _timerFd;
+
+	//! Whether the timer thread must stop executing
+	std::atomic<bool> _mustExit;
+
+	//! \brief Program the timer to expire at a given deadline
+	//!
+	//! \param[in] deadline The absolute deadline in microseconds, or 0
+	//! to disarm the timer
+	void arm(Task::deadline_t deadline);
+
+	//! \brief Move the tasks whose deadline has expired to the scheduler
+	void processDueTasks();
+
+public:
+	DeadlineTimer();
+
+	virtual ~DeadlineTimer();
+
+	//! \brief Create the timer and start its thread
+	static void initialize();
+
+	//! \brief Stop the timer thread and destroy the timer
+	static void shutdown();
+
+	//! \brief Keep a ready task until its deadline expires
+	//!
+	//! \param[in] task The task, which must have a deadline
+	static void addTask(Task *task);
+
+	//! \brief The loop that waits for expired deadlines
+	void body();
+};
+
+
+#endif // DEADLINE_TIMER_HPP
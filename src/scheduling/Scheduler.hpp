@@ -124,6 +124,16 @@ public:
 		return _instance->isServingTasks();
 	}
 
+	//! \brief Get the approximate number of ready host tasks
+	//!
+	//! This counts the host tasks that have been added to the scheduler but
+	//! have not been assigned to any compute place yet. It is updated without
+	//! locks, so it should only be used as a hint (e.g., by CPU manager policies)
+	static inline size_t getNumReadyTasks()
+	{
+		return _instance->getNumReadyTasks();
+	}
+
 	//! \brief Check whether task priority is considered
 	static inline bool isPriorityEnabled()
 	{
@@ -134,6 +144,11 @@ public:
 	{
 		return SchedulerInterface::getImmediateSuccessorAlpha();
 	}
+
+	static inline SchedulingPolicy getSchedulingPolicy()
+	{
+		return SchedulerInterface::getSchedulingPolicy();
+	}
 };
 
 #endif // SCHEDULER_HPP
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifdef HAVE_CONFIG_H
@@ -12,12 +12,14 @@
 #include "SchedulerGenerator.hpp"
 #include "executors/threads/CPUManager.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
+#include "monitoring/Monitoring.hpp"
 #include "support/config/ConfigVariable.hpp"
 #include "system/RuntimeInfo.hpp"
 
 ConfigVariable<std::string> SchedulerInterface::_schedulingPolicy("scheduler.policy");
 ConfigVariable<float> SchedulerInterface::_enableImmediateSuccessor("scheduler.immediate_successor");
 ConfigVariable<bool> SchedulerInterface::_enablePriority("scheduler.priority");
+SchedulingPolicy SchedulerInterface::_policy(FIFO_POLICY);
 
 
 SchedulerInterface::SchedulerInterface()
@@ -27,10 +29,16 @@ SchedulerInterface::SchedulerInterface()
 		policy = FIFO_POLICY;
 	} else if (_schedulingPolicy.getValue() == "lifo") {
 		policy = LIFO_POLICY;
+	} else if (_schedulingPolicy.getValue() == "cost") {
+		policy = COST_POLICY;
+		FatalErrorHandler::warnIf(!Monitoring::isEnabled(),
+			"The cost scheduling policy requires monitoring to predict the execution time of tasks; ",
+			"all tasks will be scheduled in FIFO order");
 	} else {
 		FatalErrorHandler::fail("Invalid scheduling policy ", _schedulingPolicy.getValue());
 		return;
 	}
+	_policy = policy;
 
 	RuntimeInfo::addEntry("schedulingPolicy", "SchedulingPolicy", _schedulingPolicy);
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef SCHEDULER_INTERFACE_HPP
@@ -24,6 +24,9 @@ class SchedulerInterface {
 	static ConfigVariable<float> _enableImmediateSuccessor;
 	static ConfigVariable<bool> _enablePriority;
 
+	//! The scheduling policy of the ready queues
+	static SchedulingPolicy _policy;
+
 #ifdef EXTRAE_ENABLED
 	std::atomic<Task *> _mainTask;
 	bool _mainFirstRunCompleted = false;
@@ -105,6 +108,11 @@ public:
 		return _hostScheduler->isServingTasks();
 	}
 
+	virtual inline size_t getNumReadyTasks() const
+	{
+		return _hostScheduler->getNumReadyTasks();
+	}
+
 	virtual std::string getName() const = 0;
 
 	//! \brief Check whether task priority is considered
@@ -117,6 +125,11 @@ public:
 	{
 		return _enableImmediateSuccessor;
 	}
+
+	static inline SchedulingPolicy getSchedulingPolicy()
+	{
+		return _policy;
+	}
 };
 
 #endif // SCHEDULER_INTERFACE_HPP
@@ -0,0 +1,132 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef READY_QUEUE_COST_HPP
+#define READY_QUEUE_COST_HPP
+
+#include <functional>
+#include <limits>
+
+#include "memory/numa/NUMAManager.hpp"
+#include "monitoring/TaskStatistics.hpp"
+#include "scheduling/ReadyQueue.hpp"
+#include "support/Containers.hpp"
+#include "tasks/Task.hpp"
+
+// This kind of ready queue orders the tasks of each priority by their
+// predicted execution time, serving the longest tasks first
+class ReadyQueueCost : public ReadyQueue {
+	typedef Container::deque<Task *> unblocked_queue_t;
+	typedef Container::multimap<double, Task *, std::greater<double>> cost_queue_t;
+
+	struct PriorityLevel {
+		//! Unblocked tasks, which are served before the rest
+		unblocked_queue_t _unblockedTasks;
+
+		//! Ready tasks sorted by decreasing predicted time. Tasks with equal
+		//! predictions are served in FIFO order
+		cost_queue_t _readyTasks;
+	};
+
+	typedef Container::map<Task::priority_t, PriorityLevel, std::greater<Task::priority_t>> ready_map_t;
+
+	ready_map_t _readyMap;
+
+	size_t _numReadyTasks;
+
+	bool _enablePriority;
+
+public:
+	ReadyQueueCost(bool enablePriority) :
+		ReadyQueue(COST_POLICY),
+		_numReadyTasks(0),
+		_enablePriority(enablePriority)
+	{
+	}
+
+	~ReadyQueueCost()
+	{
+		assert(_numReadyTasks == 0);
+
+		for (ready_map_t::iterator it = _readyMap.begin(); it != _readyMap.end(); it++) {
+			assert(it->second._unblockedTasks.empty());
+			assert(it->second._readyTasks.empty());
+		}
+		_readyMap.clear();
+	}
+
+	//! \brief Get the predicted execution time of a task
+	//!
+	//! Tasks without prediction are served first, so that the statistics of
+	//! their tasktype are gathered early and long unknown tasks do not end
+	//! up in the tail of the execution
+	static inline double getPredictedTime(Task *task)
+	{
+		const TaskStatistics *statistics = task->getTaskStatistics();
+		if (statistics != nullptr && statistics->hasTimePrediction()) {
+			return statistics->getTimePrediction();
+		}
+		return std::numeric_limits<double>::infinity();
+	}
+
+	inline void addReadyTask(Task *task, bool unblocked)
+	{
+		Task::priority_t priority = (_enablePriority) ? task->getPriority() : 0;
+		PriorityLevel &level = _readyMap[priority];
+
+		if (unblocked) {
+			level._unblockedTasks.push_back(task);
+		} else {
+			level._readyTasks.emplace(getPredictedTime(task), task);
+		}
+
+		++_numReadyTasks;
+	}
+
+	inline Task *getReadyTask(ComputePlace *)
+	{
+		if (_numReadyTasks == 0) {
+			return nullptr;
+		}
+
+		ready_map_t::iterator it = _readyMap.begin();
+		while (it != _readyMap.end()) {
+			PriorityLevel &level = it->second;
+
+			Task *result = nullptr;
+			if (!level._unblockedTasks.empty()) {
+				result = level._unblockedTasks.front();
+				level._unblockedTasks.pop_front();
+			} else if (!level._readyTasks.empty()) {
+				cost_queue_t::iterator longest = level._readyTasks.begin();
+				result = longest->second;
+				level._readyTasks.erase(longest);
+			} else {
+				it++;
+				continue;
+			}
+
+			assert(result != nullptr);
+			--_numReadyTasks;
+
+			return result;
+		}
+
+		// There must be a ready task
+		assert(false);
+
+		return nullptr;
+	}
+
+	inline size_t getNumReadyTasks() const
+	{
+		return _numReadyTasks;
+	}
+
+};
+
+
+#endif // READY_QUEUE_COST_HPP
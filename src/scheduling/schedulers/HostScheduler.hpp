@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef HOST_SCHEDULER_HPP
@@ -9,6 +9,7 @@
 
 #include "HostUnsyncScheduler.hpp"
 #include "SyncScheduler.hpp"
+#include "system/ExternalEventsInbox.hpp"
 
 class HostScheduler : public SyncScheduler {
 public:
@@ -46,6 +47,11 @@ private:
 		if (!cpu->isOwned())
 			return true;
 
+		// Leave the serving loop to complete the tasks whose events
+		// finished in external threads
+		if (ExternalEventsInbox::hasPendingTasks())
+			return true;
+
 		// Check disabling or shutting down status
 		return !CPUManager::acceptsWork(cpu);
 	}
@@ -1,14 +1,14 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef HOST_UNSYNC_SCHEDULER_HPP
 #define HOST_UNSYNC_SCHEDULER_HPP
 
 #include "UnsyncScheduler.hpp"
-#include "scheduling/ready-queues/DeadlineQueue.hpp"
+#include "scheduling/ready-queues/ReadyQueueCost.hpp"
 #include "scheduling/ready-queues/ReadyQueueDeque.hpp"
 #include "scheduling/ready-queues/ReadyQueueMap.hpp"
 
@@ -17,9 +17,6 @@ public:
 	HostUnsyncScheduler(SchedulingPolicy policy, bool enablePriority) :
 		UnsyncScheduler(policy, enablePriority)
 	{
-		_deadlineTasks = new DeadlineQueue(policy);
-		assert(_deadlineTasks != nullptr);
-
 		_numQueues = NUMAManager::getTrackingNodes();
 		assert(_numQueues > 0);
 
@@ -30,7 +27,9 @@ public:
 			if (NUMAManager::isValidNUMA(i) || _numQueues == 1) {
 				// In case there is a single queue we have to create it always
 				// in the first queue position
-				if (enablePriority) {
+				if (policy == COST_POLICY) {
+					_queues[i] = new ReadyQueueCost(enablePriority);
+				} else if (enablePriority) {
 					_queues[i] = new ReadyQueueMap(policy);
 				} else {
 					_queues[i] = new ReadyQueueDeque(policy);
@@ -41,12 +40,6 @@ public:
 		}
 	}
 
-	virtual ~HostUnsyncScheduler()
-	{
-		assert(_deadlineTasks != nullptr);
-		delete _deadlineTasks;
-	}
-
 	//! \brief Get a ready task for execution
 	//!
 	//! \param[in] computePlace The hardware place asking for scheduling orders
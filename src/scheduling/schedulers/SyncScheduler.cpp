@@ -15,12 +15,13 @@ Task *SyncScheduler::getTask(ComputePlace *computePlace)
 
 	Task *task = nullptr;
 	uint64_t computePlaceIdx = computePlace->getIndex();
+	uint64_t cohort = getCohort(computePlace);
 
 	Instrument::enterSchedulerLock();
 
 	// Lock or delegate the work of getting a ready task
-	if (!_lock.lockOrDelegate(computePlaceIdx, task)) {
-		// Someone else acquired the lock and assigned us work
+	if (!_lock.lockOrDelegate(computePlaceIdx, cohort, task)) {
+		// The server of our cohort assigned us work
 		if (task) {
 			Instrument::workerProgressing();
 			Instrument::exitSchedulerLockAsClient(task->getInstrumentationTaskId());
@@ -39,15 +40,21 @@ Task *SyncScheduler::getTask(ComputePlace *computePlace)
 	// resting in loop below
 	Instrument::workerProgressing();
 
+	// The busy iterations only concern the compute places of our cohort,
+	// and they are kept across servers of the cohort
+	ServerState &server = _servers[cohort];
+
 	setServingTasks(true);
+	bool serving = true;
 
 	// The idea is to always keep a compute place inside the following scheduling loop
 	// serving tasks to the rest of active compute places, except when there is work for
-	// all compute places. A compute place should stay inside the scheduler to check for
-	// deadline tasks but also for progressively resuming idle compute places when there
-	// is available work. However, device schedulers do not work like that because they
-	// already implement their progress engine using polling tasks. Also, external or
-	// compute places being disabled should not serve tasks for a long time
+	// all compute places. A compute place should stay inside the scheduler for
+	// progressively resuming idle compute places when there is available work. Tasks
+	// with deadlines are kept by the deadline timer until they expire. However, device
+	// schedulers do not work like that because they already implement their progress
+	// engine using polling tasks. Also, external or compute places being disabled
+	// should not serve tasks for a long time
 	do {
 		size_t servingIters = 0;
 
@@ -67,6 +74,7 @@ Task *SyncScheduler::getTask(ComputePlace *computePlace)
 			task = _scheduler->getReadyTask(waitingComputePlace);
 
 			if (task) {
+				readyTaskAssigned();
 				Instrument::workerProgressing();
 				Instrument::schedulerLockServesTask(task->getInstrumentationTaskId());
 			} else {
@@ -76,8 +84,13 @@ Task *SyncScheduler::getTask(ComputePlace *computePlace)
 			// If we are using the hybrid/busy policy, avoid assigning tasks even if
 			// none are found, so that threads do not spin in their body to avoid
 			// contention in here. The "responsible" thread will be the one busy
-			// iterating until the criteria of max busy iterations is met
-			if (task != nullptr || _currentBusyIters++ >= _numBusyIters) {
+			// iterating until the criteria of max busy iterations is met. The
+			// policy may change the budget depending on the load, so it is
+			// refreshed when a new wait starts
+			if (task == nullptr && server._currentBusyIters == 0)
+				server._numBusyIters = CPUManager::getMaxBusyIterations();
+
+			if (task != nullptr || server._currentBusyIters++ >= server._numBusyIters) {
 				// Assign the task to the waiting compute place even if it is nullptr. The
 				// responsible for serving tasks is the current compute place, and we want
 				// to avoid changing the responsible constantly, as happened in the original
@@ -87,7 +100,7 @@ Task *SyncScheduler::getTask(ComputePlace *computePlace)
 				// Unblock the served compute place and advance to the next one
 				_lock.popFront();
 
-				_currentBusyIters = 0;
+				server._currentBusyIters = 0;
 			}
 
 			servingIters++;
@@ -98,14 +111,32 @@ Task *SyncScheduler::getTask(ComputePlace *computePlace)
 		// No more compute places waiting; try to get work for myself
 		task = _scheduler->getReadyTask(computePlace);
 
+		if (task == nullptr) {
+			// Let the servers of other NUMA nodes access the scheduler if they
+			// are waiting, since we cannot serve the compute places of their
+			// nodes. Each cohort has at most one server, which is accounted as
+			// serving until it leaves the loop, even while it waits to get the
+			// lock back. The state of the busy iterations is also per cohort,
+			// so other servers running meanwhile do not alter ours
+			_lock.yield();
+
+			// Only one server has to stay in the loop to resume idle compute
+			// places. If none of our cohort is waiting and another cohort has
+			// a server, leave instead of spinning along with it
+			if (_lock.empty() && stopServingTasksIfOthersServe())
+				serving = false;
+		}
+
 		// Keep serving while there is no work for the current compute
 		// place or it is external/disabling
-	} while (task == nullptr && !mustStopServingTasks(computePlace));
+	} while (serving && task == nullptr && !mustStopServingTasks(computePlace));
 
 	// We are stopping to serve tasks
-	setServingTasks(false);
+	if (serving)
+		setServingTasks(false);
 
 	if (task) {
+		readyTaskAssigned();
 		Instrument::workerProgressing();
 		Instrument::exitSchedulerLockAsServer(task->getInstrumentationTaskId());
 	} else {
@@ -118,8 +149,10 @@ Task *SyncScheduler::getTask(ComputePlace *computePlace)
 
 	// Perform the required actions after stop serving tasks. In the case of
 	// the host scheduler it should resume idle compute places to guarantee
-	// that there is always a compute place serving tasks
-	postServingTasks(computePlace, task);
+	// that there is always a compute place serving tasks. That is already
+	// the case if we left because another cohort had a server
+	if (serving)
+		postServingTasks(computePlace, task);
 
 	return task;
 }
@@ -16,7 +16,8 @@
 #include "dependencies/DataTrackingSupport.hpp"
 #include "executors/threads/CPUManager.hpp"
 #include "hardware/HardwareInfo.hpp"
-#include "lowlevel/DelegationLock.hpp"
+#include "lowlevel/CohortDelegationLock.hpp"
+#include "lowlevel/Padding.hpp"
 #include "lowlevel/TicketArraySpinLock.hpp"
 #include "scheduling/SchedulerSupport.hpp"
 
@@ -34,15 +35,34 @@ protected:
 private:
 	typedef boost::lockfree::spsc_queue<Task *, boost::lockfree::allocator<TemplateAllocator<Task *>>> add_queue_t;
 
+	//! The state of the server of a cohort. Only accessed by the server
+	//! of the cohort, which is the holder of the cohort's lock
+	struct alignas(CACHELINE_SIZE) ServerState {
+		//! The number of busy iterations since the last task was assigned
+		//! to a compute place of the cohort
+		size_t _currentBusyIters;
+
+		//! The maximum number of iterations to wait before assigning a null
+		//! task. It is refreshed from the CPU manager policy when a wait starts
+		size_t _numBusyIters;
+
+		ServerState(size_t numBusyIters) :
+			_currentBusyIters(0),
+			_numBusyIters(numBusyIters)
+		{
+		}
+	};
+
 	//! Total number of computePlaces
 	uint64_t _totalComputePlaces;
 
 	//! Total number of add queues
 	size_t _totalAddQueues;
 
-	//! Delegation lock protecting the access
-	//! to the unsynchronized scheduler
-	DelegationLock<Task *> _lock;
+	//! Delegation lock protecting the access to the unsynchronized
+	//! scheduler. Compute places are served by a server of their
+	//! own NUMA node (cohort)
+	CohortDelegationLock<Task *> _lock;
 
 	//! Locks for adding tasks to the add queues
 	TicketArraySpinLock *_addQueuesLocks;
@@ -50,33 +70,46 @@ private:
 	//! Add queues of ready tasks
 	add_queue_t *_addQueues;
 
-	//! Indicates whether there is any compute place
-	//! serving tasks inside the scheduling loop
-	std::atomic<bool> _servingTasks;
+	//! The number of cohorts
+	size_t _numCohorts;
+
+	//! The state of the server of each cohort
+	ServerState *_servers;
+
+	//! The number of compute places serving tasks inside the scheduling
+	//! loop. There is at most one per cohort, and a server that yields the
+	//! lock to other cohorts is still accounted
+	std::atomic<size_t> _numServers;
 
 	//! The limit of iteration that a compute place can serve for within a
 	//! single burst in the scheduling loop. This avoids that an external
 	//! compute place gets stuck solely serving tasks for too much time
 	size_t _maxServingIters;
 
-	//! The number of busy iterations since the last task was assigned
-	size_t _currentBusyIters;
-
-	//! The maximum number of iterations to wait before assigning a null task
-	size_t _numBusyIters;
+	//! Approximate number of ready tasks that have been added but not
+	//! assigned to any compute place yet. Every task is accounted when it
+	//! enters through addReadyTasks and discounted when getTask assigns it,
+	//! which are the only ways in and out of the scheduler. Tasks that are
+	//! kept elsewhere (e.g., immediate successors, deferred events or tasks
+	//! waiting for their deadline) are not accounted until they are added
+	std::atomic<size_t> _numReadyTasks;
 
 public:
 	//! NOTE We initialize the delegation lock with 2 * numCPUs since some
 	//! threads may oversubscribe and thus we may need more than numCPUs
-	//! slots in the lock's waiting queue
+	//! slots in the lock's waiting queue. There is a cohort per NUMA node
+	//! for the host, whereas device compute places share a single cohort
 	SyncScheduler(size_t totalComputePlaces, nanos6_device_t deviceType = nanos6_host_device) :
 		_deviceType(deviceType),
 		_scheduler(nullptr),
 		_totalComputePlaces(totalComputePlaces),
-		_lock((uint64_t) totalComputePlaces * 2),
-		_servingTasks(false),
+		_lock((uint64_t) totalComputePlaces * 2,
+			(deviceType == nanos6_host_device) ? HardwareInfo::getMemoryPlaceCount(nanos6_host_device) : 1),
+		_numCohorts((deviceType == nanos6_host_device) ? HardwareInfo::getMemoryPlaceCount(nanos6_host_device) : 1),
+		_servers(nullptr),
+		_numServers(0),
 		_maxServingIters(totalComputePlaces * 20),
-		_currentBusyIters(0)
+		_numReadyTasks(0)
 	{
 		uint64_t totalCPUsPow2 = SchedulerSupport::roundToNextPowOf2(_totalComputePlaces);
 		assert(SchedulerSupport::isPowOf2(totalCPUsPow2));
@@ -97,11 +130,18 @@ public:
 			new (&_addQueuesLocks[i]) TicketArraySpinLock(_totalComputePlaces);
 		}
 
-		_numBusyIters = CPUManager::getMaxBusyIterations();
+		_servers = (ServerState *)
+			MemoryAllocator::allocAligned(_numCohorts * sizeof(ServerState));
+
+		for (size_t i = 0; i < _numCohorts; i++) {
+			new (&_servers[i]) ServerState(CPUManager::getMaxBusyIterations());
+		}
 	}
 
 	virtual ~SyncScheduler()
 	{
+		assert(_numReadyTasks.load() == 0);
+
 		for (size_t i = 0; i < _totalAddQueues; i++) {
 			_addQueues[i].~add_queue_t();
 			_addQueuesLocks[i].~TicketArraySpinLock();
@@ -109,6 +149,11 @@ public:
 		MemoryAllocator::freeAligned(_addQueues, _totalAddQueues * sizeof(add_queue_t));
 		MemoryAllocator::freeAligned(_addQueuesLocks, _totalAddQueues * sizeof(TicketArraySpinLock));
 
+		for (size_t i = 0; i < _numCohorts; i++) {
+			_servers[i].~ServerState();
+		}
+		MemoryAllocator::freeAligned(_servers, _numCohorts * sizeof(ServerState));
+
 		delete _scheduler;
 	}
 
@@ -120,7 +165,13 @@ public:
 	//! \brief Check whether a compute place is serving tasks
 	inline bool isServingTasks()
 	{
-		return _servingTasks.load(std::memory_order_relaxed);
+		return (_numServers.load(std::memory_order_relaxed) > 0);
+	}
+
+	//! \brief Get the approximate number of ready tasks waiting to be assigned
+	inline size_t getNumReadyTasks() const
+	{
+		return _numReadyTasks.load(std::memory_order_relaxed);
 	}
 
 	inline void addReadyTask(Task *task, ComputePlace *computePlace, ReadyTaskHint hint)
@@ -146,6 +197,8 @@ public:
 			tasks[t]->computeNUMAAffinity(computePlace);
 		}
 
+		_numReadyTasks.fetch_add(numTasks, std::memory_order_relaxed);
+
 		size_t count = 0;
 		while (numTasks > count) {
 			// Acquire lock since other cpus from the same NUMA may be enqueueing
@@ -209,10 +262,49 @@ private:
 	//! lock and before releasing it, which is the moment when the compute
 	//! place is responsible for serving tasks
 	//!
-	//! \param[in] servingTasks The value to be set
+	//! \param[in] servingTasks Whether the compute place starts or stops serving
 	inline void setServingTasks(bool servingTasks)
 	{
-		_servingTasks.store(servingTasks, std::memory_order_relaxed);
+		if (servingTasks) {
+			_numServers.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			__attribute__((unused)) size_t previous = _numServers.fetch_sub(1, std::memory_order_relaxed);
+			assert(previous > 0);
+		}
+	}
+
+	//! \brief Stop serving tasks if the server of another cohort is serving
+	//!
+	//! This function should be called by a server with the scheduler lock
+	//! acquired. It never leaves the scheduler without servers
+	//!
+	//! \return Whether the compute place stopped serving tasks
+	inline bool stopServingTasksIfOthersServe()
+	{
+		size_t numServers = _numServers.load(std::memory_order_relaxed);
+		while (numServers > 1) {
+			if (_numServers.compare_exchange_weak(numServers, numServers - 1, std::memory_order_relaxed))
+				return true;
+		}
+		return false;
+	}
+
+	//! \brief Get the cohort of the scheduler's lock where a compute place waits
+	//!
+	//! \param[in] computePlace The compute place
+	inline uint64_t getCohort(ComputePlace *computePlace) const
+	{
+		if (_deviceType != nanos6_host_device)
+			return 0;
+
+		return ((CPU *) computePlace)->getNumaNodeId();
+	}
+
+	//! \brief Account a ready task that has been assigned to a compute place
+	inline void readyTaskAssigned()
+	{
+		__attribute__((unused)) size_t previous = _numReadyTasks.fetch_sub(1, std::memory_order_relaxed);
+		assert(previous > 0);
 	}
 
 	//! \brief Get the compute place by its index
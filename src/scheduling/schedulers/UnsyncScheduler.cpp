@@ -16,7 +16,6 @@ UnsyncScheduler::UnsyncScheduler(
 	_queues(nullptr),
 	_numQueues(0),
 	_roundRobinQueues(0),
-	_deadlineTasks(nullptr),
 	_enablePriority(enablePriority)
 {
 }
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef UNSYNC_SCHEDULER_HPP
@@ -12,7 +12,6 @@
 #include "hardware/places/ComputePlace.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
 #include "scheduling/ReadyQueue.hpp"
-#include "scheduling/ready-queues/DeadlineQueue.hpp"
 #include "support/Containers.hpp"
 #include "tasks/Task.hpp"
 
@@ -25,8 +24,6 @@ protected:
 	// When tasks do not have a NUMA hints we assign them in a round robin basis
 	uint64_t _roundRobinQueues;
 
-	DeadlineQueue *_deadlineTasks;
-
 	bool _enablePriority;
 
 public:
@@ -43,14 +40,6 @@ public:
 	{
 		assert(task != nullptr);
 
-		if (hint == DEADLINE_TASK_HINT) {
-			assert(task->hasDeadline());
-			assert(_deadlineTasks != nullptr);
-
-			_deadlineTasks->addReadyTask(task, true);
-			return;
-		}
-
 		regularAddReadyTask(task, hint == UNBLOCKED_TASK_HINT);
 	}
 
@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2019-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2019-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "DeviceUnsyncScheduler.hpp"
@@ -49,14 +49,6 @@ void DeviceUnsyncScheduler::addReadyTask(Task *task, [[maybe_unused]] ComputePla
 {
 	assert(task != nullptr);
 
-	if (hint == DEADLINE_TASK_HINT) {
-		assert(task->hasDeadline());
-		assert(_deadlineTasks != nullptr);
-
-		_deadlineTasks->addReadyTask(task, true);
-		return;
-	}
-
 	//int devId = DeviceMemManager::computeDeviceAffinity(task);
 	int devId = task->getAccelAffinity();
 	if (devId < 0) {
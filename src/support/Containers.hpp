@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2020-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef CONTAINERS_HPP
@@ -30,6 +30,9 @@ using vector = std::vector<T, TemplateAllocator<T>>;
 template <typename K, typename T, typename Compare = std::less<K>>
 using map = std::map<K, T, Compare, TemplateAllocator<std::pair<const K, T>>>;
 
+template <typename K, typename T, typename Compare = std::less<K>>
+using multimap = std::multimap<K, T, Compare, TemplateAllocator<std::pair<const K, T>>>;
+
 template <typename T, typename BackingContainer = vector<T>, typename Compare = std::less<T>>
 using priority_queue = std::priority_queue<T, BackingContainer, Compare>;
 
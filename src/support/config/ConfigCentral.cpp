@@ -18,12 +18,16 @@ ConfigCentral::ConfigCentral() :
 {
 	// CPU manager
 	registerOption<integer_t>("cpumanager.busy_iters", 240000);
+	registerOption<float_t>("cpumanager.energy_max_slowdown", 0.1);
 	registerOption<string_t>("cpumanager.policy", "default");
 	registerOption<integer_t>("cpumanager.sponge_cpus", {});
 
 
 	// DIRECTORY
 	registerOption<bool_t>("devices.directory", true);
+	registerOption<memory_t>("devices.directory_capacity", 0);
+	registerOption<memory_t>("devices.directory_staging_chunk", 1024 * 1024);
+	registerOption<bool_t>("devices.directory_stats", false);
 
 	// CUDA devices
 	registerOption<string_t>("devices.cuda.kernels_folder", "nanos6-cuda-kernels");
@@ -43,6 +47,7 @@ ConfigCentral::ConfigCentral() :
 
 	// FPGA Devices
 	registerOption<integer_t>("devices.fpga.alignment", 16);
+	registerOption<integer_t>("devices.fpga.lookahead", 0);
 	registerOption<integer_t>("devices.fpga.page_size", 0x8000);
 	registerOption<memory_t>("devices.fpga.requested_fpga_memory",0x40000000);
 	registerOption<bool_t>("devices.fpga.reverse_offload", false);
@@ -67,6 +72,11 @@ ConfigCentral::ConfigCentral() :
 	registerOption<bool_t>("hardware_counters.papi.enabled", false);
 	registerOption<string_t>("hardware_counters.papi.counters", {});
 
+	// perf hardware counters
+	registerOption<bool_t>("hardware_counters.perf.enabled", false);
+	registerOption<string_t>("hardware_counters.perf.counters", {});
+	registerOption<bool_t>("hardware_counters.perf.software_fallback", true);
+
 	// PQOS hardware counters
 	registerOption<bool_t>("hardware_counters.pqos.enabled", false);
 	registerOption<string_t>("hardware_counters.pqos.counters", {});
@@ -75,9 +85,14 @@ ConfigCentral::ConfigCentral() :
 	registerOption<bool_t>("instrument.ctf.converter.enabled", true);
 	registerOption<bool_t>("instrument.ctf.converter.fast", false);
 	registerOption<string_t>("instrument.ctf.converter.location", "");
+	registerOption<bool_t>("instrument.ctf.converter.native", false);
 	registerOption<string_t>("instrument.ctf.events.kernel.exclude", {});
 	registerOption<string_t>("instrument.ctf.events.kernel.file", "");
 	registerOption<string_t>("instrument.ctf.events.kernel.presets", {});
+	registerOption<memory_t>("instrument.ctf.flight_recorder.buffer_size", 2 * 1024 * 1024);
+	registerOption<bool_t>("instrument.ctf.flight_recorder.enabled", false);
+	registerOption<integer_t>("instrument.ctf.flight_recorder.signal", 0);
+	registerOption<bool_t>("instrument.ctf.flusher.enabled", false);
 	registerOption<string_t>("instrument.ctf.tmpdir", "");
 
 	// Ovni instrumentation
@@ -87,6 +102,10 @@ ConfigCentral::ConfigCentral() :
 	registerOption<bool_t>("instrument.extrae.as_threads", false);
 	registerOption<integer_t>("instrument.extrae.detail_level", 1);
 
+	// Stats instrumentation
+	registerOption<string_t>("instrument.stats.format", "text");
+	registerOption<string_t>("instrument.stats.output_file", "nanos6-stats.txt");
+
 	// Verbose instrumentation
 	registerOption<string_t>("instrument.verbose.areas", {
 			"all", "!ComputePlaceManagement", "!DependenciesByAccess",
@@ -104,11 +123,17 @@ ConfigCentral::ConfigCentral() :
 	registerOption<string_t>("loader.report_prefix", "");
 
 	// Miscellaneous
+	registerOption<integer_t>("misc.deferred_events.capacity", 4096);
+	registerOption<bool_t>("misc.deferred_events.enabled", false);
 	registerOption<memory_t>("misc.stack_size", 8 * 1024 * 1024);
 
 	// Monitoring
 	registerOption<integer_t>("monitoring.cpuusage_prediction_rate", 100);
 	registerOption<bool_t>("monitoring.enabled", false);
+	registerOption<bool_t>("monitoring.energy", false);
+	registerOption<float_t>("monitoring.energy_cpu_power", 4.0);
+	registerOption<float_t>("monitoring.energy_idle_power", 20.0);
+	registerOption<integer_t>("monitoring.energy_sampling_rate", 10000);
 	registerOption<integer_t>("monitoring.rolling_window", 20);
 	registerOption<bool_t>("monitoring.verbose", true);
 	registerOption<string_t>("monitoring.verbose_file", "output-monitoring.txt");
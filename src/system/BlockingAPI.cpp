@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2021 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cassert>
@@ -14,6 +14,7 @@
 #include "TrackingPoints.hpp"
 #include "executors/threads/ThreadManager.hpp"
 #include "executors/threads/WorkerThread.hpp"
+#include "scheduling/DeadlineTimer.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "support/Chrono.hpp"
 
@@ -92,8 +93,9 @@ uint64_t BlockingAPI::waitForUs(uint64_t timeUs)
 	Task::deadline_t start = Chrono::now<Task::deadline_t>();
 	currentTask->setDeadline(start + timeout);
 
-	// Re-add the current task to the scheduler with a deadline
-	Scheduler::addReadyTask(currentTask, cpu, DEADLINE_TASK_HINT);
+	// The deadline timer re-adds the current task to the scheduler
+	// once the deadline expires
+	DeadlineTimer::addTask(currentTask);
 
 	TaskBlocking::taskBlocks(currentThread, currentTask);
 
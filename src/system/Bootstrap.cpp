@@ -27,10 +27,12 @@
 #include "lowlevel/threads/ExternalThreadGroup.hpp"
 #include "memory/numa/NUMAManager.hpp"
 #include "monitoring/Monitoring.hpp"
+#include "scheduling/DeadlineTimer.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "support/config/ConfigCentral.hpp"
 #include "support/config/ConfigChecker.hpp"
 #include "system/APICheck.hpp"
+#include "system/ExternalEventsInbox.hpp"
 #include "system/RuntimeInfoEssentials.hpp"
 #include "system/SpawnFunction.hpp"
 #include "system/Throttle.hpp"
@@ -94,6 +96,7 @@ void nanos6_preinit(void)
 	NUMAManager::initialize();
 	Scheduler::initialize();
 	Throttle::initialize();
+	ExternalEventsInbox::initialize();
 	ExternalThreadGroup::initialize();
 
 	Instrument::initialize();
@@ -118,6 +121,7 @@ void nanos6_preinit(void)
 	assert(leaderThreadCPU != nullptr);
 
 	LeaderThread::initialize(leaderThreadCPU);
+	DeadlineTimer::initialize();
 
 	CPUManager::initialize();
 	Instrument::preinitFinished();
@@ -157,10 +161,12 @@ void nanos6_shutdown(void)
 	NUMAManager::shutdown();
 	StreamManager::shutdown();
 	LeaderThread::shutdown();
+	DeadlineTimer::shutdown();
 
 
 	// Shutdown throttle service before CPUs are stopped
 	Throttle::shutdown();
+	ExternalEventsInbox::shutdown();
 
 	// Signal the shutdown to all CPUs and finalize threads
 	CPUManager::shutdownPhase1();
@@ -27,6 +27,7 @@
 #include "dependencies/DataAccessType.hpp"
 
 #include "system/AddTask.hpp"
+#include "system/BlockingAPI.hpp"
 extern "C" {
 
 
@@ -153,7 +154,11 @@ Task* createTaskWithInDep(nanos6_device_t device, int device_id, void* host_ptr,
             Accelerator* accelerator = HardwareInfo::getDeviceInfo(_argsBlock->device)->getAccelerators()[_argsBlock->device_id];
             std::vector<SymbolRepresentation> _symRep(1);
             _symRep[0].addDataAccess(dar, READ_ACCESS_TYPE);
-            DeviceDirectoryInstance::instance->register_regions(_symRep, accelerator, &accelStream, nullptr);
+            // Wait for the device to release memory if it is full
+            while (!DeviceDirectoryInstance::instance->register_regions(_symRep, accelerator, &accelStream, nullptr)) {
+                while(accelStream.streamPendingExecutors()) accelStream.streamServiceLoop();
+                BlockingAPI::waitForUs(100);
+            }
             while(accelStream.streamPendingExecutors()) accelStream.streamServiceLoop();
             
         };
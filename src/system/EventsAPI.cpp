@@ -9,6 +9,7 @@
 #include "CPUDependencyData.hpp"
 #include "DataAccessRegistration.hpp"
 #include "EventsAPI.hpp"
+#include "ExternalEventsInbox.hpp"
 #include "executors/threads/TaskFinalization.hpp"
 #include "executors/threads/ThreadManager.hpp"
 #include "executors/threads/WorkerThread.hpp"
@@ -50,33 +51,39 @@ void EventsAPI::decreaseTaskEvents(Task *task, unsigned int decrement)
 		task->completeOnready();
 
 		Scheduler::addReadyTask(task, cpu, UNBLOCKED_TASK_HINT);
-	} else {
-		// Release the data accesses of the task. Do not merge these
-		// two conditions; the creation of a local CPU dependency data
-		// structure may introduce unnecessary overhead
-		if (cpu != nullptr) {
-			DataAccessRegistration::unregisterTaskDataAccesses(
-				task, cpu, cpu->getDependencyData(),
-				/* memory place */ nullptr,
-				/* from a busy thread */ true
-			);
-		} else {
-			CPUDependencyData localDependencyData;
-			DataAccessRegistration::unregisterTaskDataAccesses(
-				task, nullptr, localDependencyData,
-				/* memory place */ nullptr,
-				/* from a busy thread */ true
-			);
-		}
-
-		TaskFinalization::taskFinished(task, cpu, true);
-
-		// Try to dispose the task
-		if (task->markAsReleased())
-			TaskFinalization::disposeTask(task);
+	} else if (cpu != nullptr) {
+		releaseTask(task, cpu, cpu->getDependencyData());
+	} else if (!ExternalEventsInbox::isEnabled() || !ExternalEventsInbox::pushTask(task)) {
+		// The completion is not deferred to the worker threads, so release
+		// the task from this thread. The creation of a local CPU dependency
+		// data structure may introduce unnecessary overhead, so it is only
+		// created here
+		CPUDependencyData localDependencyData;
+		releaseTask(task, nullptr, localDependencyData);
 	}
 }
 
+void EventsAPI::releaseTask(Task *task, CPU *cpu, CPUDependencyData &dependencyData)
+{
+	assert(task != nullptr);
+
+	// Release the data accesses of the task. It is released as if from a
+	// busy thread, so the successors go to the scheduler instead of becoming
+	// immediate successor candidates of the CPU: the finished task did not
+	// run here, so there is no data in the cache to reuse
+	DataAccessRegistration::unregisterTaskDataAccesses(
+		task, cpu, dependencyData,
+		/* memory place */ nullptr,
+		/* from a busy thread */ true
+	);
+
+	TaskFinalization::taskFinished(task, cpu, true);
+
+	// Try to dispose the task
+	if (task->markAsReleased())
+		TaskFinalization::disposeTask(task);
+}
+
 extern "C" void *nanos6_get_current_event_counter(void)
 {
 	return WorkerThread::getCurrentTask();
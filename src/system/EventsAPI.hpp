@@ -9,6 +9,9 @@
 
 #include "tasks/Task.hpp"
 
+class CPU;
+struct CPUDependencyData;
+
 namespace EventsAPI {
 
 	//! \brief Increase the current task's events to prevent the release of dependencies
@@ -21,6 +24,13 @@ namespace EventsAPI {
 	//! \param task The task to decrease the events
 	//! \param decrement The value to be decremented (must be positive or zero)
 	void decreaseTaskEvents(Task *task, unsigned int decrement);
+
+	//! \brief Release the dependencies of a task whose events have finished
+	//!
+	//! \param task The task, which must have finished its execution
+	//! \param cpu The CPU of the current thread, or nullptr if it is external
+	//! \param dependencyData The dependency data to use in the release
+	void releaseTask(Task *task, CPU *cpu, CPUDependencyData &dependencyData);
 }
 
 #endif // EVENTS_API_HPP
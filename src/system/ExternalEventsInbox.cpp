@@ -0,0 +1,85 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <cassert>
+
+#include "EventsAPI.hpp"
+#include "ExternalEventsInbox.hpp"
+#include "executors/threads/CPU.hpp"
+#include "executors/threads/CPUManager.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+
+
+ConfigVariable<bool> ExternalEventsInbox::_enabled("misc.deferred_events.enabled");
+ConfigVariable<size_t> ExternalEventsInbox::_capacity("misc.deferred_events.capacity");
+ExternalEventsInbox::inbox_t *ExternalEventsInbox::_inbox(nullptr);
+std::atomic<size_t> ExternalEventsInbox::_numPending(0);
+
+
+void ExternalEventsInbox::initialize()
+{
+	if (!_enabled)
+		return;
+
+	// The fixed-size queue addresses its nodes with 16-bit indices
+	size_t capacity = _capacity;
+	FatalErrorHandler::failIf(capacity == 0 || capacity >= 65535,
+		"The capacity of the deferred events inbox must be between 1 and 65534");
+
+	_inbox = MemoryAllocator::newObject<inbox_t>(capacity);
+}
+
+void ExternalEventsInbox::shutdown()
+{
+	if (_inbox == nullptr)
+		return;
+
+	// All tasks have finished at this point
+	assert(!hasPendingTasks());
+	assert(_inbox->empty());
+
+	MemoryAllocator::deleteObject<inbox_t>(_inbox);
+	_inbox = nullptr;
+}
+
+bool ExternalEventsInbox::pushTask(Task *task)
+{
+	assert(task != nullptr);
+	assert(_inbox != nullptr);
+
+	// Account the task before pushing it so that workers never see
+	// a pending task without a counter
+	size_t previous = _numPending.fetch_add(1, std::memory_order_relaxed);
+	if (!_inbox->bounded_push(task)) {
+		_numPending.fetch_sub(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Make sure there is a CPU awake to complete the tasks. Only the
+	// first pending task needs to request it
+	if (previous == 0) {
+		CPUManager::executeCPUManagerPolicy(nullptr, REQUEST_CPUS, 1);
+	}
+
+	return true;
+}
+
+void ExternalEventsInbox::processPendingTasks(CPU *cpu)
+{
+	assert(cpu != nullptr);
+	assert(_inbox != nullptr);
+
+	Task *task;
+	size_t numProcessed = 0;
+	while (numProcessed < MAX_BATCH_SIZE && _inbox->pop(task)) {
+		EventsAPI::releaseTask(task, cpu, cpu->getDependencyData());
+		++numProcessed;
+	}
+
+	if (numProcessed > 0) {
+		_numPending.fetch_sub(numProcessed, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,81 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef EXTERNAL_EVENTS_INBOX_HPP
+#define EXTERNAL_EVENTS_INBOX_HPP
+
+#include <atomic>
+
+#include <boost/lockfree/queue.hpp>
+
+#include "MemoryAllocator.hpp"
+#include "support/config/ConfigVariable.hpp"
+
+class CPU;
+class Task;
+
+
+//! \brief Defers the completion of tasks whose events finish in external threads
+//!
+//! When an external thread (e.g., a communication progress thread) decreases
+//! the last event of a task, releasing the dependencies and finalizing the
+//! task would run on that thread. If the inbox is enabled, the task is pushed
+//! into a lock-free queue instead, and the worker threads complete the pending
+//! tasks in batches from their loop, using the dependency data of their CPU
+class ExternalEventsInbox {
+	typedef boost::lockfree::queue<
+		Task *,
+		boost::lockfree::fixed_sized<true>,
+		boost::lockfree::allocator<TemplateAllocator<Task *>>
+	> inbox_t;
+
+	//! Maximum number of tasks completed by a worker at once
+	static constexpr size_t MAX_BATCH_SIZE = 32;
+
+	//! Whether the external completions are deferred
+	static ConfigVariable<bool> _enabled;
+
+	//! The capacity of the inbox
+	static ConfigVariable<size_t> _capacity;
+
+	//! The tasks pending to complete
+	static inbox_t *_inbox;
+
+	//! Number of tasks in the inbox
+	static std::atomic<size_t> _numPending;
+
+public:
+	static void initialize();
+
+	static void shutdown();
+
+	//! \brief Check whether the external completions are deferred
+	static inline bool isEnabled()
+	{
+		return _inbox != nullptr;
+	}
+
+	//! \brief Check whether there are tasks pending to complete
+	static inline bool hasPendingTasks()
+	{
+		return (_numPending.load(std::memory_order_relaxed) > 0);
+	}
+
+	//! \brief Defer the completion of a task from an external thread
+	//!
+	//! \param[in] task The task whose events have finished
+	//!
+	//! \returns Whether the task was deferred. Otherwise, the inbox is
+	//! full and the caller must complete the task
+	static bool pushTask(Task *task);
+
+	//! \brief Complete a batch of the pending tasks
+	//!
+	//! \param[in] cpu The CPU of the current worker thread
+	static void processPendingTasks(CPU *cpu);
+};
+
+#endif // EXTERNAL_EVENTS_INBOX_HPP
@@ -1,15 +1,21 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cassert>
-#include <ctime>
-#include <iostream>
-#include <time.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 #include "LeaderThread.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "monitoring/EnergyMonitor.hpp"
+#include "monitoring/Monitoring.hpp"
+#include "support/Chrono.hpp"
 #include "support/config/ConfigVariable.hpp"
 
 #include <InstrumentLeaderThread.hpp>
@@ -19,11 +25,54 @@
 LeaderThread *LeaderThread::_singleton;
 
 
+static void instrumentationService(void *)
+{
+	Instrument::leaderThreadSpin();
+}
+
+static void energySamplingService(void *energyMonitor)
+{
+	((EnergyMonitor *) energyMonitor)->sample();
+}
+
+
+LeaderThread::LeaderThread(CPU *leaderThreadCPU) :
+	HelperThread("leader-thread"),
+	_mustExit(false),
+	_leaderThreadCPU(leaderThreadCPU),
+	_lock(),
+	_services(),
+	_timerFd(-1)
+{
+	// Deadlines are taken from the steady clock, which is monotonic
+	_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	FatalErrorHandler::failIf(_timerFd == -1, "Failed to create the leader thread timer: ", strerror(errno));
+}
+
+LeaderThread::~LeaderThread()
+{
+	int ret = close(_timerFd);
+	FatalErrorHandler::warnIf(ret == -1, "Failed to close the leader thread timer: ", strerror(errno));
+}
+
 void LeaderThread::initialize(CPU *leaderThreadCPU)
 {
 	assert(leaderThreadCPU != nullptr);
 
 	_singleton = new LeaderThread(leaderThreadCPU);
+
+	// Only the instrumentations that need it are called periodically
+	size_t instrumentationPeriod = Instrument::leaderThreadSpinPeriod();
+	if (instrumentationPeriod > 0) {
+		registerPeriodicService(instrumentationService, nullptr, instrumentationPeriod);
+	}
+
+	// Sample the power of the packages even if no CPU changes its state
+	EnergyMonitor *energyMonitor = Monitoring::getEnergyMonitor();
+	if (energyMonitor != nullptr && EnergyMonitor::getSamplingRate() > 0) {
+		registerPeriodicService(energySamplingService, energyMonitor, EnergyMonitor::getSamplingRate());
+	}
+
 	_singleton->start(nullptr);
 }
 
@@ -35,12 +84,86 @@ void LeaderThread::shutdown()
 	_singleton->_mustExit.compare_exchange_strong(expected, true);
 	assert(!expected);
 
+	// Fire the timer right away to unblock the thread
+	_singleton->_lock.lock();
+	_singleton->arm(1);
+	_singleton->_lock.unlock();
+
 	_singleton->join();
 
 	delete _singleton;
 	_singleton = nullptr;
 }
 
+void LeaderThread::registerPeriodicService(service_function_t function, void *args, size_t period)
+{
+	assert(function != nullptr);
+	assert(period > 0);
+	assert(_singleton != nullptr);
+
+	std::lock_guard<SpinLock> guard(_singleton->_lock);
+
+	size_t deadline = Chrono::now<size_t>() + period;
+	_singleton->_services.push_back({function, args, period, deadline});
+
+	_singleton->armEarliest();
+}
+
+void LeaderThread::arm(size_t deadline)
+{
+	struct itimerspec spec;
+	spec.it_interval.tv_sec = 0;
+	spec.it_interval.tv_nsec = 0;
+	spec.it_value.tv_sec = deadline / 1000000;
+	spec.it_value.tv_nsec = (deadline % 1000000) * 1000;
+
+	int ret = timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+	FatalErrorHandler::failIf(ret == -1, "Failed to arm the leader thread timer: ", strerror(errno));
+}
+
+void LeaderThread::armEarliest()
+{
+	// A zero deadline disarms the timer when there are no services
+	size_t earliest = 0;
+	for (const PeriodicService &service : _services) {
+		if (earliest == 0 || service._deadline < earliest) {
+			earliest = service._deadline;
+		}
+	}
+
+	// Do not overwrite the expiration that wakes up the thread to exit
+	if (!_mustExit.load(std::memory_order_relaxed)) {
+		arm(earliest);
+	}
+}
+
+void LeaderThread::runDueServices(bool runAll)
+{
+	PeriodicService dueServices[MAX_DUE_SERVICES];
+	size_t numDueServices = 0;
+
+	_lock.lock();
+	size_t now = Chrono::now<size_t>();
+	for (PeriodicService &service : _services) {
+		if ((!runAll && service._deadline > now) || numDueServices == MAX_DUE_SERVICES)
+			continue;
+
+		dueServices[numDueServices++] = service;
+
+		// Skip the periods that were missed instead of running them in a burst
+		service._deadline += service._period;
+		if (service._deadline <= now) {
+			service._deadline = now + service._period;
+		}
+	}
+	armEarliest();
+	_lock.unlock();
+
+	for (size_t s = 0; s < numDueServices; ++s) {
+		dueServices[s]._function(dueServices[s]._args);
+	}
+}
+
 void LeaderThread::body()
 {
 	initializeHelperThread();
@@ -48,16 +171,29 @@ void LeaderThread::body()
 	Instrument::leaderThreadBegin();
 
 	while (!std::atomic_load_explicit(&_mustExit, std::memory_order_relaxed)) {
-		// The delay is 1 millisecond
-		struct timespec delay = {0, 1000000};
+		uint64_t expirations;
 
-		// The loop repeats the call with the remaining time in the event that
-		// the thread received a signal with a handler that has SA_RESTART set
+		// Block until the earliest deadline expires. The read is
+		// repeated if the thread is interrupted by a signal
 		Instrument::threadWillSuspend(getInstrumentationId());
-		while (_singleton->nsleep(&delay, &delay)) {
-		}
+		ssize_t ret;
+		do {
+			ret = read(_timerFd, &expirations, sizeof(expirations));
+		} while (ret == -1 && errno == EINTR);
+		FatalErrorHandler::failIf(ret != sizeof(expirations), "Failed to read the leader thread timer: ", strerror(errno));
 		Instrument::threadHasResumed(getInstrumentationId());
 
+		if (!std::atomic_load_explicit(&_mustExit, std::memory_order_relaxed)) {
+			runDueServices(false);
+		}
+	}
+
+	// Run all services a last time while exiting, so they can flush their work
+	runDueServices(true);
+
+	// The instrumentations that are not called periodically, such as the
+	// verbose one when it only dumps the log at the exit, flush it here
+	if (Instrument::leaderThreadSpinPeriod() == 0) {
 		Instrument::leaderThreadSpin();
 	}
 
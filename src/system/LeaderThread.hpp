@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef LEADER_THREAD_HPP
@@ -10,15 +10,40 @@
 #include <atomic>
 
 #include "executors/threads/CPU.hpp"
+#include "lowlevel/SpinLock.hpp"
 #include "lowlevel/threads/HelperThread.hpp"
+#include "support/Containers.hpp"
 
 
 //! \brief This class contains the code of the leader threat, which
 //! performs maintenance duties
+//!
+//! The maintenance duties are periodic services registered with their own
+//! period. The thread blocks on a timerfd armed with the earliest deadline
+//! of the registered services, so it does not wake up at all when there
+//! are no periodic services
 class LeaderThread : public HelperThread {
 
+public:
+
+	typedef void (*service_function_t)(void *args);
+
 private:
 
+	struct PeriodicService {
+		service_function_t _function;
+		void *_args;
+
+		//! The period in microseconds
+		size_t _period;
+
+		//! The next deadline in microseconds of the steady clock
+		size_t _deadline;
+	};
+
+	//! Maximum number of due services run at once
+	static constexpr size_t MAX_DUE_SERVICES = 16;
+
 	//! The singleton instance
 	static LeaderThread *_singleton;
 
@@ -28,18 +53,34 @@ private:
 	//! The LeaderThread's virtual CPU
 	CPU *_leaderThreadCPU;
 
+	//! Protects the services and the timer programming
+	SpinLock _lock;
+
+	//! The registered periodic services
+	Container::vector<PeriodicService> _services;
+
+	//! The timer armed with the earliest deadline of the services
+	int _timerFd;
+
+	//! \brief Program the timer to expire at a given deadline
+	//!
+	//! \param[in] deadline The absolute deadline in microseconds, or 0
+	//! to disarm the timer
+	void arm(size_t deadline);
+
+	//! \brief Program the timer with the earliest deadline of the services
+	void armEarliest();
+
+	//! \brief Run the services whose deadline has expired
+	//!
+	//! \param[in] runAll Whether to run all services regardless of their deadline
+	void runDueServices(bool runAll);
+
 public:
 
-	inline LeaderThread(CPU *leaderThreadCPU) :
-		HelperThread("leader-thread"),
-		_mustExit(false),
-		_leaderThreadCPU(leaderThreadCPU)
-	{
-	}
+	LeaderThread(CPU *leaderThreadCPU);
 
-	virtual ~LeaderThread()
-	{
-	}
+	virtual ~LeaderThread();
 
 	//! \brief Initialize the structures of the leader thread
 	//!
@@ -49,6 +90,13 @@ public:
 	//! \brief Finalize the structures of the leader thread
 	static void shutdown();
 
+	//! \brief Register a service that the leader thread runs periodically
+	//!
+	//! \param[in] function The function of the service
+	//! \param[in] args The argument passed to the function
+	//! \param[in] period The period in microseconds, which must be positive
+	static void registerPeriodicService(service_function_t function, void *args, size_t period);
+
 	//! \brief A loop that takes care of maintenance duties
 	void body();
 
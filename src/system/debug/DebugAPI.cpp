@@ -1,7 +1,7 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2015-2020 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include <cassert>
@@ -16,6 +16,8 @@
 #include "tasks/Task.hpp"
 #include "tasks/TaskImplementation.hpp"
 
+#include <InstrumentInitAndShutdown.hpp>
+
 
 void nanos6_wait_for_full_initialization(void)
 {
@@ -231,3 +233,8 @@ int nanos6_is_numa_tracking_enabled(void)
 {
 	return NUMAManager::isTrackingEnabled();
 }
+
+void nanos6_flight_recorder_dump(void)
+{
+	Instrument::flightRecorderDump();
+}
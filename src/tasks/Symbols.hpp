@@ -36,6 +36,9 @@ struct SymbolRepresentation
 
 	std::shared_ptr<DeviceAllocation>   allocation;
 
+	//Whether the allocation is pinned by the task owning this symbol while it runs
+	bool allocationPinned;
+
 	std::vector<DataAccessRegion> input_regions;
 	std::vector<DataAccessRegion> output_regions;
 	std::vector<DataAccessRegion> inout_regions;
@@ -43,7 +46,8 @@ struct SymbolRepresentation
 
 	SymbolRepresentation():
 		host_region(),
-		allocation(nullptr)
+		allocation(nullptr),
+		allocationPinned(false)
 		{
 
 		}
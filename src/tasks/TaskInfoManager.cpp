@@ -1,17 +1,38 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2022-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #include "TaskInfoManager.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
 
 #ifdef USE_CUDA
 #include "hardware/device/cuda/CUDAFunctions.hpp"
 #endif
 
-TaskInfoManager::task_info_map_t TaskInfoManager::_taskInfos;
-SpinLock TaskInfoManager::_lock;
+#if USE_FPGA
+#include "hardware/device/fpga/FPGAAccelerator.hpp"
+#include "hardware/device/fpga/FPGAReverseOffload.hpp"
+
+static unsigned int simple_hash_str(const char *str)
+{
+    const int MULTIPLIER = 33;
+    unsigned int h;
+    unsigned const char *p;
+
+    h = 0;
+    for (p = (unsigned const char*)str; *p != '\0'; p++)
+        h = MULTIPLIER * h + *p;
+
+    h += (h >> 5);
+
+    return h; // or, h % ARRAY_SIZE;
+}
+#endif
+
+TaskInfoManager::TaskInfoShard TaskInfoManager::_shards[NUM_SHARDS];
+std::atomic<size_t> TaskInfoManager::_unlabeledTaskInfos(0);
 
 void TaskInfoManager::checkDeviceTaskInfo(__attribute__((unused)) const nanos6_task_info_t *taskInfo)
 {
@@ -33,3 +54,69 @@ void TaskInfoManager::checkDeviceTaskInfo(__attribute__((unused)) const nanos6_t
 	}
 #endif
 }
+
+void TaskInfoManager::setupDeviceArguments(
+	__attribute__((unused)) const nanos6_task_info_t *taskInfo,
+	__attribute__((unused)) TaskInfoData &data
+) {
+#if USE_FPGA
+	// Each argument is passed to the kernel in an xtasks argument value. The
+	// symbols are passed by address, which is translated at submission
+	data._deviceArguments.resize(taskInfo->num_args);
+	for (int arg = 0; arg < taskInfo->num_args; ++arg) {
+		FatalErrorHandler::failIf(
+			(size_t) taskInfo->sizeof_table[arg] > sizeof(xtasks_arg_val),
+			"Argument ", arg, " of the FPGA task ", data._taskTypeLabel, " does not fit in an xtasks argument"
+		);
+
+		data._deviceArguments[arg]._offset = taskInfo->offset_table[arg];
+		data._deviceArguments[arg]._size = taskInfo->sizeof_table[arg];
+		data._deviceArguments[arg]._symbol = -1;
+	}
+
+	for (int symbol = 0; symbol < taskInfo->num_symbols; ++symbol) {
+		int arg = taskInfo->arg_idx_table[symbol];
+		assert(arg >= 0 && arg < taskInfo->num_args);
+		assert(data._deviceArguments[arg]._symbol == -1);
+
+		data._deviceArguments[arg]._symbol = symbol;
+	}
+#endif
+}
+
+void TaskInfoManager::setupDeviceTaskInfo(
+	__attribute__((unused)) nanos6_task_info_t *taskInfo,
+	__attribute__((unused)) TaskInfoData &data
+) {
+#if USE_FPGA
+	const nanos6_task_implementation_info_t &implementation = taskInfo->implementations[0];
+	if (implementation.device_type_id == nanos6_fpga_device) {
+		assert(implementation.device_function_name != nullptr);
+	}
+
+	if (implementation.device_function_name == nullptr)
+		return;
+
+	// The subtype identifies the accelerators that run the task, so it is
+	// computed once here instead of every time a task is submitted
+	uint64_t subtype = simple_hash_str(implementation.device_function_name) & 0xFFFFFFFF;
+	if (implementation.device_type_id == nanos6_fpga_device) {
+		subtype |= 0x100000000llu;
+		FPGAAccelerator::_numDeviceTaskTypes++;
+		setupDeviceArguments(taskInfo, data);
+	}
+#if USE_DISTRIBUTED
+	else if (implementation.device_type_id == nanos6_broadcaster_device) {
+		subtype |= 0x100000000llu;
+		FPGAAccelerator::_numDeviceTaskTypes++;
+		setupDeviceArguments(taskInfo, data);
+	}
+#endif
+	else {
+		subtype |= 0x200000000llu;
+		FPGAReverseOffload::registerReverseTaskInfo(subtype, taskInfo);
+	}
+
+	data._deviceSubtype = subtype;
+#endif
+}
@@ -1,17 +1,19 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 
-	Copyright (C) 2022 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2022-2023 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef TASK_INFO_DATA_HPP
 #define TASK_INFO_DATA_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <mutex>
 #include <string>
-#include <unordered_map>
 #include <map>
+#include <vector>
 
 #include <nanos6/task-info-registration.h>
 
@@ -23,31 +25,24 @@
 #include <config.h>
 #endif
 
-#if USE_FPGA
-#include <iostream>
-#include "hardware/device/fpga/FPGAAccelerator.hpp"
-#include "hardware/device/fpga/FPGAReverseOffload.hpp"
-
-static unsigned int simple_hash_str(const char *str)
-{
-    const int MULTIPLIER = 33;
-    unsigned int h;
-    unsigned const char *p;
-
-    h = 0;
-    for (p = (unsigned const char*)str; *p != '\0'; p++)
-        h = MULTIPLIER * h + *p;
-
-    h += (h >> 5);
-
-    return h; // or, h % ARRAY_SIZE;
-}
-#endif
-
 class TaskInfoManager;
 class TasktypeStatistics;
 
 class TaskInfoData {
+public:
+	//! Layout of an argument of a device kernel
+	struct DeviceArgument {
+		//! Offset of the argument in the args block
+		size_t _offset;
+
+		//! Size of the argument in the args block
+		size_t _size;
+
+		//! Symbol whose address is passed in the argument, or -1 if none
+		int _symbol;
+	};
+
+private:
 	//! Task type label
 	std::string _taskTypeLabel;
 
@@ -60,6 +55,15 @@ class TaskInfoData {
 	//! Monitoring-related statistics per taskType
 	TasktypeStatistics *_taskTypeStatistics;
 
+	//! Device subtype of the implementation (0 if it has none)
+	uint64_t _deviceSubtype;
+
+	//! Size of the arguments when packed one after the other
+	size_t _packedArgsSize;
+
+	//! Arguments passed to the device kernel (empty if it has none)
+	std::vector<DeviceArgument> _deviceArguments;
+
 	friend class TaskInfoManager;
 
 public:
@@ -67,7 +71,10 @@ public:
 		_taskTypeLabel(),
 		_taskDeclarationSource(),
 		_instrumentId(),
-		_taskTypeStatistics(nullptr)
+		_taskTypeStatistics(nullptr),
+		_deviceSubtype(0),
+		_packedArgsSize(0),
+		_deviceArguments()
 	{
 	}
 
@@ -95,60 +102,79 @@ public:
 	{
 		return _taskTypeStatistics;
 	}
+
+	inline uint64_t getDeviceSubtype() const
+	{
+		return _deviceSubtype;
+	}
+
+	inline size_t getPackedArgsSize() const
+	{
+		return _packedArgsSize;
+	}
+
+	inline const std::vector<DeviceArgument> &getDeviceArguments() const
+	{
+		return _deviceArguments;
+	}
 };
 
 class TaskInfoManager {
 	//! A map with task info data useful for filtering duplicated task infos
 	typedef std::map<nanos6_task_info_t *, TaskInfoData> task_info_map_t;
-	static task_info_map_t _taskInfos;
 
-	//! SpinLock to register and traverse task infos
-	static SpinLock _lock;
+	//! A part of the registered task infos with its own lock, so that
+	//! registrations from several threads do not serialize
+	struct alignas(CACHELINE_SIZE) TaskInfoShard {
+		//! SpinLock to register and traverse the task infos of the shard
+		SpinLock _lock;
+
+		task_info_map_t _taskInfos;
+	};
+
+	//! Number of shards, which must be a power of two
+	static constexpr size_t NUM_SHARDS = 16;
+
+	static TaskInfoShard _shards[NUM_SHARDS];
+
+	//! Global number of unlabeled task infos
+	static std::atomic<size_t> _unlabeledTaskInfos;
 
 	//! Check whether any device kernel must be loaded
 	static void checkDeviceTaskInfo(const nanos6_task_info_t *taskInfo);
 
+	//! Fill the device-related fields of the data of a new task info
+	static void setupDeviceTaskInfo(nanos6_task_info_t *taskInfo, TaskInfoData &data);
+
+	//! Compute the layout of the arguments passed to a device kernel
+	static void setupDeviceArguments(const nanos6_task_info_t *taskInfo, TaskInfoData &data);
+
+	static inline TaskInfoShard &getShard(const nanos6_task_info_t *taskInfo)
+	{
+		// Task infos are usually laid out one after the other
+		uintptr_t index = (uintptr_t) taskInfo / sizeof(nanos6_task_info_t);
+		return _shards[index & (NUM_SHARDS - 1)];
+	}
+
 public:
 	//! \brief Register a new task info
 	//!
+	//! The data of the task info is reachable through its task_type_data field
+	//! once registered, so accessing it later does not require any lock
+	//!
 	//! \param[in,out] taskInfo A pointer to a task info
 	static inline TaskInfoData &registerTaskInfo(nanos6_task_info_t *taskInfo) {
 		assert(taskInfo != nullptr);
 		assert(taskInfo->implementations != nullptr);
 		assert(taskInfo->implementations[0].declaration_source != nullptr);
 
-#if USE_FPGA
-		if (taskInfo->implementations[0].device_type_id == nanos6_fpga_device) {
-			assert(taskInfo->implementations[0].device_function_name != nullptr);
-		}
-		if (taskInfo->implementations[0].device_function_name != nullptr) {
-			uint64_t subtype = simple_hash_str(taskInfo->implementations[0].device_function_name) & 0xFFFFFFFF;
-			if (taskInfo->implementations[0].device_type_id == nanos6_fpga_device) {
-				subtype |= 0x100000000llu;
-				FPGAAccelerator::_device_subtype_map[taskInfo->implementations] = subtype;
-			}
-#if USE_DISTRIBUTED
-			else if (taskInfo->implementations[0].device_type_id == nanos6_broadcaster_device) {
-				subtype |= 0x100000000llu;
-				FPGAAccelerator::_device_subtype_map[taskInfo->implementations] = subtype;
-			}
-#endif
-			else {
-				subtype |= 0x200000000llu;
-				FPGAReverseOffload::_reverseMap[subtype] = taskInfo;
-			}
-		}
-#endif
-
-		// Global number of unlabeled task infos
-		static size_t unlabeledTaskInfos = 0;
-
 		// Check whether any device kernel must be loaded
 		checkDeviceTaskInfo(taskInfo);
 
-		std::lock_guard<SpinLock> lock(_lock);
+		TaskInfoShard &shard = getShard(taskInfo);
+		std::lock_guard<SpinLock> lock(shard._lock);
 
-		auto result = _taskInfos.emplace(
+		auto result = shard._taskInfos.emplace(
 			std::piecewise_construct,
 			std::forward_as_tuple(taskInfo),
 			std::forward_as_tuple(/* empty */)
@@ -164,10 +190,17 @@ public:
 		if (taskInfo->implementations[0].task_type_label) {
 			data._taskTypeLabel = std::string(taskInfo->implementations[0].task_type_label);
 		} else {
-			data._taskTypeLabel = "Unlabeled" + std::to_string(unlabeledTaskInfos++);
+			data._taskTypeLabel = "Unlabeled" + std::to_string(_unlabeledTaskInfos++);
 		}
 		data._taskDeclarationSource = std::string(taskInfo->implementations[0].declaration_source);
 
+		for (int arg = 0; arg < taskInfo->num_args; ++arg) {
+			assert(taskInfo->sizeof_table != nullptr);
+			data._packedArgsSize += taskInfo->sizeof_table[arg];
+		}
+
+		setupDeviceTaskInfo(taskInfo, data);
+
 		// Setup the reference to the data in the task info
 		taskInfo->task_type_data = &data;
 
@@ -180,10 +213,12 @@ public:
 	template <typename F>
 	static inline void processAllTaskInfos(F functionToApply)
 	{
-		std::lock_guard<SpinLock> lock(_lock);
+		for (TaskInfoShard &shard : _shards) {
+			std::lock_guard<SpinLock> lock(shard._lock);
 
-		for (auto &taskInfo : _taskInfos) {
-			functionToApply(taskInfo.first, taskInfo.second);
+			for (auto &taskInfo : shard._taskInfos) {
+				functionToApply(taskInfo.first, taskInfo.second);
+			}
 		}
 	}
 };
@@ -0,0 +1,82 @@
+#!/bin/bash
+
+#	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+#
+#	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+
+# Check that the native CTF converter generates the same Paraver trace as the
+# default one. The given test program is run with the ctf instrumentation and
+# its trace is converted with both converters. The .pcf and .row files must be
+# identical. The .prv files are compared with one event per record and sorted,
+# since the default converter joins the events emitted together in a record
+# and the records with the same timestamp may be written in another order
+#
+# Usage: ctf2prv-parity.sh <bindir> <program> [<args>...]
+#
+# The <bindir> is where ctf2prv and nanos6-ctf2prv-native are installed, and
+# babeltrace2 must be in the path
+
+if [ $# -lt 2 ]; then
+	>&2 echo "Usage: $0 <bindir> <program> [<args>...]"
+	exit 1
+fi
+
+BINDIR=$(readlink -f "$1")
+PROGRAM=$(readlink -f "$2")
+shift 2
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf ${WORKDIR}" EXIT
+
+# Run the program without converting the trace at the end
+cd ${WORKDIR}
+export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},version.instrument=ctf,instrument.ctf.converter.enabled=false"
+if ! "${PROGRAM}" "${@}" > /dev/null; then
+	>&2 echo "The program failed"
+	exit 1
+fi
+
+TRACE=$(ls -d ${WORKDIR}/trace_* 2> /dev/null | head -n 1)
+if [ -z "${TRACE}" ]; then
+	>&2 echo "The program did not generate any trace"
+	exit 1
+fi
+
+# The default converter writes the trace in <trace>/prv
+"${BINDIR}/ctf2prv" "${TRACE}" > /dev/null || exit 1
+mv "${TRACE}/prv" ${WORKDIR}/default
+
+"${BINDIR}/nanos6-ctf2prv-native" -q -o ${WORKDIR}/native "${TRACE}" || exit 1
+
+# Print the header without the conversion date, then a line per event
+normalize_prv() {
+	head -n 1 "$1" | sed -e 's/^#Paraver ([^)]*)//'
+	tail -n +2 "$1" | awk -F: '
+		$1 == 2 {
+			for (i = 7; i < NF; i += 2)
+				print $1 ":" $2 ":" $3 ":" $4 ":" $5 ":" $6 ":" $i ":" $(i + 1)
+			next
+		}
+		{ print }
+	' | sort
+}
+
+status=0
+
+normalize_prv ${WORKDIR}/default/trace.prv > ${WORKDIR}/default.prv
+normalize_prv ${WORKDIR}/native/trace.prv > ${WORKDIR}/native.prv
+if ! diff -q ${WORKDIR}/default.prv ${WORKDIR}/native.prv > /dev/null; then
+	>&2 echo "The .prv files differ:"
+	diff ${WORKDIR}/default.prv ${WORKDIR}/native.prv | head -n 20 >&2
+	status=1
+fi
+
+for ext in pcf row; do
+	if ! diff -q ${WORKDIR}/default/trace.${ext} ${WORKDIR}/native/trace.${ext} > /dev/null; then
+		>&2 echo "The .${ext} files differ:"
+		diff ${WORKDIR}/default/trace.${ext} ${WORKDIR}/native/trace.${ext} | head -n 20 >&2
+		status=1
+	fi
+done
+
+exit ${status}
@@ -0,0 +1,14 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "cuda-eviction.hpp"
+
+
+__global__ void incrementCUDAKernel(long int n, double *x)
+{
+	long int i = blockIdx.x * blockDim.x + threadIdx.x;
+	if (i < n) x[i] = x[i] + 1;
+}
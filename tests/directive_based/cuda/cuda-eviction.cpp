@@ -0,0 +1,93 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <cstdlib>
+
+#include <nanos6.h>
+
+#include "cuda-eviction.hpp"
+
+#include "TestAnyProtocolProducer.hpp"
+
+
+// The working set is four times the capacity of the device directory set for
+// this test, so sweeping it with device tasks evicts blocks. The capacity still
+// fits the blocks of the tasks running on all the streams
+#define TOTALSIZE  (8*1024*1024)
+#define BLOCKSIZE  (64*1024)
+#define ITERATIONS (10)
+
+
+TestAnyProtocolProducer tap;
+
+#pragma oss task out([BS]x)
+void initializeChunk(long int BS, long int start, double *x) {
+	for (long int i = 0; i < BS; ++i) {
+		x[i] = start + i;
+	}
+}
+
+bool validate(long int N, long int start, long int ITS, double *x) {
+	for (long int i = 0; i < N; ++i) {
+		if (x[i] != start + i + ITS) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	const long int N = TOTALSIZE;
+	const long int BS = BLOCKSIZE;
+	const int ITS = ITERATIONS;
+
+	tap.registerNewTests(3);
+	tap.begin();
+
+	// Host memory, so the directory has to copy the blocks
+	double *x = (double *) malloc(N * sizeof(double));
+	if (x == NULL) {
+		tap.bailOut("Cannot allocate the data");
+		return 1;
+	}
+
+	for (long int i = 0; i < N; i += BS) {
+		initializeChunk(BS, i, &x[i]);
+	}
+	#pragma oss taskwait
+
+	// The next taskwait waits for the device tasks without copying their
+	// blocks back, so the host only has what the evictions wrote back
+	nanos6_set_noflush(x, N * sizeof(double));
+
+	for (long int i = 0; i < N; i += BS) {
+		incrementCUDAKernel(BS, &x[i]);
+	}
+	#pragma oss taskwait
+
+	// The first block is the least recently used, so it has been evicted and,
+	// being dirty, written back to the host
+	tap.evaluate(validate(BS, 0, 1, x), "The least recently used block was written back when evicted");
+
+	// The last block is the most recently used, so it is still on the device
+	// and the host keeps the initial values
+	tap.evaluate(validate(BS, N - BS, 0, &x[N - BS]), "The most recently used block was not evicted");
+
+	for (int it = 1; it < ITS; ++it) {
+		for (long int i = 0; i < N; i += BS) {
+			incrementCUDAKernel(BS, &x[i]);
+		}
+	}
+	#pragma oss taskwait
+
+	tap.evaluate(validate(N, 0, ITS, x), "All the blocks are valid after the taskwait");
+	tap.end();
+
+	free(x);
+
+	return 0;
+}
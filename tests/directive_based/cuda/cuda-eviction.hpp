@@ -0,0 +1,22 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef CUDA_EVICTION_HPP
+#define CUDA_EVICTION_HPP
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma oss task inout([n]x) device(cuda) ndrange(1, n, 128)
+__global__ void incrementCUDAKernel(long int n, double *x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CUDA_EVICTION_HPP
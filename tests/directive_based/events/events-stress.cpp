@@ -0,0 +1,152 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6.h>
+#include <nanos6/debug.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Atomic.hpp"
+#include "TestAnyProtocolProducer.hpp"
+#include "Utils.hpp"
+
+#define NUM_TASKS 2000
+#define NUM_FULFILLERS 8
+
+typedef std::vector<Atomic<void *> > counters_list_t;
+typedef std::vector<Atomic<int> > decreased_list_t;
+
+struct FulfillerArgs {
+	counters_list_t *_counters;
+	decreased_list_t *_decreased;
+	int _id;
+
+	FulfillerArgs() :
+		_counters(NULL),
+		_decreased(NULL),
+		_id(0)
+	{
+	}
+};
+
+TestAnyProtocolProducer tap;
+
+
+void *fulfiller(void *arg)
+{
+	FulfillerArgs *args = (FulfillerArgs *) arg;
+	assert(args != NULL);
+
+	counters_list_t &counters = *args->_counters;
+	decreased_list_t &decreased = *args->_decreased;
+	const int ncounters = counters.size();
+
+	// Wait until all tasks have registered their events
+	for (int c = 0; c < ncounters; ++c) {
+		while (counters[c] == NULL);
+	}
+
+	// Let the task bodies finish, so that the last event of most tasks is
+	// decreased by one of these threads
+	usleep(100000);
+
+	// Each fulfiller decreases one event of every task, starting at a
+	// different task so that they collide on the last events of the tasks
+	const int start = (ncounters / NUM_FULFILLERS) * args->_id;
+	for (int i = 0; i < ncounters; ++i) {
+		const int c = (start + i) % ncounters;
+		void *counter = counters[c];
+		decreased[c]++;
+		nanos6_decrease_task_event_counter(counter, 1);
+	}
+	return NULL;
+}
+
+
+int main()
+{
+	const long activeCPUs = nanos6_get_num_cpus();
+	tap.emitDiagnostic("Detected ", activeCPUs, " CPUs");
+
+	if (activeCPUs == 1) {
+		// This test only works correctly with more than 1 CPU
+		tap.registerNewTests(1);
+		tap.begin();
+		tap.skip("This test does not work with just 1 CPU");
+		tap.end();
+		return 0;
+	}
+
+	const int ntasks = NUM_TASKS;
+	tap.registerNewTests(ntasks);
+	tap.begin();
+
+	// Array for storing the test data
+	int *data = (int *) calloc(ntasks, sizeof(int));
+	assert(data != NULL);
+
+	counters_list_t counters(ntasks);
+	decreased_list_t decreased(ntasks);
+	for (int c = 0; c < ntasks; ++c) {
+		counters[c] = NULL;
+		decreased[c] = 0;
+	}
+
+	// Create the external threads that will fulfill the task events
+	pthread_t threads[NUM_FULFILLERS];
+	FulfillerArgs args[NUM_FULFILLERS];
+	for (int t = 0; t < NUM_FULFILLERS; ++t) {
+		args[t]._counters = &counters;
+		args[t]._decreased = &decreased;
+		args[t]._id = t;
+		CHECK(pthread_create(&threads[t], NULL, fulfiller, &args[t]));
+	}
+
+	// Each task registers an event per fulfiller, and its successor checks
+	// that the dependency was only released after all of them. Many of the
+	// tasks complete at the same time from the fulfillers, which also
+	// exercises completing them in place when the inbox of deferred events
+	// is full
+	for (int task = 0; task < ntasks; ++task) {
+		#pragma oss task label("event") shared(counters) inout(data[task])
+		{
+			void *counter = nanos6_get_current_event_counter();
+			assert(counter != NULL);
+
+			nanos6_increase_current_task_event_counter(counter, NUM_FULFILLERS);
+			data[task]++;
+			counters[task] = counter;
+		}
+
+		#pragma oss task label("successor") shared(decreased) inout(data[task])
+		{
+			tap.evaluate(
+				data[task] == 1 && decreased[task] == NUM_FULFILLERS,
+				"Check that the successor runs after the events are fulfilled"
+			);
+			data[task]++;
+		}
+	}
+	#pragma oss taskwait
+
+	for (int t = 0; t < NUM_FULFILLERS; ++t) {
+		CHECK(pthread_join(threads[t], NULL));
+	}
+
+	for (int task = 0; task < ntasks; ++task) {
+		assert(data[task] == 2);
+	}
+
+	free(data);
+
+	tap.end();
+
+	return 0;
+}
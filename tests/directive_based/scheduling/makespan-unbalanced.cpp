@@ -0,0 +1,139 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+// Benchmark of the makespan of unbalanced task graphs, to compare the
+// scheduling policies. It is built with "make check" but it is not run as a
+// test. Run it once per policy, for instance:
+//
+//	NANOS6_CONFIG_OVERRIDE="scheduler.policy=fifo" ./makespan-unbalanced.clang.bench
+//	NANOS6_CONFIG_OVERRIDE="scheduler.policy=lifo" ./makespan-unbalanced.clang.bench
+//	NANOS6_CONFIG_OVERRIDE="scheduler.policy=cost,monitoring.enabled=true" ./makespan-unbalanced.clang.bench
+//
+// Each graph is executed several times. The first iterations let monitoring
+// predict the execution time of each tasktype, so only the following ones
+// are reported. The graphs are:
+//
+// - short-first: many independent short tasks created before long tasks
+//   for half of the CPUs, so serving the tasks in creation order leaves the
+//   long tasks for the end
+// - long-first: the same tasks, with the long ones created first
+// - chain: a chain of dependent medium tasks, the critical path, whose
+//   tasks become ready while many short tasks are queued
+
+#include <nanos6/debug.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define SHORT_US 100
+#define MEDIUM_US 2000
+#define LONG_US 20000
+#define SHORT_TASKS_PER_CPU 100
+#define CHAIN_LENGTH 20
+#define WARMUP_ITERATIONS 2
+#define ITERATIONS 5
+
+
+typedef std::chrono::steady_clock clock_type;
+
+static void spin(long us)
+{
+	clock_type::time_point end = clock_type::now() + std::chrono::microseconds(us);
+	while (clock_type::now() < end);
+}
+
+static void createShortTasks(int numTasks)
+{
+	for (int t = 0; t < numTasks; ++t) {
+		#pragma oss task label("short")
+		spin(SHORT_US);
+	}
+}
+
+static void createLongTasks(int numTasks)
+{
+	for (int t = 0; t < numTasks; ++t) {
+		#pragma oss task label("long")
+		spin(LONG_US);
+	}
+}
+
+static inline int getNumLongTasks(int numCPUs)
+{
+	return std::max(1, numCPUs / 2);
+}
+
+static void shortFirst(int numCPUs)
+{
+	createShortTasks(SHORT_TASKS_PER_CPU * numCPUs);
+	createLongTasks(getNumLongTasks(numCPUs));
+	#pragma oss taskwait
+}
+
+static void longFirst(int numCPUs)
+{
+	createLongTasks(getNumLongTasks(numCPUs));
+	createShortTasks(SHORT_TASKS_PER_CPU * numCPUs);
+	#pragma oss taskwait
+}
+
+static void chain(int numCPUs)
+{
+	int link = 0;
+	for (int c = 0; c < CHAIN_LENGTH; ++c) {
+		#pragma oss task label("medium") inout(link)
+		{
+			spin(MEDIUM_US);
+			++link;
+		}
+
+		createShortTasks(SHORT_TASKS_PER_CPU * numCPUs / CHAIN_LENGTH);
+	}
+	#pragma oss taskwait
+}
+
+template <typename F>
+static double measure(F graph, int numCPUs)
+{
+	for (int it = 0; it < WARMUP_ITERATIONS; ++it) {
+		graph(numCPUs);
+	}
+
+	std::vector<double> makespans;
+	for (int it = 0; it < ITERATIONS; ++it) {
+		clock_type::time_point start = clock_type::now();
+		graph(numCPUs);
+		clock_type::time_point end = clock_type::now();
+		makespans.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	std::sort(makespans.begin(), makespans.end());
+	return makespans[makespans.size() / 2];
+}
+
+int main()
+{
+	const int numCPUs = nanos6_get_num_cpus();
+
+	// The lower bound is the largest of the critical path and the total work
+	// divided among the CPUs
+	const double shortWork = (double) SHORT_TASKS_PER_CPU * SHORT_US / 1000.0;
+	const double longWork = (double) getNumLongTasks(numCPUs) * LONG_US / 1000.0 / numCPUs;
+	const double unbalancedBound = std::max((double) LONG_US / 1000.0, shortWork + longWork);
+	const double chainWork = (double) CHAIN_LENGTH * MEDIUM_US / 1000.0;
+	const double chainBound = std::max(chainWork, shortWork + chainWork / numCPUs);
+
+	printf("CPUs: %d, median of %d iterations after %d warm-up iterations\n", numCPUs, ITERATIONS, WARMUP_ITERATIONS);
+	printf("%12s %14s %14s\n", "graph", "makespan (ms)", "bound (ms)");
+	printf("%12s %14.1f %14.1f\n", "short-first", measure(shortFirst, numCPUs), unbalancedBound);
+	printf("%12s %14.1f %14.1f\n", "long-first", measure(longFirst, numCPUs), unbalancedBound);
+	printf("%12s %14.1f %14.1f\n", "chain", measure(chain, numCPUs), chainBound);
+
+	return 0;
+}
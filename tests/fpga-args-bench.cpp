@@ -0,0 +1,188 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+// Microbenchmark of the marshalling of the arguments of FPGA tasks. It
+// compares the previous submission path, which filled a stack array of 16
+// xtasks values and then patched the symbol addresses in a second pass, with
+// the marshalling of FPGAAccelerator, which it shares through FPGAArguments.hpp.
+//
+// It only needs the header of libxtasks and no FPGA. It is built with "make
+// check" when the FPGA support is enabled, or by hand with:
+//
+//	g++ -std=c++17 -O2 -I<dir of libxtasks.h> -Isrc tests/fpga-args-bench.cpp
+//
+// The arguments are handed to a sink that copies them, as xtasksAddArgs does
+
+#include <libxtasks.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "hardware/device/fpga/FPGAArguments.hpp"
+
+#define ITERATIONS 10000000
+#define REPETITIONS 5
+#define MAX_OLD_ARGS 16
+
+struct TaskType {
+	int _numArgs;
+	int _numSymbols;
+	std::vector<int> _offsets;
+	std::vector<int> _sizes;
+	std::vector<int> _argIndices;
+};
+
+struct DeviceArgument {
+	size_t _offset;
+	size_t _size;
+	int _symbol;
+};
+
+struct Translation {
+	uint64_t _localAddress;
+	uint64_t _deviceAddress;
+};
+
+// Copy of the arguments, as the ones kept by xtasks until the submission
+static xtasks_arg_val _submitted[64];
+static uint64_t _checksum = 0;
+
+static inline void addArgs(size_t num, const xtasks_arg_val *values, xtasks_task_handle)
+{
+	memcpy(_submitted, values, num * sizeof(xtasks_arg_val));
+	_checksum += _submitted[num - 1];
+}
+
+// The path before the argument layout was computed per task type
+static void oldSubmit(const void *args, const TaskType &type, const Translation *translations, xtasks_task_handle handle)
+{
+	xtasks_arg_val fpgaArgs[MAX_OLD_ARGS];
+	assert(type._numArgs <= MAX_OLD_ARGS);
+	memset(fpgaArgs, 0, sizeof(fpgaArgs));
+	for (int i = 0; i < type._numArgs; ++i) {
+		const char *p = (const char *) args + type._offsets[i];
+		memcpy(fpgaArgs + i, p, type._sizes[i]);
+	}
+	for (int i = 0; i < type._numSymbols; ++i) {
+		int arg = type._argIndices[i];
+		fpgaArgs[arg] = fpgaArgs[arg] - translations[i]._localAddress + translations[i]._deviceAddress;
+	}
+	addArgs(type._numArgs, fpgaArgs, handle);
+}
+
+// The path used by FPGAAccelerator::submitTask
+static void newSubmit(const void *args, const std::vector<DeviceArgument> &deviceArgs, const Translation *translations, xtasks_task_handle handle)
+{
+	std::vector<xtasks_arg_val> &fpgaArgs = FPGAArguments::marshal(args, deviceArgs,
+		[translations](int symbol) -> xtasks_arg_val {
+			return translations[symbol]._deviceAddress - translations[symbol]._localAddress;
+		}
+	);
+	addArgs(fpgaArgs.size(), fpgaArgs.data(), handle);
+}
+
+// A task type whose even arguments are pointers to symbols and whose odd
+// arguments are 32-bit scalars
+static TaskType makeTaskType(int numArgs)
+{
+	TaskType type;
+	type._numArgs = numArgs;
+	type._numSymbols = 0;
+	int offset = 0;
+	for (int i = 0; i < numArgs; ++i) {
+		const int size = (i % 2 == 0) ? 8 : 4;
+		offset = (offset + size - 1) / size * size;
+		type._offsets.push_back(offset);
+		type._sizes.push_back(size);
+		if (i % 2 == 0) {
+			type._argIndices.push_back(i);
+			type._numSymbols++;
+		}
+		offset += size;
+	}
+	return type;
+}
+
+// The layout that TaskInfoManager computes when the task type is registered
+static std::vector<DeviceArgument> makeLayout(const TaskType &type)
+{
+	std::vector<DeviceArgument> deviceArgs(type._numArgs);
+	for (int i = 0; i < type._numArgs; ++i) {
+		deviceArgs[i]._offset = type._offsets[i];
+		deviceArgs[i]._size = type._sizes[i];
+		deviceArgs[i]._symbol = -1;
+	}
+	for (int i = 0; i < type._numSymbols; ++i) {
+		deviceArgs[type._argIndices[i]]._symbol = i;
+	}
+	return deviceArgs;
+}
+
+template <typename F>
+static double measure(F submit)
+{
+	double best = 0.0;
+	for (int r = 0; r < REPETITIONS; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		for (int it = 0; it < ITERATIONS; ++it) {
+			submit(it);
+		}
+		auto end = std::chrono::steady_clock::now();
+		double ns = std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+		best = (r == 0) ? ns : std::min(best, ns);
+	}
+	return best;
+}
+
+int main()
+{
+	xtasks_task_handle handle = nullptr;
+
+	printf("%6s %12s %12s\n", "args", "old (ns)", "new (ns)");
+	for (int numArgs : {2, 4, 8, 16}) {
+		const TaskType type = makeTaskType(numArgs);
+		const std::vector<DeviceArgument> layout = makeLayout(type);
+
+		char args[256];
+		for (size_t i = 0; i < sizeof(args); ++i)
+			args[i] = (char) i;
+
+		std::vector<Translation> translations(type._numSymbols);
+		for (int i = 0; i < type._numSymbols; ++i) {
+			translations[i]._localAddress = 0x1000 * (i + 1);
+			translations[i]._deviceAddress = 0x80000000 + 0x1000 * (i + 1);
+		}
+
+		// Both paths must marshal the same values
+		oldSubmit(args, type, translations.data(), handle);
+		std::vector<xtasks_arg_val> expected(_submitted, _submitted + numArgs);
+		newSubmit(args, layout, translations.data(), handle);
+		if (!std::equal(expected.begin(), expected.end(), _submitted)) {
+			fprintf(stderr, "The arguments differ with %d arguments\n", numArgs);
+			return 1;
+		}
+
+		// Change one argument per submission so that nothing is hoisted
+		uint32_t *scalar = (uint32_t *) (args + type._offsets[1]);
+		const double oldNs = measure([&](int it) {
+			*scalar = it;
+			oldSubmit(args, type, translations.data(), handle);
+		});
+		const double newNs = measure([&](int it) {
+			*scalar = it;
+			newSubmit(args, layout, translations.data(), handle);
+		});
+		printf("%6d %12.2f %12.2f\n", numArgs, oldNs, newNs);
+	}
+
+	// Keep the checksum alive
+	return (_checksum == 42) ? 2 : 0;
+}
@@ -0,0 +1,186 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+// Microbenchmark of the wake-up of idle threads. It compares the previous
+// suspension of kernel-level threads, a ConditionVariable per thread that is
+// signaled one by one, with the ParkingSpots of a shared ParkingLot that are
+// woken up with a single ParkingBatch, as ThreadManager::resumeIdle does.
+//
+// It measures the time from the first wake-up until the last thread runs,
+// which is the time until all the CPUs are busy when the threads are the
+// workers of idle CPUs. It only needs pthreads. It is built with "make
+// check", or by hand with:
+//
+//	g++ -std=c++17 -O2 -pthread -Isrc tests/parking-bench.cpp
+//
+// The threads are not bound, so the results depend on the available CPUs
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "lowlevel/ConditionVariable.hpp"
+#include "lowlevel/ParkingLot.hpp"
+
+#define ROUNDS 200
+
+typedef std::chrono::steady_clock clock_type;
+
+// State shared by the waker and the parked threads
+struct Round {
+	std::atomic<size_t> _awake;
+	std::atomic<bool> _done;
+	std::atomic<bool> _stop;
+	clock_type::time_point _lastAwake;
+
+	Round() : _awake(0), _done(false), _stop(false)
+	{
+	}
+
+	// Called by each thread after it wakes up
+	inline void arrive(size_t numThreads)
+	{
+		if (_awake.fetch_add(1) + 1 == numThreads) {
+			_lastAwake = clock_type::now();
+			_done.store(true);
+		}
+	}
+
+	inline void reset()
+	{
+		_awake.store(0);
+		_done.store(false);
+	}
+};
+
+// The waker waits until all threads arrived, and then lets them park again
+static inline void waitRound(Round &round)
+{
+	while (!round._done.load())
+		std::this_thread::yield();
+}
+
+static inline void letThreadsPark()
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+static double median(std::vector<double> &times)
+{
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+// The path before the parking spots, one condition variable per thread
+static double benchConditionVariables(size_t numThreads)
+{
+	Round round;
+	std::vector<ConditionVariable> condVars(numThreads);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < numThreads; ++t) {
+		threads.emplace_back([&, t]() {
+			while (true) {
+				condVars[t].wait();
+				if (round._stop.load())
+					break;
+				round.arrive(numThreads);
+			}
+		});
+	}
+
+	std::vector<double> times;
+	for (int r = 0; r < ROUNDS; ++r) {
+		letThreadsPark();
+		round.reset();
+
+		clock_type::time_point start = clock_type::now();
+		for (size_t t = 0; t < numThreads; ++t) {
+			condVars[t].signal();
+		}
+		waitRound(round);
+		times.push_back(std::chrono::duration<double, std::micro>(round._lastAwake - start).count());
+	}
+
+	letThreadsPark();
+	round._stop.store(true);
+	for (size_t t = 0; t < numThreads; ++t) {
+		condVars[t].signal();
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	return median(times);
+}
+
+// The path of ThreadManager::resumeIdle, one batch for the shared lot
+static double benchParkingBatch(size_t numThreads)
+{
+	Round round;
+	ParkingLot lot;
+	std::vector<ParkingSpot> spots(numThreads);
+	for (ParkingSpot &spot : spots) {
+		spot.setLot(&lot);
+	}
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < numThreads; ++t) {
+		threads.emplace_back([&, t]() {
+			while (true) {
+				spots[t].park();
+				if (round._stop.load())
+					break;
+				round.arrive(numThreads);
+			}
+		});
+	}
+
+	std::vector<double> times;
+	for (int r = 0; r < ROUNDS; ++r) {
+		letThreadsPark();
+		round.reset();
+
+		clock_type::time_point start = clock_type::now();
+		{
+			ParkingBatch batch;
+			for (size_t t = 0; t < numThreads; ++t) {
+				spots[t].unpark(batch);
+			}
+		}
+		waitRound(round);
+		times.push_back(std::chrono::duration<double, std::micro>(round._lastAwake - start).count());
+	}
+
+	letThreadsPark();
+	round._stop.store(true);
+	{
+		ParkingBatch batch;
+		for (size_t t = 0; t < numThreads; ++t) {
+			spots[t].unpark(batch);
+		}
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	return median(times);
+}
+
+int main()
+{
+	printf("CPUs: %u, median of %d rounds\n", std::thread::hardware_concurrency(), ROUNDS);
+	printf("%8s %16s %16s\n", "threads", "condvar (us)", "batch (us)");
+	for (size_t numThreads : {1, 2, 4, 8, 16, 32}) {
+		const double condVarUs = benchConditionVariables(numThreads);
+		const double batchUs = benchParkingBatch(numThreads);
+		printf("%8zu %16.1f %16.1f\n", numThreads, condVarUs, batchUs);
+	}
+
+	return 0;
+}
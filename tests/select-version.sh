@@ -33,6 +33,16 @@ else
 	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},dlb.enabled=false"
 fi
 
+# Defer the external event completions with a small inbox so that it fills up
+if [[ "${*}" == *"events-stress"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},misc.deferred_events.enabled=true,misc.deferred_events.capacity=16"
+fi
+
+# Limit the device memory used by the directory so that the blocks are evicted
+if [[ "${*}" == *"cuda-eviction"* ]]; then
+	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},devices.directory_capacity=16M"
+fi
+
 # Setup NUMA config for numa-specific tests
 if [[ "${*}" == *"numa-on"* ]]; then
 	export NANOS6_CONFIG_OVERRIDE="${NANOS6_CONFIG_OVERRIDE},numa.tracking=on"
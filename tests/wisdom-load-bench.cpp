@@ -0,0 +1,172 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+
+	Copyright (C) 2023 Barcelona Supercomputing Center (BSC)
+*/
+
+// Microbenchmark of the load of the monitoring wisdom at the startup. It
+// compares the previous path, which parsed the JSON wisdom with JsonFile and
+// matched every tasktype of the file against every registered tasktype, with
+// the binary file of WisdomFile, which is mapped and searched per tasktype.
+//
+// It does not need the runtime. It is built with "make check", or by hand with:
+//
+//	g++ -std=c++17 -O2 -Isrc tests/wisdom-load-bench.cpp src/monitoring/WisdomFile.cpp src/lowlevel/FatalErrorHandler.cpp
+//
+// Both files are written in a temporary directory, so the loads read them
+// from the page cache
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "monitoring/WisdomFile.hpp"
+#include "support/JsonFile.hpp"
+
+#define REPETITIONS 5
+
+static const std::vector<std::string> _metrics = {
+	"NORMALIZED_COST", "PQOS_MON_EVENT_L3_OCCUP", "PQOS_PERF_EVENT_INSTRUCTIONS",
+	"PQOS_PERF_EVENT_CYCLES", "PQOS_PERF_EVENT_LLC_MISS"
+};
+
+static std::string label(int tasktype)
+{
+	return "tasktype-" + std::to_string(tasktype) + ":src/application.cpp:" + std::to_string(100 + tasktype);
+}
+
+static double value(int tasktype, size_t metric)
+{
+	return tasktype * 10.0 + metric + 0.5;
+}
+
+// The path before the binary wisdom, as in Monitoring::loadMonitoringWisdom
+static double oldLoad(const std::string &path, const std::vector<std::string> &registered)
+{
+	double sum = 0.0;
+
+	JsonFile wisdom(path);
+	wisdom.loadData();
+	wisdom.getRootNode()->traverseChildrenNodes(
+		[&](const std::string &fileLabel, const JsonNode<> &metricsNode) {
+			for (const std::string &taskLabel : registered) {
+				if (taskLabel != fileLabel)
+					continue;
+
+				for (const std::string &metric : _metrics) {
+					if (metricsNode.dataExists(metric)) {
+						double metricValue = 0.0;
+						if (metricsNode.getData(metric, metricValue))
+							sum += metricValue;
+					}
+				}
+			}
+		}
+	);
+
+	return sum;
+}
+
+// The path of Monitoring::loadMonitoringWisdom
+static double newLoad(const std::string &path, const std::vector<std::string> &registered)
+{
+	double sum = 0.0;
+
+	WisdomFile wisdom(path);
+	if (!wisdom.load())
+		return -1.0;
+
+	std::vector<int> indexes;
+	for (const std::string &metric : _metrics) {
+		indexes.push_back(wisdom.getMetricIndex(metric));
+	}
+
+	for (const std::string &taskLabel : registered) {
+		const double *values = wisdom.getValues(taskLabel);
+		if (values == nullptr)
+			continue;
+
+		for (int index : indexes) {
+			if (index >= 0 && !std::isnan(values[index]))
+				sum += values[index];
+		}
+	}
+
+	return sum;
+}
+
+template <typename F>
+static double measure(F load)
+{
+	double best = 0.0;
+	for (int r = 0; r < REPETITIONS; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		load();
+		auto end = std::chrono::steady_clock::now();
+		double us = std::chrono::duration<double, std::micro>(end - start).count();
+		best = (r == 0) ? us : std::min(best, us);
+	}
+	return best;
+}
+
+int main()
+{
+	char directory[] = "/tmp/nanos6-wisdom-bench-XXXXXX";
+	if (mkdtemp(directory) == nullptr) {
+		perror("mkdtemp");
+		return 1;
+	}
+	const std::string jsonPath = std::string(directory) + "/wisdom.json";
+	const std::string binaryPath = std::string(directory) + "/wisdom.bin";
+
+	int result = 0;
+
+	printf("%10s %14s %14s\n", "tasktypes", "json (us)", "binary (us)");
+	for (int numTasktypes : {10, 100, 1000, 5000}) {
+		// Write the same wisdom in both formats
+		boost::property_tree::ptree root;
+		WisdomFile::wisdom_data_t data;
+		std::vector<std::string> registered;
+		for (int t = 0; t < numTasktypes; ++t) {
+			const std::string taskLabel = label(t);
+			boost::property_tree::ptree metricsNode;
+			for (size_t m = 0; m < _metrics.size(); ++m) {
+				metricsNode.put(_metrics[m], value(t, m));
+				data[taskLabel][_metrics[m]] = value(t, m);
+			}
+			root.push_back(std::make_pair(taskLabel, metricsNode));
+			registered.push_back(taskLabel);
+		}
+		boost::property_tree::write_json(jsonPath, root);
+
+		unlink(binaryPath.c_str());
+		WisdomFile(binaryPath).store(data);
+
+		// Both paths must load the same values
+		const double oldSum = oldLoad(jsonPath, registered);
+		const double newSum = newLoad(binaryPath, registered);
+		if (oldSum != newSum) {
+			fprintf(stderr, "The loaded values differ with %d tasktypes\n", numTasktypes);
+			result = 1;
+			break;
+		}
+
+		const double oldUs = measure([&]() { oldLoad(jsonPath, registered); });
+		const double newUs = measure([&]() { newLoad(binaryPath, registered); });
+		printf("%10d %14.1f %14.1f\n", numTasktypes, oldUs, newUs);
+	}
+
+	unlink(jsonPath.c_str());
+	unlink(binaryPath.c_str());
+	rmdir(directory);
+
+	return result;
+}